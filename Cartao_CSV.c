@@ -11,6 +11,7 @@
 #include "hardware/i2c.h"
 #include "hardware/pwm.h"
 #include "hardware/clocks.h"
+#include "hardware/sync.h"
 #include "pico/stdlib.h"
 #include "pico/binary_info.h"
 #include "ff.h"
@@ -22,15 +23,48 @@
 #include "sd_card.h"
 #include "pico/bootrom.h"
 #include "ssd1306.h"
+#include "feedback.h"
+#include "amostras.h"
+#include "grafico.h"
+#include "protocolo.h"
+#include "usb_saida.h"
+#include "transferencia.h"
+#include "console.h"
+#include "catalogo.h"
+#include "indice.h"
+#include "agregador.h"
+#include "registro_csv.h"
+#include "estatisticas.h"
+#include "espaco.h"
+#include "formato.h"
+#include "orientacao.h"
+#include "nucleo1.h"
+#include "calibracao.h"
+#include "gatilho.h"
+#include "espectro.h"
+#include "decimador.h"
+#include "atividade.h"
+#include "mpu6050_escala.h"
+#include "adc_dma.h"
+#include "analogico.h"
+#include "sensores.h"
+#include "ambiente.h"
+#include "i2c_transacao.h"
 
 #define ADC_PIN 26
 #define I2C_PORT i2c0
 #define I2C_SDA 0
 #define I2C_SCL 1
 #define ENDERECO_MPU6050 0x68
+#define MPU6050_REG_SMPLRT_DIV 0x19
+#define MPU6050_REG_CONFIG 0x1A
+#define MPU6050_REG_PWR_MGMT_1 0x6B
 
 #define MAX_AMOSTRAS 99999
 #define PERIODO_MS 1000
+#define BYTES_POR_AMOSTRA_INICIAL 80 // linha típica do CSV, até medir a sessão atual
+#define ORIENTACAO_GANHO_PADRAO 1000  // Kp = 1,0 rad/s
+#define ORIENTACAO_ESPERA_US 2000     // espera máxima pelo quatérnio do core1
 #define I2C_PORT_DISP i2c1
 #define I2C_SDA_DISP 14
 #define I2C_SCL_DISP 15
@@ -69,9 +103,11 @@ static bool flag_gravar = false;
 static bool flag_parar_gravar = false;
 
 static void mpu6050_reset(void);
+static bool mpu6050_configurar_taxa(uint8_t divisor, uint8_t dlpf);
 static bool mpu6050_testar(void);
 static void mpu6050_ler_dados(int16_t accel[3], int16_t gyro[3], int16_t *temp);
-static void capture_adc_data_and_save(void);
+static bool mpu6050_ler_bruto(int16_t accel[3], int16_t gyro[3], int16_t *temp);
+static void run_adc(void);
 static void capturar_dados_mpu6050_e_salvar(void);
 static void run_setrtc(void);
 static void run_format(void);
@@ -79,131 +115,253 @@ static void run_mount(void);
 static void run_unmount(void);
 static void run_getfree(void);
 static void run_ls(void);
+static void run_dir(void);
+static void run_info(void);
+static void run_catalogo(void);
+static void run_range(void);
+static void run_exportar(void);
 static void run_cat(void);
 static void run_iniciar(void);
 static void run_ajuda(void);
-static void processar_stdio(int cRxedChar);
+static void run_grafico(void);
+static void run_stream(void);
+static void run_baixar(void);
+static void run_orientacao(void);
+static void run_calibrar(void);
+static void run_gatilho(void);
+static void run_espectro(void);
+static void run_decimar(void);
+static void run_adaptativo(void);
+static void run_mpu6050(void);
+static void run_analogico(void);
+static void run_sensores(void);
+static void encerrar_captura(void);
+static int processar_stdio(int cRxedChar);
 static void ler_arquivo(const char *nome_arquivo);
 static void gpio_irq_handler(uint gpio, uint32_t events);
 static void exibir_data_hora(void);
+static uint32_t taxa_gravacao(void);
 
 static bool logger_ativado = false;
 static absolute_time_t proxima_captura;
 static char nome_arquivo[32]; // Aumentado para suportar "dadosDDMMAAAAHHMMSS.csv"
 static int contador_amostras = 0;
 static ssd1306_t ssd;
-static absolute_time_t mensagem_timeout = {0};           // Controla timeout da mensagem
+static catalogo_sessao_t sessao; // registro da captura em andamento no catálogo
+static uint32_t sessao_indice;
+static bool sessao_aberta = false;
+static absolute_time_t inicio_captura; // referência da coluna Tempo_ms
+static char nome_indice[32];
+static estatisticas_t estatisticas; // gravadas em dadosX.est ao parar
+static bool estatisticas_pendentes = false;
+static uint32_t bytes_sessao;      // gravados no CSV e no índice na captura atual
+static uint32_t bytes_por_amostra = BYTES_POR_AMOSTRA_INICIAL;
+static bool orientacao_sessao = false; // colunas Q0..Q3 no CSV da captura atual
+static uint32_t orientacao_atrasos;    // amostras gravadas sem o quatérnio
+static calibracao_t calibracao;         // aplicada a cada amostra da captura
+static calibracao_t calibracao_salva;   // como está na flash, nas faixas em que foi estimada
+static bool gatilho_sessao = false;     // captura atual disparada por evento
+static bool adc_gravando = false;       // captura do ADC por DMA em andamento
 static absolute_time_t ultima_atualizacao_display = {0}; // Controla atualização do display
 
 static sd_card_t *sd_obter_por_nome(const char *const nome)
 {
-   // printf("[DEBUG] sd_obter_por_nome: Procurando %s\n", nome);
+   // LOG_DEBUG("sd_obter_por_nome: Procurando %s\n", nome);
     for (size_t i = 0; i < sd_get_num(); ++i)
         if (0 == strcmp(sd_get_by_num(i)->pcName, nome))
             return sd_get_by_num(i);
-    printf("[ERRO] sd_obter_por_nome: Nome desconhecido %s\n", nome);
+    LOG_ERRO("sd_obter_por_nome: Nome desconhecido %s\n", nome);
     return NULL;
 }
 
 static FATFS *sd_obter_fs_por_nome(const char *nome)
 {
-    printf("[DEBUG] sd_obter_fs_por_nome: Procurando %s\n", nome);
+    LOG_DEBUG("sd_obter_fs_por_nome: Procurando %s\n", nome);
     for (size_t i = 0; i < sd_get_num(); ++i)
         if (0 == strcmp(sd_get_by_num(i)->pcName, nome))
             return &sd_get_by_num(i)->fatfs;
-    printf("[ERRO] sd_obter_fs_por_nome: Nome desconhecido %s\n", nome);
+    LOG_ERRO("sd_obter_fs_por_nome: Nome desconhecido %s\n", nome);
     return NULL;
 }
 
-static bool sd_esta_montado(const char *nome)
+// Estado da montagem em flag: o laço principal consulta várias vezes por
+// volta, sem procurar o cartão pelo nome
+static bool sd_montado = false;
+
+static inline bool sd_esta_montado()
 {
-    //printf("[DEBUG] sd_esta_montado: Verificando %s\n", nome);
-    sd_card_t *pSD = sd_obter_por_nome(nome);
-    bool montado = pSD && pSD->mounted;
-    //printf("[DEBUG] sd_esta_montado: Resultado=%d\n", montado);
-    return montado;
+    return sd_montado;
 }
 
 static bool mpu6050_testar()
 {
-    printf("[DEBUG] mpu6050_testar: Iniciando teste...\n");
+    LOG_DEBUG("mpu6050_testar: Iniciando teste...\n");
     uint8_t who_am_i = 0x75;
     uint8_t valor;
     int write_result = i2c_write_blocking(I2C_PORT, ENDERECO_MPU6050, &who_am_i, 1, true);
-    printf("[DEBUG] mpu6050_testar: I2C write (WHO_AM_I): resultado=%d\n", write_result);
+    LOG_DEBUG("mpu6050_testar: I2C write (WHO_AM_I): resultado=%d\n", write_result);
     sleep_us(100);
     if (write_result != 1)
     {
-        printf("[ERRO] mpu6050_testar: Falha na escrita I2C\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro MPU6050", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        LOG_ERRO("mpu6050_testar: Falha na escrita I2C\n");
+        feedback_mensagem("Erro MPU6050", MENSAGEM_TIMEOUT_MS);
         return false;
     }
     int read_result = i2c_read_blocking(I2C_PORT, ENDERECO_MPU6050, &valor, 1, false);
-    printf("[DEBUG] mpu6050_testar: I2C read (WHO_AM_I): resultado=%d, valor=0x%02X\n", read_result, valor);
+    LOG_DEBUG("mpu6050_testar: I2C read (WHO_AM_I): resultado=%d, valor=0x%02X\n", read_result, valor);
     sleep_us(100);
     if (read_result != 1)
     {
-        printf("[ERRO] mpu6050_testar: Falha na leitura I2C\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro MPU6050", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        LOG_ERRO("mpu6050_testar: Falha na leitura I2C\n");
+        feedback_mensagem("Erro MPU6050", MENSAGEM_TIMEOUT_MS);
         return false;
     }
     bool sucesso = (valor == 0x68 || valor == 0x70);
     if (valor == 0x70)
-        printf("[AVISO] mpu6050_testar: Endereço I2C não padrão detectado (0x70).\n");
-    printf("[DEBUG] mpu6050_testar: Resultado=%s (esperado=0x68 ou 0x70, recebido=0x%02X)\n", sucesso ? "Sucesso" : "Falha", valor);
+        LOG_AVISO("mpu6050_testar: Endereço I2C não padrão detectado (0x70).\n");
+    LOG_DEBUG("mpu6050_testar: Resultado=%s (esperado=0x68 ou 0x70, recebido=0x%02X)\n", sucesso ? "Sucesso" : "Falha", valor);
     return sucesso;
 }
 
+// Faixas, DLPF e divisor em uso (lib/mpu6050_escala.h). O comando
+// "mpu6050" troca tudo entre capturas; a taxa adaptativa muda só o divisor
+// e o DLPF durante a captura e os devolve no fim
+static mpu6050_config_t mpu6050_config;
+
+// Colunas de aceleração e rotação do CSV em µg e m°/s ("mpu6050 unidades
+// on"). Só a saída muda: estatísticas, gatilho, espectro e orientação
+// continuam trabalhando em LSB
+static bool unidades_engenharia = false;
+
+static void unidades_converter(const int16_t accel[3], const int16_t gyro[3], int32_t accel_saida[3],
+                               int32_t gyro_saida[3])
+{
+    if (unidades_engenharia)
+    {
+        mpu6050_unidades(&mpu6050_config, accel, gyro, accel_saida, gyro_saida);
+        return;
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        accel_saida[i] = accel[i];
+        gyro_saida[i] = gyro[i];
+    }
+}
+
+static bool mpu6050_escrever(uint8_t reg, uint8_t valor)
+{
+    uint8_t buf[] = {reg, valor};
+    return i2c_write_blocking(I2C_PORT, ENDERECO_MPU6050, buf, 2, false) == 2;
+}
+
+// SMPLRT_DIV e CONFIG numa só transação (registros consecutivos). Sem logs
+// nem esperas: a taxa adaptativa chama na interrupção de leitura
+static bool mpu6050_configurar_taxa(uint8_t divisor, uint8_t dlpf)
+{
+    uint8_t buf[] = {MPU6050_REG_SMPLRT_DIV, divisor, dlpf};
+    if (i2c_write_blocking(I2C_PORT, ENDERECO_MPU6050, buf, 3, false) != 3)
+        return false;
+    mpu6050_config.divisor = divisor;
+    mpu6050_config.dlpf = dlpf;
+    return true;
+}
+
+// Os registros 0x19 a 0x1C numa só transação, conferidos por releitura: ou
+// a configuração inteira vale, ou os registros voltam à anterior
+static bool mpu6050_aplicar(const mpu6050_config_t *c)
+{
+    static const uint8_t mascara[4] = {0xFF, 0x3F, 0x18, 0x18};
+    uint8_t buf[5] = {MPU6050_REG_SMPLRT_DIV};
+    mpu6050_registros(c, buf + 1);
+    uint8_t reg = MPU6050_REG_SMPLRT_DIV;
+    uint8_t lido[4];
+    bool ok = i2c_write_blocking(I2C_PORT, ENDERECO_MPU6050, buf, sizeof(buf), false) == sizeof(buf) &&
+              i2c_write_blocking(I2C_PORT, ENDERECO_MPU6050, &reg, 1, true) == 1 &&
+              i2c_read_blocking(I2C_PORT, ENDERECO_MPU6050, lido, sizeof(lido), false) == sizeof(lido);
+    for (int i = 0; ok && i < 4; i++)
+        ok = (lido[i] & mascara[i]) == buf[1 + i];
+    if (!ok)
+    {
+        mpu6050_registros(&mpu6050_config, buf + 1);
+        i2c_write_blocking(I2C_PORT, ENDERECO_MPU6050, buf, sizeof(buf), false);
+        return false;
+    }
+    mpu6050_config = *c;
+    return true;
+}
+
 static void mpu6050_reset()
 {
-    printf("[DEBUG] mpu6050_reset: Iniciando reset...\n");
-    uint8_t buf[] = {0x6B, 0x80};
-    i2c_write_blocking(I2C_PORT, ENDERECO_MPU6050, buf, 2, false);
+    LOG_DEBUG("mpu6050_reset: Iniciando reset...\n");
+    mpu6050_escrever(MPU6050_REG_PWR_MGMT_1, 0x80);
     sleep_ms(100);
-    buf[1] = 0x00;
-    i2c_write_blocking(I2C_PORT, ENDERECO_MPU6050, buf, 2, false);
+    mpu6050_escrever(MPU6050_REG_PWR_MGMT_1, 0x00);
     sleep_ms(10);
-    printf("[DEBUG] mpu6050_reset: Reset concluído\n");
+    // O reset volta os registros ao padrão: reaplica a configuração em uso
+    mpu6050_config_t em_uso = mpu6050_config;
+    if (!mpu6050_aplicar(&em_uso))
+        LOG_ERRO("mpu6050_reset: Falha ao reaplicar faixas e taxa\n");
+    LOG_DEBUG("mpu6050_reset: Reset concluído\n");
 }
 
 static void mpu6050_ler_dados(int16_t accel[3], int16_t gyro[3], int16_t *temp)
 {
-    printf("[DEBUG] mpu6050_ler_dados: Iniciando leitura...\n");
+    LOG_DEBUG("mpu6050_ler_dados: Iniciando leitura...\n");
     uint8_t buffer[6];
     uint8_t val = 0x3B;
     int write_result = i2c_write_blocking(I2C_PORT, ENDERECO_MPU6050, &val, 1, true);
-    printf("[DEBUG] mpu6050_ler_dados: I2C write (accel, 0x3B): resultado=%d\n", write_result);
+    LOG_DEBUG("mpu6050_ler_dados: I2C write (accel, 0x3B): resultado=%d\n", write_result);
     sleep_us(100);
     int read_result = i2c_read_blocking(I2C_PORT, ENDERECO_MPU6050, buffer, 6, false);
-    printf("[DEBUG] mpu6050_ler_dados: I2C read (accel): resultado=%d\n", read_result);
+    LOG_DEBUG("mpu6050_ler_dados: I2C read (accel): resultado=%d\n", read_result);
     for (int i = 0; i < 3; i++)
         accel[i] = (buffer[i * 2] << 8) | buffer[(i * 2) + 1];
-    printf("[DEBUG] mpu6050_ler_dados: Acelerômetro: X=%d, Y=%d, Z=%d\n", accel[0], accel[1], accel[2]);
+    LOG_DEBUG("mpu6050_ler_dados: Acelerômetro: X=%d, Y=%d, Z=%d\n", accel[0], accel[1], accel[2]);
 
     val = 0x43;
     write_result = i2c_write_blocking(I2C_PORT, ENDERECO_MPU6050, &val, 1, true);
-    printf("[DEBUG] mpu6050_ler_dados: I2C write (gyro, 0x43): resultado=%d\n", write_result);
+    LOG_DEBUG("mpu6050_ler_dados: I2C write (gyro, 0x43): resultado=%d\n", write_result);
     sleep_us(100);
     read_result = i2c_read_blocking(I2C_PORT, ENDERECO_MPU6050, buffer, 6, false);
-    printf("[DEBUG] mpu6050_ler_dados: I2C read (gyro): resultado=%d\n", read_result);
+    LOG_DEBUG("mpu6050_ler_dados: I2C read (gyro): resultado=%d\n", read_result);
     for (int i = 0; i < 3; i++)
         gyro[i] = (buffer[i * 2] << 8) | buffer[(i * 2) + 1];
-    printf("[DEBUG] mpu6050_ler_dados: Giroscópio: X=%d, Y=%d, Z=%d\n", gyro[0], gyro[1], gyro[2]);
+    LOG_DEBUG("mpu6050_ler_dados: Giroscópio: X=%d, Y=%d, Z=%d\n", gyro[0], gyro[1], gyro[2]);
 
     val = 0x41;
     write_result = i2c_write_blocking(I2C_PORT, ENDERECO_MPU6050, &val, 1, true);
-    printf("[DEBUG] mpu6050_ler_dados: I2C write (temp, 0x41): resultado=%d\n", write_result);
+    LOG_DEBUG("mpu6050_ler_dados: I2C write (temp, 0x41): resultado=%d\n", write_result);
     sleep_us(100);
     read_result = i2c_read_blocking(I2C_PORT, ENDERECO_MPU6050, buffer, 2, false);
-    printf("[DEBUG] mpu6050_ler_dados: I2C read (temp): resultado=%d\n", read_result);
+    LOG_DEBUG("mpu6050_ler_dados: I2C read (temp): resultado=%d\n", read_result);
     *temp = (buffer[0] << 8) | buffer[1];
-    printf("[DEBUG] mpu6050_ler_dados: Temperatura: %d\n", *temp);
+    LOG_DEBUG("mpu6050_ler_dados: Temperatura: %d\n", *temp);
+}
+
+// Limites da leitura em rajada. A soma (491 us) fica abaixo do menor período
+// de amostragem (500 us): barramento preso vira leitura falha em vez de
+// travar a interrupção do amostrador
+#define MPU6050_LIMITE_REGISTRO_US I2C_TRANSACAO_US(2) // endereço + registro
+#define MPU6050_LIMITE_RAJADA_US I2C_TRANSACAO_US(15)  // endereço + 14 bytes
+
+// Leitura em rajada dos 14 bytes a partir de ACCEL_XOUT_H (0x3B):
+// acelerômetro, temperatura e giroscópio em uma única transação, sem logs
+static bool mpu6050_ler_bruto(int16_t accel[3], int16_t gyro[3], int16_t *temp)
+{
+    uint8_t reg = 0x3B;
+    uint8_t buffer[14];
+    if (i2c_write_timeout_us(I2C_PORT, ENDERECO_MPU6050, &reg, 1, true, MPU6050_LIMITE_REGISTRO_US) != 1)
+        return false;
+    if (i2c_read_timeout_us(I2C_PORT, ENDERECO_MPU6050, buffer, sizeof(buffer), false, MPU6050_LIMITE_RAJADA_US) !=
+        sizeof(buffer))
+        return false;
+    for (int i = 0; i < 3; i++)
+    {
+        accel[i] = (buffer[i * 2] << 8) | buffer[(i * 2) + 1];
+        gyro[i] = (buffer[8 + i * 2] << 8) | buffer[8 + (i * 2) + 1];
+    }
+    *temp = (buffer[6] << 8) | buffer[7];
+    return true;
 }
 
 static void exibir_data_hora()
@@ -218,12 +376,27 @@ static void exibir_data_hora()
         ssd1306_draw_string(&ssd, data_str, 5, 0);
         ssd1306_draw_string(&ssd, hora_str, 5, 10);
 
-        if (!sd_esta_montado("0:"))
+        if (!sd_esta_montado())
         {
             ssd1306_draw_string(&ssd, "MONTAR SD CARD", 0, 30);
         }
         else
         {
+            // Espaço livre e quanto tempo de captura ele comporta
+            char linha[20];
+            uint64_t livre;
+            uint32_t segundos;
+            if (espaco_livre(&livre) && espaco_previsao(taxa_gravacao(), &segundos))
+            {
+                char duracao[12];
+                espaco_formatar_duracao(segundos, duracao, sizeof(duracao));
+                snprintf(linha, sizeof(linha), "%.1fG %s", livre / 1073741824.0, duracao);
+            }
+            else
+            {
+                snprintf(linha, sizeof(linha), "Contando %u%%", espaco_progresso());
+            }
+            ssd1306_draw_string(&ssd, linha, 5, 20);
             ssd1306_draw_string(&ssd, "Pronto para ", 30, 30);
             ssd1306_draw_string(&ssd, "Iniciar", 30, 40);
             ssd1306_draw_string(&ssd, "Captura", 30, 50);
@@ -240,70 +413,52 @@ static void exibir_data_hora()
 
 static void run_setrtc()
 {
-    printf("[DEBUG] run_setrtc: Iniciando...\n");
+    LOG_DEBUG("run_setrtc: Iniciando...\n");
     const char *diaStr = strtok(NULL, " ");
     if (!diaStr)
     {
-        printf("Falta argumento\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro: Argumento", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Falta argumento\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
         return;
     }
     int dia = atoi(diaStr);
     const char *mesStr = strtok(NULL, " ");
     if (!mesStr)
     {
-        printf("Falta argumento\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro: Argumento", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Falta argumento\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
         return;
     }
     int mes = atoi(mesStr);
     const char *anoStr = strtok(NULL, " ");
     if (!anoStr)
     {
-        printf("Falta argumento\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro: Argumento", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Falta argumento\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
         return;
     }
     int ano = atoi(anoStr) + 2000;
     const char *horaStr = strtok(NULL, " ");
     if (!horaStr)
     {
-        printf("Falta argumento\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro: Argumento", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Falta argumento\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
         return;
     }
     int hora = atoi(horaStr);
     const char *minStr = strtok(NULL, " ");
     if (!minStr)
     {
-        printf("Falta argumento\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro: Argumento", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Falta argumento\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
         return;
     }
     int min = atoi(minStr);
     const char *segStr = strtok(NULL, " ");
     if (!segStr)
     {
-        printf("Falta argumento\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro: Argumento", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Falta argumento\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
         return;
     }
     int seg = atoi(segStr);
@@ -317,67 +472,108 @@ static void run_setrtc()
         .sec = (int8_t)seg};
     if (rtc_set_datetime(&t))
     {
-        printf("[DEBUG] run_setrtc: RTC configurado com sucesso\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "RTC Configurado", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        LOG_DEBUG("run_setrtc: RTC configurado com sucesso\n");
+        feedback_mensagem("RTC Configurado", MENSAGEM_TIMEOUT_MS);
     }
     else
     {
-        printf("[ERRO] run_setrtc: Falha ao configurar RTC\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro RTC", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        LOG_ERRO("run_setrtc: Falha ao configurar RTC\n");
+        feedback_mensagem("Erro RTC", MENSAGEM_TIMEOUT_MS);
     }
 }
 
+// format [registro|padrao] [<drive#:>]: o perfil de registro (padrão)
+// escolhe FAT, cluster e alinhamento pela capacidade (lib/formato.h);
+// "padrao" mantém a escolha automática do FatFs
 static void run_format()
 {
-    printf("[DEBUG] run_format: Iniciando...\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "Formatando SD", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-    const char *arg1 = strtok(NULL, " ");
+    LOG_DEBUG("run_format: Iniciando...\n");
+    feedback_mensagem("Formatando SD", MENSAGEM_TIMEOUT_MS);
+    const char *arg1 = NULL;
+    bool perfil_registro = true;
+    for (const char *arg = strtok(NULL, " "); arg; arg = strtok(NULL, " "))
+    {
+        if (0 == strcmp(arg, "padrao"))
+            perfil_registro = false;
+        else if (0 != strcmp(arg, "registro"))
+            arg1 = arg;
+    }
     if (!arg1)
         arg1 = sd_get_by_num(0)->pcName;
     FATFS *p_fs = sd_obter_fs_por_nome(arg1);
-    if (!p_fs)
+    sd_card_t *pSD = sd_obter_por_nome(arg1);
+    if (!p_fs || !pSD)
     {
-        printf("Número de drive desconhecido: \"%s\"\n", arg1);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro: Drive", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Número de drive desconhecido: \"%s\"\n", arg1);
+        feedback_mensagem("Erro: Drive", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (pSD->init(pSD) & STA_NOINIT)
+    {
+        console_printf("Cartão SD não responde\n");
+        feedback_mensagem("SD Não Detectado", MENSAGEM_TIMEOUT_MS);
         return;
     }
-    FRESULT fr = f_mkfs(arg1, 0, 0, FF_MAX_SS * 2);
+
+    formato_perfil_t perfil;
+    formato_perfil_registro(pSD->sectors, &perfil);
+    if (perfil_registro)
+        console_printf("Perfil de registro para %llu MiB: %s\n", (unsigned long long)(pSD->sectors / 2048),
+                       perfil.descricao);
+    else
+        console_printf("Perfil padrão do FatFs\n");
+
+    espaco_parar();
+    absolute_time_t inicio = get_absolute_time();
+    const MKFS_PARM *parametros = perfil_registro ? &perfil.parametros : NULL;
+    // Buffer maior: a FAT é zerada em gravações de vários setores
+    FRESULT fr = f_mkfs(arg1, parametros, NULL, FORMATO_BUFFER);
+    if (FR_NOT_ENOUGH_CORE == fr)
+        fr = f_mkfs(arg1, parametros, NULL, FF_MAX_SS * 2);
     if (FR_OK != fr)
     {
-        printf("Erro f_mkfs: %s (%d)\n", FRESULT_str(fr), fr);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro Formatação", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Erro f_mkfs: %s (%d)\n", FRESULT_str(fr), fr);
+        feedback_mensagem("Erro Formatação", MENSAGEM_TIMEOUT_MS);
         return;
     }
-    printf("[DEBUG] run_format: Formatação concluída\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "SD Formatado", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+    uint32_t duracao_ms = (uint32_t)(absolute_time_diff_us(inicio, get_absolute_time()) / 1000);
+
+    // O f_mkfs invalida a montagem anterior: remonta para o contador de
+    // espaço livre e para informar o resultado
+    if (pSD->mounted)
+    {
+        fr = f_mount(p_fs, arg1, 1);
+        if (FR_OK == fr)
+        {
+            espaco_iniciar(p_fs);
+            console_printf("%s, cluster de %lu KiB, dados a partir do setor %llu, em %lu ms\n",
+                           formato_nome_tipo(p_fs->fs_type), (unsigned long)(p_fs->csize / 2),
+                           (unsigned long long)p_fs->database, (unsigned long)duracao_ms);
+        }
+        else
+        {
+            console_printf("Erro f_mount: %s (%d)\n", FRESULT_str(fr), fr);
+        }
+    }
+    LOG_DEBUG("run_format: Formatação concluída\n");
+    feedback_mensagem("SD Formatado", MENSAGEM_TIMEOUT_MS);
 }
 
 ///--------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static int sd_cartao_conectado(const char *nome)
+// Identidade (CID) do último cartão inicializado. Enquanto o cartão não sai
+// do soquete ele continua em modo SPI, e a remontagem dispensa o CMD0/CMD8/ACMD41
+static uint8_t sd_cid[16];
+static bool sd_cid_valido = false;
+
+static int sd_cartao_conectado(const char *nome, bool *rapido)
 {
+    *rapido = false;
+
     // Valida o formato do nome do drive (ex.: "0:")
     if (!nome || nome[0] < '0' || nome[0] > '9' || nome[1] != ':')
     {
-        printf("[ERRO] sd_cartao_conectado: Formato de nome inválido: %s\n", nome ? nome : "NULL");
+        LOG_ERRO("sd_cartao_conectado: Formato de nome inválido: %s\n", nome ? nome : "NULL");
         return 0;
     }
 
@@ -385,28 +581,45 @@ static int sd_cartao_conectado(const char *nome)
     sd_card_t *pSD = sd_obter_por_nome(nome);
     if (!pSD)
     {
-        printf("[ERRO] sd_cartao_conectado: Drive %s não encontrado\n", nome);
+        LOG_ERRO("sd_cartao_conectado: Drive %s não encontrado\n", nome);
         return 0;
     }
 
     // Extrai o índice do drive
     int drive_num = nome[0] - '0'; // Converte '0' para 0, '1' para 1, etc.
 
-    // Força inicialização para atualizar o status
+    // Mesmo cartão ainda inicializado: responde ao CMD10 com o CID guardado.
+    // Um cartão trocado ou reinserido não responde (voltou ao modo SD) ou
+    // traz outro CID, e passa pela inicialização completa. Sem cartão no
+    // soquete, disk_status() já devolve STA_NOINIT
+    if (sd_cid_valido && !(disk_status(drive_num) & STA_NOINIT))
+    {
+        uint8_t cid[16];
+        if (sd_read_cid(pSD, cid) && 0 == memcmp(cid, sd_cid, sizeof(cid)))
+        {
+            LOG_DEBUG("sd_cartao_conectado: Mesmo cartão, inicialização reaproveitada\n");
+            *rapido = true;
+            return 1;
+        }
+        pSD->m_Status |= STA_NOINIT;
+    }
+    sd_cid_valido = false;
+
     if (disk_initialize(drive_num) != 0)
     {
-        printf("[ERRO] sd_cartao_conectado: Falha ao inicializar drive %d\n", drive_num);
+        LOG_ERRO("sd_cartao_conectado: Falha ao inicializar drive %d\n", drive_num);
         return 0;
     }
 
     // Verifica se o cartão está ausente
     if (disk_status(drive_num) & STA_NODISK)
     {
-        printf("[DEBUG] sd_cartao_conectado: Cartão SD não detectado (STA_NODISK)\n");
+        LOG_DEBUG("sd_cartao_conectado: Cartão SD não detectado (STA_NODISK)\n");
         return 0;
     }
+    sd_cid_valido = sd_read_cid(pSD, sd_cid);
 
-    printf("[DEBUG] sd_cartao_conectado: Cartão SD detectado no drive %d\n", drive_num);
+    LOG_DEBUG("sd_cartao_conectado: Cartão SD detectado no drive %d\n", drive_num);
     return 1;
 }
 //--------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -415,20 +628,18 @@ static bool erro_montagem = false;
 
 static void run_mount()
 {
-    printf("[DEBUG] run_mount: Iniciando...\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "Montando SD", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+    LOG_DEBUG("run_mount: Iniciando...\n");
+    feedback_mensagem("Montando SD", MENSAGEM_TIMEOUT_MS);
+
+    // Latência da montagem: da detecção do cartão até o volume montado
+    absolute_time_t inicio = get_absolute_time();
+    bool rapido;
 
     // Verifica se o cartão SD está conectado
-    if (!sd_cartao_conectado("0:"))
+    if (!sd_cartao_conectado("0:", &rapido))
     {
-        printf("[ERRO] Cartão SD não detectado\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "SD Não Detectado", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        LOG_ERRO("Cartão SD não detectado\n");
+        feedback_mensagem("SD Não Detectado", MENSAGEM_TIMEOUT_MS);
         erro_montagem = true; // Define flag de erro
         return;
     }
@@ -439,11 +650,8 @@ static void run_mount()
     FATFS *p_fs = sd_obter_fs_por_nome(arg1);
     if (!p_fs)
     {
-        printf("Número de drive desconhecido: \"%s\"\n", arg1);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro: Drive", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Número de drive desconhecido: \"%s\"\n", arg1);
+        feedback_mensagem("Erro: Drive", MENSAGEM_TIMEOUT_MS);
         erro_montagem = true; // Define flag de erro
         return;
     }
@@ -451,11 +659,8 @@ static void run_mount()
     FRESULT fr = f_mount(p_fs, arg1, 1);
     if (FR_OK != fr)
     {
-        printf("Erro f_mount: %s (%d)\n", FRESULT_str(fr), fr);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro Montagem", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Erro f_mount: %s (%d)\n", FRESULT_str(fr), fr);
+        feedback_mensagem("Erro Montagem", MENSAGEM_TIMEOUT_MS);
         erro_montagem = true; // Define flag de erro
         return;
     }
@@ -463,105 +668,94 @@ static void run_mount()
     sd_card_t *pSD = sd_obter_por_nome(arg1);
     myASSERT(pSD);
     pSD->mounted = true;
-    printf("Processo de montagem do SD ( %s ) concluído\n", pSD->pcName);
-    printf("[DEBUG] run_mount: Montagem concluída\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "SD Montado", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+    sd_montado = true;
+    uint32_t latencia_us = (uint32_t)absolute_time_diff_us(inicio, get_absolute_time());
+    espaco_iniciar(p_fs);
+    console_printf("Processo de montagem do SD ( %s ) concluído em %lu.%03lu ms (%s)\n", pSD->pcName,
+                   (unsigned long)(latencia_us / 1000), (unsigned long)(latencia_us % 1000),
+                   rapido ? "remontagem rápida" : "inicialização completa");
+    LOG_DEBUG("run_mount: Montagem concluída\n");
+    feedback_mensagem("SD Montado", MENSAGEM_TIMEOUT_MS);
     erro_montagem = false; // Montagem bem-sucedida, zera flag de erro
 }
 
 static void run_unmount()
 {
-    printf("[DEBUG] run_unmount: Iniciando...\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "Desmontando SD", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+    LOG_DEBUG("run_unmount: Iniciando...\n");
+    feedback_mensagem("Desmontando SD", MENSAGEM_TIMEOUT_MS);
     const char *arg1 = strtok(NULL, " ");
     if (!arg1)
         arg1 = sd_get_by_num(0)->pcName;
     FATFS *p_fs = sd_obter_fs_por_nome(arg1);
     if (!p_fs)
     {
-        printf("Número de drive desconhecido: \"%s\"\n", arg1);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro: Drive", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Número de drive desconhecido: \"%s\"\n", arg1);
+        feedback_mensagem("Erro: Drive", MENSAGEM_TIMEOUT_MS);
         return;
     }
+    espaco_parar();
     FRESULT fr = f_unmount(arg1);
     if (FR_OK != fr)
     {
-        printf("Erro f_unmount: %s (%d)\n", FRESULT_str(fr), fr);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro Desmontagem", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Erro f_unmount: %s (%d)\n", FRESULT_str(fr), fr);
+        feedback_mensagem("Erro Desmontagem", MENSAGEM_TIMEOUT_MS);
         return;
     }
     sd_card_t *pSD = sd_obter_por_nome(arg1);
     myASSERT(pSD);
     pSD->mounted = false;
-    pSD->m_Status |= STA_NOINIT;
-    printf("SD ( %s ) desmontado\n", pSD->pcName);
-    printf("[DEBUG] run_unmount: Desmontagem concluída\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "SD Desmontado", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+    sd_montado = false;
+    // O cartão continua inicializado: a próxima montagem confere o CID e só
+    // refaz o handshake se for outro cartão
+    console_printf("SD ( %s ) desmontado\n", pSD->pcName);
+    LOG_DEBUG("run_unmount: Desmontagem concluída\n");
+    feedback_mensagem("SD Desmontado", MENSAGEM_TIMEOUT_MS);
+}
+
+// Taxa de gravação da captura: bytes por amostra medidos na sessão atual
+// (ou na última) no período configurado
+static uint32_t taxa_gravacao()
+{
+    return bytes_por_amostra * 1000 / PERIODO_MS;
 }
 
+// Espaço livre pelo contador mantido em lib/espaco: não chama f_getfree(),
+// que pode percorrer a FAT inteira
 static void run_getfree()
 {
-    printf("[DEBUG] run_getfree: Iniciando...\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "Verificando Espaço", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-    const char *arg1 = strtok(NULL, " ");
-    if (!arg1)
-        arg1 = sd_get_by_num(0)->pcName;
-    DWORD fre_clust, fre_sect, tot_sect;
-    FATFS *p_fs = sd_obter_fs_por_nome(arg1);
-    if (!p_fs)
+    LOG_DEBUG("run_getfree: Iniciando...\n");
+    if (espaco_estado() == ESPACO_DESMONTADO)
     {
-        printf("Número de drive desconhecido: \"%s\"\n", arg1);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro: Drive", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Cartão SD não está montado.\n");
+        feedback_mensagem("Erro: SD Não Montado", MENSAGEM_TIMEOUT_MS);
         return;
     }
-    FRESULT fr = f_getfree(arg1, &fre_clust, &p_fs);
-    if (FR_OK != fr)
+    uint64_t livre;
+    console_printf("%10llu KiB de espaço total.\n", (unsigned long long)(espaco_total() / 1024));
+    if (!espaco_livre(&livre))
     {
-        printf("Erro f_getfree: %s (%d)\n", FRESULT_str(fr), fr);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro Espaço", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Espaço livre: contando clusters (%u%%), tente de novo em instantes.\n", espaco_progresso());
+        feedback_mensagem("Contando Espaço", MENSAGEM_TIMEOUT_MS);
         return;
     }
-    tot_sect = (p_fs->n_fatent - 2) * p_fs->csize;
-    fre_sect = fre_clust * p_fs->csize;
-    printf("%10lu KiB de espaço total.\n%10lu KiB disponíveis.\n", tot_sect / 2, fre_sect / 2);
-    printf("[DEBUG] run_getfree: Espaço livre obtido\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "Espaço Obtido", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+    console_printf("%10llu KiB disponíveis (%s).\n", (unsigned long long)(livre / 1024),
+                   espaco_estado() == ESPACO_VERIFICADO ? "conferido com a FAT" : "FSINFO, conferindo");
+    uint32_t segundos;
+    char duracao[16];
+    if (espaco_previsao(taxa_gravacao(), &segundos))
+    {
+        espaco_formatar_duracao(segundos, duracao, sizeof(duracao));
+        console_printf("Captura restante: %s a %lu bytes/amostra a cada %d ms (reserva de %u KiB)\n", duracao,
+                       (unsigned long)bytes_por_amostra, PERIODO_MS, ESPACO_RESERVA_BYTES / 1024);
+    }
+    LOG_DEBUG("run_getfree: Espaço livre obtido\n");
+    feedback_mensagem("Espaço Obtido", MENSAGEM_TIMEOUT_MS);
 }
 
-static void run_ls()
+static void run_dir()
 {
-    printf("[DEBUG] run_ls: Iniciando...\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "Listando Arquivos", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+    LOG_DEBUG("run_dir: Iniciando...\n");
+    feedback_mensagem("Listando Arquivos", MENSAGEM_TIMEOUT_MS);
     const char *arg1 = strtok(NULL, " ");
     if (!arg1)
         arg1 = "";
@@ -577,16 +771,13 @@ static void run_ls()
         fr = f_getcwd(cwdbuf, sizeof cwdbuf);
         if (FR_OK != fr)
         {
-            printf("Erro f_getcwd: %s (%d)\n", FRESULT_str(fr), fr);
-            ssd1306_fill(&ssd, false);
-            ssd1306_draw_string(&ssd, "Erro Listagem", 5, 0);
-            ssd1306_send_data(&ssd);
-            mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+            console_printf("Erro f_getcwd: %s (%d)\n", FRESULT_str(fr), fr);
+            feedback_mensagem("Erro Listagem", MENSAGEM_TIMEOUT_MS);
             return;
         }
         p_dir = cwdbuf;
     }
-    printf("Listagem de diretórios: %s\n", p_dir);
+    console_printf("Listagem de diretórios: %s\n", p_dir);
     DIR dj;
     FILINFO fno;
     memset(&dj, 0, sizeof dj);
@@ -594,11 +785,8 @@ static void run_ls()
     fr = f_findfirst(&dj, &fno, p_dir, "*");
     if (FR_OK != fr)
     {
-        printf("Erro f_findfirst: %s (%d)\n", FRESULT_str(fr), fr);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro Listagem", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Erro f_findfirst: %s (%d)\n", FRESULT_str(fr), fr);
+        feedback_mensagem("Erro Listagem", MENSAGEM_TIMEOUT_MS);
         return;
     }
     while (fr == FR_OK && fno.fname[0])
@@ -613,408 +801,3649 @@ static void run_ls()
             pcAtributo = pcArquivoSomenteLeitura;
         else
             pcAtributo = pcArquivoGravavel;
-        printf("%s [%s] [tamanho=%llu]\n", fno.fname, pcAtributo, fno.fsize);
+        // Saída longa: espera a USB em vez de descartar linhas da listagem
+        console_aguardar(CONSOLE_MAX_MENSAGEM * 2, 500);
+        console_printf("%s [%s] [tamanho=%llu]\n", fno.fname, pcAtributo, fno.fsize);
         fr = f_findnext(&dj, &fno);
     }
     f_closedir(&dj);
-    printf("[DEBUG] run_ls: Listagem concluída\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "Listagem Concluída", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+    LOG_DEBUG("run_dir: Listagem concluída\n");
+    feedback_mensagem("Listagem Concluída", MENSAGEM_TIMEOUT_MS);
 }
 
-static void run_cat()
+#define LS_SESSOES_PADRAO 20
+
+static const char *nome_estado(uint8_t estado)
 {
-    printf("[DEBUG] run_cat: Iniciando...\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "Lendo Arquivo", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-    char *arg1 = strtok(NULL, " ");
-    if (!arg1)
+    switch (estado)
     {
-        printf("Falta argumento\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro: Argumento", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-        return;
+    case CATALOGO_ESTADO_ABERTA:
+        return "aberta";
+    case CATALOGO_ESTADO_FECHADA:
+        return "fechada";
+    case CATALOGO_ESTADO_IMPORTADA:
+        return "importada";
+    default:
+        return "inválida";
     }
-    FIL fil;
-    FRESULT fr = f_open(&fil, arg1, FA_READ);
+}
+
+static void imprimir_sessao(uint32_t indice, const catalogo_sessao_t *s)
+{
+    char inicio[20];
+    catalogo_formatar_data(s->inicio, inicio, sizeof(inicio));
+    console_aguardar(CONSOLE_MAX_MENSAGEM * 2, 500);
+    console_printf("#%-5lu %-24.24s %s %7lu amostras %8lu bytes  %s\n", (unsigned long)indice, s->nome, inicio,
+                   (unsigned long)s->amostras, (unsigned long)s->tamanho, nome_estado(s->estado));
+}
+
+// Lista as últimas sessões lendo só o fim do catálogo
+static void run_ls()
+{
+    const char *arg1 = strtok(NULL, " ");
+    uint32_t quantas = arg1 ? (uint32_t)atoi(arg1) : LS_SESSOES_PADRAO;
+    uint32_t total;
+    FRESULT fr = catalogo_quantidade(&total);
     if (FR_OK != fr)
     {
-        printf("Erro f_open: %s (%d)\n", FRESULT_str(fr), fr);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro Leitura", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Erro ao ler o catálogo: %s (%d)\n", FRESULT_str(fr), fr);
+        feedback_mensagem("Erro Listagem", MENSAGEM_TIMEOUT_MS);
         return;
     }
-    char buf[256];
-    while (f_gets(buf, sizeof buf, &fil))
+    if (total == 0)
     {
-        printf("%s", buf);
+        console_printf("Catálogo vazio. Use 'dir' para listar o diretório ou 'catalogo reconstruir'.\n");
+        return;
     }
-    fr = f_close(&fil);
-    if (FR_OK != fr)
+    uint32_t primeiro = (quantas == 0 || quantas >= total) ? 0 : total - quantas;
+    console_printf("Sessões %lu a %lu de %lu:\n", (unsigned long)primeiro, (unsigned long)(total - 1), (unsigned long)total);
+    catalogo_sessao_t bloco[8];
+    while (primeiro < total)
     {
-        printf("Erro f_close: %s (%d)\n", FRESULT_str(fr), fr);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro Fechamento", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-        return;
+        uint32_t lidos;
+        fr = catalogo_ler(primeiro, bloco, count_of(bloco), &lidos);
+        if (FR_OK != fr || lidos == 0)
+            break;
+        for (uint32_t i = 0; i < lidos; i++)
+            imprimir_sessao(primeiro + i, &bloco[i]);
+        primeiro += lidos;
     }
-    printf("[DEBUG] run_cat: Leitura concluída\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "Leitura Concluída", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+    feedback_mensagem("Listagem Concluída", MENSAGEM_TIMEOUT_MS);
 }
 
-static void run_iniciar()
+// Lê o .est de um arquivo de dados; false se não existe ou está corrompido
+static bool ler_estatisticas(const char *arquivo, estatisticas_t *e)
 {
-    printf("[DEBUG] run_iniciar: Iniciando...\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "Iniciando Captura", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-    if (logger_ativado)
-    {
-        printf("Captura já está em andamento.\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Captura Ativa", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-        return;
-    }
-    if (!sd_esta_montado("0:"))
-    {
-        printf("[ERRO] Cartão SD não está montado. Use o comando 'a' para montar.\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro: SD Não Montado", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-        return;
-    }
-    if (!mpu6050_testar())
+    char nome[32];
+    estatisticas_nome(arquivo, nome, sizeof(nome));
+    FIL f;
+    if (FR_OK != f_open(&f, nome, FA_READ))
+        return false;
+    UINT br = 0;
+    FRESULT fr = f_read(&f, e, sizeof(*e), &br);
+    f_close(&f);
+    return FR_OK == fr && br == sizeof(*e) && estatisticas_valida(e);
+}
+
+// Detalhes de uma sessão pelo número (acesso direto) ou pelo nome do arquivo
+static void run_info()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1)
     {
-        printf("[ERRO] Falha na comunicação com o MPU6050. Verifique as conexões I2C.\n");
+        console_printf("Falta argumento\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
         return;
     }
-    // Gerar nome do arquivo com base na data e hora atuais
-    datetime_t t;
-    if (rtc_get_datetime(&t))
+    catalogo_sessao_t s;
+    uint32_t indice;
+    FRESULT fr;
+    if (arg1[0] == '#' || isdigit((unsigned char)arg1[0]))
     {
-        snprintf(nome_arquivo, sizeof(nome_arquivo), "dados%02d%02d%04d%02d%02d%02d.csv",
-                 t.day, t.month, t.year, t.hour, t.min, t.sec);
-        printf("[DEBUG] run_iniciar: Nome do arquivo gerado: %s\n", nome_arquivo);
+        indice = (uint32_t)strtoul(arg1[0] == '#' ? arg1 + 1 : arg1, NULL, 10);
+        uint32_t lidos;
+        fr = catalogo_ler(indice, &s, 1, &lidos);
+        if (FR_OK == fr && lidos == 0)
+            fr = FR_NO_FILE;
     }
     else
     {
-        strcpy(nome_arquivo, "dados_fallback.csv");
-        printf("[ERRO] run_iniciar: RTC não configurado, usando nome de arquivo padrão: %s\n", nome_arquivo);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro RTC", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        fr = catalogo_procurar(arg1, &indice, &s);
     }
-    logger_ativado = true;
-    contador_amostras = 0;
-    proxima_captura = get_absolute_time();
-    printf("[DEBUG] run_iniciar: Abrindo arquivo %s para escrita...\n", nome_arquivo);
-    FIL arquivo;
-    FRESULT res = f_open(&arquivo, nome_arquivo, FA_WRITE | FA_CREATE_ALWAYS);
-    if (res != FR_OK)
+    if (FR_OK != fr)
     {
-        printf("[ERRO] Não foi possível abrir o arquivo %s para escrita: %s (%d)\n", nome_arquivo, FRESULT_str(res), res);
-        logger_ativado = false;
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro Arquivo", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Sessão \"%s\" não está no catálogo: %s (%d)\n", arg1, FRESULT_str(fr), fr);
+        feedback_mensagem("Sessão Inexistente", MENSAGEM_TIMEOUT_MS);
         return;
     }
-    const char *cabecalho = "Data,Hora,Amostra,AccX,AccY,AccZ,GyroX,GyroY,GyroZ,Temperatura\n";
-    UINT bw;
-    printf("[DEBUG] run_iniciar: Escrevendo cabeçalho...\n");
-    res = f_write(&arquivo, cabecalho, strlen(cabecalho), &bw);
-    if (res != FR_OK || bw != strlen(cabecalho))
+    char inicio[20], fim[20];
+    catalogo_formatar_data(s.inicio, inicio, sizeof(inicio));
+    catalogo_formatar_data(s.fim, fim, sizeof(fim));
+    console_printf("Sessão #%lu: %.24s (%s)\n", (unsigned long)indice, s.nome, nome_estado(s.estado));
+    console_printf("  Início:   %s\n", inicio);
+    console_printf("  Fim:      %s\n", s.estado == CATALOGO_ESTADO_ABERTA ? "-" : fim);
+    console_printf("  Amostras: %lu a cada %lu us\n", (unsigned long)s.amostras, (unsigned long)s.periodo_us);
+    console_printf("  Formato:  %s, %lu bytes\n",
+                   s.formato == CATALOGO_FORMATO_CSV           ? "CSV"
+                   : s.formato == CATALOGO_FORMATO_CSV_EVENTOS ? "CSV por eventos"
+                   : s.formato == CATALOGO_FORMATO_ESPECTRO    ? "CSV de espectros"
+                                                               : "?",
+                   (unsigned long)s.tamanho);
+    if (s.amostras > 0)
     {
-        printf("[ERRO] Não foi possível escrever o cabeçalho no arquivo %s: %s (%d), bytes escritos=%u\n", nome_arquivo, FRESULT_str(res), res, bw);
-        logger_ativado = false;
-        f_close(&arquivo);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro Escrita", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-        return;
+        console_printf("  AccX:     %d a %d\n", s.accel_min[0], s.accel_max[0]);
+        console_printf("  AccY:     %d a %d\n", s.accel_min[1], s.accel_max[1]);
+        console_printf("  AccZ:     %d a %d\n", s.accel_min[2], s.accel_max[2]);
+        console_printf("  Temp.:    %.2f a %.2f C\n", (s.temp_min / 340.0) + 15, (s.temp_max / 340.0) + 15);
     }
-    f_sync(&arquivo);
-    f_close(&arquivo);
-    printf("Captura de dados iniciada. Serão coletadas %d amostras em %s.\n", MAX_AMOSTRAS, nome_arquivo);
-    printf("[DEBUG] run_iniciar: Iniciado com sucesso\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "Captura Iniciada", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+
+    estatisticas_t e;
+    char nome[25];
+    snprintf(nome, sizeof(nome), "%.24s", s.nome);
+    if (!ler_estatisticas(nome, &e) || e.amostras == 0)
+        return;
+    uint8_t accel_faixa = e.accel_faixa & 3;
+    console_printf("  Faixas: ±%u g, ±%u °/s (eixos em LSB)\n", mpu6050_accel_fundo_g[accel_faixa],
+                   mpu6050_giro_fundo_dps[e.giro_faixa & 3]);
+    console_printf("  Canal        mín      máx      média     desvio\n");
+    for (int c = 0; c < EST_TEMP; c++)
+        console_printf("  %-6s %9d %8d %10.1f %10.1f\n", estatisticas_nomes[c], e.canal[c].min, e.canal[c].max,
+                       estatisticas_media(&e, c), estatisticas_desvio(&e, c));
+    console_printf("  %-6s %9.2f %8.2f %10.2f %10.3f C\n", estatisticas_nomes[EST_TEMP],
+                   (e.canal[EST_TEMP].min / 340.0) + 15, (e.canal[EST_TEMP].max / 340.0) + 15,
+                   (estatisticas_media(&e, EST_TEMP) / 340.0) + 15, estatisticas_desvio(&e, EST_TEMP) / 340.0);
+    console_printf("  Pico |a|: %.0f (%.2f g em ±%u g) na amostra %lu\n", estatisticas_pico_accel(&e),
+                   estatisticas_pico_accel(&e) / mpu6050_accel_lsb_g[accel_faixa], mpu6050_accel_fundo_g[accel_faixa],
+                   (unsigned long)e.pico_amostra);
+    if (e.amostras > 1)
+        console_printf("  Intervalo: média %.0f us, %lu a %lu us, jitter %.0f us\n",
+                       estatisticas_intervalo_medio_us(&e), (unsigned long)e.intervalo_min_us,
+                       (unsigned long)e.intervalo_max_us, estatisticas_jitter_us(&e));
 }
 
-static void capture_adc_data_and_save()
+static void run_catalogo()
 {
-    printf("[DEBUG] capture_adc_data_and_save: Iniciando...\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "Capturando ADC", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-    if (!sd_esta_montado("0:"))
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1 || strcmp(arg1, "reconstruir") != 0)
     {
-        printf("[ERRO] Cartão SD não está montado. Use o comando 'a' para montar.\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro: SD Não Montado", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Uso: catalogo reconstruir\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
         return;
     }
-    printf("\nCapturando dados do ADC. Aguarde finalização...\n");
-    FIL file;
-    FRESULT res = f_open(&file, "txt.txt", FA_WRITE | FA_CREATE_ALWAYS);
-    if (res != FR_OK)
+    feedback_mensagem("Catalogando", MENSAGEM_TIMEOUT_MS);
+    uint32_t importados;
+    FRESULT fr = catalogo_reconstruir(&importados);
+    if (FR_OK != fr)
     {
-        printf("[ERRO] Não foi possível abrir o arquivo txt.txt para escrita: %s (%d)\n", FRESULT_str(res), res);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro Arquivo", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        console_printf("Erro ao reconstruir o catálogo: %s (%d)\n", FRESULT_str(fr), fr);
+        feedback_mensagem("Erro Catálogo", MENSAGEM_TIMEOUT_MS);
         return;
     }
-    for (int i = 0; i < 128; i++)
+    console_printf("%lu arquivo(s) acrescentado(s) ao catálogo\n", (unsigned long)importados);
+    feedback_mensagem("Catálogo Pronto", MENSAGEM_TIMEOUT_MS);
+}
+
+// Leitura de linhas em blocos de setor (f_gets lê byte a byte)
+typedef struct
+{
+    FIL *arquivo;
+    char buffer[512];
+    UINT pos, len;
+} leitor_linhas_t;
+
+static bool ler_linha(leitor_linhas_t *l, char *linha, size_t tamanho)
+{
+    size_t n = 0;
+    for (;;)
     {
-        adc_select_input(0);
-        uint16_t adc_value = adc_read();
-        char buffer[50];
-        sprintf(buffer, "%d %d\n", i + 1, adc_value);
-        UINT bw;
-        res = f_write(&file, buffer, strlen(buffer), &bw);
-        if (res != FR_OK)
+        if (l->pos == l->len)
         {
-            printf("[ERRO] Não foi possível escrever no arquivo txt.txt: %s (%d)\n", FRESULT_str(res), res);
-            f_close(&file);
-            ssd1306_fill(&ssd, false);
-            ssd1306_draw_string(&ssd, "Erro Escrita", 5, 0);
-            ssd1306_send_data(&ssd);
-            mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-            return;
+            l->pos = 0;
+            if (FR_OK != f_read(l->arquivo, l->buffer, sizeof(l->buffer), &l->len) || l->len == 0)
+            {
+                linha[n] = '\0';
+                return n > 0;
+            }
+        }
+        char c = l->buffer[l->pos++];
+        if (n < tamanho - 1)
+            linha[n++] = c;
+        if (c == '\n')
+        {
+            linha[n] = '\0';
+            return true;
         }
-        sleep_ms(100);
     }
-    f_sync(&file);
-    f_close(&file);
-    printf("\nDados do ADC salvos no arquivo txt.txt.\n\n");
-    printf("[DEBUG] capture_adc_data_and_save: Concluído\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "ADC Salvo", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
 }
 
-static void capturar_dados_mpu6050_e_salvar()
+// Campo Tempo_ms (o 11º) de uma linha do CSV; false em linhas do formato
+// antigo, sem essa coluna. Colunas opcionais (orientação) vêm depois dele
+static bool tempo_da_linha(const char *linha, uint32_t *tempo_ms)
 {
-    printf("[DEBUG] capturar_dados_mpu6050_e_salvar: Iniciando amostra %d\n", contador_amostras + 1);
-    ssd1306_fill(&ssd, false);
-    char buffer[32];
-    snprintf(buffer, sizeof(buffer), "Amostra %d/%d", contador_amostras + 1, MAX_AMOSTRAS);
-    ssd1306_draw_string(&ssd, buffer, 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-    if (!sd_esta_montado("0:"))
+    int virgulas = 0;
+    const char *p = linha;
+    for (; *p && virgulas < 10; p++)
+        virgulas += (*p == ',');
+    if (virgulas != 10 || !isdigit((unsigned char)*p))
+        return false;
+    *tempo_ms = (uint32_t)strtoul(p, NULL, 10);
+    return true;
+}
+
+#define RANGE_TABELA_CLUSTERS 64 // até 31 fragmentos do arquivo
+
+// Extrai as amostras entre dois instantes (segundos desde o início da
+// captura): o índice dá a posição de partida e a tabela de clusters torna o
+// f_lseek direto, então só o trecho pedido é lido do cartão
+static void run_range()
+{
+    const char *arquivo = strtok(NULL, " ");
+    const char *arg_inicio = strtok(NULL, " ");
+    const char *arg_fim = strtok(NULL, " ");
+    const char *saida = strtok(NULL, " ");
+    if (!arquivo || !arg_inicio || !arg_fim)
     {
-        printf("[ERRO] Cartão SD não está montado. Parando captura.\n");
-        logger_ativado = false;
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro: SD Não Montado", 5, 0);
+        console_printf("Uso: range <arquivo> <inicio_s> <fim_s> [saida.csv]\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    double inicio_s = strtod(arg_inicio, NULL);
+    double fim_s = strtod(arg_fim, NULL);
+    if (inicio_s < 0 || fim_s < inicio_s)
+    {
+        console_printf("Intervalo inválido: %s a %s\n", arg_inicio, arg_fim);
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    uint32_t inicio_ms = (uint32_t)(inicio_s * 1000.0);
+    uint32_t fim_ms = (uint32_t)(fim_s * 1000.0);
+
+    FIL csv;
+    FRESULT fr = f_open(&csv, arquivo, FA_READ);
+    if (FR_OK != fr)
+    {
+        console_printf("Erro f_open: %s (%d)\n", FRESULT_str(fr), fr);
+        feedback_mensagem("Erro Leitura", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    static DWORD tabela_clusters[RANGE_TABELA_CLUSTERS];
+    bool mapeado = indice_mapear_clusters(&csv, tabela_clusters, count_of(tabela_clusters));
+
+    // Cabeçalho do CSV (linhas "#" de metadados e a dos nomes das colunas):
+    // vai para o arquivo de saída e marca onde começam os dados
+    static leitor_linhas_t leitor;
+    leitor.arquivo = &csv;
+    leitor.pos = leitor.len = 0;
+    char linha[160];
+    static char cabecalho[1024];
+    cabecalho[0] = '\0';
+    while (ler_linha(&leitor, linha, sizeof(linha)))
+    {
+        strncat(cabecalho, linha, sizeof(cabecalho) - strlen(cabecalho) - 1);
+        if (linha[0] != '#')
+            break;
+    }
+    FSIZE_t offset = (FSIZE_t)strlen(cabecalho);
+
+    char nome_idx[32];
+    indice_nome(arquivo, nome_idx, sizeof(nome_idx));
+    indice_entrada_t entrada;
+    bool encontrada;
+    fr = indice_buscar(nome_idx, inicio_ms, &entrada, &encontrada);
+    if (FR_OK == fr && encontrada)
+        offset = entrada.offset;
+    else if (FR_NO_FILE == fr)
+        LOG_AVISO("Arquivo sem índice (%s), lendo desde o início\n", nome_idx);
+    else if (FR_OK != fr)
+        LOG_ERRO("Erro ao ler o índice %s: %s (%d)\n", nome_idx, FRESULT_str(fr), fr);
+
+    FIL destino;
+    bool para_arquivo = saida != NULL;
+    if (para_arquivo)
+    {
+        fr = f_open(&destino, saida, FA_WRITE | FA_CREATE_ALWAYS);
+        UINT bw;
+        if (FR_OK == fr)
+            fr = f_write(&destino, cabecalho, strlen(cabecalho), &bw);
+        if (FR_OK != fr)
+        {
+            console_printf("Erro ao criar %s: %s (%d)\n", saida, FRESULT_str(fr), fr);
+            feedback_mensagem("Erro Arquivo", MENSAGEM_TIMEOUT_MS);
+            f_close(&csv);
+            return;
+        }
+    }
+    else
+    {
+        console_escrever(cabecalho, strlen(cabecalho));
+    }
+
+    fr = f_lseek(&csv, offset);
+    leitor.pos = leitor.len = 0;
+    uint32_t enviadas = 0, lidas = 0;
+    bool formato_antigo = false;
+    while (FR_OK == fr && ler_linha(&leitor, linha, sizeof(linha)))
+    {
+        lidas++;
+        // Linhas "#" entre os dados (trocas de taxa) seguem para a saída
+        uint32_t tempo_ms = inicio_ms;
+        if (linha[0] != '#' && !tempo_da_linha(linha, &tempo_ms))
+        {
+            formato_antigo = true;
+            break;
+        }
+        if (tempo_ms < inicio_ms)
+            continue;
+        if (tempo_ms > fim_ms)
+            break;
+        size_t n = strlen(linha);
+        if (para_arquivo)
+        {
+            UINT bw;
+            fr = f_write(&destino, linha, n, &bw);
+        }
+        else
+        {
+            console_aguardar(2 * n, 500);
+            console_escrever(linha, n);
+        }
+        enviadas++;
+    }
+    f_close(&csv);
+    if (para_arquivo)
+        f_close(&destino);
+
+    if (formato_antigo)
+    {
+        console_printf("%s não tem a coluna Tempo_ms (gravado antes do índice)\n", arquivo);
+        feedback_mensagem("Sem Tempo_ms", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (FR_OK != fr)
+        console_printf("Erro durante a extração: %s (%d)\n", FRESULT_str(fr), fr);
+    console_printf("%lu amostra(s) de %.3f a %.3f s%s%s; %lu linha(s) lidas a partir do byte %lu%s\n",
+                   (unsigned long)enviadas, inicio_s, fim_s, para_arquivo ? " salvas em " : "",
+                   para_arquivo ? saida : "", (unsigned long)lidas, (unsigned long)offset,
+                   mapeado ? "" : " (sem tabela de clusters)");
+    feedback_mensagem("Trecho Extraído", MENSAGEM_TIMEOUT_MS);
+}
+
+#define EXPORTAR_CANAIS 7
+
+// Resumo de uma sessão em janelas de N amostras (mín/máx/média/RMS por
+// canal). Lê o CSV linha a linha, então a memória usada não depende do
+// tamanho do arquivo; o mesmo agregador roda no PC em verificar_agregador
+static void run_exportar()
+{
+    const char *arquivo = strtok(NULL, " ");
+    const char *arg_janela = strtok(NULL, " ");
+    const char *saida = strtok(NULL, " ");
+    long janela = arg_janela ? strtol(arg_janela, NULL, 10) : 0;
+    if (!arquivo || janela <= 0)
+    {
+        console_printf("Uso: exportar <arquivo> <amostras_por_janela> [saida.csv]\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+
+    FIL csv;
+    FRESULT fr = f_open(&csv, arquivo, FA_READ);
+    if (FR_OK != fr)
+    {
+        console_printf("Erro f_open: %s (%d)\n", FRESULT_str(fr), fr);
+        feedback_mensagem("Erro Leitura", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    feedback_mensagem("Exportando...", MENSAGEM_TIMEOUT_MS);
+
+    static const char *const nomes[EXPORTAR_CANAIS] = {"AccX", "AccY", "AccZ", "GyroX", "GyroY", "GyroZ",
+                                                       "Temp_x100"};
+    static leitor_linhas_t leitor;
+    static agregador_t agregador;
+    static agregador_janela_t janela_pronta;
+    leitor.arquivo = &csv;
+    leitor.pos = leitor.len = 0;
+    agregador_iniciar(&agregador, EXPORTAR_CANAIS, (uint32_t)janela);
+
+    char texto[400];
+    FIL destino;
+    bool para_arquivo = saida != NULL;
+    int n = agregador_formatar_cabecalho(nomes, EXPORTAR_CANAIS, texto, sizeof(texto));
+    if (para_arquivo)
+    {
+        fr = f_open(&destino, saida, FA_WRITE | FA_CREATE_ALWAYS);
+        UINT bw;
+        if (FR_OK == fr)
+            fr = f_write(&destino, texto, n, &bw);
+        if (FR_OK != fr)
+        {
+            console_printf("Erro ao criar %s: %s (%d)\n", saida, FRESULT_str(fr), fr);
+            feedback_mensagem("Erro Arquivo", MENSAGEM_TIMEOUT_MS);
+            f_close(&csv);
+            return;
+        }
+    }
+    else
+    {
+        console_escrever(texto, n);
+    }
+
+    char linha[160];
+    uint32_t lidas = 0, ignoradas = 0, janelas = 0;
+    for (;;)
+    {
+        bool fim = !ler_linha(&leitor, linha, sizeof(linha));
+        bool pronta;
+        if (fim)
+        {
+            pronta = agregador_finalizar(&agregador, &janela_pronta);
+        }
+        else
+        {
+            registro_csv_t r;
+            if (!registro_csv_ler(linha, &r))
+            {
+                ignoradas++; // cabeçalho e linhas cortadas por falta de energia
+                continue;
+            }
+            lidas++;
+            int32_t valores[EXPORTAR_CANAIS] = {r.accel[0], r.accel[1], r.accel[2], r.gyro[0],
+                                                r.gyro[1], r.gyro[2], r.temp_centesimos};
+            pronta = agregador_adicionar(&agregador, valores, r.amostra, r.tempo_ms, &janela_pronta);
+        }
+        if (pronta)
+        {
+            n = agregador_formatar(&janela_pronta, texto, sizeof(texto));
+            if (para_arquivo)
+            {
+                UINT bw;
+                fr = f_write(&destino, texto, n, &bw);
+            }
+            else
+            {
+                console_aguardar(2 * n, 500);
+                console_escrever(texto, n);
+            }
+            janelas++;
+        }
+        if (fim || FR_OK != fr)
+            break;
+    }
+    f_close(&csv);
+    if (para_arquivo)
+        f_close(&destino);
+
+    if (FR_OK != fr)
+    {
+        console_printf("Erro durante a exportação: %s (%d)\n", FRESULT_str(fr), fr);
+        feedback_mensagem("Erro Escrita", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    console_printf("%lu amostra(s) resumidas em %lu janela(s) de %ld%s%s (%lu linha(s) ignoradas)\n",
+                   (unsigned long)lidas, (unsigned long)janelas, janela, para_arquivo ? " em " : "",
+                   para_arquivo ? saida : "", (unsigned long)ignoradas);
+    feedback_mensagem("Resumo Exportado", MENSAGEM_TIMEOUT_MS);
+}
+
+static void run_cat()
+{
+    LOG_DEBUG("run_cat: Iniciando...\n");
+    feedback_mensagem("Lendo Arquivo", MENSAGEM_TIMEOUT_MS);
+    char *arg1 = strtok(NULL, " ");
+    if (!arg1)
+    {
+        console_printf("Falta argumento\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    FIL fil;
+    FRESULT fr = f_open(&fil, arg1, FA_READ);
+    if (FR_OK != fr)
+    {
+        console_printf("Erro f_open: %s (%d)\n", FRESULT_str(fr), fr);
+        feedback_mensagem("Erro Leitura", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    // Blocos de 512 bytes alinhados ao setor; para baixar arquivos use o
+    // comando "baixar", que é binário e retomável
+    char buf[512];
+    UINT br;
+    while (f_read(&fil, buf, sizeof buf, &br) == FR_OK && br > 0)
+    {
+        console_aguardar(2 * br, 500);
+        console_escrever(buf, br);
+    }
+    fr = f_close(&fil);
+    if (FR_OK != fr)
+    {
+        console_printf("Erro f_close: %s (%d)\n", FRESULT_str(fr), fr);
+        feedback_mensagem("Erro Fechamento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    LOG_DEBUG("run_cat: Leitura concluída\n");
+    feedback_mensagem("Leitura Concluída", MENSAGEM_TIMEOUT_MS);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Canais analógicos junto das leituras do MPU6050 (comando "analogico"):
+// lib/analogico.c escolhe o canal de cada leitura; o ADC converte uma vez,
+// disparado antes da leitura do sensor e recolhido depois dela, sem esperar
+// a conversão. O valor segue na amostra, com o mesmo número e instante, e
+// sai nas colunas ADC0..ADC_T do CSV, vazias nas linhas de outro canal.
+// Vale nas capturas periódica e adaptativa: a por evento guarda a fila
+// própria, e a decimada e a de espectro não gravam as leituras.
+
+#define ANALOGICO_LINHA_MAX 24 // ",4095" por canal
+
+static bool analogico_ligado = false; // vale para as próximas capturas
+static analogico_config_t analogico_config = {.a_cada = {1, 0, 0, 0}};
+static bool analogico_sessao = false;
+static analogico_t analogico;
+static volatile uint32_t analogico_atrasadas; // conversões que não terminaram até o fim da leitura
+
+// ADC em conversões avulsas: sem FIFO, sem rodízio e parado
+static void analogico_preparar()
+{
+    analogico_iniciar(&analogico, &analogico_config, 1);
+    analogico_atrasadas = 0;
+    for (int i = 0; i < ANALOGICO_CANAIS - 1; i++)
+        if (analogico_config.a_cada[i])
+            adc_gpio_init(26 + analogico_entrada[i]);
+    adc_set_temp_sensor_enabled(analogico_config.a_cada[ANALOGICO_CANAIS - 1] != 0);
+    adc_run(false);
+    adc_set_round_robin(0);
+    adc_fifo_setup(false, false, 0, false, false);
+}
+
+// Antes da leitura 'seq' do MPU6050 (também na interrupção): dispara a
+// conversão do canal da vez e retorna o 'adc' da amostra só com o canal,
+// ou 0 se não há
+static uint16_t analogico_disparar(uint32_t seq)
+{
+    if (!analogico_sessao)
+        return 0;
+    int canal = analogico_escolher(&analogico, seq);
+    if (canal < 0)
+        return 0;
+    adc_select_input(analogico_entrada[canal]);
+    hw_set_bits(&adc_hw->cs, ADC_CS_START_ONCE_BITS);
+    return AMOSTRA_ADC(canal, 0);
+}
+
+// Depois da leitura: a conversão de 2 us já terminou durante o I2C
+static void analogico_recolher(amostra_t *a)
+{
+    if (!a->adc)
+        return;
+    if (!(adc_hw->cs & ADC_CS_READY_BITS))
+    {
+        analogico_atrasadas++;
+        a->adc = 0;
+        return;
+    }
+    a->adc = AMOSTRA_ADC(AMOSTRA_ADC_CANAL(a->adc), adc_hw->result);
+}
+
+// Linha "# analogico ..." do cabeçalho
+static int analogico_cabecalho(char *destino, size_t tamanho)
+{
+    int n = snprintf(destino, tamanho, "\n# analogico a_cada=");
+    n += analogico_config_formatar(&analogico_config, destino + n, tamanho - n);
+    n += snprintf(destino + n, tamanho - n, " bits=12 vref_mv=3300");
+    return n;
+}
+
+static void analogico_encerrar()
+{
+    console_printf("%lu conversão(ões) do ADC junto das leituras\n", (unsigned long)analogico.conversoes);
+    if (analogico.perdidas)
+        LOG_AVISO("%lu período(s) de canal analógico sem conversão\n", (unsigned long)analogico.perdidas);
+    if (analogico_atrasadas)
+        LOG_AVISO("%lu conversão(ões) do ADC não terminaram a tempo\n", (unsigned long)analogico_atrasadas);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Sensores ambientais (comando "sensores"): BMP280 e AHT20 no I2C0, junto do
+// MPU6050, pelo escalonador de lib/sensores.c. Os passos rodam logo depois
+// de cada leitura do MPU6050, no mesmo contexto dela (a interrupção do
+// amostrador ou o laço principal na captura periódica), e só se couberem
+// antes da leitura seguinte. As medidas vão para o CSV da captura como
+// linhas "# bmp280 t_us=..." intercaladas com as amostras assim que
+// terminam: t_us é o início da medida, contado do início da captura como
+// Tempo_ms, e é ele (não a posição no arquivo) que alinha os fluxos.
+
+#define SENSORES_PERIODO_PADRAO_MS 1000
+#define SENSORES_PERIODO_MIN_MS 10
+#define SENSORES_PERIODO_MAX_MS 60000
+#define SENSORES_MARGEM_US 100  // reservado antes da próxima leitura do MPU6050
+#define SENSORES_LACO_US 2000   // folga por volta do laço na captura periódica
+#define SENSORES_LINHA_MAX 80   // maior registro "# ..."
+#define SENSORES_PREFIXO_MAX (2 * SENSORES_LINHA_MAX)
+
+static bool sensores_ligado = false; // vale para as próximas capturas
+static uint32_t sensores_bmp280_ms = SENSORES_PERIODO_PADRAO_MS; // 0: fora
+static uint32_t sensores_aht20_ms = SENSORES_PERIODO_PADRAO_MS;
+static bool sensores_sessao = false;
+static sensores_t sensores;
+static sensor_t sensor_bmp280, sensor_aht20;
+
+// Procura e configura os sensores ligados (antes do temporizador, com o
+// I2C0 livre); false se nenhum responde
+static bool sensores_preparar()
+{
+    sensores_iniciar(&sensores);
+    memset(&sensor_bmp280, 0, sizeof(sensor_bmp280));
+    memset(&sensor_aht20, 0, sizeof(sensor_aht20));
+    if (sensores_bmp280_ms)
+    {
+        if (ambiente_bmp280(I2C_PORT, &sensor_bmp280))
+        {
+            sensor_bmp280.periodo_us = sensores_bmp280_ms * 1000;
+            sensores_registrar(&sensores, &sensor_bmp280);
+        }
+        else
+            LOG_AVISO("BMP280 não responde no I2C0: fica fora desta captura\n");
+    }
+    if (sensores_aht20_ms)
+    {
+        if (ambiente_aht20(I2C_PORT, &sensor_aht20))
+        {
+            sensor_aht20.periodo_us = sensores_aht20_ms * 1000;
+            sensores_registrar(&sensores, &sensor_aht20);
+        }
+        else
+            LOG_AVISO("AHT20 não responde no I2C0: fica fora desta captura\n");
+    }
+    return sensores.n > 0;
+}
+
+// Registros com início até 'ate_us', formatados em 'destino' enquanto
+// couber mais um
+static size_t sensores_texto(uint64_t ate_us, char *destino, size_t tamanho)
+{
+    size_t n = 0;
+    sensores_registro_t r;
+    while (tamanho - n > SENSORES_LINHA_MAX && sensores_proximo(&sensores, ate_us, &r))
+        n += sensores_formatar(&sensores, &r, to_us_since_boot(inicio_captura), destino + n, tamanho - n);
+    return n;
+}
+
+// Grava no arquivo aberto os registros até 'ate_us' (captura periódica e
+// fim da captura)
+static bool sensores_descarregar(FIL *arquivo, uint64_t ate_us)
+{
+    char texto[SENSORES_PREFIXO_MAX];
+    size_t n;
+    while ((n = sensores_texto(ate_us, texto, sizeof(texto))) > 0)
+    {
+        UINT bw = 0;
+        FRESULT res = f_write(arquivo, texto, n, &bw);
+        if (res != FR_OK || bw != n)
+        {
+            LOG_ERRO("Não foi possível escrever no arquivo %s: %s (%d), bytes escritos=%u\n", nome_arquivo,
+                     FRESULT_str(res), res, bw);
+            return false;
+        }
+        bytes_sessao += bw;
+    }
+    return true;
+}
+
+// Linha "# sensores ..." do cabeçalho, com os sensores que responderam
+static int sensores_cabecalho(char *destino, size_t tamanho)
+{
+    int n = snprintf(destino, tamanho, "\n# sensores");
+    for (int i = 0; i < sensores.n && (size_t)n < tamanho; i++)
+        n += snprintf(destino + n, tamanho - n, " %s_ms=%lu", sensores.sensores[i]->nome,
+                      (unsigned long)(sensores.sensores[i]->periodo_us / 1000));
+    return n;
+}
+
+static void imprimir_sensores_contagem()
+{
+    for (int i = 0; i < sensores.n; i++)
+    {
+        const sensor_t *s = sensores.sensores[i];
+        console_printf("  %s: %lu medida(s), %lu falha(s), %lu período(s) pulados\n", s->nome,
+                       (unsigned long)s->medidas, (unsigned long)s->falhas, (unsigned long)s->atrasadas);
+    }
+    if (sensores.adiados)
+        console_printf("  %lu passo(s) adiados por falta de folga entre as leituras do MPU6050\n",
+                       (unsigned long)sensores.adiados);
+}
+
+// Depois de parar as leituras: grava os registros que ficaram depois da
+// última amostra
+static void sensores_encerrar()
+{
+    FIL arquivo;
+    if (FR_OK == f_open(&arquivo, nome_arquivo, FA_WRITE | FA_OPEN_APPEND))
+    {
+        sensores_descarregar(&arquivo, UINT64_MAX);
+        f_close(&arquivo);
+    }
+    console_printf("Sensores ambientais:\n");
+    imprimir_sensores_contagem();
+    if (sensores.perdidos)
+        LOG_AVISO("%lu medida(s) ambientais perdidas (gravação atrasada)\n", (unsigned long)sensores.perdidos);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Linha do CSV das capturas gravadas em blocos (por evento e decimada), com
+// as mesmas colunas da captura periódica. Data e Hora são as do momento da
+// formatação; a temperatura em centésimos usa só inteiros
+static int formatar_linha_csv(char *destino, size_t tamanho, uint32_t numero, const int16_t accel[3],
+                              const int16_t gyro[3], int16_t temp, uint32_t tempo_ms)
+{
+    datetime_t t;
+    if (!rtc_get_datetime(&t))
+        memset(&t, 0, sizeof(t));
+    int32_t centesimos = 1500 + ((int32_t)temp * 100 + (temp < 0 ? -170 : 170)) / 340;
+    int32_t modulo = centesimos < 0 ? -centesimos : centesimos;
+    int32_t a[3], g[3];
+    unidades_converter(accel, gyro, a, g);
+    return snprintf(destino, tamanho, "%02d/%02d/%02d,%02d:%02d:%02d,%lu,%ld,%ld,%ld,%ld,%ld,%ld,%s%ld.%02ld,%lu\n",
+                    t.day, t.month, t.year % 100, t.hour, t.min, t.sec, (unsigned long)numero, (long)a[0], (long)a[1],
+                    (long)a[2], (long)g[0], (long)g[1], (long)g[2], centesimos < 0 ? "-" : "", (long)(modulo / 100),
+                    (long)(modulo % 100), (unsigned long)tempo_ms);
+}
+
+// Entrada do índice para a linha que começa em 'offset' no arquivo
+static void indexar_linha(uint32_t numero, uint32_t tempo_ms, uint32_t offset)
+{
+    indice_entrada_t entrada = {.amostra = numero, .tempo_ms = tempo_ms, .offset = offset};
+    FRESULT res = indice_acrescentar(nome_indice, &entrada);
+    if (res == FR_OK)
+        bytes_sessao += sizeof(entrada);
+    else
+        LOG_ERRO("Não foi possível atualizar o índice %s: %s (%d)\n", nome_indice, FRESULT_str(res), res);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Captura disparada por evento (comando "gatilho"): com ele ligado, a
+// captura lê o MPU6050 no período configurado, guarda as amostras na fila
+// de lib/gatilho.c e só grava no CSV as janelas em torno dos disparos. O
+// arquivo fica aberto durante o evento e as linhas saem em blocos, um por
+// volta do laço principal, para a leitura do sensor não esperar o cartão.
+
+#define GATILHO_PERIODO_PADRAO_US 1000
+#define GATILHO_PERIODO_MIN_US 1000
+#define GATILHO_PRE_PADRAO_MS 200
+#define GATILHO_POS_PADRAO_MS 500
+#define GATILHO_LINHA_MAX 96 // maior linha do CSV sem as colunas de orientação
+
+static bool gatilho_ligado = false; // vale para as próximas capturas
+static gatilho_config_t gatilho_config;
+static uint32_t gatilho_periodo_us = GATILHO_PERIODO_PADRAO_US;
+static gatilho_t gatilho;
+static absolute_time_t gatilho_proxima_leitura;
+static uint32_t gatilho_falhas; // leituras do MPU6050 que falharam
+static FIL gatilho_arquivo;
+static bool gatilho_arquivo_aberto = false;
+static bool gatilho_erro = false;
+static char gatilho_bloco[1024];
+static size_t gatilho_bloco_n;
+
+static void gatilho_preparar()
+{
+    gatilho_iniciar(&gatilho, &gatilho_config, mpu6050_giro_dps(&mpu6050_config), mpu6050_accel_g(&mpu6050_config));
+    gatilho_proxima_leitura = get_absolute_time();
+    gatilho_falhas = 0;
+    gatilho_arquivo_aberto = false;
+    gatilho_erro = false;
+    gatilho_bloco_n = 0;
+}
+
+// Data e Hora são as do momento da gravação (atrasada em relação à
+// leitura); Tempo_ms é o instante da leitura
+static void gatilho_formatar(const gatilho_amostra_t *a, uint32_t numero)
+{
+    uint32_t tempo_ms = a->tempo_us / 1000;
+    if (nome_indice[0] && contador_amostras % INDICE_PASSO == 0)
+        indexar_linha(numero, tempo_ms, (uint32_t)f_tell(&gatilho_arquivo) + (uint32_t)gatilho_bloco_n);
+    gatilho_bloco_n += formatar_linha_csv(gatilho_bloco + gatilho_bloco_n, sizeof(gatilho_bloco) - gatilho_bloco_n,
+                                          numero, a->accel, a->gyro, a->temp, tempo_ms);
+    contador_amostras++;
+    catalogo_sessao_acumular(&sessao, a->accel, a->temp);
+}
+
+// Grava um bloco de linhas do evento; com 'tudo', esvazia a fila. O arquivo
+// é aberto no início do evento e fechado (com f_sync) quando ele termina
+static bool gatilho_gravar(bool tudo)
+{
+    if (gatilho_erro)
+        return false;
+    if (!gatilho_arquivo_aberto)
+    {
+        if (!gatilho_pendentes(&gatilho))
+            return true;
+        FRESULT res = f_open(&gatilho_arquivo, nome_arquivo, FA_WRITE | FA_OPEN_APPEND);
+        if (res != FR_OK)
+        {
+            LOG_ERRO("Não foi possível abrir o arquivo %s para escrita: %s (%d)\n", nome_arquivo, FRESULT_str(res),
+                     res);
+            gatilho_erro = true;
+            return false;
+        }
+        gatilho_arquivo_aberto = true;
+    }
+    for (;;)
+    {
+        gatilho_amostra_t a;
+        uint32_t numero;
+        bool cheio = false;
+        while (!(cheio = gatilho_bloco_n > sizeof(gatilho_bloco) - GATILHO_LINHA_MAX) &&
+               gatilho_proxima(&gatilho, &a, &numero))
+            gatilho_formatar(&a, numero);
+        bool fim_evento = !gatilho_evento_aberto(&gatilho);
+        // Bloco incompleto com o evento em andamento: espera mais amostras
+        if (!cheio && !fim_evento && !tudo)
+            return true;
+
+        UINT bw = 0;
+        FRESULT res = gatilho_bloco_n ? f_write(&gatilho_arquivo, gatilho_bloco, gatilho_bloco_n, &bw) : FR_OK;
+        if (res != FR_OK || bw != gatilho_bloco_n)
+        {
+            LOG_ERRO("Não foi possível escrever no arquivo %s: %s (%d), bytes escritos=%u\n", nome_arquivo,
+                     FRESULT_str(res), res, bw);
+            f_close(&gatilho_arquivo);
+            gatilho_arquivo_aberto = false;
+            gatilho_erro = true;
+            return false;
+        }
+        gatilho_bloco_n = 0;
+        bytes_sessao += bw;
+        if (contador_amostras)
+            bytes_por_amostra = bytes_sessao / contador_amostras;
+        if (tudo && cheio)
+            continue;
+        if (fim_evento || tudo)
+        {
+            f_sync(&gatilho_arquivo);
+            f_close(&gatilho_arquivo);
+            gatilho_arquivo_aberto = false;
+        }
+        return true;
+    }
+}
+
+// Leitura na cadência configurada (as vencidas são lidas em seguida, como
+// no stream) e, depois, no máximo um bloco gravado no cartão
+static void gatilho_tarefa()
+{
+    while (logger_ativado && time_reached(gatilho_proxima_leitura))
+    {
+        gatilho_proxima_leitura = delayed_by_us(gatilho_proxima_leitura, gatilho_periodo_us);
+        gatilho_amostra_t a;
+        uint64_t agora = time_us_64();
+        if (!mpu6050_ler_bruto(a.accel, a.gyro, &a.temp))
+        {
+            gatilho_falhas++;
+            continue;
+        }
+        calibracao_aplicar(&calibracao, a.accel, a.gyro);
+        a.tempo_us = (uint32_t)(agora - to_us_since_boot(inicio_captura));
+        // As estatísticas cobrem todo o monitoramento, não só os eventos
+        estatisticas_acumular(&estatisticas, a.accel, a.gyro, a.temp, agora);
+        amostra_t amostra = {
+            .seq = gatilho.escrita + 1,
+            .tempo_us = agora,
+            .accel = {a.accel[0], a.accel[1], a.accel[2]},
+            .gyro = {a.gyro[0], a.gyro[1], a.gyro[2]},
+            .temp = a.temp};
+        amostras_publicar(&amostra);
+        if (gatilho_acrescentar(&gatilho, &a))
+        {
+            char texto[32];
+            snprintf(texto, sizeof(texto), "Evento %lu\nGravando", (unsigned long)gatilho.eventos);
+            if (!grafico_ativo())
+                feedback_mensagem(texto, MENSAGEM_TIMEOUT_MS);
+            console_printf("Evento %lu aos %lu.%03lu s\n", (unsigned long)gatilho.eventos,
+                           (unsigned long)(a.tempo_us / 1000000), (unsigned long)(a.tempo_us / 1000 % 1000));
+        }
+    }
+    if (!logger_ativado)
+        return;
+
+    if (!sd_esta_montado())
+    {
+        LOG_ERRO("Cartão SD não está montado. Parando captura.\n");
+        gatilho_erro = true;
+        encerrar_captura();
+        feedback_mensagem("Erro: SD Não Montado", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    // O espaço é conferido ao abrir cada evento, deixando a reserva para fechar a sessão
+    if (!gatilho_arquivo_aberto && gatilho_pendentes(&gatilho) && espaco_esgotado())
+    {
+        LOG_AVISO("Cartão SD cheio (menos de %u KiB livres). Parando captura.\n", ESPACO_RESERVA_BYTES / 1024);
+        gatilho_erro = true;
+        encerrar_captura();
+        feedback_mensagem("Cartão Cheio\nCaptura Parada", MENSAGEM_TIMEOUT_MS);
+        feedback_bipe(3, 100, 100);
+        return;
+    }
+    if (!gatilho_gravar(false))
+    {
+        encerrar_captura();
+        feedback_mensagem("Erro Escrita", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (contador_amostras >= MAX_AMOSTRAS)
+    {
+        encerrar_captura();
+        console_printf("Limite de %d amostras gravadas atingido.\n", MAX_AMOSTRAS);
+        feedback_mensagem("Captura Concluída", MENSAGEM_TIMEOUT_MS);
+    }
+}
+
+// Fim de uma captura por evento: grava o que ainda está na fila
+static void gatilho_encerrar()
+{
+    gatilho_gravar(true);
+    if (gatilho_arquivo_aberto)
+    {
+        f_close(&gatilho_arquivo);
+        gatilho_arquivo_aberto = false;
+    }
+    console_printf("%lu evento(s): %lu de %lu amostras lidas gravadas\n", (unsigned long)gatilho.eventos,
+                   (unsigned long)contador_amostras, (unsigned long)gatilho.escrita);
+    if (gatilho.perdidas)
+        LOG_AVISO("%lu amostras de evento perdidas (gravação atrasada)\n", (unsigned long)gatilho.perdidas);
+    if (gatilho_falhas)
+        LOG_AVISO("%lu leituras do MPU6050 falharam\n", (unsigned long)gatilho_falhas);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Leitura do MPU6050 por temporizador (capturas de espectro, decimada e
+// adaptativa): a interrupção de um temporizador repetitivo faz a leitura em
+// rajada e aplica a calibração, com intervalo uniforme mesmo quando o laço
+// principal espera o cartão, e entrega a amostra ao destino do modo. O I2C0
+// fica com a interrupção durante a captura: os comandos que usam o sensor
+// recusam rodar com captura ativa.
+
+typedef void (*amostrador_destino_t)(const amostra_t *a);
+
+static repeating_timer_t amostrador_temporizador;
+static bool amostrador_ativo = false;
+static amostrador_destino_t amostrador_destino;
+static volatile uint32_t amostrador_seq;
+static volatile uint32_t amostrador_falhas; // leituras do MPU6050 que falharam
+
+// Uma leitura que falha consome o número de sequência: os estágios seguintes
+// veem a lacuna (e perdem a conversão analógica disparada junto)
+static bool amostrador_ler(repeating_timer_t *rt)
+{
+    (void)rt;
+    amostra_t a;
+    a.tempo_us = time_us_64();
+    a.seq = ++amostrador_seq;
+    a.adc = analogico_disparar(a.seq);
+    if (!mpu6050_ler_bruto(a.accel, a.gyro, &a.temp))
+    {
+        amostrador_falhas++;
+        return logger_ativado;
+    }
+    analogico_recolher(&a);
+    calibracao_aplicar(&calibracao, a.accel, a.gyro);
+    amostrador_destino(&a);
+    if (sensores_sessao)
+    {
+        // O que sobra do período fica para os outros sensores do I2C0
+        uint64_t agora = time_us_64();
+        int32_t folga = (int32_t)(-amostrador_temporizador.delay_us) - (int32_t)(agora - a.tempo_us) -
+                        SENSORES_MARGEM_US;
+        sensores_executar(&sensores, agora, folga);
+    }
+    return logger_ativado;
+}
+
+// Só de dentro do destino (na interrupção): vale a partir da próxima
+// leitura, contada do instante previsto da atual
+static void amostrador_mudar_periodo(uint32_t periodo_us)
+{
+    amostrador_temporizador.delay_us = -(int64_t)periodo_us;
+}
+
+static bool amostrador_iniciar(uint32_t periodo_us, amostrador_destino_t destino)
+{
+    amostrador_seq = 0;
+    amostrador_falhas = 0;
+    amostrador_destino = destino;
+    amostrador_ativo =
+        add_repeating_timer_us(-(int64_t)periodo_us, amostrador_ler, NULL, &amostrador_temporizador);
+    return amostrador_ativo;
+}
+
+static void amostrador_parar()
+{
+    if (amostrador_ativo)
+    {
+        cancel_repeating_timer(&amostrador_temporizador);
+        amostrador_ativo = false;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Captura de espectro (comando "espectro"): as leituras do temporizador vão
+// para a fila de amostras; o core1 junta as janelas de um eixo e calcula o
+// espectro (lib/espectro.c). Aqui só se grava uma linha por janela, com os
+// picos e, opcionalmente, todos os bins. As amostras em si não vão para o
+// cartão.
+
+#define ESPECTRO_PERIODO_PADRAO_US 1000
+#define ESPECTRO_PERIODO_MIN_US 500 // a leitura em rajada leva ~400 us no I2C a 400 kHz
+#define ESPECTRO_N_PADRAO 256
+#define ESPECTRO_LINHA_MAX (128 + (ESPECTRO_N_MAX / 2 + 1) * 6)
+#define ESPECTRO_BENCH_REPETICOES 50
+
+static bool espectro_ligado = false; // vale para as próximas capturas
+static espectro_config_t espectro_config = {.n = ESPECTRO_N_PADRAO, .eixo = 2, .bins = false};
+static uint32_t espectro_periodo_us = ESPECTRO_PERIODO_PADRAO_US;
+static bool espectro_sessao = false;
+static bool espectro_erro = false;
+static absolute_time_t espectro_proxima_tela;
+static char espectro_linha[ESPECTRO_LINHA_MAX];
+static const char *const espectro_eixos[3] = {"ax", "ay", "az"};
+
+// Na interrupção: a amostra vai para o core1 pela fila (com a lacuna de uma
+// leitura que falhou, o core1 recomeça a janela). Estatísticas e catálogo
+// cobrem todas as amostras lidas
+static void espectro_publicar(const amostra_t *a)
+{
+    amostras_publicar(a);
+    estatisticas_acumular(&estatisticas, a->accel, a->gyro, a->temp, a->tempo_us);
+    catalogo_sessao_acumular(&sessao, a->accel, a->temp);
+}
+
+static bool espectro_armar()
+{
+    espectro_erro = false;
+    espectro_proxima_tela = get_absolute_time();
+    return amostrador_iniciar(espectro_periodo_us, espectro_publicar);
+}
+
+// Cabeçalho das colunas; os bins vão de 0 a n/2, com k · Fs_Hz / n Hz
+static int espectro_colunas()
+{
+    int n = snprintf(espectro_linha, sizeof(espectro_linha),
+                     "Janela,Tempo_ms,Fs_Hz,Media,RMS,Pico1_Hz,Amp1,Pico2_Hz,Amp2,Pico3_Hz,Amp3,Maior_intervalo_us");
+    if (espectro_config.bins)
+        for (int k = 0; k <= espectro_config.n / 2; k++)
+            n += snprintf(espectro_linha + n, sizeof(espectro_linha) - n, ",B%d", k);
+    n += snprintf(espectro_linha + n, sizeof(espectro_linha) - n, "\n");
+    return n;
+}
+
+// Frequências em centésimos de Hz e amplitudes em LSB do eixo
+static int espectro_formatar(const espectro_resultado_t *r)
+{
+    uint32_t tempo_ms = (uint32_t)((r->tempo_us - to_us_since_boot(inicio_captura)) / 1000);
+    int n = snprintf(espectro_linha, sizeof(espectro_linha), "%lu,%lu,%lu.%02lu,%d,%u", (unsigned long)r->janela,
+                     (unsigned long)tempo_ms, (unsigned long)(r->fs_chz / 100), (unsigned long)(r->fs_chz % 100),
+                     r->media, r->rms);
+    for (int p = 0; p < ESPECTRO_PICOS; p++)
+    {
+        const espectro_pico_t *pico = &r->picos[p];
+        if (pico->amplitude)
+            n += snprintf(espectro_linha + n, sizeof(espectro_linha) - n, ",%lu.%02lu,%u",
+                          (unsigned long)(pico->frequencia_chz / 100), (unsigned long)(pico->frequencia_chz % 100),
+                          pico->amplitude);
+        else
+            n += snprintf(espectro_linha + n, sizeof(espectro_linha) - n, ",,");
+    }
+    n += snprintf(espectro_linha + n, sizeof(espectro_linha) - n, ",%lu", (unsigned long)r->maior_intervalo_us);
+    if (espectro_config.bins)
+        for (int k = 0; k <= r->n / 2; k++)
+            n += snprintf(espectro_linha + n, sizeof(espectro_linha) - n, ",%u", r->amplitude[k]);
+    n += snprintf(espectro_linha + n, sizeof(espectro_linha) - n, "\n");
+    return n;
+}
+
+// Grava as janelas prontas no core1, todas com o arquivo aberto uma vez
+static bool espectro_gravar()
+{
+    if (espectro_erro)
+        return false;
+    const espectro_resultado_t *r = nucleo1_espectro_obter();
+    if (!r)
+        return true;
+    FIL arquivo;
+    FRESULT res = f_open(&arquivo, nome_arquivo, FA_WRITE | FA_OPEN_APPEND);
+    if (res != FR_OK)
+    {
+        LOG_ERRO("Não foi possível abrir o arquivo %s para escrita: %s (%d)\n", nome_arquivo, FRESULT_str(res), res);
+        espectro_erro = true;
+        return false;
+    }
+    espectro_pico_t pico = {0};
+    for (; r && contador_amostras < MAX_AMOSTRAS; r = nucleo1_espectro_obter())
+    {
+        int n = espectro_formatar(r);
+        pico = r->picos[0];
+        nucleo1_espectro_liberar();
+        UINT bw = 0;
+        res = f_write(&arquivo, espectro_linha, n, &bw);
+        if (res != FR_OK || bw != (UINT)n)
+        {
+            LOG_ERRO("Não foi possível escrever no arquivo %s: %s (%d), bytes escritos=%u\n", nome_arquivo,
+                     FRESULT_str(res), res, bw);
+            f_close(&arquivo);
+            espectro_erro = true;
+            return false;
+        }
+        bytes_sessao += bw;
+        contador_amostras++;
+    }
+    f_sync(&arquivo);
+    f_close(&arquivo);
+    bytes_por_amostra = bytes_sessao / contador_amostras;
+
+    if (time_reached(espectro_proxima_tela) && !grafico_ativo())
+    {
+        char texto[48];
+        snprintf(texto, sizeof(texto), "Janela %d\nPico %lu.%01lu Hz", contador_amostras,
+                 (unsigned long)(pico.frequencia_chz / 100), (unsigned long)(pico.frequencia_chz % 100 / 10));
+        feedback_mensagem(texto, MENSAGEM_TIMEOUT_MS);
+        espectro_proxima_tela = make_timeout_time_ms(DISPLAY_UPDATE_MS);
+    }
+    return true;
+}
+
+static void espectro_tarefa()
+{
+    if (!sd_esta_montado())
+    {
+        LOG_ERRO("Cartão SD não está montado. Parando captura.\n");
+        espectro_erro = true;
+        encerrar_captura();
+        feedback_mensagem("Erro: SD Não Montado", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (espaco_esgotado())
+    {
+        LOG_AVISO("Cartão SD cheio (menos de %u KiB livres). Parando captura.\n", ESPACO_RESERVA_BYTES / 1024);
+        espectro_erro = true;
+        encerrar_captura();
+        feedback_mensagem("Cartão Cheio\nCaptura Parada", MENSAGEM_TIMEOUT_MS);
+        feedback_bipe(3, 100, 100);
+        return;
+    }
+    if (!espectro_gravar())
+    {
+        encerrar_captura();
+        feedback_mensagem("Erro Escrita", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (contador_amostras >= MAX_AMOSTRAS)
+    {
+        encerrar_captura();
+        console_printf("Limite de %d janelas gravadas atingido.\n", MAX_AMOSTRAS);
+        feedback_mensagem("Captura Concluída", MENSAGEM_TIMEOUT_MS);
+    }
+}
+
+// Fim de uma captura de espectro: para as leituras, grava as janelas já
+// calculadas e desliga o estágio no core1 (a janela incompleta é descartada)
+static void espectro_encerrar()
+{
+    amostrador_parar();
+    espectro_gravar();
+    uint32_t janelas, descartadas, maximo_us;
+    nucleo1_espectro_estatisticas(&janelas, &descartadas, &maximo_us);
+    nucleo1_espectro_configurar(NULL);
+    console_printf("%lu janela(s) de %u pontos calculadas, %d gravadas; pior cálculo %lu us (janela de %lu us)\n",
+                   (unsigned long)janelas, espectro_config.n, contador_amostras, (unsigned long)maximo_us,
+                   (unsigned long)(espectro_config.n * espectro_periodo_us));
+    if (descartadas)
+        LOG_AVISO("%lu janela(s) descartadas (amostra faltando ou gravação atrasada)\n", (unsigned long)descartadas);
+    if (amostrador_falhas)
+        LOG_AVISO("%lu leituras do MPU6050 falharam\n", (unsigned long)amostrador_falhas);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Gravação das amostras da fila (capturas decimada e adaptativa): o laço
+// principal lê a fila de amostras como mais um leitor, monta as linhas do
+// CSV (mesmas colunas da captura periódica) e grava em blocos, com o
+// arquivo aberto só durante a escrita. O modo pode intercalar linhas "#"
+// antes de uma amostra.
+
+#define FILA_GRAVACAO_MS 500 // maior intervalo entre gravações do bloco
+#define FILA_PREFIXO_MAX 96  // maior texto intercalado antes de uma linha
+
+// Escreve em 'destino' o que vai antes da linha da amostra 'seq' e retorna
+// o número de bytes
+typedef size_t (*fila_prefixo_t)(uint32_t seq, char *destino, size_t tamanho);
+
+static amostras_leitor_t fila_leitor;
+static fila_prefixo_t fila_prefixo;
+static uint32_t fila_tamanho; // bytes já no arquivo (posição das linhas no índice)
+static absolute_time_t fila_proxima_gravacao;
+static bool fila_erro = false;
+static char fila_bloco[2048];
+static size_t fila_bloco_n;
+
+// Antes de ligar o temporizador; o cabeçalho já está no arquivo
+static void fila_iniciar(fila_prefixo_t prefixo)
+{
+    amostras_leitor_iniciar(&fila_leitor);
+    fila_prefixo = prefixo;
+    FILINFO fno;
+    fila_tamanho = (FR_OK == f_stat(nome_arquivo, &fno)) ? (uint32_t)fno.fsize : 0;
+    fila_proxima_gravacao = make_timeout_time_ms(FILA_GRAVACAO_MS);
+    fila_erro = false;
+    fila_bloco_n = 0;
+}
+
+static bool fila_gravar_bloco()
+{
+    if (fila_bloco_n == 0)
+        return true;
+    FIL arquivo;
+    FRESULT res = f_open(&arquivo, nome_arquivo, FA_WRITE | FA_OPEN_APPEND);
+    if (res != FR_OK)
+    {
+        LOG_ERRO("Não foi possível abrir o arquivo %s para escrita: %s (%d)\n", nome_arquivo, FRESULT_str(res), res);
+        fila_erro = true;
+        return false;
+    }
+    UINT bw = 0;
+    res = f_write(&arquivo, fila_bloco, fila_bloco_n, &bw);
+    if (res != FR_OK || bw != fila_bloco_n)
+    {
+        LOG_ERRO("Não foi possível escrever no arquivo %s: %s (%d), bytes escritos=%u\n", nome_arquivo,
+                 FRESULT_str(res), res, bw);
+        f_close(&arquivo);
+        fila_erro = true;
+        return false;
+    }
+    f_sync(&arquivo);
+    f_close(&arquivo);
+    fila_tamanho += bw;
+    bytes_sessao += bw;
+    fila_bloco_n = 0;
+    if (contador_amostras)
+        bytes_por_amostra = bytes_sessao / contador_amostras;
+    return true;
+}
+
+// Formata as amostras que chegaram à fila e grava o bloco quando ele enche
+// ou passa FILA_GRAVACAO_MS; com 'tudo', grava o que houver
+static bool fila_gravar(bool tudo)
+{
+    if (fila_erro)
+        return false;
+    amostra_t a;
+    while (contador_amostras < MAX_AMOSTRAS && amostras_ler(&fila_leitor, &a))
+    {
+        if (fila_bloco_n >
+                sizeof(fila_bloco) - GATILHO_LINHA_MAX - FILA_PREFIXO_MAX - SENSORES_PREFIXO_MAX - ANALOGICO_LINHA_MAX &&
+            !fila_gravar_bloco())
+            return false;
+        uint32_t tempo_ms = (uint32_t)((a.tempo_us - to_us_since_boot(inicio_captura)) / 1000);
+        contador_amostras++;
+        if (nome_indice[0] && (contador_amostras - 1) % INDICE_PASSO == 0)
+            indexar_linha(a.seq, tempo_ms, fila_tamanho + (uint32_t)fila_bloco_n);
+        if (fila_prefixo)
+            fila_bloco_n += fila_prefixo(a.seq, fila_bloco + fila_bloco_n, FILA_PREFIXO_MAX);
+        if (sensores_sessao)
+            fila_bloco_n += sensores_texto(a.tempo_us, fila_bloco + fila_bloco_n, SENSORES_PREFIXO_MAX);
+        fila_bloco_n += formatar_linha_csv(fila_bloco + fila_bloco_n, sizeof(fila_bloco) - fila_bloco_n, a.seq,
+                                           a.accel, a.gyro, a.temp, tempo_ms);
+        if (analogico_sessao)
+        {
+            // Colunas analógicas no lugar da quebra de linha
+            fila_bloco_n--;
+            fila_bloco_n += analogico_formatar(&analogico_config, AMOSTRA_ADC_CANAL(a.adc), AMOSTRA_ADC_VALOR(a.adc),
+                                               fila_bloco + fila_bloco_n, sizeof(fila_bloco) - fila_bloco_n);
+            fila_bloco[fila_bloco_n++] = '\n';
+        }
+        estatisticas_acumular(&estatisticas, a.accel, a.gyro, a.temp, a.tempo_us);
+        catalogo_sessao_acumular(&sessao, a.accel, a.temp);
+    }
+    if (!tudo && !time_reached(fila_proxima_gravacao))
+        return true;
+    fila_proxima_gravacao = make_timeout_time_ms(FILA_GRAVACAO_MS);
+    return fila_gravar_bloco();
+}
+
+// Uma volta do laço principal; 'modo' vai na segunda linha do OLED
+static void fila_tarefa(const char *modo)
+{
+    if (!sd_esta_montado())
+    {
+        LOG_ERRO("Cartão SD não está montado. Parando captura.\n");
+        fila_erro = true;
+        encerrar_captura();
+        feedback_mensagem("Erro: SD Não Montado", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (espaco_esgotado())
+    {
+        LOG_AVISO("Cartão SD cheio (menos de %u KiB livres). Parando captura.\n", ESPACO_RESERVA_BYTES / 1024);
+        fila_erro = true;
+        encerrar_captura();
+        feedback_mensagem("Cartão Cheio\nCaptura Parada", MENSAGEM_TIMEOUT_MS);
+        feedback_bipe(3, 100, 100);
+        return;
+    }
+    int antes = contador_amostras;
+    if (!fila_gravar(false))
+    {
+        encerrar_captura();
+        feedback_mensagem("Erro Escrita", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (contador_amostras / 100 != antes / 100 && !grafico_ativo())
+    {
+        char texto[48];
+        snprintf(texto, sizeof(texto), "Amostra %d/%d\n%s", contador_amostras, MAX_AMOSTRAS, modo);
+        feedback_mensagem(texto, MENSAGEM_TIMEOUT_MS);
+    }
+    if (contador_amostras >= MAX_AMOSTRAS)
+    {
+        encerrar_captura();
+        console_printf("Coleta de %d amostras concluída com sucesso.\n", MAX_AMOSTRAS);
+        feedback_mensagem("Captura Concluída", MENSAGEM_TIMEOUT_MS);
+    }
+}
+
+// Grava o que ainda está na fila; o temporizador já parou
+static void fila_encerrar()
+{
+    fila_gravar(true);
+    if (fila_leitor.perdidas)
+        LOG_AVISO("%lu amostras perdidas (gravação atrasada)\n", (unsigned long)fila_leitor.perdidas);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Captura decimada (comando "decimar"): as leituras do temporizador passam
+// pela cadeia CIC + FIR de lib/decimador.c ainda na interrupção, e só as
+// amostras de saída vão para a fila, gravadas como na seção anterior.
+
+#define DECIMACAO_ENTRADA_PADRAO_US 1000
+#define DECIMACAO_ENTRADA_MIN_US 500 // a leitura em rajada leva ~400 us no I2C a 400 kHz
+#define DECIMACAO_TAPS_PADRAO 21
+
+static bool decimacao_ligada = false; // vale para as próximas capturas
+static decimador_config_t decimacao_config;
+static uint32_t decimacao_entrada_us = DECIMACAO_ENTRADA_PADRAO_US;
+static bool decimacao_sessao = false;
+static decimador_t decimador;
+static uint32_t decimacao_seq;
+static int16_t decimacao_leitura[DECIMADOR_CANAIS]; // última leitura boa
+static uint32_t decimacao_leitura_seq;
+static uint32_t decimacao_atraso_us; // atraso de grupo descontado do instante da saída
+static uint32_t decimacao_aquecimento; // entradas até a cadeia encher
+
+static void decimacao_padrao()
+{
+    memset(&decimacao_config, 0, sizeof(decimacao_config));
+    decimacao_config.cic_fator = 10;
+    decimacao_config.cic_ordem = 4;
+    decimacao_config.fir_fator = 2;
+    decimador_projetar_fir(&decimacao_config, DECIMACAO_TAPS_PADRAO);
+}
+
+static uint32_t decimacao_saida_us()
+{
+    return decimacao_entrada_us * decimador_fator(&decimacao_config);
+}
+
+static void decimacao_entrada(const int16_t entrada[DECIMADOR_CANAIS], uint64_t tempo_us)
+{
+    int16_t saida[DECIMADOR_CANAIS];
+    bool cheia = decimacao_aquecimento == 0;
+    if (!cheia)
+        decimacao_aquecimento--;
+    // As saídas do início misturam os zeros do estado inicial e ficariam
+    // antes do início da captura depois de descontado o atraso
+    if (!decimador_acrescentar(&decimador, entrada, saida) || !cheia)
+        return;
+    amostra_t s = {
+        .seq = ++decimacao_seq,
+        .tempo_us = tempo_us - decimacao_atraso_us,
+        .accel = {saida[0], saida[1], saida[2]},
+        .gyro = {saida[3], saida[4], saida[5]},
+        .temp = saida[6]};
+    amostras_publicar(&s);
+}
+
+// Na interrupção. A cadeia conta com uma entrada por período: a leitura
+// anterior é repetida no lugar das que falharam. A saída leva o instante
+// da leitura menos o atraso de grupo, e fica alinhada com o sinal
+static void decimacao_acrescentar(const amostra_t *a)
+{
+    for (uint32_t s = decimacao_leitura_seq + 1; decimacao_leitura_seq && s < a->seq; s++)
+        decimacao_entrada(decimacao_leitura, a->tempo_us - (uint64_t)(a->seq - s) * decimacao_entrada_us);
+    int16_t entrada[DECIMADOR_CANAIS] = {a->accel[0], a->accel[1], a->accel[2], a->gyro[0],
+                                         a->gyro[1],  a->gyro[2],  a->temp};
+    memcpy(decimacao_leitura, entrada, sizeof(decimacao_leitura));
+    decimacao_leitura_seq = a->seq;
+    decimacao_entrada(entrada, a->tempo_us);
+}
+
+// Começa as leituras; o cabeçalho já está no arquivo
+static bool decimacao_armar()
+{
+    decimador_iniciar(&decimador, &decimacao_config);
+    decimacao_seq = 0;
+    decimacao_leitura_seq = 0;
+    decimacao_atraso_us = (uint32_t)((uint64_t)decimador_atraso_x2(&decimacao_config) * decimacao_entrada_us / 2);
+    decimacao_aquecimento = decimador_atraso_x2(&decimacao_config);
+    fila_iniciar(NULL);
+    return amostrador_iniciar(decimacao_entrada_us, decimacao_acrescentar);
+}
+
+// Linhas "# decimacao ..." e "# fir ..." do cabeçalho: coeficientes Q14
+// separados por ':' (sem vírgulas), até 16 por linha para caberem na
+// leitura de linhas do range
+static int decimacao_cabecalho(char *destino, size_t tamanho)
+{
+    const decimador_config_t *c = &decimacao_config;
+    int n = snprintf(destino, tamanho,
+                     "\n# decimacao entrada_us=%lu cic=%ux%u fir_fator=%u taps=%u saida_us=%lu atraso_us=%lu",
+                     (unsigned long)decimacao_entrada_us, c->cic_fator, c->cic_fator > 1 ? c->cic_ordem : 0,
+                     c->fir_fator, c->taps, (unsigned long)decimacao_saida_us(),
+                     (unsigned long)((uint64_t)decimador_atraso_x2(c) * decimacao_entrada_us / 2));
+    if (c->taps)
+    {
+        for (int i = 0; i < c->taps; i++)
+            n += snprintf(destino + n, tamanho - n, i % 16 ? ":%d" : "\n# fir %d", c->fir[i]);
+    }
+    return n;
+}
+
+static void decimacao_tarefa()
+{
+    fila_tarefa("Decimada");
+}
+
+// Fim de uma captura decimada: para as leituras e grava as saídas que
+// ainda estão na fila
+static void decimacao_encerrar()
+{
+    amostrador_parar();
+    fila_encerrar();
+    console_printf("%lu leituras decimadas em %d amostras gravadas\n", (unsigned long)amostrador_seq,
+                   contador_amostras);
+    if (amostrador_falhas)
+        LOG_AVISO("%lu leituras do MPU6050 falharam (repetida a anterior)\n", (unsigned long)amostrador_falhas);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Taxa adaptativa (comando "adaptativo"): as leituras do temporizador vão
+// direto para a fila e passam pelo detector de movimento de lib/atividade.c.
+// Quando ele muda de estado, ainda na interrupção, SMPLRT_DIV e DLPF mudam
+// pelo mesmo mpu6050_configurar_taxa() do reset, o temporizador passa ao
+// novo período a partir da leitura seguinte e a troca entra numa fila
+// pequena. A gravação põe cada troca numa linha "# taxa ..." antes da
+// primeira amostra no novo período.
+
+#define ADAPTATIVO_ALTO_PADRAO_HZ 1000
+#define ADAPTATIVO_BAIXO_PADRAO_HZ 50
+#define ADAPTATIVO_TROCAS 8 // potência de 2
+
+typedef struct
+{
+    uint32_t seq;        // primeira amostra no novo período
+    uint32_t periodo_us;
+    uint8_t divisor;
+    uint8_t dlpf;
+    bool ok;             // o MPU6050 aceitou a configuração
+} adaptativo_troca_t;
+
+static bool adaptativo_ligado = false; // vale para as próximas capturas
+static bool adaptativo_sessao = false;
+static atividade_config_t adaptativo_config = {.accel_mg = 50, .giro_dps = 20, .espera_ms = 2000};
+static uint8_t adaptativo_divisor_alto = 1000 / ADAPTATIVO_ALTO_PADRAO_HZ - 1;
+static uint8_t adaptativo_divisor_baixo = 1000 / ADAPTATIVO_BAIXO_PADRAO_HZ - 1;
+static atividade_t atividade;
+static adaptativo_troca_t adaptativo_trocas[ADAPTATIVO_TROCAS];
+static volatile uint32_t adaptativo_trocas_escrita;
+static uint32_t adaptativo_trocas_leitura;
+static volatile uint32_t adaptativo_trocas_perdidas;
+static volatile uint32_t adaptativo_leituras_baixa;
+static uint8_t adaptativo_divisor_antes, adaptativo_dlpf_antes; // restaurados no fim
+
+// Com o DLPF ligado a taxa interna é 1 kHz / (1 + divisor), e o
+// temporizador lê no mesmo ritmo
+static uint32_t adaptativo_periodo_us(uint8_t divisor)
+{
+    return 1000u * (1u + divisor);
+}
+
+// Na interrupção
+static void adaptativo_trocar(uint8_t divisor, uint32_t seq)
+{
+    uint8_t dlpf = mpu6050_dlpf_para(divisor);
+    bool ok = mpu6050_configurar_taxa(divisor, dlpf);
+    uint32_t periodo_us = adaptativo_periodo_us(divisor);
+    amostrador_mudar_periodo(periodo_us);
+    uint32_t escrita = adaptativo_trocas_escrita;
+    if (escrita - adaptativo_trocas_leitura >= ADAPTATIVO_TROCAS)
+    {
+        adaptativo_trocas_perdidas++;
+        return;
+    }
+    adaptativo_trocas[escrita & (ADAPTATIVO_TROCAS - 1)] =
+        (adaptativo_troca_t){.seq = seq, .periodo_us = periodo_us, .divisor = divisor, .dlpf = dlpf, .ok = ok};
+    __dmb();
+    adaptativo_trocas_escrita = escrita + 1;
+}
+
+// Na interrupção
+static void adaptativo_acrescentar(const amostra_t *a)
+{
+    amostras_publicar(a);
+    bool antes = atividade.ativo;
+    if (!antes)
+        adaptativo_leituras_baixa++;
+    if (atividade_acrescentar(&atividade, a->accel, a->gyro, a->tempo_us) != antes)
+        adaptativo_trocar(atividade.ativo ? adaptativo_divisor_alto : adaptativo_divisor_baixo, a->seq + 1);
+}
+
+// Linha "# taxa ..." das trocas que valem a partir da amostra 'seq'; uma por
+// linha de dados, que é o que a fila de gravação reserva
+static size_t adaptativo_prefixo(uint32_t seq, char *destino, size_t tamanho)
+{
+    if (adaptativo_trocas_leitura == adaptativo_trocas_escrita)
+        return 0;
+    __dmb();
+    const adaptativo_troca_t *t = &adaptativo_trocas[adaptativo_trocas_leitura & (ADAPTATIVO_TROCAS - 1)];
+    if ((int32_t)(seq - t->seq) < 0)
+        return 0;
+    int n = snprintf(destino, tamanho, "# taxa amostra=%lu periodo_us=%lu smplrt_div=%u dlpf=%u%s\n",
+                     (unsigned long)t->seq, (unsigned long)t->periodo_us, t->divisor, t->dlpf,
+                     t->ok ? "" : " falhou");
+    adaptativo_trocas_leitura++;
+    return n > 0 && (size_t)n < tamanho ? (size_t)n : 0;
+}
+
+// Linha "# adaptativo ..." do cabeçalho
+static int adaptativo_cabecalho(char *destino, size_t tamanho)
+{
+    return snprintf(destino, tamanho,
+                    "\n# adaptativo alto_us=%lu alto_div=%u alto_dlpf=%u baixo_us=%lu baixo_div=%u baixo_dlpf=%u "
+                    "accel_mg=%u giro_dps=%u espera_ms=%u",
+                    (unsigned long)adaptativo_periodo_us(adaptativo_divisor_alto), adaptativo_divisor_alto,
+                    mpu6050_dlpf_para(adaptativo_divisor_alto),
+                    (unsigned long)adaptativo_periodo_us(adaptativo_divisor_baixo), adaptativo_divisor_baixo,
+                    mpu6050_dlpf_para(adaptativo_divisor_baixo), adaptativo_config.accel_mg,
+                    adaptativo_config.giro_dps, adaptativo_config.espera_ms);
+}
+
+// Começa na taxa alta; o cabeçalho já está no arquivo
+static bool adaptativo_armar()
+{
+    atividade_iniciar(&atividade, &adaptativo_config, mpu6050_giro_dps(&mpu6050_config),
+                      mpu6050_accel_g(&mpu6050_config));
+    adaptativo_trocas_escrita = adaptativo_trocas_leitura = 0;
+    adaptativo_trocas_perdidas = 0;
+    adaptativo_leituras_baixa = 0;
+    adaptativo_divisor_antes = mpu6050_config.divisor;
+    adaptativo_dlpf_antes = mpu6050_config.dlpf;
+    if (!mpu6050_configurar_taxa(adaptativo_divisor_alto, mpu6050_dlpf_para(adaptativo_divisor_alto)))
+        LOG_AVISO("O MPU6050 não aceitou a taxa alta; seguindo com a anterior\n");
+    fila_iniciar(adaptativo_prefixo);
+    return amostrador_iniciar(adaptativo_periodo_us(adaptativo_divisor_alto), adaptativo_acrescentar);
+}
+
+static void adaptativo_tarefa()
+{
+    fila_tarefa("Adaptativa");
+}
+
+// Fim de uma captura adaptativa: para as leituras, grava o que está na fila
+// e devolve ao MPU6050 a taxa de antes
+static void adaptativo_encerrar()
+{
+    amostrador_parar();
+    fila_encerrar();
+    mpu6050_configurar_taxa(adaptativo_divisor_antes, adaptativo_dlpf_antes);
+    console_printf("%lu leituras (%lu na taxa baixa), %lu troca(s) de taxa, %d amostras gravadas\n",
+                   (unsigned long)amostrador_seq, (unsigned long)adaptativo_leituras_baixa,
+                   (unsigned long)(adaptativo_trocas_escrita + adaptativo_trocas_perdidas), contador_amostras);
+    if (adaptativo_trocas_perdidas)
+        LOG_AVISO("%lu troca(s) de taxa sem registro no arquivo\n", (unsigned long)adaptativo_trocas_perdidas);
+    if (amostrador_falhas)
+        LOG_AVISO("%lu leituras do MPU6050 falharam\n", (unsigned long)amostrador_falhas);
+}
+
+static void run_iniciar()
+{
+    LOG_DEBUG("run_iniciar: Iniciando...\n");
+    feedback_mensagem("Iniciando Captura", MENSAGEM_TIMEOUT_MS);
+    if (logger_ativado)
+    {
+        console_printf("Captura já está em andamento.\n");
+        feedback_mensagem("Captura Ativa", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (adc_gravando)
+    {
+        console_printf("Captura do ADC em andamento ('adc off' interrompe).\n");
+        feedback_mensagem("Captura Ativa", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (!sd_esta_montado())
+    {
+        LOG_ERRO("Cartão SD não está montado. Use o comando 'a' para montar.\n");
+        feedback_mensagem("Erro: SD Não Montado", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (!mpu6050_testar())
+    {
+        LOG_ERRO("Falha na comunicação com o MPU6050. Verifique as conexões I2C.\n");
+        return;
+    }
+    if (espaco_esgotado())
+    {
+        console_printf("Cartão SD cheio: menos de %u KiB livres.\n", ESPACO_RESERVA_BYTES / 1024);
+        feedback_mensagem("Cartão Cheio", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    // Gerar nome do arquivo com base na data e hora atuais
+    datetime_t t;
+    if (rtc_get_datetime(&t))
+    {
+        snprintf(nome_arquivo, sizeof(nome_arquivo), "dados%02d%02d%04d%02d%02d%02d.csv",
+                 t.day, t.month, t.year, t.hour, t.min, t.sec);
+        LOG_DEBUG("run_iniciar: Nome do arquivo gerado: %s\n", nome_arquivo);
+    }
+    else
+    {
+        strcpy(nome_arquivo, "dados_fallback.csv");
+        LOG_ERRO("run_iniciar: RTC não configurado, usando nome de arquivo padrão: %s\n", nome_arquivo);
+        feedback_mensagem("Erro RTC", MENSAGEM_TIMEOUT_MS);
+    }
+    logger_ativado = true;
+    contador_amostras = 0;
+    amostras_limpar();
+    gatilho_sessao = gatilho_ligado;
+    espectro_sessao = espectro_ligado;
+    decimacao_sessao = decimacao_ligada;
+    adaptativo_sessao = adaptativo_ligado;
+    analogico_sessao = analogico_ligado && !gatilho_sessao && !espectro_sessao && !decimacao_sessao;
+    if (analogico_ligado && !analogico_sessao)
+        LOG_AVISO("Canais analógicos fora desta captura: só nas capturas periódica e adaptativa\n");
+    if (analogico_sessao)
+        analogico_preparar();
+    sensores_sessao = sensores_ligado && !gatilho_sessao && !espectro_sessao;
+    if (sensores_ligado && !sensores_sessao)
+        LOG_AVISO("Sensores ambientais fora desta captura: não gravam junto de evento ou espectro\n");
+    if (sensores_sessao && !sensores_preparar())
+    {
+        LOG_AVISO("Nenhum sensor ambiental respondeu: captura só com o MPU6050\n");
+        sensores_sessao = false;
+    }
+    // O estágio de espectro do core1 só roda nas capturas de espectro (e a
+    // configuração já reinicia a sessão do core1)
+    nucleo1_espectro_configurar(espectro_sessao ? &espectro_config : NULL);
+    // O core1 só guarda o quatérnio das amostras mais recentes: as capturas
+    // por evento, decimada e adaptativa, gravadas com atraso, ficam sem as
+    // colunas Q0..Q3, e as de espectro não têm linha por amostra
+    orientacao_sessao = nucleo1_orientacao_ligada() && !gatilho_sessao && !espectro_sessao && !decimacao_sessao &&
+                        !adaptativo_sessao;
+    orientacao_atrasos = 0;
+    if (gatilho_sessao)
+        gatilho_preparar();
+    proxima_captura = get_absolute_time();
+    inicio_captura = proxima_captura;
+    LOG_DEBUG("run_iniciar: Abrindo arquivo %s para escrita...\n", nome_arquivo);
+    FIL arquivo;
+    FRESULT res = f_open(&arquivo, nome_arquivo, FA_WRITE | FA_CREATE_ALWAYS);
+    if (res != FR_OK)
+    {
+        LOG_ERRO("Não foi possível abrir o arquivo %s para escrita: %s (%d)\n", nome_arquivo, FRESULT_str(res), res);
+        logger_ativado = false;
+        feedback_mensagem("Erro Arquivo", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    // Linhas de metadados com a calibração aplicada, o modo de captura e as
+    // faixas do MPU6050 (sem vírgulas, para não serem confundidas com dados)
+    // seguidas dos nomes das colunas. Estático: com os coeficientes do FIR
+    // passa de 600 bytes
+    static char cabecalho[1024];
+    int n = snprintf(cabecalho, sizeof(cabecalho), "# calibracao ");
+    n += calibracao_formatar(&calibracao, cabecalho + n, sizeof(cabecalho) - n);
+    if (gatilho_sessao)
+        n += snprintf(cabecalho + n, sizeof(cabecalho) - n,
+                      "\n# gatilho accel_mg=%u giro_dps=%u pre=%u pos=%u periodo_us=%lu", gatilho_config.accel_mg,
+                      gatilho_config.giro_dps, gatilho_config.pre, gatilho_config.pos,
+                      (unsigned long)gatilho_periodo_us);
+    if (espectro_sessao)
+        n += snprintf(cabecalho + n, sizeof(cabecalho) - n, "\n# espectro n=%u eixo=%s periodo_us=%lu janela=hann",
+                      espectro_config.n, espectro_eixos[espectro_config.eixo], (unsigned long)espectro_periodo_us);
+    if (decimacao_sessao)
+        n += decimacao_cabecalho(cabecalho + n, sizeof(cabecalho) - n);
+    if (adaptativo_sessao)
+        n += adaptativo_cabecalho(cabecalho + n, sizeof(cabecalho) - n);
+    if (analogico_sessao)
+        n += analogico_cabecalho(cabecalho + n, sizeof(cabecalho) - n);
+    if (sensores_sessao)
+        n += sensores_cabecalho(cabecalho + n, sizeof(cabecalho) - n);
+    n += snprintf(cabecalho + n, sizeof(cabecalho) - n, "\n# mpu6050 ");
+    n += mpu6050_config_formatar(&mpu6050_config, cabecalho + n, sizeof(cabecalho) - n);
+    n += snprintf(cabecalho + n, sizeof(cabecalho) - n, " unidades=%s", unidades_engenharia ? "ug_mdps" : "lsb");
+    const char *colunas_imu = unidades_engenharia ? "AccX_ug,AccY_ug,AccZ_ug,GyroX_mdps,GyroY_mdps,GyroZ_mdps"
+                                                  : "AccX,AccY,AccZ,GyroX,GyroY,GyroZ";
+    char colunas_adc[ANALOGICO_LINHA_MAX + 8] = "";
+    if (analogico_sessao)
+        analogico_colunas(&analogico_config, colunas_adc, sizeof(colunas_adc));
+    if (espectro_sessao)
+        snprintf(cabecalho + n, sizeof(cabecalho) - n, "\n");
+    else
+        snprintf(cabecalho + n, sizeof(cabecalho) - n, "\nData,Hora,Amostra,%s,Temperatura,Tempo_ms%s%s\n",
+                 colunas_imu, orientacao_sessao ? ",Q0,Q1,Q2,Q3" : "", colunas_adc);
+    UINT bw;
+    LOG_DEBUG("run_iniciar: Escrevendo cabeçalho...\n");
+    res = f_write(&arquivo, cabecalho, strlen(cabecalho), &bw);
+    bool escrito = (res == FR_OK && bw == strlen(cabecalho));
+    if (escrito && espectro_sessao)
+    {
+        // Com os bins, a linha de colunas passa de 3 KB
+        int n_colunas = espectro_colunas();
+        res = f_write(&arquivo, espectro_linha, n_colunas, &bw);
+        escrito = (res == FR_OK && bw == (UINT)n_colunas);
+    }
+    if (!escrito)
+    {
+        LOG_ERRO("Não foi possível escrever o cabeçalho no arquivo %s: %s (%d), bytes escritos=%u\n", nome_arquivo, FRESULT_str(res), res, bw);
+        logger_ativado = false;
+        f_close(&arquivo);
+        feedback_mensagem("Erro Escrita", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    f_sync(&arquivo);
+    f_close(&arquivo);
+
+    // O índice aponta linhas de amostras: o arquivo de espectro não tem
+    nome_indice[0] = '\0';
+    if (!espectro_sessao)
+    {
+        indice_nome(nome_arquivo, nome_indice, sizeof(nome_indice));
+        res = indice_criar(nome_indice);
+        if (res != FR_OK)
+        {
+            LOG_ERRO("Não foi possível criar o índice %s: %s (%d)\n", nome_indice, FRESULT_str(res), res);
+            nome_indice[0] = '\0';
+        }
+    }
+
+    uint32_t periodo_us = gatilho_sessao      ? gatilho_periodo_us
+                          : espectro_sessao   ? espectro_periodo_us
+                          : decimacao_sessao  ? decimacao_saida_us()
+                          : adaptativo_sessao ? adaptativo_periodo_us(adaptativo_divisor_alto)
+                                              : PERIODO_MS * 1000;
+    estatisticas_iniciar(&estatisticas, periodo_us, mpu6050_config.accel_faixa, mpu6050_config.giro_faixa);
+    if (sensores_sessao)
+        sensores_armar(&sensores, to_us_since_boot(inicio_captura));
+    bytes_sessao = 0;
+    estatisticas_pendentes = true;
+    catalogo_sessao_iniciar(&sessao, nome_arquivo, get_fattime(), periodo_us,
+                            gatilho_sessao    ? CATALOGO_FORMATO_CSV_EVENTOS
+                            : espectro_sessao ? CATALOGO_FORMATO_ESPECTRO
+                                              : CATALOGO_FORMATO_CSV);
+    res = catalogo_acrescentar(&sessao, &sessao_indice);
+    sessao_aberta = (res == FR_OK);
+    if (!sessao_aberta)
+        LOG_ERRO("Não foi possível registrar a sessão no catálogo: %s (%d)\n", FRESULT_str(res), res);
+    if (gatilho_sessao)
+    {
+        console_printf("Captura por evento armada em %s: leitura a cada %lu us, até %d amostras gravadas.\n",
+                       nome_arquivo, (unsigned long)gatilho_periodo_us, MAX_AMOSTRAS);
+        feedback_mensagem("Gatilho Armado", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (espectro_sessao)
+    {
+        if (!espectro_armar())
+        {
+            LOG_ERRO("Não foi possível criar o temporizador de leitura do MPU6050\n");
+            encerrar_captura();
+            feedback_mensagem("Erro Temporizador", MENSAGEM_TIMEOUT_MS);
+            return;
+        }
+        console_printf("Espectro de %s em %s: janelas de %u pontos a cada %lu us (%lu ms), até %d janelas.\n",
+                       espectro_eixos[espectro_config.eixo], nome_arquivo, espectro_config.n,
+                       (unsigned long)espectro_periodo_us,
+                       (unsigned long)(espectro_config.n * espectro_periodo_us / 1000), MAX_AMOSTRAS);
+        feedback_mensagem("Espectro\nIniciado", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (decimacao_sessao)
+    {
+        if (!decimacao_armar())
+        {
+            LOG_ERRO("Não foi possível criar o temporizador de leitura do MPU6050\n");
+            encerrar_captura();
+            feedback_mensagem("Erro Temporizador", MENSAGEM_TIMEOUT_MS);
+            return;
+        }
+        console_printf("Captura decimada em %s: leitura a cada %lu us, uma amostra gravada a cada %lu us, até %d "
+                       "amostras.\n",
+                       nome_arquivo, (unsigned long)decimacao_entrada_us, (unsigned long)decimacao_saida_us(),
+                       MAX_AMOSTRAS);
+        feedback_mensagem("Captura Iniciada\nDecimada", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (adaptativo_sessao)
+    {
+        if (!adaptativo_armar())
+        {
+            LOG_ERRO("Não foi possível criar o temporizador de leitura do MPU6050\n");
+            encerrar_captura();
+            feedback_mensagem("Erro Temporizador", MENSAGEM_TIMEOUT_MS);
+            return;
+        }
+        console_printf("Captura adaptativa em %s: leitura a cada %lu us em movimento e %lu us parado, até %d "
+                       "amostras.\n",
+                       nome_arquivo, (unsigned long)adaptativo_periodo_us(adaptativo_divisor_alto),
+                       (unsigned long)adaptativo_periodo_us(adaptativo_divisor_baixo), MAX_AMOSTRAS);
+        feedback_mensagem("Captura Iniciada\nAdaptativa", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    console_printf("Captura de dados iniciada. Serão coletadas %d amostras em %s.\n", MAX_AMOSTRAS, nome_arquivo);
+    LOG_DEBUG("run_iniciar: Iniciado com sucesso\n");
+    feedback_mensagem("Captura Iniciada", MENSAGEM_TIMEOUT_MS);
+}
+
+// Grava o registro de estatísticas ao lado do arquivo de dados
+static void gravar_estatisticas()
+{
+    char nome[32];
+    estatisticas_nome(nome_arquivo, nome, sizeof(nome));
+    estatisticas_fechar(&estatisticas);
+    FIL f;
+    FRESULT fr = f_open(&f, nome, FA_WRITE | FA_CREATE_ALWAYS);
+    UINT bw;
+    if (FR_OK == fr)
+    {
+        fr = f_write(&f, &estatisticas, sizeof(estatisticas), &bw);
+        FRESULT fr_close = f_close(&f);
+        if (FR_OK == fr)
+            fr = fr_close;
+    }
+    if (FR_OK != fr)
+        LOG_ERRO("Não foi possível gravar as estatísticas em %s: %s (%d)\n", nome, FRESULT_str(fr), fr);
+}
+
+// Fim da captura (pedido, concluída ou por erro): grava as estatísticas e
+// fecha o registro da sessão no catálogo com a hora de término e o tamanho
+static void encerrar_captura()
+{
+    logger_ativado = false;
+    if (gatilho_sessao)
+        gatilho_encerrar();
+    if (espectro_sessao)
+        espectro_encerrar();
+    if (decimacao_sessao)
+        decimacao_encerrar();
+    if (adaptativo_sessao)
+        adaptativo_encerrar();
+    if (analogico_sessao)
+        analogico_encerrar();
+    if (sensores_sessao)
+        sensores_encerrar();
+    if (orientacao_sessao && orientacao_atrasos)
+        LOG_AVISO("%lu amostras gravadas sem orientação (core1 atrasado)\n", (unsigned long)orientacao_atrasos);
+    if (estatisticas_pendentes)
+    {
+        estatisticas_pendentes = false;
+        gravar_estatisticas();
+    }
+    if (!sessao_aberta)
+        return;
+    sessao_aberta = false;
+    sessao.fim = get_fattime();
+    sessao.estado = CATALOGO_ESTADO_FECHADA;
+    FILINFO fno;
+    if (FR_OK == f_stat(nome_arquivo, &fno))
+        sessao.tamanho = (uint32_t)fno.fsize;
+    FRESULT fr = catalogo_atualizar(sessao_indice, &sessao);
+    if (FR_OK != fr)
+        LOG_ERRO("Não foi possível fechar a sessão no catálogo: %s (%d)\n", FRESULT_str(fr), fr);
+}
+
+static void capturar_dados_mpu6050_e_salvar()
+{
+    LOG_DEBUG("capturar_dados_mpu6050_e_salvar: Iniciando amostra %d\n", contador_amostras + 1);
+    char buffer[48];
+    int n = snprintf(buffer, sizeof(buffer), "Amostra %d/%d", contador_amostras + 1, MAX_AMOSTRAS);
+    if (grafico_ativo())
+    {
+        grafico_cabecalho(buffer);
+    }
+    else
+    {
+        // Segunda linha: quanto tempo de captura cabe no cartão neste ritmo
+        uint32_t segundos;
+        if (espaco_previsao(taxa_gravacao(), &segundos))
+        {
+            char duracao[16];
+            espaco_formatar_duracao(segundos, duracao, sizeof(duracao));
+            snprintf(buffer + n, sizeof(buffer) - n, "\nSD: %s", duracao);
+        }
+        feedback_mensagem(buffer, MENSAGEM_TIMEOUT_MS);
+    }
+    if (!sd_esta_montado())
+    {
+        LOG_ERRO("Cartão SD não está montado. Parando captura.\n");
+        encerrar_captura();
+        feedback_mensagem("Erro: SD Não Montado", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    // Para antes de o cartão encher, deixando espaço para fechar a sessão
+    if (espaco_esgotado())
+    {
+        LOG_AVISO("Cartão SD cheio (menos de %u KiB livres). Parando captura.\n", ESPACO_RESERVA_BYTES / 1024);
+        encerrar_captura();
+        feedback_mensagem("Cartão Cheio\nCaptura Parada", MENSAGEM_TIMEOUT_MS);
+        feedback_bipe(3, 100, 100);
+        return;
+    }
+    if (!mpu6050_testar())
+    {
+        LOG_ERRO("Falha na comunicação com o MPU6050. Parando captura.\n");
+        encerrar_captura();
+        return;
+    }
+    int16_t accel[3], gyro[3], temp;
+    absolute_time_t instante = get_absolute_time();
+    uint16_t adc = analogico_disparar((uint32_t)contador_amostras + 1);
+    mpu6050_ler_dados(accel, gyro, &temp);
+    calibracao_aplicar(&calibracao, accel, gyro);
+    contador_amostras++;
+
+    // Disponibiliza a amostra para os consumidores (gráfico no OLED)
+    amostra_t amostra = {
+        .seq = contador_amostras,
+        .tempo_us = to_us_since_boot(instante),
+        .accel = {accel[0], accel[1], accel[2]},
+        .gyro = {gyro[0], gyro[1], gyro[2]},
+        .temp = temp,
+        .adc = adc};
+    analogico_recolher(&amostra);
+    amostras_publicar(&amostra);
+    catalogo_sessao_acumular(&sessao, accel, temp);
+    estatisticas_acumular(&estatisticas, accel, gyro, temp, amostra.tempo_us);
+    float temperatura = (temp / 340.0) + 15; // Temperatura em Celsius
+    LOG_DEBUG("capturar_dados_mpu6050_e_salvar: Amostra %d lida: AccX=%d, AccY=%d, AccZ=%d, GyroX=%d, GyroY=%d, GyroZ=%d, Temp=%d, Temperatura=%.2f C\n",
+           contador_amostras, accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2], temp, temperatura);
+
+    datetime_t t;
+    char data_str[16], hora_str[16];
+    if (rtc_get_datetime(&t))
+    {
+        snprintf(data_str, sizeof(data_str), "%02d/%02d/%02d", t.day, t.month, t.year % 100);
+        snprintf(hora_str, sizeof(hora_str), "%02d:%02d:%02d", t.hour, t.min, t.sec);
+    }
+    else
+    {
+        strcpy(data_str, "00/00/00");
+        strcpy(hora_str, "00:00:00");
+        LOG_ERRO("capturar_dados_mpu6050_e_salvar: RTC não configurado, usando 00/00/00 00:00:00\n");
+    }
+
+    LOG_DEBUG("capturar_dados_mpu6050_e_salvar: Abrindo arquivo %s para escrita (append)...\n", nome_arquivo);
+    FIL arquivo;
+    FRESULT res = f_open(&arquivo, nome_arquivo, FA_WRITE | FA_OPEN_APPEND);
+    if (res != FR_OK)
+    {
+        LOG_ERRO("Não foi possível abrir o arquivo %s para escrita: %s (%d)\n", nome_arquivo, FRESULT_str(res), res);
+        encerrar_captura();
+        feedback_mensagem("Erro Arquivo", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+
+    // Medidas ambientais que começaram antes desta leitura, antes da linha dela
+    if (sensores_sessao && !sensores_descarregar(&arquivo, amostra.tempo_us))
+    {
+        f_close(&arquivo);
+        encerrar_captura();
+        feedback_mensagem("Erro Escrita", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+
+    // Uma entrada no índice a cada INDICE_PASSO amostras, com a posição da linha
+    uint32_t tempo_ms = (uint32_t)(absolute_time_diff_us(inicio_captura, instante) / 1000);
+    if (nome_indice[0] && (contador_amostras - 1) % INDICE_PASSO == 0)
+    {
+        indice_entrada_t entrada = {
+            .amostra = (uint32_t)contador_amostras,
+            .tempo_ms = tempo_ms,
+            .offset = (uint32_t)f_tell(&arquivo)};
+        res = indice_acrescentar(nome_indice, &entrada);
+        if (res == FR_OK)
+            bytes_sessao += sizeof(entrada);
+        if (res != FR_OK)
+            LOG_ERRO("Não foi possível atualizar o índice %s: %s (%d)\n", nome_indice, FRESULT_str(res), res);
+    }
+
+    char buffer_data[192];
+    int32_t a[3], g[3];
+    unidades_converter(accel, gyro, a, g);
+    int tamanho = snprintf(buffer_data, sizeof(buffer_data) - 1, "%s,%s,%d,%ld,%ld,%ld,%ld,%ld,%ld,%.2f,%lu",
+                           data_str, hora_str, contador_amostras, (long)a[0], (long)a[1], (long)a[2], (long)g[0],
+                           (long)g[1], (long)g[2], temperatura, (unsigned long)tempo_ms);
+    if (orientacao_sessao)
+    {
+        // O core1 processou a amostra enquanto o arquivo era aberto; se
+        // atrasar, as colunas ficam vazias e a linha não espera mais
+        int32_t q[4];
+        buffer_data[tamanho++] = ',';
+        if (nucleo1_orientacao_ler((uint32_t)contador_amostras, q, ORIENTACAO_ESPERA_US))
+        {
+            tamanho += orientacao_formatar(q, buffer_data + tamanho, sizeof(buffer_data) - 1 - tamanho);
+        }
+        else
+        {
+            tamanho += snprintf(buffer_data + tamanho, sizeof(buffer_data) - 1 - tamanho, ",,,");
+            orientacao_atrasos++;
+        }
+    }
+    if (analogico_sessao)
+        tamanho += analogico_formatar(&analogico_config, AMOSTRA_ADC_CANAL(amostra.adc), AMOSTRA_ADC_VALOR(amostra.adc),
+                                      buffer_data + tamanho, sizeof(buffer_data) - 1 - tamanho);
+    buffer_data[tamanho++] = '\n';
+    buffer_data[tamanho] = '\0';
+    LOG_DEBUG("capturar_dados_mpu6050_e_salvar: Buffer preparado: %s", buffer_data);
+    UINT bw;
+    LOG_DEBUG("capturar_dados_mpu6050_e_salvar: Escrevendo amostra %d...\n", contador_amostras);
+    res = f_write(&arquivo, buffer_data, strlen(buffer_data), &bw);
+    if (res != FR_OK || bw != strlen(buffer_data))
+    {
+        LOG_ERRO("Não foi possível escrever no arquivo %s: %s (%d), bytes escritos=%u\n", nome_arquivo, FRESULT_str(res), res, bw);
+        f_close(&arquivo);
+        encerrar_captura();
+        feedback_mensagem("Erro Escrita", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    f_sync(&arquivo);
+    f_close(&arquivo);
+    bytes_sessao += bw;
+    bytes_por_amostra = bytes_sessao / contador_amostras;
+    console_printf("Amostra %d salva em %s.\n", contador_amostras, nome_arquivo);
+
+    if (contador_amostras >= MAX_AMOSTRAS)
+    {
+        encerrar_captura();
+        console_printf("Coleta de %d amostras concluída com sucesso.\n", MAX_AMOSTRAS);
+        feedback_mensagem("Captura Concluída", MENSAGEM_TIMEOUT_MS);
+
+        /* code */
+    }
+    LOG_DEBUG("capturar_dados_mpu6050_e_salvar: Amostra %d concluída\n", contador_amostras);
+}
+
+static void ler_arquivo(const char *nome_arquivo)
+{
+    LOG_DEBUG("ler_arquivo: Iniciando leitura de %s\n", nome_arquivo);
+    feedback_mensagem("Lendo Arquivo", MENSAGEM_TIMEOUT_MS);
+    if (!sd_esta_montado())
+    {
+        LOG_ERRO("Cartão SD não está montado. Use o comando 'a' para montar.\n");
+        feedback_mensagem("Erro: SD Não Montado", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    FIL arquivo;
+    FRESULT res = f_open(&arquivo, nome_arquivo, FA_READ);
+    if (res != FR_OK)
+    {
+        LOG_ERRO("Não foi possível abrir o arquivo %s para leitura: %s (%d)\n", nome_arquivo, FRESULT_str(res), res);
+        feedback_mensagem("Erro Leitura", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    char buffer[512];
+    UINT br;
+    console_printf("Conteúdo do arquivo %s:\n", nome_arquivo);
+    while (f_read(&arquivo, buffer, sizeof(buffer), &br) == FR_OK && br > 0)
+    {
+        console_aguardar(2 * br, 500);
+        console_escrever(buffer, br);
+    }
+    f_close(&arquivo);
+    console_printf("\nLeitura do arquivo %s concluída.\n\n", nome_arquivo);
+    LOG_DEBUG("ler_arquivo: Leitura concluída\n");
+    feedback_mensagem("Leitura Concluída", MENSAGEM_TIMEOUT_MS);
+}
+
+static void gpio_irq_handler(uint gpio, uint32_t events)
+{
+    static uint32_t last_press = 0;
+    uint32_t current_time = to_ms_since_boot(get_absolute_time());
+    if (current_time - last_press < 200)
+        return;
+    last_press = current_time;
+
+    if (gpio == BOTAO_A)
+    { //
+      // aqui altera o valor da flag de montar/desmontar o cartão SD
+        LOG_DEBUG("gpio_irq_handler: Interrupção BOTAO_A acionada\n");
+        flag_montar = !flag_montar;
+        flag_desmontar = true;
+    }
+    else if (gpio == BOTAO_B)
+    { //
+      // aqui altera o valor da flag para gravar e parar de gravar
+        LOG_DEBUG("gpio_irq_handler: Interrupção BOTAO_B acionada\n");
+        if (sd_esta_montado())
+        {
+            flag_gravar = !flag_gravar;
+            flag_parar_gravar = true;
+        }
+    }
+    else if (gpio == JOYSTICK_SW)
+    {
+        LOG_DEBUG("gpio_irq_handler: Interrupção BOOTSEL acionada\n");
+        // Desenha direto: o reset acontece antes do laço principal rodar de novo
+        ssd1306_fill(&ssd, false);
+        ssd1306_draw_string(&ssd, "Modo Gravacao", 5, 0);
         ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        ssd1306_wait(&ssd);
+        reset_usb_boot(0, 0);
+    }
+}
+
+static void run_ajuda()
+{
+    LOG_DEBUG("run_ajuda: Iniciando...\n");
+    feedback_mensagem("Exibindo Ajuda", MENSAGEM_TIMEOUT_MS);
+    console_printf("\nComandos disponíveis:\n\n");
+    console_printf("Digite 'a' para montar o cartão SD\n");
+    console_printf("Digite 'b' para desmontar o cartão SD\n");
+    console_printf("Digite 'c' para listar as últimas sessões do catálogo\n");
+    console_printf("Digite 'd' para mostrar conteúdo do arquivo\n");
+    console_printf("Digite 'e' para obter espaço livre no cartão SD\n");
+    console_printf("Digite 'f' para gravar 1 s do ADC0 a 500 ksps em binário ('adc on <duracao_ms> [divisor] [canal]' para escolher)\n");
+    console_printf("Digite 'g' para formatar o cartão SD\n");
+    console_printf("Digite 'h' para exibir os comandos disponíveis\n");
+    console_printf("Digite 'i' para começar a captura de %d amostras do MPU6050\n", MAX_AMOSTRAS);
+    console_printf("Digite 'grafico [canal] [janela]' para o gráfico ao vivo no OLED ('grafico off' encerra)\n");
+    console_printf("Digite 'stream [periodo_us]' para transmitir amostras em binário pela USB\n");
+    console_printf("Digite 'baixar <arquivo> [offset]' para enviar um arquivo em binário (cliente host/baixar)\n");
+    console_printf("Digite 'range <arquivo> <inicio_s> <fim_s> [saida]' para extrair um trecho da captura\n");
+    console_printf("Digite 'exportar <arquivo> <janela> [saida]' para resumir a captura em janelas de amostras\n");
+    console_printf("Digite 'orientacao [on [ganho]|off|bench]' para gravar o quatérnio de orientação nas capturas\n");
+    console_printf("Digite 'gatilho on <accel_mg> <giro_dps> [pre_ms] [pos_ms] [periodo_us]' para gravar só os eventos ('gatilho off' volta ao normal)\n");
+    console_printf("Digite 'espectro on <n> [periodo_us] [ax|ay|az] [bins]' para gravar o espectro de vibração em vez das amostras ('espectro bench' mede o custo)\n");
+    console_printf("Digite 'decimar on [<entrada_us> <R> <N> [M] [taps]]' para gravar as amostras filtradas a uma taxa menor ('decimar fir <c0,c1,...>' troca o FIR)\n");
+    console_printf("Digite 'adaptativo on [<alto_hz> <baixo_hz> <accel_mg> <giro_dps> [espera_ms]]' para baixar a taxa do MPU6050 com a placa parada\n");
+    console_printf("Digite 'mpu6050 [accel <g>] [giro <dps>] [dlpf <0-6>] [div <0-255>] [unidades on|off]' para as faixas e a taxa do MPU6050\n");
+    console_printf("Digite 'analogico on [<0|1|2|t>:<a_cada> ...]' para gravar ADC0-2 e a temperatura interna junto das amostras ('analogico off' desliga)\n");
+    console_printf("Digite 'sensores on [bmp280 <ms>] [aht20 <ms>]' para gravar pressão, temperatura e umidade junto das amostras ('sensores off' desliga)\n");
+    console_printf("Digite 'calibrar [pose [n]|salvar|limpar|bench]' para calibrar o MPU6050 (placa parada em cada posição)\n");
+    console_printf("Digite 'ls [n]' para as últimas sessões, 'info <arquivo|#n>' para detalhes, 'dir [caminho]' para o diretório\n");
+    console_printf("\nEscolha o comando:  ");
+    LOG_DEBUG("run_ajuda: Concluído\n");
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Transmissão ao vivo pela USB (comando "stream"): amostras em quadros
+// binários (protocolo.h), sem passar pelo cartão SD. Qualquer tecla encerra.
+
+#define STREAM_PERIODO_PADRAO_US 1000
+#define STREAM_PERIODO_MIN_US 500
+
+static bool stream_ativo = false;
+static uint32_t stream_periodo_us;
+static absolute_time_t stream_proxima;
+static uint64_t stream_inicio_us;
+static uint32_t stream_seq, stream_enviados, stream_perdidos;
+
+// Quadros de controle (início/fim) não podem ser perdidos: espera a FIFO
+// da USB por um tempo limitado
+static bool stream_enviar_controle(uint8_t tipo, const void *carga, uint16_t len)
+{
+    uint8_t quadro[PROTOCOLO_EXTRA + 16];
+    size_t n = protocolo_montar(quadro, tipo, stream_seq, carga, len);
+    absolute_time_t limite = make_timeout_time_ms(200);
+    while (!usb_saida_enviar(quadro, n))
+    {
+        if (time_reached(limite))
+            return false;
+        tight_loop_contents();
+    }
+    return true;
+}
+
+static void run_baixar()
+{
+    const char *arg1 = strtok(NULL, " ");
+    const char *arg2 = strtok(NULL, " ");
+    if (!arg1)
+    {
+        console_printf("Falta argumento\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (!sd_esta_montado())
+    {
+        LOG_ERRO("Cartão SD não está montado. Use o comando 'a' para montar.\n");
+        feedback_mensagem("Erro: SD Não Montado", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (logger_ativado || stream_ativo || adc_gravando)
+    {
+        LOG_ERRO("Captura ou transmissão em andamento.\n");
+        feedback_mensagem("Captura Ativa", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    uint64_t offset = arg2 ? strtoull(arg2, NULL, 10) : 0;
+    console_descarregar(200);
+    FRESULT fr = transferencia_iniciar(arg1, offset);
+    if (FR_OK != fr)
+    {
+        console_printf("Erro f_open: %s (%d)\n", FRESULT_str(fr), fr);
+        feedback_mensagem("Erro Leitura", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    feedback_mensagem("Enviando\nArquivo", MENSAGEM_TIMEOUT_MS);
+}
+
+static void run_stream()
+{
+    if (logger_ativado || adc_gravando)
+    {
+        LOG_ERRO("Captura em andamento. Pare a captura antes de transmitir.\n");
+        feedback_mensagem("Captura Ativa", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    const char *arg1 = strtok(NULL, " ");
+    int periodo = arg1 ? atoi(arg1) : STREAM_PERIODO_PADRAO_US;
+    if (periodo < STREAM_PERIODO_MIN_US)
+    {
+        console_printf("Período inválido: %s (mínimo %d us)\n", arg1, STREAM_PERIODO_MIN_US);
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    console_printf("Transmissão binária a cada %d us. Pressione qualquer tecla para encerrar.\n", periodo);
+    console_descarregar(200);
+
+    stream_periodo_us = (uint32_t)periodo;
+    stream_seq = stream_enviados = stream_perdidos = 0;
+    amostras_limpar();
+    nucleo1_nova_sessao();
+    protocolo_inicio_t inicio = {.periodo_us = stream_periodo_us};
+    stream_enviar_controle(PROTOCOLO_TIPO_INICIO, &inicio, sizeof(inicio));
+    stream_inicio_us = time_us_64();
+    stream_proxima = get_absolute_time();
+    stream_ativo = true;
+    feedback_led_fixo(COR_CIANO);
+    feedback_mensagem("Stream USB", MENSAGEM_TIMEOUT_MS);
+}
+
+static void stream_parar()
+{
+    stream_ativo = false;
+    stream_seq++;
+    protocolo_fim_t fim = {.enviados = stream_enviados, .perdidos = stream_perdidos};
+    stream_enviar_controle(PROTOCOLO_TIPO_FIM, &fim, sizeof(fim));
+    feedback_led_fixo(COR_APAGADO);
+    console_printf("\nTransmissão encerrada: %lu quadros enviados, %lu descartados (USB cheia)\n",
+           (unsigned long)stream_enviados, (unsigned long)stream_perdidos);
+    feedback_mensagem("Stream Fim", MENSAGEM_TIMEOUT_MS);
+}
+
+static void stream_tarefa()
+{
+    // Uma captura para o SD iniciada pelos botões encerra a transmissão
+    if (stream_ativo && logger_ativado)
+        stream_parar();
+
+    // Cadência fixa a partir do instante inicial; se o laço atrasar mais de
+    // um período, as amostras vencidas são lidas em seguida
+    while (stream_ativo && time_reached(stream_proxima))
+    {
+        stream_proxima = delayed_by_us(stream_proxima, stream_periodo_us);
+        int16_t accel[3], gyro[3], temp;
+        uint64_t agora = time_us_64();
+        if (!mpu6050_ler_bruto(accel, gyro, &temp))
+        {
+            stream_perdidos++;
+            stream_seq++;
+            continue;
+        }
+        stream_seq++;
+
+        amostra_t amostra = {
+            .seq = stream_seq,
+            .tempo_us = agora,
+            .accel = {accel[0], accel[1], accel[2]},
+            .gyro = {gyro[0], gyro[1], gyro[2]},
+            .temp = temp};
+        amostras_publicar(&amostra);
+
+        protocolo_amostra_t carga = {
+            .tempo_us = (uint32_t)(agora - stream_inicio_us),
+            .accel = {accel[0], accel[1], accel[2]},
+            .gyro = {gyro[0], gyro[1], gyro[2]},
+            .temp = temp};
+        uint8_t quadro[PROTOCOLO_EXTRA + sizeof(carga)];
+        size_t n = protocolo_montar(quadro, PROTOCOLO_TIPO_AMOSTRA, stream_seq, &carga, sizeof(carga));
+        // Sem espaço na USB o quadro é descartado: a amostragem nunca espera
+        // o PC; o receptor detecta a falha pelo número de sequência
+        if (usb_saida_enviar(quadro, n))
+            stream_enviados++;
+        else
+            stream_perdidos++;
+    }
+}
+
+static void run_grafico()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (arg1 && 0 == strcmp(arg1, "off"))
+    {
+        grafico_parar();
+        console_printf("Gráfico desativado\n");
+        feedback_mensagem("Grafico Off", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    grafico_canal_t canal = arg1 ? grafico_canal_por_nome(arg1) : GRAFICO_AZ;
+    if (canal == GRAFICO_NUM_CANAIS)
+    {
+        console_printf("Canal desconhecido: \"%s\" (use ax, ay, az, gx, gy ou gz)\n", arg1);
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    const char *arg2 = strtok(NULL, " ");
+    int janela = arg2 ? atoi(arg2) : 1;
+    if (janela < 1 || janela > 10000)
+    {
+        console_printf("Janela inválida: %s (1 a 10000 amostras por coluna)\n", arg2);
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    grafico_iniciar(&ssd, canal, (uint16_t)janela);
+    console_printf("Gráfico de %s, %d amostra(s) por coluna\n", grafico_nome_canal(canal), janela);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Estimativa de orientação no core1 (comando "orientacao"): com ela ligada,
+// as capturas ganham as colunas Q0..Q3 do quatérnio de cada amostra
+
+#define ORIENTACAO_BENCH_AMOSTRAS 5000
+
+// Custo do filtro por amostra neste núcleo, com movimento sintético que
+// passa sempre pela correção da gravidade (o caso mais caro)
+static void orientacao_bench()
+{
+    static int16_t accel[64][3], gyro[64][3];
+    for (int k = 0; k < 64; k++)
+    {
+        accel[k][0] = (int16_t)(k * 97 % 4001 - 2000);
+        accel[k][1] = (int16_t)(k * 53 % 4001 - 2000);
+        accel[k][2] = 16000;
+        gyro[k][0] = (int16_t)(k * 131 % 2001 - 1000);
+        gyro[k][1] = (int16_t)(k * 71 % 2001 - 1000);
+        gyro[k][2] = (int16_t)(k * 29 % 2001 - 1000);
+    }
+    orientacao_config_t config = {mpu6050_giro_dps(&mpu6050_config), mpu6050_accel_g(&mpu6050_config),
+                                  ORIENTACAO_GANHO_PADRAO};
+    orientacao_t filtro;
+    orientacao_iniciar(&filtro, &config);
+    uint64_t inicio = time_us_64();
+    for (uint32_t i = 0; i < ORIENTACAO_BENCH_AMOSTRAS; i++)
+        orientacao_atualizar(&filtro, accel[i & 63], gyro[i & 63], (uint64_t)i * 1000);
+    uint64_t duracao_us = time_us_64() - inicio;
+
+    uint32_t hz = clock_get_hz(clk_sys);
+    uint32_t ns = (uint32_t)(duracao_us * 1000 / ORIENTACAO_BENCH_AMOSTRAS);
+    uint32_t ciclos = (uint32_t)(duracao_us * (hz / 1000000) / ORIENTACAO_BENCH_AMOSTRAS);
+    console_printf("%d atualizações em %llu us: %lu ciclos (%lu ns) por amostra a %lu MHz\n",
+                   ORIENTACAO_BENCH_AMOSTRAS, (unsigned long long)duracao_us, (unsigned long)ciclos,
+                   (unsigned long)ns, (unsigned long)(hz / 1000000));
+    console_printf("Taxa máxima que o core1 acompanha: %lu amostras/s\n", (unsigned long)(1000000000u / (ns ? ns : 1)));
+    feedback_mensagem("Bench Concluido", MENSAGEM_TIMEOUT_MS);
+}
+
+static void run_orientacao()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1)
+    {
+        const orientacao_config_t *c = nucleo1_orientacao_config();
+        uint32_t processadas, perdidas, maximo_us;
+        nucleo1_estatisticas(&processadas, &perdidas, &maximo_us);
+        if (nucleo1_orientacao_ligada())
+            console_printf("Orientação ligada, Kp %u.%03u\n", c->ganho_x1000 / 1000, c->ganho_x1000 % 1000);
+        else
+            console_printf("Orientação desligada\n");
+        console_printf("Sessão atual no core1: %lu amostras, %lu perdidas, pior %lu us por amostra\n",
+                       (unsigned long)processadas, (unsigned long)perdidas, (unsigned long)maximo_us);
+        return;
+    }
+    if (0 == strcmp(arg1, "bench"))
+    {
+        orientacao_bench();
+        return;
+    }
+    if (logger_ativado || stream_ativo)
+    {
+        LOG_ERRO("Captura ou transmissão em andamento.\n");
+        feedback_mensagem("Captura Ativa", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (0 == strcmp(arg1, "on"))
+    {
+        const char *arg2 = strtok(NULL, " ");
+        int ganho = arg2 ? atoi(arg2) : ORIENTACAO_GANHO_PADRAO;
+        if (ganho < 1 || ganho > 20000)
+        {
+            console_printf("Ganho inválido: %s (1 a 20000 milésimos)\n", arg2);
+            feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+            return;
+        }
+        orientacao_config_t config = {mpu6050_giro_dps(&mpu6050_config), mpu6050_accel_g(&mpu6050_config),
+                                      (uint16_t)ganho};
+        nucleo1_orientacao_configurar(&config);
+        console_printf("Orientação ligada (Kp %d.%03d): colunas Q0..Q3 nas próximas capturas\n", ganho / 1000,
+                       ganho % 1000);
+        feedback_mensagem("Orientacao On", MENSAGEM_TIMEOUT_MS);
+    }
+    else if (0 == strcmp(arg1, "off"))
+    {
+        nucleo1_orientacao_configurar(NULL);
+        console_printf("Orientação desligada\n");
+        feedback_mensagem("Orientacao Off", MENSAGEM_TIMEOUT_MS);
+    }
+    else
+    {
+        console_printf("Uso: orientacao [on [ganho_x1000]|off|bench]\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Calibração do MPU6050 (comando "calibrar"): cada "calibrar pose" mede a
+// placa parada em uma posição; "calibrar salvar" estima os coeficientes com
+// as posições acumuladas e os grava na flash. Com a placa deitada basta uma
+// posição (bias do giroscópio e offset de X e Y); as seis faces para cima e
+// para baixo dão também o offset de Z e a escala dos três eixos.
+
+#define CALIBRAR_AMOSTRAS_PADRAO 1000
+#define CALIBRAR_AMOSTRAS_MAX 20000
+#define CALIBRAR_PERIODO_US 1000
+#define CALIBRAR_AGITACAO_MAX 30 // desvio do giroscópio (LSB) acima do qual a placa mexeu
+#define CALIBRAR_BENCH_AMOSTRAS 100000
+
+static calibracao_estimativa_t calibracao_estimativa;
+
+static void imprimir_calibracao(const char *titulo, const calibracao_t *c)
+{
+    char texto[128];
+    calibracao_formatar(c, texto, sizeof(texto));
+    console_printf("%s: %s%s\n", titulo, texto, calibracao_neutra(c) ? " (neutra)" : "");
+}
+
+// Custo de calibracao_aplicar() por amostra: o mesmo laço com e sem a
+// chamada, para descontar a cópia da amostra e o próprio laço
+static void calibracao_bench()
+{
+    static int16_t accel[64][3], gyro[64][3];
+    for (int k = 0; k < 64; k++)
+        for (int i = 0; i < 3; i++)
+        {
+            accel[k][i] = (int16_t)((k * 97 + i * 31) % 4001 - 2000);
+            gyro[k][i] = (int16_t)((k * 53 + i * 17) % 2001 - 1000);
+        }
+    volatile int32_t sorvedouro = 0;
+    int16_t a[3], g[3];
+
+    uint64_t inicio = time_us_64();
+    for (uint32_t k = 0; k < CALIBRAR_BENCH_AMOSTRAS; k++)
+    {
+        memcpy(a, accel[k & 63], sizeof(a));
+        memcpy(g, gyro[k & 63], sizeof(g));
+        sorvedouro += a[0] + a[1] + a[2] + g[0] + g[1] + g[2];
+    }
+    uint64_t base_us = time_us_64() - inicio;
+
+    inicio = time_us_64();
+    for (uint32_t k = 0; k < CALIBRAR_BENCH_AMOSTRAS; k++)
+    {
+        memcpy(a, accel[k & 63], sizeof(a));
+        memcpy(g, gyro[k & 63], sizeof(g));
+        calibracao_aplicar(&calibracao, a, g);
+        sorvedouro += a[0] + a[1] + a[2] + g[0] + g[1] + g[2];
+    }
+    uint64_t com_us = time_us_64() - inicio;
+    (void)sorvedouro;
+
+    uint32_t mhz = clock_get_hz(clk_sys) / 1000000;
+    uint64_t extra_us = com_us > base_us ? com_us - base_us : 0;
+    uint32_t ciclos = (uint32_t)(extra_us * mhz / CALIBRAR_BENCH_AMOSTRAS);
+    uint32_t ns = (uint32_t)(extra_us * 1000 / CALIBRAR_BENCH_AMOSTRAS);
+
+    // Referência: uma leitura em rajada do MPU6050 (14 bytes no I2C)
+    int16_t temp;
+    inicio = time_us_64();
+    bool leu = mpu6050_ler_bruto(a, g, &temp);
+    uint32_t leitura_us = (uint32_t)(time_us_64() - inicio);
+
+    console_printf("%d amostras: %llu us sem e %llu us com a calibração a %lu MHz\n", CALIBRAR_BENCH_AMOSTRAS,
+                   (unsigned long long)base_us, (unsigned long long)com_us, (unsigned long)mhz);
+    console_printf("Custo por amostra: %lu ciclos (%lu ns)", (unsigned long)ciclos, (unsigned long)ns);
+    if (leu && leitura_us)
+        console_printf(", %lu.%02lu%% de uma leitura do MPU6050 (%lu us)",
+                       (unsigned long)(ns / 10 / leitura_us), (unsigned long)(ns / 10 % leitura_us * 100 / leitura_us),
+                       (unsigned long)leitura_us);
+    console_printf("\n");
+    feedback_mensagem("Bench Concluido", MENSAGEM_TIMEOUT_MS);
+}
+
+static void calibrar_pose(const char *arg)
+{
+    long n = arg ? atol(arg) : CALIBRAR_AMOSTRAS_PADRAO;
+    if (n < 100 || n > CALIBRAR_AMOSTRAS_MAX)
+    {
+        console_printf("Número de amostras inválido: %s (100 a %d)\n", arg, CALIBRAR_AMOSTRAS_MAX);
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (!mpu6050_testar())
+    {
+        LOG_ERRO("Falha na comunicação com o MPU6050. Verifique as conexões I2C.\n");
+        return;
+    }
+    feedback_mensagem("Calibrando\nNao Mova a Placa", MENSAGEM_TIMEOUT_MS);
+    feedback_tarefa();
+
+    // Leituras brutas: a calibração em uso não entra na estimativa
+    calibracao_janela_t janela;
+    calibracao_janela_iniciar(&janela);
+    uint32_t falhas = 0;
+    absolute_time_t proxima = get_absolute_time();
+    for (long k = 0; k < n; k++)
+    {
+        proxima = delayed_by_us(proxima, CALIBRAR_PERIODO_US);
+        int16_t accel[3], gyro[3], temp;
+        if (mpu6050_ler_bruto(accel, gyro, &temp))
+            calibracao_janela_acumular(&janela, accel, gyro);
+        else
+            falhas++;
+        sleep_until(proxima);
+    }
+    if (janela.amostras < (uint32_t)n / 2)
+    {
+        LOG_ERRO("Falha na leitura do MPU6050: %lu de %ld amostras perdidas\n", (unsigned long)falhas, n);
+        feedback_mensagem("Erro MPU6050", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    uint32_t agitacao = calibracao_janela_agitacao(&janela);
+    if (agitacao > CALIBRAR_AGITACAO_MAX)
+    {
+        console_printf("Placa em movimento (desvio do giroscópio %lu LSB, máximo %d): posição descartada\n",
+                       (unsigned long)agitacao, CALIBRAR_AGITACAO_MAX);
+        feedback_mensagem("Placa Mexeu\nRepita", MENSAGEM_TIMEOUT_MS);
+        feedback_bipe(2, 100, 100);
+        return;
+    }
+    int eixo =
+        calibracao_estimativa_acrescentar(&calibracao_estimativa, &janela, 32768 / mpu6050_accel_g(&mpu6050_config));
+    static const char *const nomes[] = {"X para cima", "Y para cima", "Z para cima",
+                                        "X para baixo", "Y para baixo", "Z para baixo"};
+    console_printf("Posição %lu: %lu amostras, %s (desvio do giroscópio %lu LSB)\n",
+                   (unsigned long)calibracao_estimativa.posicoes, (unsigned long)janela.amostras,
+                   eixo >= 0 ? nomes[eixo] : "inclinada, só o giroscópio entra", (unsigned long)agitacao);
+    calibracao_t previa;
+    calibracao_estimativa_resultado(&calibracao_estimativa, mpu6050_giro_dps(&mpu6050_config), mpu6050_accel_g(&mpu6050_config),
+                                    &previa);
+    imprimir_calibracao("Estimativa", &previa);
+    feedback_mensagem(eixo >= 0 ? "Posicao Medida" : "Posicao Inclinada", MENSAGEM_TIMEOUT_MS);
+}
+
+// Coeficientes da flash convertidos para as faixas em uso
+static void calibracao_atualizar()
+{
+    calibracao_converter(&calibracao_salva, mpu6050_giro_dps(&mpu6050_config), mpu6050_accel_g(&mpu6050_config),
+                         &calibracao);
+}
+
+static void calibrar_gravar(const calibracao_t *c)
+{
+    if (!calibracao_gravar(c))
+    {
+        LOG_ERRO("Falha ao gravar a calibração na flash\n");
+        feedback_mensagem("Erro Flash", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    calibracao_salva = *c;
+    calibracao_atualizar();
+    imprimir_calibracao("Calibração gravada na flash", &calibracao);
+    feedback_mensagem("Calibracao Salva", MENSAGEM_TIMEOUT_MS);
+}
+
+static void run_calibrar()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1)
+    {
+        imprimir_calibracao("Calibração em uso", &calibracao);
+        console_printf("%lu posição(ões) medidas para a próxima estimativa\n",
+                       (unsigned long)calibracao_estimativa.posicoes);
+        return;
+    }
+    // O bench também lê o MPU6050: durante uma captura o I2C0 é do amostrador
+    if (logger_ativado || stream_ativo || adc_gravando)
+    {
+        LOG_ERRO("Captura ou transmissão em andamento.\n");
+        feedback_mensagem("Captura Ativa", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (0 == strcmp(arg1, "bench"))
+    {
+        calibracao_bench();
+        return;
+    }
+    if (0 == strcmp(arg1, "pose"))
+    {
+        calibrar_pose(strtok(NULL, " "));
+    }
+    else if (0 == strcmp(arg1, "salvar"))
+    {
+        if (calibracao_estimativa.posicoes == 0)
+        {
+            console_printf("Nenhuma posição medida: use 'calibrar pose' com a placa parada\n");
+            feedback_mensagem("Sem Posicoes", MENSAGEM_TIMEOUT_MS);
+            return;
+        }
+        calibracao_t nova;
+        calibracao_estimativa_resultado(&calibracao_estimativa, mpu6050_giro_dps(&mpu6050_config), mpu6050_accel_g(&mpu6050_config),
+                                        &nova);
+        calibracao_selar(&nova);
+        calibrar_gravar(&nova);
+        calibracao_estimativa_iniciar(&calibracao_estimativa);
+    }
+    else if (0 == strcmp(arg1, "limpar"))
+    {
+        calibracao_t neutra;
+        calibracao_padrao(&neutra, mpu6050_giro_dps(&mpu6050_config), mpu6050_accel_g(&mpu6050_config));
+        calibracao_estimativa_iniciar(&calibracao_estimativa);
+        calibrar_gravar(&neutra);
+    }
+    else
+    {
+        console_printf("Uso: calibrar [pose [n]|salvar|limpar|bench]\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Evento, espectro, decimação e taxa adaptativa usam a leitura por
+// temporizador e não se combinam: ligar um desliga os outros
+
+static void desligar_outros_modos(const char *novo)
+{
+    if (gatilho_ligado && 0 != strcmp(novo, "gatilho"))
+    {
+        gatilho_ligado = false;
+        console_printf("Captura por evento desligada (não combina com %s)\n", novo);
+    }
+    if (espectro_ligado && 0 != strcmp(novo, "espectro"))
+    {
+        espectro_ligado = false;
+        console_printf("Captura de espectro desligada (não combina com %s)\n", novo);
+    }
+    if (decimacao_ligada && 0 != strcmp(novo, "decimar"))
+    {
+        decimacao_ligada = false;
+        console_printf("Captura decimada desligada (não combina com %s)\n", novo);
+    }
+    if (adaptativo_ligado && 0 != strcmp(novo, "adaptativo"))
+    {
+        adaptativo_ligado = false;
+        console_printf("Taxa adaptativa desligada (não combina com %s)\n", novo);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Configuração da captura por evento (a execução está junto de run_iniciar)
+
+static void imprimir_gatilho()
+{
+    console_printf("Gatilho: |a| fora de 1 g ± %u mg%s, rotação acima de %u °/s%s; %u amostras antes e %u depois, "
+                   "leitura a cada %lu us\n",
+                   gatilho_config.accel_mg, gatilho_config.accel_mg ? "" : " (não usa)", gatilho_config.giro_dps,
+                   gatilho_config.giro_dps ? "" : " (não usa)", gatilho_config.pre, gatilho_config.pos,
+                   (unsigned long)gatilho_periodo_us);
+}
+
+static void run_gatilho()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1)
+    {
+        if (!gatilho_ligado)
+            console_printf("Captura por evento desligada\n");
+        else
+            imprimir_gatilho();
+        if (logger_ativado && gatilho_sessao)
+            console_printf("Captura atual: %lu evento(s), %lu amostras lidas, %lu gravadas, %lu pendentes, %lu "
+                           "perdidas\n",
+                           (unsigned long)gatilho.eventos, (unsigned long)gatilho.escrita,
+                           (unsigned long)contador_amostras, (unsigned long)gatilho_pendentes(&gatilho),
+                           (unsigned long)gatilho.perdidas);
+        return;
+    }
+    if (logger_ativado || stream_ativo)
+    {
+        LOG_ERRO("Captura ou transmissão em andamento.\n");
+        feedback_mensagem("Captura Ativa", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (0 == strcmp(arg1, "off"))
+    {
+        gatilho_ligado = false;
+        console_printf("Captura por evento desligada: as próximas capturas são periódicas\n");
+        feedback_mensagem("Gatilho Off", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    const char *arg_accel = strtok(NULL, " ");
+    const char *arg_giro = strtok(NULL, " ");
+    const char *arg_pre = strtok(NULL, " ");
+    const char *arg_pos = strtok(NULL, " ");
+    const char *arg_periodo = strtok(NULL, " ");
+    if (0 != strcmp(arg1, "on") || !arg_accel || !arg_giro)
+    {
+        console_printf("Uso: gatilho [on <accel_mg> <giro_dps> [pre_ms] [pos_ms] [periodo_us]|off]\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    long accel_mg = atol(arg_accel), giro_dps = atol(arg_giro);
+    long pre_ms = arg_pre ? atol(arg_pre) : GATILHO_PRE_PADRAO_MS;
+    long pos_ms = arg_pos ? atol(arg_pos) : GATILHO_POS_PADRAO_MS;
+    long periodo_us = arg_periodo ? atol(arg_periodo) : GATILHO_PERIODO_PADRAO_US;
+    int fundo_mg = mpu6050_accel_g(&mpu6050_config) * 1000, fundo_dps = mpu6050_giro_dps(&mpu6050_config);
+    if (accel_mg < 0 || accel_mg > fundo_mg || giro_dps < 0 || giro_dps > fundo_dps || (!accel_mg && !giro_dps))
+    {
+        console_printf("Limiares inválidos: 0 a %d mg e 0 a %d °/s, ao menos um diferente de zero\n", fundo_mg,
+                       fundo_dps);
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (periodo_us < GATILHO_PERIODO_MIN_US || periodo_us > 1000000 || pre_ms < 0 || pos_ms < 0)
+    {
+        console_printf("Período inválido: %d a 1000000 us\n", GATILHO_PERIODO_MIN_US);
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    uint64_t pre = (uint64_t)pre_ms * 1000 / periodo_us, pos = (uint64_t)pos_ms * 1000 / periodo_us;
+    if (pre > GATILHO_PRE_MAX || pos > UINT16_MAX)
+    {
+        console_printf("Janelas longas demais: até %d amostras antes e %u depois do disparo (%lu ms e %lu ms)\n",
+                       GATILHO_PRE_MAX, UINT16_MAX, (unsigned long)((uint64_t)GATILHO_PRE_MAX * periodo_us / 1000),
+                       (unsigned long)((uint64_t)UINT16_MAX * periodo_us / 1000));
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    gatilho_config.accel_mg = (uint16_t)accel_mg;
+    gatilho_config.giro_dps = (uint16_t)giro_dps;
+    gatilho_config.pre = (uint16_t)pre;
+    gatilho_config.pos = (uint16_t)pos;
+    gatilho_periodo_us = (uint32_t)periodo_us;
+    desligar_outros_modos("gatilho");
+    gatilho_ligado = true;
+    imprimir_gatilho();
+    console_printf("As próximas capturas ('i' ou botão) gravam só os eventos\n");
+    feedback_mensagem("Gatilho On", MENSAGEM_TIMEOUT_MS);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Configuração da captura de espectro (a execução está junto de run_iniciar)
+
+static void imprimir_espectro()
+{
+    uint32_t janela_us = espectro_config.n * espectro_periodo_us;
+    console_printf("Espectro: eixo %s, janelas de Hann de %u pontos, leitura a cada %lu us (%lu.%02lu Hz, "
+                   "resolução %lu.%02lu Hz, janela de %lu ms), %s\n",
+                   espectro_eixos[espectro_config.eixo], espectro_config.n, (unsigned long)espectro_periodo_us,
+                   (unsigned long)(1000000 / espectro_periodo_us),
+                   (unsigned long)(100000000 / espectro_periodo_us % 100),
+                   (unsigned long)(100000000ull / janela_us / 100), (unsigned long)(100000000ull / janela_us % 100),
+                   (unsigned long)(janela_us / 1000), espectro_config.bins ? "picos e bins" : "só os picos");
+}
+
+// Tempo de uma janela no core1 para cada tamanho e a taxa que ele sustenta,
+// ao lado do limite da leitura do MPU6050 pelo I2C
+static void espectro_bench()
+{
+    uint32_t mhz = clock_get_hz(clk_sys) / 1000000;
+    int16_t a[3], g[3], temp;
+    uint64_t inicio = time_us_64();
+    bool leu = mpu6050_ler_bruto(a, g, &temp);
+    uint32_t leitura_us = (uint32_t)(time_us_64() - inicio);
+    console_printf("Espectro no core1 a %lu MHz (média de %d janelas):\n", (unsigned long)mhz,
+                   ESPECTRO_BENCH_REPETICOES);
+    console_printf("      n   us/janela      ciclos   taxa máx. (cálculo)\n");
+    for (uint32_t n = ESPECTRO_N_MIN; n <= ESPECTRO_N_MAX; n *= 2)
+    {
+        uint32_t us;
+        if (!nucleo1_espectro_bench((uint16_t)n, ESPECTRO_BENCH_REPETICOES, &us))
+        {
+            LOG_ERRO("O core1 não respondeu\n");
+            feedback_mensagem("Erro Core1", MENSAGEM_TIMEOUT_MS);
+            return;
+        }
+        console_printf("  %5lu  %10lu  %10lu  %12lu Hz\n", (unsigned long)n, (unsigned long)us,
+                       (unsigned long)(us * mhz), us ? (unsigned long)((uint64_t)n * 1000000 / us) : 0ul);
+    }
+    if (leu)
+        console_printf("Leitura em rajada do MPU6050: %lu us, até ~%lu Hz (período mínimo aceito: %d us)\n",
+                       (unsigned long)leitura_us, leitura_us ? (unsigned long)(1000000 / leitura_us) : 0ul,
+                       ESPECTRO_PERIODO_MIN_US);
+    else
+        LOG_ERRO("Falha na leitura do MPU6050\n");
+    console_printf("Uma combinação é sustentada quando a janela (n x período) dura mais que o cálculo\n");
+    feedback_mensagem("Bench Concluído", MENSAGEM_TIMEOUT_MS);
+}
+
+static void run_espectro()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1)
+    {
+        if (!espectro_ligado)
+            console_printf("Captura de espectro desligada\n");
+        else
+            imprimir_espectro();
+        if (logger_ativado && espectro_sessao)
+        {
+            uint32_t janelas, descartadas, maximo_us;
+            nucleo1_espectro_estatisticas(&janelas, &descartadas, &maximo_us);
+            console_printf("Captura atual: %lu amostras lidas, %lu janela(s) calculadas, %d gravadas, %lu "
+                           "descartadas, pior cálculo %lu us\n",
+                           (unsigned long)amostrador_seq, (unsigned long)janelas, contador_amostras,
+                           (unsigned long)descartadas, (unsigned long)maximo_us);
+        }
+        return;
+    }
+    if (logger_ativado || stream_ativo)
+    {
+        LOG_ERRO("Captura ou transmissão em andamento.\n");
+        feedback_mensagem("Captura Ativa", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (0 == strcmp(arg1, "bench"))
+    {
+        espectro_bench();
+        return;
+    }
+    if (0 == strcmp(arg1, "off"))
+    {
+        espectro_ligado = false;
+        console_printf("Captura de espectro desligada: as próximas capturas são periódicas\n");
+        feedback_mensagem("Espectro Off", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    const char *arg_n = strtok(NULL, " ");
+    if (0 != strcmp(arg1, "on") || !arg_n)
+    {
+        console_printf("Uso: espectro [on <n> [periodo_us] [ax|ay|az] [bins]|off|bench]\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    espectro_config_t config = {.n = 0, .eixo = 2, .bins = false};
+    long n = atol(arg_n);
+    long periodo_us = ESPECTRO_PERIODO_PADRAO_US;
+    // Opções em qualquer ordem depois de n
+    for (const char *arg = strtok(NULL, " "); arg; arg = strtok(NULL, " "))
+    {
+        if (0 == strcmp(arg, "bins"))
+            config.bins = true;
+        else if (arg[0] == 'a' && arg[1] >= 'x' && arg[1] <= 'z' && !arg[2])
+            config.eixo = (uint8_t)(arg[1] - 'x');
+        else if (isdigit((unsigned char)arg[0]))
+            periodo_us = atol(arg);
+        else
+        {
+            console_printf("Opção desconhecida: %s\n", arg);
+            feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+            return;
+        }
+    }
+    if (n <= 0 || !espectro_n_valido((uint32_t)n))
+    {
+        console_printf("Tamanho inválido: potência de 2 de %d a %d\n", ESPECTRO_N_MIN, ESPECTRO_N_MAX);
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (periodo_us < ESPECTRO_PERIODO_MIN_US || periodo_us > 1000000)
+    {
+        console_printf("Período inválido: %d a 1000000 us\n", ESPECTRO_PERIODO_MIN_US);
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    config.n = (uint16_t)n;
+    espectro_config = config;
+    espectro_periodo_us = (uint32_t)periodo_us;
+    desligar_outros_modos("espectro");
+    espectro_ligado = true;
+    imprimir_espectro();
+    console_printf("As próximas capturas ('i' ou botão) gravam só os espectros\n");
+    feedback_mensagem("Espectro On", MENSAGEM_TIMEOUT_MS);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Configuração da captura decimada (a execução está junto de run_iniciar)
+
+static void imprimir_decimacao()
+{
+    const decimador_config_t *c = &decimacao_config;
+    uint32_t saida_us = decimacao_saida_us();
+    console_printf("Decimação: leitura a cada %lu us, CIC R=%u N=%u, FIR %u coeficiente(s) decimando por %u; uma "
+                   "amostra a cada %lu us (%lu.%02lu Hz), atraso de %lu us\n",
+                   (unsigned long)decimacao_entrada_us, c->cic_fator, c->cic_fator > 1 ? c->cic_ordem : 0, c->taps,
+                   c->fir_fator, (unsigned long)saida_us, (unsigned long)(1000000 / saida_us),
+                   (unsigned long)(100000000 / saida_us % 100),
+                   (unsigned long)((uint64_t)decimador_atraso_x2(c) * decimacao_entrada_us / 2));
+    if (c->taps)
+    {
+        console_printf("FIR (Q14, 16384 = 1):");
+        for (int i = 0; i < c->taps; i++)
+            console_printf(" %d", c->fir[i]);
+        console_printf("\n");
+    }
+}
+
+// Valida a configuração nova e só então a adota
+static bool decimacao_aplicar(const decimador_config_t *c, long entrada_us)
+{
+    const char *motivo;
+    if (!decimador_config_valida(c, &motivo))
+    {
+        console_printf("Configuração inválida: %s\n", motivo);
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return false;
+    }
+    if (entrada_us < DECIMACAO_ENTRADA_MIN_US || entrada_us > 1000000 ||
+        (uint64_t)entrada_us * decimador_fator(c) > 60000000)
+    {
+        console_printf("Período inválido: leitura de %d a 1000000 us e saída até 60 s\n", DECIMACAO_ENTRADA_MIN_US);
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return false;
+    }
+    decimacao_config = *c;
+    decimacao_entrada_us = (uint32_t)entrada_us;
+    return true;
+}
+
+static void run_decimar()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1)
+    {
+        if (!decimacao_ligada)
+            console_printf("Captura decimada desligada\n");
+        imprimir_decimacao();
+        if (logger_ativado && decimacao_sessao)
+            console_printf("Captura atual: %lu leituras, %d amostras gravadas, %lu falha(s) de leitura\n",
+                           (unsigned long)amostrador_seq, contador_amostras, (unsigned long)amostrador_falhas);
+        return;
+    }
+    if (logger_ativado || stream_ativo)
+    {
+        LOG_ERRO("Captura ou transmissão em andamento.\n");
+        feedback_mensagem("Captura Ativa", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (0 == strcmp(arg1, "off"))
+    {
+        decimacao_ligada = false;
+        console_printf("Captura decimada desligada: as próximas capturas são periódicas\n");
+        feedback_mensagem("Decimar Off", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    decimador_config_t config = decimacao_config;
+    long entrada_us = decimacao_entrada_us;
+    if (0 == strcmp(arg1, "fir"))
+    {
+        // Coeficientes próprios, mantendo R, N e M
+        const char *arg = strtok(NULL, " ");
+        int taps = 0;
+        for (char *p = (char *)arg; p && *p && taps < DECIMADOR_TAPS_MAX + 1;)
+        {
+            char *fim;
+            long v = strtol(p, &fim, 10);
+            if (fim == p || v < INT16_MIN || v > INT16_MAX || (*fim && *fim != ','))
+            {
+                taps = -1;
+                break;
+            }
+            if (taps < DECIMADOR_TAPS_MAX)
+                config.fir[taps] = (int16_t)v;
+            taps++;
+            p = *fim ? fim + 1 : fim;
+        }
+        if (taps <= 0 || taps > DECIMADOR_TAPS_MAX)
+        {
+            console_printf("Uso: decimar fir <c0,c1,...>: 1 a %d coeficientes Q14 (16384 = 1)\n", DECIMADOR_TAPS_MAX);
+            feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+            return;
+        }
+        config.taps = (uint8_t)taps;
+    }
+    else
+    {
+        const char *arg_entrada = strtok(NULL, " ");
+        const char *arg_r = strtok(NULL, " ");
+        const char *arg_n = strtok(NULL, " ");
+        const char *arg_m = strtok(NULL, " ");
+        const char *arg_taps = strtok(NULL, " ");
+        if (0 != strcmp(arg1, "on") || (arg_entrada && (!arg_r || !arg_n)))
+        {
+            console_printf("Uso: decimar [on [<entrada_us> <cic_fator> <cic_ordem> [fir_fator] [taps]]|fir "
+                           "<c0,c1,...>|off]\n");
+            feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+            return;
+        }
+        // Sem argumentos liga com a configuração atual
+        if (arg_entrada)
+        {
+            long r = atol(arg_r), n = atol(arg_n);
+            long m = arg_m ? atol(arg_m) : 1;
+            long taps = arg_taps ? atol(arg_taps) : (m > 1 ? DECIMACAO_TAPS_PADRAO : 0);
+            if (r < 1 || r > UINT16_MAX || n < 0 || n > DECIMADOR_ORDEM_MAX || m < 1 || m > UINT8_MAX || taps < 0 ||
+                taps > DECIMADOR_TAPS_MAX)
+            {
+                console_printf("Fatores inválidos: R de 1 a %u, N de 0 a %d, M de 1 a %u, taps de 0 a %d\n",
+                               UINT16_MAX, DECIMADOR_ORDEM_MAX, UINT8_MAX, DECIMADOR_TAPS_MAX);
+                feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+                return;
+            }
+            memset(&config, 0, sizeof(config));
+            entrada_us = atol(arg_entrada);
+            config.cic_fator = (uint16_t)r;
+            config.cic_ordem = (uint8_t)n;
+            config.fir_fator = (uint8_t)m;
+            if (taps)
+                decimador_projetar_fir(&config, (uint8_t)taps);
+        }
+    }
+    if (!decimacao_aplicar(&config, entrada_us))
+        return;
+    desligar_outros_modos("decimar");
+    decimacao_ligada = true;
+    imprimir_decimacao();
+    console_printf("As próximas capturas ('i' ou botão) gravam as amostras decimadas\n");
+    feedback_mensagem("Decimar On", MENSAGEM_TIMEOUT_MS);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Configuração da taxa adaptativa (a execução está junto de run_iniciar)
+
+static void imprimir_adaptativo()
+{
+    uint8_t alto = adaptativo_divisor_alto, baixo = adaptativo_divisor_baixo;
+    console_printf("Taxa adaptativa: %lu Hz em movimento (SMPLRT_DIV %u, DLPF %u) e %lu.%02lu Hz parado (SMPLRT_DIV "
+                   "%u, DLPF %u); movimento acima de %u mg%s ou %u °/s%s; volta à taxa baixa após %u ms parado\n",
+                   (unsigned long)(1000 / (1u + alto)), alto, mpu6050_dlpf_para(alto),
+                   (unsigned long)(1000 / (1u + baixo)), (unsigned long)(100000 / (1u + baixo) % 100), baixo,
+                   mpu6050_dlpf_para(baixo), adaptativo_config.accel_mg,
+                   adaptativo_config.accel_mg ? "" : " (não usa)", adaptativo_config.giro_dps,
+                   adaptativo_config.giro_dps ? "" : " (não usa)", adaptativo_config.espera_ms);
+}
+
+// Taxa em Hz para o SMPLRT_DIV mais próximo, com a taxa interna de 1 kHz
+static bool adaptativo_divisor(long hz, uint8_t *divisor)
+{
+    if (hz < 4 || hz > 1000)
+        return false;
+    long d = (1000 + hz / 2) / hz - 1;
+    *divisor = (uint8_t)(d > UINT8_MAX ? UINT8_MAX : d);
+    return true;
+}
+
+static void run_adaptativo()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1)
+    {
+        if (!adaptativo_ligado)
+            console_printf("Taxa adaptativa desligada\n");
+        imprimir_adaptativo();
+        if (logger_ativado && adaptativo_sessao)
+            console_printf("Captura atual: %s, %lu leituras (%lu na taxa baixa), %lu troca(s), %d amostras "
+                           "gravadas\n",
+                           atividade.ativo ? "em movimento" : "parado", (unsigned long)amostrador_seq,
+                           (unsigned long)adaptativo_leituras_baixa,
+                           (unsigned long)(adaptativo_trocas_escrita + adaptativo_trocas_perdidas),
+                           contador_amostras);
+        return;
+    }
+    if (logger_ativado || stream_ativo)
+    {
+        LOG_ERRO("Captura ou transmissão em andamento.\n");
+        feedback_mensagem("Captura Ativa", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (0 == strcmp(arg1, "off"))
+    {
+        adaptativo_ligado = false;
+        console_printf("Taxa adaptativa desligada: as próximas capturas são periódicas\n");
+        feedback_mensagem("Adaptativo Off", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    const char *arg_alto = strtok(NULL, " ");
+    const char *arg_baixo = strtok(NULL, " ");
+    const char *arg_accel = strtok(NULL, " ");
+    const char *arg_giro = strtok(NULL, " ");
+    const char *arg_espera = strtok(NULL, " ");
+    if (0 != strcmp(arg1, "on") || (arg_alto && (!arg_baixo || !arg_accel || !arg_giro)))
+    {
+        console_printf("Uso: adaptativo [on [<alto_hz> <baixo_hz> <accel_mg> <giro_dps> [espera_ms]]|off]\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    // Sem argumentos liga com a configuração atual
+    if (arg_alto)
+    {
+        uint8_t alto, baixo;
+        long accel_mg = atol(arg_accel), giro_dps = atol(arg_giro);
+        long espera_ms = arg_espera ? atol(arg_espera) : adaptativo_config.espera_ms;
+        if (!adaptativo_divisor(atol(arg_alto), &alto) || !adaptativo_divisor(atol(arg_baixo), &baixo) ||
+            baixo <= alto)
+        {
+            console_printf("Taxas inválidas: de 4 a 1000 Hz, a baixa menor que a alta\n");
+            feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+            return;
+        }
+        int fundo_mg = mpu6050_accel_g(&mpu6050_config) * 1000, fundo_dps = mpu6050_giro_dps(&mpu6050_config);
+        if (accel_mg < 0 || accel_mg > fundo_mg || giro_dps < 0 || giro_dps > fundo_dps || (!accel_mg && !giro_dps) ||
+            espera_ms < 0 || espera_ms > UINT16_MAX)
+        {
+            console_printf("Limiares inválidos: 0 a %d mg e 0 a %d °/s, ao menos um diferente de zero; espera até "
+                           "%u ms\n",
+                           fundo_mg, fundo_dps, UINT16_MAX);
+            feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+            return;
+        }
+        adaptativo_divisor_alto = alto;
+        adaptativo_divisor_baixo = baixo;
+        adaptativo_config.accel_mg = (uint16_t)accel_mg;
+        adaptativo_config.giro_dps = (uint16_t)giro_dps;
+        adaptativo_config.espera_ms = (uint16_t)espera_ms;
+    }
+    desligar_outros_modos("adaptativo");
+    adaptativo_ligado = true;
+    imprimir_adaptativo();
+    console_printf("As próximas capturas ('i' ou botão) mudam a taxa com o movimento\n");
+    feedback_mensagem("Adaptativo On", MENSAGEM_TIMEOUT_MS);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Captura do ADC por DMA (comando "adc" e atalho 'f'): lib/adc_dma.c enche
+// um anel de blocos de 8 KiB sem passar pela CPU, e o laço principal grava
+// um bloco cheio por volta em adcDDMMAAAAHHMMSS.bin, aberto durante toda a
+// captura. Como o cabeçalho ocupa um setor, cada bloco cai alinhado no
+// arquivo e o FatFs o envia do anel direto para o cartão, sem cópia.
+
+#define ADC_DURACAO_PADRAO_MS 1000
+#define ADC_SINCRONIZACAO_MS 1000 // f_sync: o que já foi gravado sobrevive à falta de energia
+#define ADC_BLOCOS_MAX ((UINT32_MAX - ADC_DMA_CABECALHO_BYTES) / ADC_DMA_BLOCO_BYTES) // arquivo abaixo de 4 GiB
+
+static FIL adc_arquivo;
+static char adc_nome[32];
+static adc_dma_arquivo_t adc_cabecalho;
+static absolute_time_t adc_proxima_sincronizacao;
+static uint64_t adc_inicio_us;
+
+// Cabeçalho completado com zeros até um setor, sempre no início do arquivo
+static bool adc_gravar_cabecalho()
+{
+    static uint8_t setor[ADC_DMA_CABECALHO_BYTES];
+    memset(setor, 0, sizeof(setor));
+    memcpy(setor, &adc_cabecalho, sizeof(adc_cabecalho));
+    UINT bw = 0;
+    FRESULT res = f_lseek(&adc_arquivo, 0);
+    if (res == FR_OK)
+        res = f_write(&adc_arquivo, setor, sizeof(setor), &bw);
+    if (res != FR_OK || bw != sizeof(setor))
+    {
+        LOG_ERRO("Não foi possível escrever o cabeçalho em %s: %s (%d)\n", adc_nome, FRESULT_str(res), res);
+        return false;
+    }
+    return true;
+}
+
+static bool adc_gravar_bloco(const uint8_t *bloco)
+{
+    UINT bw = 0;
+    FRESULT res = f_write(&adc_arquivo, bloco, ADC_DMA_BLOCO_BYTES, &bw);
+    adc_dma_liberar();
+    if (res != FR_OK || bw != ADC_DMA_BLOCO_BYTES)
+    {
+        LOG_ERRO("Não foi possível escrever em %s: %s (%d), bytes escritos=%u\n", adc_nome, FRESULT_str(res), res,
+                 bw);
+        return false;
+    }
+    adc_cabecalho.blocos_gravados++;
+    return true;
+}
+
+static void imprimir_adc(const adc_dma_arquivo_t *c)
+{
+    uint32_t taxa_chz = (uint32_t)((uint64_t)c->relogio_hz * 100 / c->ciclos);
+    console_printf("ADC canal %u: %lu.%02lu Hz (%lu ciclos), %lu ms, %lu bloco(s) de %u amostras\n", c->canal,
+                   (unsigned long)(taxa_chz / 100), (unsigned long)(taxa_chz % 100), (unsigned long)c->ciclos,
+                   (unsigned long)c->duracao_ms, (unsigned long)c->blocos_previstos, c->amostras_por_bloco);
+}
+
+// Fim da captura (pedido, prevista ou por erro): grava os blocos que ainda
+// estão no anel, fecha o cabeçalho com as contagens e relata as perdas
+static void adc_encerrar(bool gravar_pendentes)
+{
+    adc_dma_parar();
+    const uint8_t *bloco;
+    while (gravar_pendentes && (bloco = adc_dma_bloco()) != NULL)
+        if (!adc_gravar_bloco(bloco))
+            break;
+    while (adc_dma_bloco() != NULL)
+        adc_dma_liberar();
+    adc_dma_contagem_t contagem;
+    adc_dma_contagem(&contagem);
+    adc_cabecalho.blocos_perdidos = contagem.perdidos;
+    adc_cabecalho.transbordos_fifo = contagem.transbordos_fifo;
+    adc_cabecalho.completo = 1;
+    bool ok = adc_gravar_cabecalho();
+    ok = (FR_OK == f_close(&adc_arquivo)) && ok;
+    adc_gravando = false;
+    feedback_led_parar();
+
+    uint64_t decorrido_us = time_us_64() - adc_inicio_us;
+    uint64_t bytes = (uint64_t)adc_cabecalho.blocos_gravados * ADC_DMA_BLOCO_BYTES;
+    console_printf("\nCaptura do ADC encerrada em %s: %lu de %lu bloco(s) gravados, %lu perdido(s) com o anel "
+                   "cheio, %lu transbordo(s) da FIFO\n",
+                   adc_nome, (unsigned long)adc_cabecalho.blocos_gravados, (unsigned long)contagem.produzidos,
+                   (unsigned long)contagem.perdidos, (unsigned long)contagem.transbordos_fifo);
+    console_printf("Maior ocupação do anel: %lu de %u blocos; gravação a %lu KiB/s\n",
+                   (unsigned long)contagem.maior_ocupacao, ADC_DMA_BLOCOS,
+                   (unsigned long)(decorrido_us ? bytes * 1000000 / decorrido_us / 1024 : 0));
+    if (!ok)
+        feedback_mensagem("Erro Escrita", MENSAGEM_TIMEOUT_MS);
+    else if (contagem.perdidos || contagem.transbordos_fifo)
+        feedback_mensagem("ADC Salvo\nCom Perdas", MENSAGEM_TIMEOUT_MS);
+    else
+        feedback_mensagem("ADC Salvo", MENSAGEM_TIMEOUT_MS);
+}
+
+static void adc_capturar(uint32_t duracao_ms, uint32_t divisor, uint8_t canal)
+{
+    if (logger_ativado || stream_ativo || transferencia_ativa() || adc_gravando)
+    {
+        LOG_ERRO("Captura ou transmissão em andamento.\n");
+        feedback_mensagem("Captura Ativa", MENSAGEM_TIMEOUT_MS);
         return;
     }
-    if (!mpu6050_testar())
+    if (!sd_esta_montado())
     {
-        printf("[ERRO] Falha na comunicação com o MPU6050. Parando captura.\n");
-        logger_ativado = false;
+        LOG_ERRO("Cartão SD não está montado. Use o comando 'a' para montar.\n");
+        feedback_mensagem("Erro: SD Não Montado", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    uint32_t ciclos = adc_dma_ciclos(divisor);
+    uint32_t blocos = adc_dma_blocos(duracao_ms, ciclos);
+    uint64_t tamanho = ADC_DMA_CABECALHO_BYTES + (uint64_t)blocos * ADC_DMA_BLOCO_BYTES;
+    uint64_t livre;
+    if (blocos > ADC_BLOCOS_MAX)
+    {
+        console_printf("Duração longa demais para essa taxa: o arquivo passaria de 4 GiB\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (espaco_esgotado() || (espaco_livre(&livre) && livre < tamanho + ESPACO_RESERVA_BYTES))
+    {
+        console_printf("Espaço insuficiente no cartão para %llu KiB\n", (unsigned long long)(tamanho / 1024));
+        feedback_mensagem("Cartão Cheio", MENSAGEM_TIMEOUT_MS);
         return;
     }
-    int16_t accel[3], gyro[3], temp;
-    mpu6050_ler_dados(accel, gyro, &temp);
-    contador_amostras++;
-    float temperatura = (temp / 340.0) + 15; // Temperatura em Celsius
-    printf("[DEBUG] capturar_dados_mpu6050_e_salvar: Amostra %d lida: AccX=%d, AccY=%d, AccZ=%d, GyroX=%d, GyroY=%d, GyroZ=%d, Temp=%d, Temperatura=%.2f C\n",
-           contador_amostras, accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2], temp, temperatura);
 
     datetime_t t;
-    char data_str[16], hora_str[16];
     if (rtc_get_datetime(&t))
+        snprintf(adc_nome, sizeof(adc_nome), "adc%02d%02d%04d%02d%02d%02d.bin", t.day, t.month, t.year, t.hour,
+                 t.min, t.sec);
+    else
+        strcpy(adc_nome, "adc_fallback.bin");
+    FRESULT res = f_open(&adc_arquivo, adc_nome, FA_WRITE | FA_CREATE_ALWAYS);
+    if (res != FR_OK)
     {
-        snprintf(data_str, sizeof(data_str), "%02d/%02d/%02d", t.day, t.month, t.year % 100);
-        snprintf(hora_str, sizeof(hora_str), "%02d:%02d:%02d", t.hour, t.min, t.sec);
+        LOG_ERRO("Não foi possível abrir o arquivo %s para escrita: %s (%d)\n", adc_nome, FRESULT_str(res), res);
+        feedback_mensagem("Erro Arquivo", MENSAGEM_TIMEOUT_MS);
+        return;
     }
-    else
+    memset(&adc_cabecalho, 0, sizeof(adc_cabecalho));
+    memcpy(adc_cabecalho.assinatura, "ADC1", 4);
+    adc_cabecalho.tamanho = sizeof(adc_cabecalho);
+    adc_cabecalho.bloco_bytes = ADC_DMA_BLOCO_BYTES;
+    adc_cabecalho.amostras_por_bloco = ADC_DMA_AMOSTRAS_POR_BLOCO;
+    adc_cabecalho.canal = canal;
+    adc_cabecalho.relogio_hz = ADC_DMA_RELOGIO_HZ;
+    adc_cabecalho.ciclos = ciclos;
+    adc_cabecalho.duracao_ms = duracao_ms;
+    adc_cabecalho.blocos_previstos = blocos;
+    if (!adc_gravar_cabecalho() || !adc_dma_iniciar(canal, divisor, blocos))
     {
-        strcpy(data_str, "00/00/00");
-        strcpy(hora_str, "00:00:00");
-        printf("[ERRO] capturar_dados_mpu6050_e_salvar: RTC não configurado, usando 00/00/00 00:00:00\n");
+        LOG_ERRO("Não foi possível iniciar a captura do ADC (sem canal de DMA livre?)\n");
+        f_close(&adc_arquivo);
+        f_unlink(adc_nome);
+        feedback_mensagem("Erro ADC", MENSAGEM_TIMEOUT_MS);
+        return;
     }
+    adc_gravando = true;
+    adc_inicio_us = time_us_64();
+    adc_proxima_sincronizacao = make_timeout_time_ms(ADC_SINCRONIZACAO_MS);
+    imprimir_adc(&adc_cabecalho);
+    console_printf("Gravando em %s a %lu KiB/s ('adc off' interrompe)\n", adc_nome,
+                   (unsigned long)((uint64_t)ADC_DMA_RELOGIO_HZ / ciclos * sizeof(uint16_t) / 1024));
+    feedback_led_fixo(COR_AZUL);
+    feedback_mensagem("Capturando ADC", MENSAGEM_TIMEOUT_MS);
+}
 
-    printf("[DEBUG] capturar_dados_mpu6050_e_salvar: Abrindo arquivo %s para escrita (append)...\n", nome_arquivo);
-    FIL arquivo;
-    FRESULT res = f_open(&arquivo, nome_arquivo, FA_WRITE | FA_OPEN_APPEND);
-    if (res != FR_OK)
+// Uma volta do laço principal: no máximo um bloco, para o console e o OLED
+// continuarem respondendo entre as gravações
+static void adc_tarefa()
+{
+    if (!adc_gravando)
+        return;
+    if (!sd_esta_montado())
     {
-        printf("[ERRO] Não foi possível abrir o arquivo %s para escrita: %s (%d)\n", nome_arquivo, FRESULT_str(res), res);
-        logger_ativado = false;
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro Arquivo", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        LOG_ERRO("Cartão SD não está montado. Parando captura do ADC.\n");
+        adc_dma_parar();
+        while (adc_dma_bloco() != NULL)
+            adc_dma_liberar();
+        adc_gravando = false;
+        feedback_led_parar();
+        feedback_mensagem("Erro: SD Não Montado", MENSAGEM_TIMEOUT_MS);
         return;
     }
-
-    char buffer_data[128];
-    sprintf(buffer_data, "%s,%s,%d,%d,%d,%d,%d,%d,%d,%.2f\n",
-            data_str, hora_str, contador_amostras, accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2], temperatura);
-    printf("[DEBUG] capturar_dados_mpu6050_e_salvar: Buffer preparado: %s", buffer_data);
-    UINT bw;
-    printf("[DEBUG] capturar_dados_mpu6050_e_salvar: Escrevendo amostra %d...\n", contador_amostras);
-    res = f_write(&arquivo, buffer_data, strlen(buffer_data), &bw);
-    if (res != FR_OK || bw != strlen(buffer_data))
+    const uint8_t *bloco = adc_dma_bloco();
+    if (bloco && !adc_gravar_bloco(bloco))
     {
-        printf("[ERRO] Não foi possível escrever no arquivo %s: %s (%d), bytes escritos=%u\n", nome_arquivo, FRESULT_str(res), res, bw);
-        logger_ativado = false;
-        f_close(&arquivo);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro Escrita", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        adc_encerrar(false);
         return;
     }
-    f_sync(&arquivo);
-    f_close(&arquivo);
-    printf("Amostra %d salva em %s.\n", contador_amostras, nome_arquivo);
-
-    if (contador_amostras >= MAX_AMOSTRAS)
+    if (!bloco && !adc_dma_convertendo())
     {
-        logger_ativado = false;
-        printf("Coleta de %d amostras concluída com sucesso.\n", MAX_AMOSTRAS);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Captura Concluída", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-
-        /* code */
+        adc_encerrar(true);
+        return;
+    }
+    if (time_reached(adc_proxima_sincronizacao))
+    {
+        f_sync(&adc_arquivo);
+        adc_proxima_sincronizacao = make_timeout_time_ms(ADC_SINCRONIZACAO_MS);
     }
-    printf("[DEBUG] capturar_dados_mpu6050_e_salvar: Amostra %d concluída\n", contador_amostras);
 }
 
-static void ler_arquivo(const char *nome_arquivo)
+static void run_adc()
 {
-    printf("[DEBUG] ler_arquivo: Iniciando leitura de %s\n", nome_arquivo);
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "Lendo Arquivo", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-    if (!sd_esta_montado("0:"))
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1)
     {
-        printf("[ERRO] Cartão SD não está montado. Use o comando 'a' para montar.\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro: SD Não Montado", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        if (!adc_gravando)
+        {
+            console_printf("Nenhuma captura do ADC em andamento\n");
+            return;
+        }
+        adc_dma_contagem_t c;
+        adc_dma_contagem(&c);
+        imprimir_adc(&adc_cabecalho);
+        console_printf("%s: %lu bloco(s) convertidos, %lu gravados, %lu no anel, %lu perdido(s), %lu transbordo(s) "
+                       "da FIFO\n",
+                       adc_nome, (unsigned long)c.produzidos, (unsigned long)adc_cabecalho.blocos_gravados,
+                       (unsigned long)c.pendentes, (unsigned long)c.perdidos, (unsigned long)c.transbordos_fifo);
         return;
     }
-    FIL arquivo;
-    FRESULT res = f_open(&arquivo, nome_arquivo, FA_READ);
-    if (res != FR_OK)
+    if (0 == strcmp(arg1, "off"))
     {
-        printf("[ERRO] Não foi possível abrir o arquivo %s para leitura: %s (%d)\n", nome_arquivo, FRESULT_str(res), res);
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Erro Leitura", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+        if (adc_gravando)
+            adc_encerrar(true);
+        else
+            console_printf("Nenhuma captura do ADC em andamento\n");
         return;
     }
-    char buffer[128];
-    UINT br;
-    printf("Conteúdo do arquivo %s:\n", nome_arquivo);
-    while (f_read(&arquivo, buffer, sizeof(buffer) - 1, &br) == FR_OK && br > 0)
+    const char *arg_duracao = strtok(NULL, " ");
+    const char *arg_divisor = strtok(NULL, " ");
+    const char *arg_canal = strtok(NULL, " ");
+    long duracao_ms = arg_duracao ? atol(arg_duracao) : ADC_DURACAO_PADRAO_MS;
+    long divisor = arg_divisor ? atol(arg_divisor) : 0;
+    long canal = arg_canal ? atol(arg_canal) : 0;
+    if (0 != strcmp(arg1, "on") || duracao_ms <= 0 || divisor < 0 || divisor > ADC_DMA_DIVISOR_MAX || canal < 0 ||
+        canal > ADC_DMA_CANAL_TEMPERATURA)
     {
-        buffer[br] = '\0';
-        printf("%s", buffer);
+        console_printf("Uso: adc [on [<duracao_ms> [divisor] [canal]]|off] (divisor 0 a %u: 48 MHz / max(96, "
+                       "divisor + 1); canal 0 a 3 ou 4 = temperatura)\n",
+                       ADC_DMA_DIVISOR_MAX);
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
     }
-    f_close(&arquivo);
-    printf("\nLeitura do arquivo %s concluída.\n\n");
-    printf("[DEBUG] ler_arquivo: Leitura concluída\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "Leitura Concluída", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+    adc_capturar((uint32_t)duracao_ms, (uint32_t)divisor, (uint8_t)canal);
 }
 
-static void gpio_irq_handler(uint gpio, uint32_t events)
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Configuração dos canais analógicos (a leitura está junto do amostrador)
+
+static void imprimir_analogico()
 {
-    static uint32_t last_press = 0;
-    uint32_t current_time = to_ms_since_boot(get_absolute_time());
-    if (current_time - last_press < 200)
-        return;
-    last_press = current_time;
+    char texto[64];
+    analogico_config_formatar(&analogico_config, texto, sizeof(texto));
+    console_printf("Analógico: %s (conversão a cada n leituras do MPU6050)\n", texto);
+}
 
-    if (gpio == BOTAO_A)
-    { //
-      // aqui altera o valor da flag de montar/desmontar o cartão SD
-        printf("[DEBUG] gpio_irq_handler: Interrupção BOTAO_A acionada\n");
-        flag_montar = !flag_montar;
-        flag_desmontar = true;
+static void run_analogico()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1)
+    {
+        if (!analogico_ligado)
+            console_printf("Canais analógicos desligados\n");
+        imprimir_analogico();
+        if (logger_ativado && analogico_sessao)
+            console_printf("Captura atual: %lu conversão(ões), %lu período(s) sem conversão, %lu atrasada(s)\n",
+                           (unsigned long)analogico.conversoes, (unsigned long)analogico.perdidas,
+                           (unsigned long)analogico_atrasadas);
+        return;
     }
-    else if (gpio == BOTAO_B)
-    { //
-      // aqui altera o valor da flag para gravar e parar de gravar
-        printf("[DEBUG] gpio_irq_handler: Interrupção BOTAO_B acionada\n");
-        if (sd_esta_montado("0:"))
+    if (logger_ativado || stream_ativo)
+    {
+        LOG_ERRO("Captura ou transmissão em andamento.\n");
+        feedback_mensagem("Captura Ativa", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (0 == strcmp(arg1, "off"))
+    {
+        analogico_ligado = false;
+        console_printf("Canais analógicos desligados: as próximas capturas gravam só o MPU6050\n");
+        feedback_mensagem("Analogico Off", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (0 != strcmp(arg1, "on"))
+    {
+        console_printf("Uso: analogico [on [<0|1|2|t>:<a_cada> ...]|off]\n");
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    // Sem canais liga com a configuração atual
+    analogico_config_t nova = {0};
+    bool algum = false;
+    for (char *par = strtok(NULL, " "); par; par = strtok(NULL, " "))
+    {
+        char *separador = strchr(par, ':');
+        long a_cada = separador ? atol(separador + 1) : 0;
+        if (separador)
+            *separador = '\0';
+        int canal = analogico_canal(par);
+        if (canal < 0 || a_cada <= 0 || a_cada > ANALOGICO_A_CADA_MAX)
         {
-            flag_gravar = !flag_gravar;
-            flag_parar_gravar = true;
+            console_printf("Uso: analogico [on [<0|1|2|t>:<a_cada> ...]|off] (a_cada de 1 a %u leituras)\n",
+                           ANALOGICO_A_CADA_MAX);
+            feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+            return;
         }
+        nova.a_cada[canal] = (uint16_t)a_cada;
+        algum = true;
     }
-    else if (gpio == JOYSTICK_SW)
+    if (algum)
     {
-        printf("[DEBUG] gpio_irq_handler: Interrupção BOOTSEL acionada\n");
-        ssd1306_fill(&ssd, false);
-        ssd1306_draw_string(&ssd, "Modo Gravacao", 5, 0);
-        ssd1306_send_data(&ssd);
-        mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-        reset_usb_boot(0, 0);
+        if (!analogico_config_valida(&nova))
+        {
+            console_printf("Canais demais para a taxa: uma conversão por leitura, a soma de 1/a_cada passa de 1\n");
+            feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+            return;
+        }
+        analogico_config = nova;
     }
+    analogico_ligado = true;
+    imprimir_analogico();
+    console_printf("As próximas capturas ('i' ou botão) gravam as colunas analógicas\n");
+    feedback_mensagem("Analogico On", MENSAGEM_TIMEOUT_MS);
 }
 
-static void run_ajuda()
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Configuração dos sensores ambientais (o escalonador roda junto do amostrador)
+
+static void imprimir_sensores()
 {
-    printf("[DEBUG] run_ajuda: Iniciando...\n");
-    ssd1306_fill(&ssd, false);
-    ssd1306_draw_string(&ssd, "Exibindo Ajuda", 5, 0);
-    ssd1306_send_data(&ssd);
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-    printf("\nComandos disponíveis:\n\n");
-    printf("Digite 'a' para montar o cartão SD\n");
-    printf("Digite 'b' para desmontar o cartão SD\n");
-    printf("Digite 'c' para listar arquivos\n");
-    printf("Digite 'd' para mostrar conteúdo do arquivo\n");
-    printf("Digite 'e' para obter espaço livre no cartão SD\n");
-    printf("Digite 'f' para capturar dados do ADC e salvar no arquivo\n");
-    printf("Digite 'g' para formatar o cartão SD\n");
-    printf("Digite 'h' para exibir os comandos disponíveis\n");
-    printf("Digite 'i' para começar a captura de %d amostras do MPU6050\n", MAX_AMOSTRAS);
-    printf("\nEscolha o comando:  ");
-    printf("[DEBUG] run_ajuda: Concluído\n");
+    console_printf("Sensores: BMP280 a cada %lu ms, AHT20 a cada %lu ms (0: fora da captura)\n",
+                   (unsigned long)sensores_bmp280_ms, (unsigned long)sensores_aht20_ms);
+}
+
+static void run_sensores()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1)
+    {
+        if (!sensores_ligado)
+            console_printf("Sensores ambientais desligados\n");
+        imprimir_sensores();
+        if (logger_ativado && sensores_sessao)
+        {
+            console_printf("Captura atual:\n");
+            imprimir_sensores_contagem();
+        }
+        return;
+    }
+    if (logger_ativado || stream_ativo)
+    {
+        LOG_ERRO("Captura ou transmissão em andamento.\n");
+        feedback_mensagem("Captura Ativa", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    if (0 == strcmp(arg1, "off"))
+    {
+        sensores_ligado = false;
+        console_printf("Sensores ambientais desligados: as próximas capturas gravam só o MPU6050\n");
+        feedback_mensagem("Sensores Off", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    uint32_t bmp280_ms = sensores_bmp280_ms, aht20_ms = sensores_aht20_ms;
+    bool valido = 0 == strcmp(arg1, "on");
+    // Sem pares liga com a configuração atual
+    for (const char *chave = strtok(NULL, " "); valido && chave; chave = strtok(NULL, " "))
+    {
+        const char *valor = strtok(NULL, " ");
+        long ms = valor ? atol(valor) : -1;
+        valido = ms == 0 || (ms >= SENSORES_PERIODO_MIN_MS && ms <= SENSORES_PERIODO_MAX_MS);
+        if (valido && 0 == strcmp(chave, "bmp280"))
+            bmp280_ms = (uint32_t)ms;
+        else if (valido && 0 == strcmp(chave, "aht20"))
+            aht20_ms = (uint32_t)ms;
+        else
+            valido = false;
+    }
+    if (!valido || (!bmp280_ms && !aht20_ms))
+    {
+        console_printf("Uso: sensores [on [bmp280 <ms>] [aht20 <ms>]|off] (período de %u a %u ms, 0 deixa o sensor "
+                       "fora; ao menos um ligado)\n",
+                       SENSORES_PERIODO_MIN_MS, SENSORES_PERIODO_MAX_MS);
+        feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    sensores_bmp280_ms = bmp280_ms;
+    sensores_aht20_ms = aht20_ms;
+    sensores_ligado = true;
+    imprimir_sensores();
+    console_printf("As próximas capturas ('i' ou botão) gravam as medidas ambientais entre as amostras\n");
+    feedback_mensagem("Sensores On", MENSAGEM_TIMEOUT_MS);
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// Faixas e taxa do MPU6050 (comando "mpu6050"): acelerômetro, giroscópio,
+// DLPF e divisor da taxa mudam juntos entre capturas, com releitura dos
+// registros. A calibração da flash é convertida para as faixas novas e a
+// orientação passa a usar os fundos de escala novos
+
+static void imprimir_mpu6050()
+{
+    char texto[128];
+    mpu6050_config_formatar(&mpu6050_config, texto, sizeof(texto));
+    console_printf("MPU6050: %s, CSV em %s\n", texto, unidades_engenharia ? "µg e m°/s" : "LSB");
+}
+
+static void run_mpu6050()
+{
+    const char *chave = strtok(NULL, " ");
+    if (!chave)
+    {
+        imprimir_mpu6050();
+        return;
+    }
+    if (logger_ativado || stream_ativo)
+    {
+        LOG_ERRO("Captura ou transmissão em andamento.\n");
+        feedback_mensagem("Captura Ativa", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    mpu6050_config_t nova = mpu6050_config;
+    mpu6050_config_t antiga = mpu6050_config;
+    bool unidades = unidades_engenharia;
+    for (; chave; chave = strtok(NULL, " "))
+    {
+        const char *valor = strtok(NULL, " ");
+        long v = valor ? atol(valor) : -1;
+        int faixa;
+        if (valor && 0 == strcmp(chave, "accel") && (faixa = mpu6050_faixa_accel((uint32_t)v)) >= 0)
+            nova.accel_faixa = (uint8_t)faixa;
+        else if (valor && 0 == strcmp(chave, "giro") && (faixa = mpu6050_faixa_giro((uint32_t)v)) >= 0)
+            nova.giro_faixa = (uint8_t)faixa;
+        else if (valor && 0 == strcmp(chave, "dlpf") && v >= 0 && v <= MPU6050_DLPF_MAX)
+            nova.dlpf = (uint8_t)v;
+        else if (valor && 0 == strcmp(chave, "div") && v >= 0 && v <= UINT8_MAX)
+            nova.divisor = (uint8_t)v;
+        else if (valor && 0 == strcmp(chave, "unidades") && (0 == strcmp(valor, "on") || 0 == strcmp(valor, "off")))
+            unidades = 0 == strcmp(valor, "on");
+        else
+        {
+            console_printf("Uso: mpu6050 [accel <2|4|8|16>] [giro <250|500|1000|2000>] [dlpf <0-%d>] [div <0-255>] "
+                           "[unidades on|off]\n",
+                           MPU6050_DLPF_MAX);
+            feedback_mensagem("Erro: Argumento", MENSAGEM_TIMEOUT_MS);
+            return;
+        }
+    }
+    if (!mpu6050_config_valida(&nova) || !mpu6050_aplicar(&nova))
+    {
+        LOG_ERRO("Falha ao configurar o MPU6050: registros mantidos na configuração anterior\n");
+        feedback_mensagem("Erro MPU6050", MENSAGEM_TIMEOUT_MS);
+        return;
+    }
+    unidades_engenharia = unidades;
+    if (nova.giro_faixa != antiga.giro_faixa || nova.accel_faixa != antiga.accel_faixa)
+    {
+        calibracao_atualizar();
+        // As posições medidas para a próxima estimativa estão em LSB das faixas antigas
+        calibracao_estimativa_iniciar(&calibracao_estimativa);
+    }
+    if (nucleo1_orientacao_ligada())
+    {
+        orientacao_config_t config = *nucleo1_orientacao_config();
+        config.giro_dps = mpu6050_giro_dps(&mpu6050_config);
+        config.accel_g = mpu6050_accel_g(&mpu6050_config);
+        nucleo1_orientacao_configurar(&config);
+    }
+    imprimir_mpu6050();
+    feedback_mensagem("MPU6050 Config", MENSAGEM_TIMEOUT_MS);
 }
 
 typedef void (*p_fn_t)();
@@ -1027,41 +4456,65 @@ typedef struct
 
 static cmd_def_t comandos[] = {
     {"setrtc", run_setrtc, "setrtc <DD> <MM> <AA> <hh> <mm> <ss>: Configura o relógio em tempo real"},
-    {"format", run_format, "format [<drive#:>]: Formata o cartão SD"},
+    {"format", run_format, "format [registro|padrao] [<drive#:>]: Formata o cartão SD (perfil de registro por padrão)"},
     {"mount", run_mount, "mount [<drive#:>]: Monta o cartão SD"},
     {"unmount", run_unmount, "unmount <drive#:>: Desmonta o cartão SD"},
     {"getfree", run_getfree, "getfree [<drive#:>]: Exibe espaço livre"},
-    {"ls", run_ls, "ls: Lista arquivos"},
+    {"ls", run_ls, "ls [n]: Lista as últimas n sessões do catálogo"},
+    {"info", run_info, "info <arquivo|#n>: Detalhes de uma sessão do catálogo"},
+    {"catalogo", run_catalogo, "catalogo reconstruir: Cataloga arquivos .csv antigos"},
+    {"range", run_range, "range <arquivo> <inicio_s> <fim_s> [saida]: Extrai um trecho pelo índice de tempo"},
+    {"exportar", run_exportar, "exportar <arquivo> <janela> [saida]: Resumo mín/máx/média/RMS por janela"},
+    {"dir", run_dir, "dir [caminho]: Lista arquivos do diretório"},
     {"cat", run_cat, "cat <nome_arquivo>: Exibe conteúdo do arquivo"},
-    {"i", run_iniciar, "i: Começa a captura de 25 amostras do MPU6050"},
+    {"grafico", run_grafico, "grafico [ax|ay|az|gx|gy|gz|off] [janela]: Gráfico ao vivo no OLED"},
+    {"stream", run_stream, "stream [periodo_us]: Transmite amostras em binário pela USB"},
+    {"baixar", run_baixar, "baixar <arquivo> [offset]: Envia um arquivo em binário pela USB"},
+    {"orientacao", run_orientacao, "orientacao [on [ganho]|off|bench]: Quatérnio de orientação no CSV (core1)"},
+    {"gatilho", run_gatilho, "gatilho [on <accel_mg> <giro_dps> [pre_ms] [pos_ms] [periodo_us]|off]: Captura por evento"},
+    {"espectro", run_espectro, "espectro [on <n> [periodo_us] [ax|ay|az] [bins]|off|bench]: Espectro de vibração por janela"},
+    {"decimar", run_decimar, "decimar [on [<entrada_us> <R> <N> [M] [taps]]|fir <c0,c1,...>|off]: Captura filtrada e decimada"},
+    {"adaptativo", run_adaptativo, "adaptativo [on [<alto_hz> <baixo_hz> <accel_mg> <giro_dps> [espera_ms]]|off]: Taxa que acompanha o movimento"},
+    {"mpu6050", run_mpu6050, "mpu6050 [accel <2|4|8|16>] [giro <250|500|1000|2000>] [dlpf <0-6>] [div <0-255>] [unidades on|off]: Faixas e taxa"},
+    {"analogico", run_analogico, "analogico [on [<0|1|2|t>:<a_cada> ...]|off]: ADC0-2 e temperatura no CSV junto do MPU6050"},
+    {"sensores", run_sensores, "sensores [on [bmp280 <ms>] [aht20 <ms>]|off]: BMP280 e AHT20 no CSV entre as amostras"},
+    {"adc", run_adc, "adc [on [<duracao_ms> [divisor] [canal]]|off]: Captura contínua do ADC por DMA em binário"},
+    {"calibrar", run_calibrar, "calibrar [pose [n]|salvar|limpar|bench]: Calibração do MPU6050 gravada na flash"},
     {"ajuda", run_ajuda, "ajuda: Exibe comandos disponíveis"}};
 
-static void processar_stdio(int cRxedChar)
+// Retorna a tecla de atalho ('a' a 'i') quando ela é digitada sozinha na
+// linha e confirmada com Enter; 0 nos demais casos. Assim as letras dos
+// comandos longos (ex.: "grafico") não disparam os atalhos.
+static int processar_stdio(int cRxedChar)
 {
-    printf("[DEBUG] processar_stdio: Caractere recebido=%c (0x%02X)\n", isprint(cRxedChar) ? cRxedChar : '.', cRxedChar);
+    LOG_DEBUG("processar_stdio: Caractere recebido=%c (0x%02X)\n", isprint(cRxedChar) ? cRxedChar : '.', cRxedChar);
     static char cmd[256];
     static size_t ix;
 
     if (!isprint(cRxedChar) && !isspace(cRxedChar) && '\r' != cRxedChar &&
         '\b' != cRxedChar && cRxedChar != (char)127)
-        return;
-    printf("%c", cRxedChar);
-    stdio_flush();
+        return 0;
+    console_putc((char)cRxedChar);
     if (cRxedChar == '\r')
     {
-        printf("%c", '\n');
-        stdio_flush();
+        console_putc('\n');
 
         if (!strnlen(cmd, sizeof cmd))
         {
-            printf("> ");
-            stdio_flush();
-            return;
+            console_printf("> ");
+            return 0;
+        }
+        if (ix == 1 && cmd[0] >= 'a' && cmd[0] <= 'i')
+        {
+            int atalho = cmd[0];
+            ix = 0;
+            memset(cmd, 0, sizeof cmd);
+            return atalho;
         }
         char *cmdn = strtok(cmd, " ");
         if (cmdn)
         {
-            printf("[DEBUG] processar_stdio: Comando processado: %s\n", cmdn);
+            LOG_DEBUG("processar_stdio: Comando processado: %s\n", cmdn);
             size_t i;
             for (i = 0; i < count_of(comandos); ++i)
             {
@@ -1073,17 +4526,13 @@ static void processar_stdio(int cRxedChar)
             }
             if (count_of(comandos) == i)
             {
-                printf("Comando \"%s\" não encontrado\n", cmdn);
-                ssd1306_fill(&ssd, false);
-                ssd1306_draw_string(&ssd, "Comando Inválido", 5, 0);
-                ssd1306_send_data(&ssd);
-                mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
+                console_printf("Comando \"%s\" não encontrado\n", cmdn);
+                feedback_mensagem("Comando Inválido", MENSAGEM_TIMEOUT_MS);
             }
         }
         ix = 0;
         memset(cmd, 0, sizeof cmd);
-        printf("\n> ");
-        stdio_flush();
+        console_printf("\n> ");
     }
     else
     {
@@ -1104,27 +4553,54 @@ static void processar_stdio(int cRxedChar)
             }
         }
     }
+    return 0;
+}
+
+// Sinalização das ações de montar/desmontar e iniciar/parar captura.
+// Os padrões rodam no temporizador do módulo feedback, sem sleep_ms aqui.
+static void montar_sd_com_feedback()
+{
+    console_printf("\nMontando o SD...\n");
+    run_mount();
+    console_printf("\nEscolha o comando (h = ajuda):  ");
+    if (!erro_montagem)
+        feedback_led_piscar(COR_AMARELO, 800, 0, 1);
+    flag_desmontar = false;
+}
+
+static void desmontar_sd_com_feedback()
+{
+    console_printf("\nDesmontando o SD...\n");
+    run_unmount();
+    console_printf("\nEscolha o comando (h = ajuda):  ");
+    feedback_led_fixo(COR_APAGADO);
+    feedback_led_piscar(COR_AMARELO, 4000, 0, 1);
+    flag_desmontar = false;
 }
 
-void init_buzzer()
+static void iniciar_captura_com_feedback()
 {
-    gpio_set_function(BUZZER_PIN, GPIO_FUNC_PWM);
-    uint slice_num = pwm_gpio_to_slice_num(BUZZER_PIN);
-    uint clk_div = clock_get_hz(clk_sys) / (1000 * 4096); // Frequência ~1000Hz
-    pwm_set_clkdiv(slice_num, clk_div);
-    pwm_set_wrap(slice_num, 4095); // Resolução PWM
-    pwm_set_enabled(slice_num, true);
-    printf("Buzzer inicializado\n");
+    console_printf("\nIniciando captura de dados do MPU6050...\n");
+    run_iniciar();
+    feedback_led_fixo(COR_VERMELHO);
+    feedback_led_piscar(COR_AZUL, 100, 100, 10);
+    feedback_bipe(1, 200, 0);
+    flag_parar_gravar = false;
 }
 
-void set_buzzer(bool ligado)
+static void parar_captura_com_feedback()
 {
-    pwm_set_gpio_level(BUZZER_PIN, ligado ? 256 : 0);
+    flag_parar_gravar = false;
+    if (logger_ativado)
+        encerrar_captura();
+    feedback_led_fixo(COR_APAGADO);
+    feedback_bipe(2, 200, 200);
 }
 
 int main()
 {
-    printf("[DEBUG] main: Iniciando programa...\n");
+    console_init();
+    LOG_DEBUG("main: Iniciando programa...\n");
     gpio_init(BOTAO_A);
     gpio_set_dir(BOTAO_A, GPIO_IN);
     gpio_pull_up(BOTAO_A);
@@ -1156,31 +4632,23 @@ int main()
         .sec = 0};
     if (!rtc_set_datetime(&t_inicial))
     {
-        printf("[ERRO] main: Falha ao configurar RTC inicial\n");
+        LOG_ERRO("main: Falha ao configurar RTC inicial\n");
     }
     else
     {
-        printf("[DEBUG] main: RTC configurado com data inicial 29/07/2025 13:00:00\n");
+        LOG_DEBUG("main: RTC configurado com data inicial 29/07/2025 13:00:00\n");
     }
 
-    // inicializar buzzer
-    init_buzzer();
-
-    // Inicializar LEDs RGB
-    gpio_init(LED_R);
-    gpio_set_dir(LED_R, GPIO_OUT);
-    gpio_init(LED_G);
-    gpio_set_dir(LED_G, GPIO_OUT);
-    gpio_init(LED_B);
-    gpio_set_dir(LED_B, GPIO_OUT);
-    printf("LED RGB inicializado\n");
-
     i2c_init(I2C_PORT, 400 * 1000);
     gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
     gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
     gpio_pull_up(I2C_SDA);
     gpio_pull_up(I2C_SCL);
     mpu6050_reset();
+    if (calibracao_carregar(&calibracao_salva, mpu6050_giro_dps(&mpu6050_config), mpu6050_accel_g(&mpu6050_config)))
+        console_printf("Calibração do MPU6050 carregada da flash\n");
+    calibracao_atualizar();
+    decimacao_padrao();
 
     sleep_ms(5000);
     i2c_init(I2C_PORT_DISP, 400 * 1000);
@@ -1193,121 +4661,107 @@ int main()
     ssd1306_config(&ssd);
     ssd1306_send_data(&ssd);
 
+    // Atualizações do OLED por DMA: o laço principal não espera o I2C
+    if (!ssd1306_dma_init(&ssd))
+        LOG_ERRO("main: Sem canal DMA livre, OLED em modo bloqueante\n");
+
+    // Estágios de processamento das amostras no core1 (orientação)
+    nucleo1_iniciar();
+
+    // LEDs RGB, buzzer e mensagens temporizadas do OLED
+    feedback_init(LED_R, LED_G, LED_B, BUZZER_PIN, &ssd);
+    console_printf("LED RGB e buzzer inicializados\n");
+
     // Sistema inicializando / Montando cartão SD.
     ssd1306_fill(&ssd, false);
     ssd1306_draw_string(&ssd, "Sistema ", 30, 0);
     ssd1306_draw_string(&ssd, "Iniciando", 30, 10);
     ssd1306_send_data(&ssd);
-    printf("Sistema iniciando...\n");
+    console_printf("Sistema iniciando...\n");
 
     // ligar led rgb na cor amarela
-    gpio_put(LED_R, 1);
-    gpio_put(LED_G, 1);
-    gpio_put(LED_B, 0);
+    feedback_led_fixo(COR_AMARELO);
     sleep_ms(5000);
-    printf("\nMontando o SD...\n");
+    console_printf("\nMontando o SD...\n");
     run_mount();
+    feedback_tarefa();
     sleep_ms(5000);
+    feedback_led_fixo(COR_APAGADO);
 
-    mensagem_timeout = delayed_by_ms(get_absolute_time(), MENSAGEM_TIMEOUT_MS);
-
-    printf("Registrador de Dados FatFS SPI + MPU6050\n");
-    printf("\033[2J\033[H");
-    printf("\n> ");
-    stdio_flush();
+    console_printf("Registrador de Dados FatFS SPI + MPU6050\n");
+    console_printf("\033[2J\033[H");
+    console_printf("\n> ");
     run_ajuda();
 
+    bool erro_sinalizado = false;
     while (true)
     {
 
-        if (erro_montagem)
+        if (erro_montagem != erro_sinalizado)
         {
-            // pisca led na cor roxXA
-
-            gpio_put(LED_R, 1);
-            gpio_put(LED_G, 0);
-            gpio_put(LED_B, 1);
-            sleep_ms(1000);
-            gpio_put(LED_R, 0);
-            gpio_put(LED_G, 0);
-            gpio_put(LED_B, 0);
-            sleep_ms(1000);
+            // pisca led na cor roxa enquanto houver erro de montagem
+            if (erro_montagem)
+                feedback_led_piscar(COR_ROXO, 1000, 1000, 0);
+            else
+                feedback_led_parar();
+            erro_sinalizado = erro_montagem;
         }
 
-        int cRxedChar = getchar_timeout_us(0);
+        // Durante um download a entrada da USB são os ACKs do PC
+        int cRxedChar = transferencia_ativa() ? PICO_ERROR_TIMEOUT : getchar_timeout_us(0);
+        if (stream_ativo && PICO_ERROR_TIMEOUT != cRxedChar)
+        {
+            // Durante a transmissão, qualquer tecla apenas encerra
+            stream_parar();
+            cRxedChar = PICO_ERROR_TIMEOUT;
+        }
+        stream_tarefa();
+        transferencia_tarefa();
+        adc_tarefa();
         if (PICO_ERROR_TIMEOUT != cRxedChar)
         {
-            printf("[DEBUG] main: Caractere recebido=%c (0x%02X)\n", isprint(cRxedChar) ? cRxedChar : '.', cRxedChar);
-            processar_stdio(cRxedChar);
+            LOG_DEBUG("main: Caractere recebido=%c (0x%02X)\n", isprint(cRxedChar) ? cRxedChar : '.', cRxedChar);
+            cRxedChar = processar_stdio(cRxedChar);
         }
 
         if (cRxedChar == 'a')
         {
             flag_montar = !flag_montar;
             flag_desmontar = true;
-            printf("\nflag_montar=%d, flag_desmontar=%d\n", flag_montar, flag_desmontar);
-            printf("\nMontando o SD...\n");
-            run_mount();
-            printf("\nEscolha o comando (h = ajuda):  ");
-            for (int i = 0; i < 2; i++)
-            {
-                gpio_put(LED_R, 1);
-                gpio_put(LED_G, 1);
-                gpio_put(LED_B, 0);
-
-                sleep_ms(200);
-
-                sleep_ms(200);
-            }
-            gpio_put(LED_R, 0);
-            gpio_put(LED_G, 0);
-            gpio_put(LED_B, 0);
-            flag_desmontar = false;
+            console_printf("\nflag_montar=%d, flag_desmontar=%d\n", flag_montar, flag_desmontar);
+            montar_sd_com_feedback();
         }
         else if (cRxedChar == 'b')
         {
-            printf("\nflag_montar=%d, flag_desmontar=%d\n", flag_montar, flag_desmontar);
-            printf("\nDesmontando o SD...\n");
-            run_unmount();
-            printf("\nEscolha o comando (h = ajuda):  ");
-            for (int i = 0; i < 4; i++)
-            {
-                gpio_put(LED_R, 1);
-                gpio_put(LED_G, 1);
-                gpio_put(LED_B, 0);
-
-                sleep_ms(500);
-
-                sleep_ms(500);
-            }
-            gpio_put(LED_R, 0);
-            gpio_put(LED_G, 0);
-            gpio_put(LED_B, 0);
-
-            flag_desmontar = false;
+            console_printf("\nflag_montar=%d, flag_desmontar=%d\n", flag_montar, flag_desmontar);
+            desmontar_sd_com_feedback();
         }
         else if (cRxedChar == 'c')
         {
-            printf("\nListagem de arquivos no cartão SD.\n");
+            console_printf("\nÚltimas sessões no cartão SD.\n");
             run_ls();
-            printf("\nEscolha o comando (h = ajuda):  ");
+            console_printf("\nEscolha o comando (h = ajuda):  ");
         }
         else if (cRxedChar == 'd')
         {
             ler_arquivo(nome_arquivo);
-            printf("Escolha o comando (h = ajuda):  ");
+            console_printf("Escolha o comando (h = ajuda):  ");
         }
         else if (cRxedChar == 'e')
         {
-            printf("\nObtendo espaço livre no SD.\n\n");
+            console_printf("\nObtendo espaço livre no SD.\n\n");
             run_getfree();
-            printf("\nEscolha o comando (h = ajuda):  ");
+            console_printf("\nEscolha o comando (h = ajuda):  ");
+        }
+        else if (cRxedChar == 'f')
+        {
+            adc_capturar(ADC_DURACAO_PADRAO_MS, 0, 0);
         }
         else if (cRxedChar == 'g')
         {
-            printf("\nProcesso de formatação do SD iniciado. Aguarde...\n");
+            console_printf("\nProcesso de formatação do SD iniciado. Aguarde...\n");
             run_format();
-            printf("\nEscolha o comando (h = ajuda):  ");
+            console_printf("\nEscolha o comando (h = ajuda):  ");
         }
         else if (cRxedChar == 'h')
         {
@@ -1315,7 +4769,7 @@ int main()
         }
         else if (cRxedChar == 'i')
         {
-            if (!sd_esta_montado("0:"))
+            if (!sd_esta_montado())
             {
                 run_iniciar();
             }
@@ -1323,45 +4777,48 @@ int main()
             {
                 flag_gravar = !flag_gravar;
                 flag_parar_gravar = true;
-                printf("\nIniciando captura de dados do MPU6050...\n");
-                for (int i = 0; i < 10; i++)
-                {
-                    gpio_put(LED_R, 0);
-                    gpio_put(LED_G, 0);
-                    gpio_put(LED_B, 1);
-                    sleep_ms(100);
-                    gpio_put(LED_B, 0);
-                    sleep_ms(100);
-                }
-                set_buzzer(1);
-                sleep_ms(200);
-                set_buzzer(0);
-
-                run_iniciar();
-
-                gpio_put(LED_R, 1);
-                gpio_put(LED_G, 0);
-                gpio_put(LED_B, 0);
-                flag_parar_gravar = false;
+                iniciar_captura_com_feedback();
             }
         }
 
-        if (logger_ativado)
+        if (logger_ativado && gatilho_sessao)
+        {
+            gatilho_tarefa();
+        }
+        else if (logger_ativado && espectro_sessao)
+        {
+            espectro_tarefa();
+        }
+        else if (logger_ativado && decimacao_sessao)
+        {
+            decimacao_tarefa();
+        }
+        else if (logger_ativado && adaptativo_sessao)
+        {
+            adaptativo_tarefa();
+        }
+        else if (logger_ativado)
         {
             int64_t diff = absolute_time_diff_us(get_absolute_time(), proxima_captura);
-            printf("[DEBUG] main: Verificando tempo: diff=%lld us\n", diff);
+            LOG_DEBUG("main: Verificando tempo: diff=%lld us\n", diff);
             if (diff <= 0)
             {
-                printf("[DEBUG] main: Tempo atingido, chamando capturar_dados_mpu6050_e_salvar...\n");
+                LOG_DEBUG("main: Tempo atingido, chamando capturar_dados_mpu6050_e_salvar...\n");
                 capturar_dados_mpu6050_e_salvar();
                 proxima_captura = delayed_by_ms(get_absolute_time(), PERIODO_MS);
-                printf("[DEBUG] main: proxima_captura atualizada\n");
+                LOG_DEBUG("main: proxima_captura atualizada\n");
             }
+            // Sem temporizador, os passos dos sensores ambientais rodam aqui
+            if (logger_ativado && sensores_sessao)
+                sensores_executar(&sensores, time_us_64(), SENSORES_LACO_US);
         }
 
         // Atualiza o display com a data e hora se o timeout da mensagem expirou
         int64_t diff_display = absolute_time_diff_us(get_absolute_time(), ultima_atualizacao_display);
-        if (diff_display <= 0 && absolute_time_diff_us(get_absolute_time(), mensagem_timeout) <= 0)
+        feedback_tarefa();
+        grafico_tarefa();
+        ssd1306_poll(&ssd);
+        if (diff_display <= 0 && !feedback_mensagem_ativa() && !grafico_ativo())
         {
             exibir_data_hora();
             ultima_atualizacao_display = delayed_by_ms(get_absolute_time(), DISPLAY_UPDATE_MS);
@@ -1374,114 +4831,54 @@ int main()
 
         if (flag_montar && flag_desmontar)
         {
-            printf("\nflag_montar=%d, flag_desmontar=%d\n", flag_montar, flag_desmontar);
-            printf("\nMontando o SD...\n");
-            run_mount();
-            printf("\nEscolha o comando (h = ajuda):  ");
-            for (int i = 0; i < 2; i++)
-            {
-                gpio_put(LED_R, 1);
-                gpio_put(LED_G, 1);
-                gpio_put(LED_B, 0);
-                sleep_ms(200);
-            }
-            gpio_put(LED_R, 0);
-            gpio_put(LED_G, 0);
-            gpio_put(LED_B, 0);
-            flag_desmontar = false;
+            console_printf("\nflag_montar=%d, flag_desmontar=%d\n", flag_montar, flag_desmontar);
+            montar_sd_com_feedback();
         }
 
         // desmontar o sd
         else if (!flag_montar && flag_desmontar)
         {
-            printf("\nflag_montar=%d, flag_desmontar=%d\n", flag_montar, flag_desmontar);
-            printf("\nDesmontando o SD...\n");
-            run_unmount();
-            printf("\nEscolha o comando (h = ajuda):  ");
-            for (int i = 0; i < 4; i++)
-            {
-                gpio_put(LED_R, 1);
-                gpio_put(LED_G, 1);
-                gpio_put(LED_B, 0);
-                sleep_ms(500);
-                sleep_ms(500);
-            }
-            gpio_put(LED_R, 0);
-            gpio_put(LED_G, 0);
-            gpio_put(LED_B, 0);
-
-            flag_desmontar = false;
+            console_printf("\nflag_montar=%d, flag_desmontar=%d\n", flag_montar, flag_desmontar);
+            desmontar_sd_com_feedback();
         }
 
-        if (flag_gravar && flag_parar_gravar && !sd_esta_montado("0:"))
+        if (flag_gravar && flag_parar_gravar && !sd_esta_montado())
         {
-            ssd1306_fill(&ssd, false);
-            ssd1306_draw_string(&ssd, "Erro ", 30, 0);
-            ssd1306_draw_string(&ssd, "SDCARD", 30, 10);
-            ssd1306_draw_string(&ssd, "NOT MOUNT   ", 30, 20);
-            ssd1306_send_data(&ssd);
-            sleep_ms(2000);
+            feedback_mensagem("Erro\nSDCARD\nNOT MOUNT", 2000);
             flag_parar_gravar = false;
             // flag_gravar = 0;
         }
         else
         {
-            if (flag_gravar && flag_parar_gravar && sd_esta_montado("0:"))
-            {
-                printf("\nIniciando captura de dados do MPU6050...\n");
-                for (int i = 0; i < 10; i++)
-                {
-                    gpio_put(LED_R, 0);
-                    gpio_put(LED_G, 0);
-                    gpio_put(LED_B, 1);
-                    sleep_ms(100);
-                    gpio_put(LED_B, 0);
-                    sleep_ms(100);
-                }
-
-                set_buzzer(1);
-                sleep_ms(200);
-                set_buzzer(0);
-                run_iniciar();
-
-                gpio_put(LED_R, 1);
-                gpio_put(LED_G, 0);
-                gpio_put(LED_B, 0);
-                flag_parar_gravar = false;
-            }
-            else
+            if (flag_gravar && flag_parar_gravar && sd_esta_montado())
             {
-                // flag_gravar = 0;
+                iniciar_captura_com_feedback();
             }
 
-            if (!flag_gravar && flag_parar_gravar && sd_esta_montado("0:"))
-            {
-                flag_parar_gravar = false;
-                contador_amostras = 10000000;
-                gpio_put(LED_R, 0);
-                gpio_put(LED_G, 0);
-                gpio_put(LED_B, 0);
-                set_buzzer(1);
-                sleep_ms(200);
-                set_buzzer(0);
-                sleep_ms(200);
-                set_buzzer(1);
-                sleep_ms(200);
-                set_buzzer(0);
-            }
-            else
+            if (!flag_gravar && flag_parar_gravar && sd_esta_montado())
             {
+                parar_captura_com_feedback();
             }
         }
 
-        if (sd_esta_montado("0:") && flag_gravar == 0)
+        if (sd_esta_montado() && flag_gravar == 0 && !stream_ativo)
+        {
+            feedback_led_fixo(COR_VERDE);
+        }
+
+        // Texto do console e contagem do espaço livre só entre os modos
+        // binários da USB
+        if (!stream_ativo && !transferencia_ativa())
         {
-            gpio_put(LED_R, 0);
-            gpio_put(LED_G, 1);
-            gpio_put(LED_B, 0);
+            console_tarefa();
+            espaco_tarefa();
         }
 
-        sleep_ms(50);
+        // Na transmissão ao vivo, no download e nas capturas que não são a
+        // periódica o laço não dorme
+        if (!stream_ativo && !transferencia_ativa() && !adc_gravando &&
+            !(logger_ativado && (gatilho_sessao || espectro_sessao || decimacao_sessao || adaptativo_sessao)))
+            sleep_ms(50);
     }
     return 0;
 }
\ No newline at end of file
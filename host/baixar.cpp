@@ -0,0 +1,217 @@
+// Cliente do comando "baixar": copia um arquivo do cartão SD para o PC
+// pelos quadros binários de lib/protocolo.h, com confirmação por janela e
+// retomada. Se o arquivo de destino já existe, continua de onde parou.
+//
+// Uso: baixar <porta> <arquivo_no_cartao> [destino]
+//   porta    ex.: /dev/ttyACM0
+//   destino  padrão: mesmo nome do arquivo no cartão
+
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "quadros.hpp"
+#include "serial.hpp"
+
+static volatile sig_atomic_t interrompido = 0;
+
+static void ao_interromper(int)
+{
+    interrompido = 1;
+}
+
+static void enviar(Serial &serial, uint8_t tipo, uint64_t offset)
+{
+    static uint32_t seq = 0;
+    uint8_t quadro[PROTOCOLO_EXTRA + sizeof(protocolo_arq_ack_t)];
+    protocolo_arq_ack_t ack{offset};
+    size_t n = protocolo_montar(quadro, tipo, seq++, &ack, tipo == PROTOCOLO_TIPO_ARQ_CANCELAR ? 0 : sizeof(ack));
+    serial.escrever(quadro, n);
+}
+
+static const char *descrever_erro(int32_t codigo)
+{
+    switch (codigo)
+    {
+    case PROTOCOLO_ERRO_TIMEOUT:
+        return "a placa não recebeu confirmações";
+    case PROTOCOLO_ERRO_CANCELADO:
+        return "cancelado";
+    case 4: // FR_NO_FILE
+        return "arquivo não encontrado";
+    default:
+        return "erro do FatFs";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "Uso: %s <porta> <arquivo_no_cartao> [destino]\n", argv[0]);
+        return 2;
+    }
+    const char *porta = argv[1];
+    const std::string remoto = argv[2];
+    const std::string destino = argc > 3 ? argv[3] : remoto;
+
+    // Retomada: reaproveita o que já foi baixado, alinhado ao setor
+    uint64_t offset = 0;
+    struct stat st;
+    if (stat(destino.c_str(), &st) == 0)
+        offset = (uint64_t)st.st_size & ~(uint64_t)511;
+
+    FILE *saida = fopen(destino.c_str(), offset ? "r+b" : "wb");
+    if (!saida)
+    {
+        perror(destino.c_str());
+        return 1;
+    }
+    if (offset && (ftruncate(fileno(saida), (off_t)offset) != 0 || fseeko(saida, (off_t)offset, SEEK_SET) != 0))
+    {
+        perror(destino.c_str());
+        return 1;
+    }
+
+    Serial serial(porta);
+    if (!serial.aberta())
+        return 1;
+    signal(SIGINT, ao_interromper);
+    serial.escrever("baixar " + remoto + " " + std::to_string(offset) + "\r");
+
+    using relogio = std::chrono::steady_clock;
+    auto inicio = relogio::now();
+    auto ultimo_dado = inicio;
+    auto ultimo_nack = relogio::time_point{};
+    auto ultimo_progresso = inicio;
+    auto ultimo_ack_repetido = inicio;
+    bool iniciado = false, terminou = false, cancelado = false;
+    int codigo = 0;
+    uint64_t tamanho = 0, esperado = offset, inicial = offset;
+    uint64_t nack_offset = UINT64_MAX;
+    protocolo_arq_fim_t fim{};
+
+    DecodificadorQuadros dec;
+    static uint8_t buf[16384];
+    while (!terminou)
+    {
+        auto agora = relogio::now();
+        if (interrompido && !cancelado)
+        {
+            enviar(serial, PROTOCOLO_TIPO_ARQ_CANCELAR, 0);
+            cancelado = true;
+            ultimo_dado = agora;
+        }
+        if (agora - ultimo_dado > std::chrono::seconds(cancelado ? 2 : (iniciado ? 12 : 5)))
+        {
+            fprintf(stderr, "\nSem resposta da placa\n");
+            codigo = PROTOCOLO_ERRO_TIMEOUT;
+            break;
+        }
+        // Quadros de ACK perdidos: repete a confirmação para destravar a janela
+        if (iniciado && !cancelado && agora - ultimo_dado > std::chrono::milliseconds(300) &&
+            agora - ultimo_ack_repetido > std::chrono::milliseconds(300))
+        {
+            enviar(serial, PROTOCOLO_TIPO_ARQ_ACK, esperado);
+            ultimo_ack_repetido = agora;
+        }
+
+        ssize_t n = serial.ler(buf, sizeof(buf), 50);
+        if (n < 0)
+        {
+            fprintf(stderr, "\nPorta serial fechada\n");
+            codigo = PROTOCOLO_ERRO_TIMEOUT;
+            break;
+        }
+        if (n > 0)
+            ultimo_dado = agora;
+        dec.alimentar(buf, (size_t)n);
+
+        Quadro q;
+        while (dec.proximo(q))
+        {
+            if (q.tipo == PROTOCOLO_TIPO_ARQ_INICIO)
+            {
+                protocolo_arq_inicio_t ini;
+                if (!q.como(ini))
+                    continue;
+                tamanho = ini.tamanho;
+                esperado = inicial = ini.offset;
+                iniciado = true;
+                inicio = relogio::now();
+                printf("%s: %llu bytes, a partir de %llu (janela %u, blocos de %u)\n", remoto.c_str(),
+                       (unsigned long long)tamanho, (unsigned long long)esperado, (unsigned)ini.janela,
+                       (unsigned)ini.bloco);
+                if (esperado < offset && ftruncate(fileno(saida), (off_t)esperado) == 0)
+                    fseeko(saida, (off_t)esperado, SEEK_SET);
+            }
+            else if (q.tipo == PROTOCOLO_TIPO_ARQ_BLOCO && iniciado)
+            {
+                protocolo_arq_bloco_t b;
+                if (q.carga.size() < sizeof(b))
+                    continue;
+                memcpy(&b, q.carga.data(), sizeof(b));
+                size_t len = q.carga.size() - sizeof(b);
+                if (b.offset == esperado)
+                {
+                    fwrite(q.carga.data() + sizeof(b), 1, len, saida);
+                    esperado += len;
+                    nack_offset = UINT64_MAX;
+                    enviar(serial, PROTOCOLO_TIPO_ARQ_ACK, esperado);
+                }
+                else if (b.offset > esperado)
+                {
+                    // Faltou um bloco: pede reenvio uma vez por lacuna; os
+                    // blocos já em trânsito depois dele são descartados
+                    if (nack_offset != esperado || agora - ultimo_nack > std::chrono::milliseconds(500))
+                    {
+                        enviar(serial, PROTOCOLO_TIPO_ARQ_NACK, esperado);
+                        nack_offset = esperado;
+                        ultimo_nack = agora;
+                    }
+                }
+            }
+            else if (q.tipo == PROTOCOLO_TIPO_ARQ_FIM)
+            {
+                q.como(fim);
+                terminou = true;
+            }
+            else if (q.tipo == PROTOCOLO_TIPO_ARQ_ERRO)
+            {
+                protocolo_arq_erro_t e{};
+                q.como(e);
+                codigo = e.codigo;
+                terminou = true;
+            }
+        }
+
+        if (iniciado && agora - ultimo_progresso > std::chrono::milliseconds(500))
+        {
+            double s = std::chrono::duration<double>(agora - inicio).count();
+            printf("\r%6.1f%%  %8.1f KiB/s", tamanho ? 100.0 * esperado / tamanho : 100.0,
+                   s > 0 ? (esperado - inicial) / 1024.0 / s : 0.0);
+            fflush(stdout);
+            ultimo_progresso = agora;
+        }
+    }
+    fclose(saida);
+
+    double s = std::chrono::duration<double>(relogio::now() - inicio).count();
+    printf("\r%llu de %llu bytes em %.2f s (%.1f KiB/s)\n", (unsigned long long)esperado,
+           (unsigned long long)tamanho, s, s > 0 ? (esperado - inicial) / 1024.0 / s : 0.0);
+    printf("Quadros com CRC inválido: %llu, blocos reenviados pela placa: %u\n",
+           (unsigned long long)dec.erros_crc, (unsigned)fim.retransmissoes);
+    if (codigo != 0)
+    {
+        fprintf(stderr, "Transferência interrompida: %s (%d). Execute de novo para retomar.\n",
+                descrever_erro(codigo), (int)codigo);
+        return 1;
+    }
+    return esperado == tamanho ? 0 : 1;
+}
@@ -0,0 +1,251 @@
+// Benchmark do perfil de formatação (lib/formato.c) contra a escolha
+// automática do f_mkfs, usando o FatFs do firmware sobre uma imagem de disco
+// no PC. Conta os comandos e setores que chegariam ao cartão e estima o
+// tempo com um modelo simples de SD em SPI:
+//   tempo = gravações * latência + leituras * acesso + setores * 512 * 8 / clock
+//           + trocas de AU * penalidade
+// Uma "troca de AU" é uma gravação numa unidade de apagamento (4 MiB) que
+// não está entre as duas usadas por último: como pede a especificação de
+// classes de velocidade, o cartão mantém abertas a AU da FAT e a dos dados,
+// e qualquer outra obriga a fechar uma delas.
+//
+// Cargas:
+//   registro   o laço de captura do firmware: abre, acrescenta uma linha de
+//              ~80 bytes, f_sync, fecha; uma entrada no .idx a cada 128
+//   sequencial blocos de 4 KiB num arquivo grande (vazão sustentada)
+//
+// Uso: bench_formato [imagem] [tamanhos_MiB...]   (padrão: 256 1024 8192)
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+extern "C" {
+#include "ff.h"
+#include "diskio.h"
+#include "formato.h"
+}
+
+static const uint32_t AU_SETORES = 8192;  // 4 MiB
+static const double LATENCIA_US = 800.0;   // ocupado após cada comando de escrita
+static const double ACESSO_US = 100.0;     // até o primeiro dado de uma leitura
+static const double CLOCK_SPI = 25e6;
+static const double PENALIDADE_AU_US = 3000.0;
+
+static int imagem = -1;
+static uint64_t setores_imagem;
+
+struct Contadores
+{
+    uint64_t escritas, setores_escritos, leituras, setores_lidos, trocas_au;
+    uint64_t au_aberta[2]; // [0] = usada por último
+};
+static Contadores cont;
+
+static void zerar()
+{
+    cont = Contadores{};
+    cont.au_aberta[0] = cont.au_aberta[1] = UINT64_MAX;
+}
+
+static double tempo_modelo_s(const Contadores &c)
+{
+    double us = c.escritas * LATENCIA_US + c.leituras * ACESSO_US +
+                (c.setores_escritos + c.setores_lidos) * 512 * 8 / CLOCK_SPI * 1e6 +
+                c.trocas_au * PENALIDADE_AU_US;
+    return us / 1e6;
+}
+
+extern "C" DSTATUS disk_initialize(BYTE) { return 0; }
+extern "C" DSTATUS disk_status(BYTE) { return 0; }
+
+extern "C" DRESULT disk_read(BYTE, BYTE *b, LBA_t s, UINT n)
+{
+    cont.leituras++;
+    cont.setores_lidos += n;
+    return pread(imagem, b, (size_t)n * 512, (off_t)s * 512) == (ssize_t)n * 512 ? RES_OK : RES_ERROR;
+}
+
+extern "C" DRESULT disk_write(BYTE, const BYTE *b, LBA_t s, UINT n)
+{
+    cont.escritas++;
+    cont.setores_escritos += n;
+    for (uint64_t au = s / AU_SETORES; au <= (s + n - 1) / AU_SETORES; au++)
+    {
+        if (au == cont.au_aberta[0])
+            continue;
+        if (au != cont.au_aberta[1])
+            cont.trocas_au++;
+        cont.au_aberta[1] = cont.au_aberta[0];
+        cont.au_aberta[0] = au;
+    }
+    return pwrite(imagem, b, (size_t)n * 512, (off_t)s * 512) == (ssize_t)n * 512 ? RES_OK : RES_ERROR;
+}
+
+extern "C" DRESULT disk_ioctl(BYTE, BYTE cmd, void *buf)
+{
+    switch (cmd)
+    {
+    case GET_SECTOR_COUNT:
+        *(LBA_t *)buf = setores_imagem;
+        return RES_OK;
+    case GET_BLOCK_SIZE:
+        *(DWORD *)buf = 1; // como o driver SPI (lib/FatFs_SPI/src/glue.c)
+        return RES_OK;
+    case CTRL_SYNC:
+        return RES_OK;
+    }
+    return RES_PARERR;
+}
+
+extern "C" DWORD get_fattime(void) { return (45u << 25) | (7u << 21) | (29u << 16) | (13u << 11); }
+
+struct Resultado
+{
+    const char *tipo;
+    uint32_t cluster_kib;
+    uint64_t inicio_dados;
+    Contadores mkfs;
+    double mkfs_ms;
+    Contadores registro;
+    Contadores sequencial;
+};
+
+static const int AMOSTRAS = 20000;
+static const uint32_t SEQUENCIAL_MIB = 64;
+
+static bool medir(const MKFS_PARM *parametros, UINT buffer, Resultado &r)
+{
+    static FATFS fs;
+    std::vector<uint8_t> trabalho(buffer);
+    zerar();
+    auto t0 = std::chrono::steady_clock::now();
+    FRESULT fr = f_mkfs("", parametros, trabalho.data(), buffer);
+    auto t1 = std::chrono::steady_clock::now();
+    if (FR_OK != fr)
+    {
+        fprintf(stderr, "f_mkfs: %d\n", fr);
+        return false;
+    }
+    r.mkfs = cont;
+    r.mkfs_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    if (FR_OK != f_mount(&fs, "", 1))
+        return false;
+    r.tipo = formato_nome_tipo(fs.fs_type);
+    r.cluster_kib = fs.csize / 2;
+    r.inicio_dados = fs.database;
+
+    // Laço de captura do firmware (Cartao_CSV.c)
+    zerar();
+    FIL f;
+    UINT bw;
+    f_open(&f, "dados.csv", FA_WRITE | FA_CREATE_ALWAYS);
+    const char *cabecalho = "Data,Hora,Amostra,AccX,AccY,AccZ,GyroX,GyroY,GyroZ,Temperatura,Tempo_ms\n";
+    f_write(&f, cabecalho, strlen(cabecalho), &bw);
+    f_close(&f);
+    f_open(&f, "dados.idx", FA_WRITE | FA_CREATE_ALWAYS);
+    f_write(&f, "IDX1\x80\0\x0c\0\0\0\0\0", 12, &bw);
+    f_close(&f);
+    for (int i = 1; i <= AMOSTRAS; i++)
+    {
+        char linha[128];
+        int n = snprintf(linha, sizeof(linha), "29/07/25,13:%02d:%02d,%d,%d,%d,%d,%d,%d,%d,%.2f,%d\n", i / 60 % 60,
+                         i % 60, i, -1234 + i % 97, 456 - i % 31, 16384 - i % 7, 12, -34, 56, 31.25, i * 1000);
+        if (FR_OK != f_open(&f, "dados.csv", FA_WRITE | FA_OPEN_APPEND))
+            return false;
+        FSIZE_t offset = f_tell(&f);
+        if ((i - 1) % 128 == 0)
+        {
+            FIL idx;
+            uint32_t entrada[3] = {(uint32_t)i, (uint32_t)i * 1000, (uint32_t)offset};
+            f_open(&idx, "dados.idx", FA_WRITE | FA_OPEN_APPEND);
+            f_write(&idx, entrada, sizeof(entrada), &bw);
+            f_close(&idx);
+        }
+        f_write(&f, linha, n, &bw);
+        f_sync(&f);
+        f_close(&f);
+    }
+    r.registro = cont;
+
+    // Vazão sustentada
+    zerar();
+    static uint8_t bloco[4096];
+    f_open(&f, "grande.bin", FA_WRITE | FA_CREATE_ALWAYS);
+    for (uint32_t i = 0; i < SEQUENCIAL_MIB * 256; i++)
+    {
+        bloco[0] = (uint8_t)i;
+        if (FR_OK != f_write(&f, bloco, sizeof(bloco), &bw) || bw != sizeof(bloco))
+            return false;
+    }
+    f_close(&f);
+    r.sequencial = cont;
+    f_unmount("");
+    return true;
+}
+
+static void imprimir(const char *nome, const Resultado &r)
+{
+    uint64_t alinhamento = 1;
+    while (alinhamento < AU_SETORES && r.inicio_dados % (alinhamento * 2) == 0)
+        alinhamento *= 2;
+    printf("  %-9s %-5s cluster %3u KiB, dados no setor %8llu (alinhados a %llu KiB)\n", nome, r.tipo,
+           r.cluster_kib, (unsigned long long)r.inicio_dados, (unsigned long long)alinhamento / 2);
+    printf("    f_mkfs:     %6llu gravacoes, %8llu setores, modelo %7.2f s, PC %6.1f ms\n",
+           (unsigned long long)r.mkfs.escritas, (unsigned long long)r.mkfs.setores_escritos, tempo_modelo_s(r.mkfs),
+           r.mkfs_ms);
+    printf("    registro:   %6llu gravacoes, %6llu leituras, %5llu trocas de AU, modelo %6.2f ms/amostra\n",
+           (unsigned long long)r.registro.escritas, (unsigned long long)r.registro.leituras,
+           (unsigned long long)r.registro.trocas_au, tempo_modelo_s(r.registro) * 1000 / AMOSTRAS);
+    double s = tempo_modelo_s(r.sequencial);
+    printf("    sequencial: %6llu gravacoes, %6llu leituras, %5llu trocas de AU, modelo %6.0f KiB/s\n",
+           (unsigned long long)r.sequencial.escritas, (unsigned long long)r.sequencial.leituras,
+           (unsigned long long)r.sequencial.trocas_au, SEQUENCIAL_MIB * 1024 / s);
+}
+
+int main(int argc, char **argv)
+{
+    const char *caminho = argc > 1 ? argv[1] : "bench_formato.img";
+    std::vector<uint64_t> tamanhos;
+    for (int i = 2; i < argc; i++)
+        tamanhos.push_back(strtoull(argv[i], nullptr, 10));
+    if (tamanhos.empty())
+        tamanhos = {256, 1024, 8192};
+
+    printf("Modelo: %.0f us por gravacao, %.0f us por leitura, SPI a %.0f MHz, %.0f us por troca de AU de 4 MiB\n",
+           LATENCIA_US, ACESSO_US, CLOCK_SPI / 1e6, PENALIDADE_AU_US);
+    printf("Cargas: %d amostras do laco de captura; %u MiB em blocos de 4 KiB\n", AMOSTRAS, SEQUENCIAL_MIB);
+    for (uint64_t mib : tamanhos)
+    {
+        // Imagem esparsa: só os setores gravados ocupam o disco do PC
+        imagem = open(caminho, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (imagem < 0 || ftruncate(imagem, (off_t)(mib << 20)) != 0)
+        {
+            perror(caminho);
+            return 2;
+        }
+        setores_imagem = mib * 2048;
+
+        formato_perfil_t perfil;
+        formato_perfil_registro(setores_imagem, &perfil);
+        printf("\nImagem de %llu MiB\n", (unsigned long long)mib);
+        Resultado padrao{}, registro{};
+        // Chamada anterior do firmware: f_mkfs(arg1, 0, 0, FF_MAX_SS * 2)
+        if (!medir(nullptr, FF_MAX_SS * 2, padrao) || !medir(&perfil.parametros, FORMATO_BUFFER, registro))
+        {
+            fprintf(stderr, "falha na imagem de %llu MiB\n", (unsigned long long)mib);
+            return 1;
+        }
+        imprimir("padrao", padrao);
+        imprimir("registro", registro);
+        printf("    -> %s\n", perfil.descricao);
+        close(imagem);
+    }
+    unlink(caminho);
+    return 0;
+}
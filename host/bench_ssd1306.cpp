@@ -0,0 +1,213 @@
+// Benchmark do driver SSD1306 no PC: tempo para compor um quadro e bytes
+// enviados pelo I2C, comparando com a implementação anterior (pixel a pixel
+// e envio do framebuffer inteiro a cada atualização). Antes de medir,
+// confere que os dois desenham exatamente o mesmo quadro.
+//
+// Uso: bench_ssd1306 [iteracoes]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include "ssd1306.h"
+#include "font.h"
+}
+
+static uint64_t bytes_i2c = 0;
+static uint64_t transacoes_i2c = 0;
+
+// Conta bytes no barramento: endereço + dados de cada transação
+extern "C" int i2c_write_blocking(i2c_inst_t *, uint8_t, const uint8_t *, size_t len, bool)
+{
+    bytes_i2c += len + 1;
+    transacoes_i2c++;
+    return (int)len;
+}
+
+// ---------------------------------------------------------------------------
+// Referência: algoritmo anterior (endereçamento vertical, pixel a pixel)
+
+struct legado_t
+{
+    uint8_t buf[128 * 8 + 1];
+};
+
+static void legado_pixel(legado_t *d, uint8_t x, uint8_t y, bool v)
+{
+    uint16_t index = (y >> 3) + (x << 3) + 1;
+    uint8_t pixel = (y & 0b111);
+    if (v)
+        d->buf[index] |= (1 << pixel);
+    else
+        d->buf[index] &= ~(1 << pixel);
+}
+
+static void legado_fill(legado_t *d, bool v)
+{
+    for (uint8_t y = 0; y < 64; ++y)
+        for (uint8_t x = 0; x < 128; ++x)
+            legado_pixel(d, x, y, v);
+}
+
+static void legado_draw_string(legado_t *d, const char *s, uint8_t x, uint8_t y)
+{
+    while (*s)
+    {
+        char c = *s++;
+        uint16_t index = (c >= ' ' && c <= '~') ? (c - ' ') * 8 : 0;
+        for (uint8_t i = 0; i < 8; ++i)
+        {
+            uint8_t line = font[index + i];
+            for (uint8_t j = 0; j < 8; ++j)
+                legado_pixel(d, x + i, y + j, line & (1 << j));
+        }
+        x += 8;
+        if (x + 8 >= 128)
+        {
+            x = 0;
+            y += 8;
+        }
+        if (y + 8 >= 64)
+            break;
+    }
+}
+
+// Framebuffer legado (coluna a coluna) no endereçamento horizontal do
+// driver novo: página a página, 128 bytes por página
+static void legado_em_paginas(const legado_t *d, uint8_t *paginas)
+{
+    for (int pagina = 0; pagina < 8; pagina++)
+        for (int x = 0; x < 128; x++)
+            paginas[pagina * 128 + x] = d->buf[1 + (x << 3) + pagina];
+}
+
+static void legado_send(legado_t *d)
+{
+    for (int i = 0; i < 6; i++)
+        i2c_write_blocking(nullptr, 0x3C, d->buf, 2, false);
+    i2c_write_blocking(nullptr, 0x3C, d->buf, sizeof(d->buf), false);
+}
+
+// ---------------------------------------------------------------------------
+// Quadro típico: a tela de repouso de exibir_data_hora()
+
+// Três inteiros de até 11 caracteres, dois separadores e o '\0'
+#define TEXTO_HORA 40
+
+static void hora(char *data, char *hora_str, int segundo)
+{
+    snprintf(data, TEXTO_HORA, "%02d/%02d/%02d", 29, 7, 25);
+    snprintf(hora_str, TEXTO_HORA, "%02d:%02d:%02d", 13, segundo / 60, segundo % 60);
+}
+
+static void compor_novo(ssd1306_t *ssd, int segundo)
+{
+    char d[TEXTO_HORA], h[TEXTO_HORA];
+    hora(d, h, segundo);
+    ssd1306_fill(ssd, false);
+    ssd1306_draw_string(ssd, d, 5, 0);
+    ssd1306_draw_string(ssd, h, 5, 10);
+    ssd1306_draw_string(ssd, "Pronto para ", 30, 30);
+    ssd1306_draw_string(ssd, "Iniciar", 30, 40);
+    ssd1306_draw_string(ssd, "Captura", 30, 50);
+}
+
+static void compor_legado(legado_t *d, int segundo)
+{
+    char ds[TEXTO_HORA], h[TEXTO_HORA];
+    hora(ds, h, segundo);
+    legado_fill(d, false);
+    legado_draw_string(d, ds, 5, 0);
+    legado_draw_string(d, h, 5, 10);
+    legado_draw_string(d, "Pronto para ", 30, 30);
+    legado_draw_string(d, "Iniciar", 30, 40);
+    legado_draw_string(d, "Captura", 30, 50);
+}
+
+template <typename F>
+static double ns_por_iteracao(int iteracoes, F f)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iteracoes; i++)
+        f(i);
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / iteracoes;
+}
+
+int main(int argc, char **argv)
+{
+    int iteracoes = argc > 1 ? atoi(argv[1]) : 20000;
+
+    ssd1306_t ssd;
+    ssd1306_init(&ssd, 128, 64, false, 0x3C, nullptr);
+    legado_t legado;
+    memset(legado.buf, 0, sizeof(legado.buf));
+    legado.buf[0] = 0x40;
+
+    // Os dois caminhos precisam produzir o mesmo framebuffer em todos os
+    // quadros medidos
+    const int quadros = 240;
+    uint8_t paginas[128 * 8];
+    for (int i = 0; i < quadros; i++)
+    {
+        compor_legado(&legado, i);
+        compor_novo(&ssd, i);
+        legado_em_paginas(&legado, paginas);
+        if (memcmp(paginas, &ssd.ram_buffer[1], sizeof(paginas)) != 0)
+        {
+            fprintf(stderr, "Quadro %d: framebuffer novo difere do legado\n", i);
+            return 1;
+        }
+    }
+    printf("Framebuffers iguais em %d quadros\n\n", quadros);
+
+    // Consome o framebuffer para o compilador não eliminar a composição
+    volatile uint8_t sorvedouro = 0;
+    double ns_legado = ns_por_iteracao(iteracoes, [&](int i) {
+        compor_legado(&legado, i);
+        sorvedouro += legado.buf[1 + (i & 1023)];
+    });
+    double ns_novo = ns_por_iteracao(iteracoes, [&](int i) {
+        compor_novo(&ssd, i);
+        sorvedouro += ssd.ram_buffer[1 + (i & 1023)];
+    });
+
+    printf("Composicao do quadro (tela de repouso), %d iteracoes\n", iteracoes);
+    printf("  legado (pixel a pixel): %10.1f ns/quadro\n", ns_legado);
+    printf("  novo (bytes/colunas):   %10.1f ns/quadro  (%.1fx)\n", ns_novo, ns_legado / ns_novo);
+
+    // Bytes no I2C: 2 atualizações por segundo durante 2 minutos, como no
+    // laço principal (DISPLAY_UPDATE_MS = 500)
+    const int atualizacoes = quadros;
+    bytes_i2c = transacoes_i2c = 0;
+    for (int i = 0; i < atualizacoes; i++)
+    {
+        compor_legado(&legado, i / 2);
+        legado_send(&legado);
+    }
+    uint64_t bytes_legado = bytes_i2c, trans_legado = transacoes_i2c;
+
+    ssd1306_invalidate(&ssd);
+    bytes_i2c = transacoes_i2c = 0;
+    for (int i = 0; i < atualizacoes; i++)
+    {
+        compor_novo(&ssd, i / 2);
+        ssd1306_send_data(&ssd);
+    }
+    uint64_t bytes_novo = bytes_i2c, trans_novo = transacoes_i2c;
+
+    // Tempo de barramento a 400 kHz: ~9 bits por byte
+    const double us_por_byte = 9.0 / 400000.0 * 1e6;
+    printf("\nTransferencia I2C, %d atualizacoes (2 min de relogio)\n", atualizacoes);
+    printf("  legado: %8llu bytes em %5llu transacoes, %6.1f ms/atualizacao\n",
+           (unsigned long long)bytes_legado, (unsigned long long)trans_legado,
+           bytes_legado * us_por_byte / 1000.0 / atualizacoes);
+    printf("  novo:   %8llu bytes em %5llu transacoes, %6.1f ms/atualizacao\n",
+           (unsigned long long)bytes_novo, (unsigned long long)trans_novo,
+           bytes_novo * us_por_byte / 1000.0 / atualizacoes);
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Lê a captura binária do comando "adc" (adcDDMMAAAAHHMMSS.bin, formato em
+// lib/adc_dma.h): confere o cabeçalho e a numeração dos blocos, mostra as
+// lacunas (blocos descartados pela placa com o anel cheio) e mínimo, máximo
+// e média das amostras. Com um segundo argumento grava um CSV com o
+// instante de cada amostra, calculado pelo número do bloco.
+//
+// Uso: ler_adc <adcX.bin> [saida.csv]
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "adc_dma.h"
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Uso: %s <adcX.bin> [saida.csv]\n", argv[0]);
+        return 2;
+    }
+    FILE *in = fopen(argv[1], "rb");
+    if (!in)
+    {
+        fprintf(stderr, "Nao foi possivel abrir %s\n", argv[1]);
+        return 1;
+    }
+    uint8_t setor[ADC_DMA_CABECALHO_BYTES] = {};
+    adc_dma_arquivo_t c;
+    size_t n_setor = fread(setor, 1, sizeof(setor), in);
+    memcpy(&c, setor, sizeof(c));
+    if (n_setor != sizeof(setor) || memcmp(c.assinatura, "ADC1", 4) != 0 || c.tamanho != sizeof(c) ||
+        c.bloco_bytes != ADC_DMA_BLOCO_BYTES || c.amostras_por_bloco != ADC_DMA_AMOSTRAS_POR_BLOCO || c.ciclos == 0)
+    {
+        fprintf(stderr, "%s: cabecalho invalido\n", argv[1]);
+        return 1;
+    }
+    double taxa = (double)c.relogio_hz / c.ciclos;
+    printf("Canal %u, %.2f Hz (%u ciclos), %u ms pedidos, %u blocos previstos de %u amostras\n", c.canal, taxa,
+           c.ciclos, c.duracao_ms, c.blocos_previstos, c.amostras_por_bloco);
+    if (c.completo)
+        printf("Placa: %u blocos gravados, %u perdidos com o anel cheio, %u transbordos da FIFO\n",
+               c.blocos_gravados, c.blocos_perdidos, c.transbordos_fifo);
+    else
+        printf("Captura nao foi fechada (falta de energia ou cartao removido): contagens da placa ausentes\n");
+
+    FILE *out = nullptr;
+    if (argc > 2)
+    {
+        out = fopen(argv[2], "w");
+        if (!out)
+        {
+            fprintf(stderr, "Nao foi possivel criar %s\n", argv[2]);
+            return 1;
+        }
+        fprintf(out, "Amostra,Tempo_us,Valor\n");
+    }
+
+    std::vector<uint8_t> bloco(ADC_DMA_BLOCO_BYTES);
+    uint32_t lidos = 0, lacunas = 0, faltando = 0, invalidos = 0;
+    int64_t esperado = 0;
+    uint16_t minimo = UINT16_MAX, maximo = 0;
+    double soma = 0;
+    uint64_t amostras = 0;
+    while (fread(bloco.data(), 1, bloco.size(), in) == bloco.size())
+    {
+        adc_dma_bloco_t b;
+        memcpy(&b, bloco.data(), sizeof(b));
+        if (b.marca != ADC_DMA_MARCA || b.amostras != ADC_DMA_AMOSTRAS_POR_BLOCO || b.numero < esperado)
+        {
+            invalidos++;
+            continue;
+        }
+        if (b.numero > esperado)
+        {
+            printf("  lacuna: blocos %lld a %u (%.1f ms)\n", (long long)esperado, b.numero - 1,
+                   (b.numero - esperado) * ADC_DMA_AMOSTRAS_POR_BLOCO * 1000.0 / taxa);
+            lacunas++;
+            faltando += (uint32_t)(b.numero - esperado);
+        }
+        esperado = (int64_t)b.numero + 1;
+        lidos++;
+        const uint8_t *p = bloco.data() + sizeof(b);
+        for (uint32_t i = 0; i < b.amostras; i++)
+        {
+            uint16_t v = (uint16_t)(p[2 * i] | p[2 * i + 1] << 8);
+            minimo = std::min(minimo, v);
+            maximo = std::max(maximo, v);
+            soma += v;
+            if (out)
+            {
+                uint64_t n = (uint64_t)b.numero * ADC_DMA_AMOSTRAS_POR_BLOCO + i;
+                fprintf(out, "%llu,%.2f,%u\n", (unsigned long long)n, n * 1e6 * c.ciclos / c.relogio_hz, v);
+            }
+        }
+        amostras += b.amostras;
+    }
+    fclose(in);
+    if (out)
+        fclose(out);
+
+    printf("%u blocos lidos, %u lacuna(s) somando %u bloco(s), %u bloco(s) invalidos\n", lidos, lacunas, faltando,
+           invalidos);
+    if (amostras)
+        printf("%llu amostras: min %u, max %u, media %.2f (%.4f V com 3,3 V de referencia)\n",
+               (unsigned long long)amostras, minimo, maximo, soma / amostras, soma / amostras * 3.3 / 4096);
+    bool ok = invalidos == 0 && (!c.completo || (lidos == c.blocos_gravados && faltando <= c.blocos_perdidos));
+    printf("%s\n", ok ? "OK" : "DIVERGENTE");
+    return ok ? 0 : 1;
+}
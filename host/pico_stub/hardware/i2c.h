@@ -0,0 +1,20 @@
+// Substituto do hardware/i2c.h: as transferências são implementadas pela
+// ferramenta que linka o driver (ex.: contadores de bytes nos benchmarks)
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+#include "pico/stdlib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct i2c_inst i2c_inst_t;
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,18 @@
+// Substituto do hardware/sync.h: as barreiras são implementadas pela
+// ferramenta que linka o módulo (ex.: simular o outro núcleo no meio de
+// uma leitura)
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void __dmb(void);
+void __sev(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,14 @@
+// Substituto mínimo do pico/stdlib.h para compilar drivers da pasta lib no PC
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef unsigned int uint;
+
+static inline void tight_loop_contents(void) {}
+
+#endif
@@ -0,0 +1,98 @@
+// Decodificador dos quadros binários de lib/protocolo.h, para as
+// ferramentas do PC. Bytes fora de quadro (texto do console) são pulados;
+// quadros com CRC inválido são descartados e contados.
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "protocolo.h"
+}
+
+struct Quadro
+{
+    uint8_t tipo = 0;
+    uint32_t seq = 0;
+    std::vector<uint8_t> carga;
+
+    template <typename T>
+    bool como(T &destino) const
+    {
+        if (carga.size() != sizeof(T))
+            return false;
+        memcpy(&destino, carga.data(), sizeof(T));
+        return true;
+    }
+};
+
+class DecodificadorQuadros
+{
+public:
+    uint64_t erros_crc = 0;
+    uint64_t bytes_ignorados = 0;
+
+    void alimentar(const uint8_t *dados, size_t len)
+    {
+        buf_.insert(buf_.end(), dados, dados + len);
+    }
+
+    // Extrai o próximo quadro válido, se já houver um completo no buffer
+    bool proximo(Quadro &q)
+    {
+        for (;;)
+        {
+            size_t i = inicio_;
+            while (i + 1 < buf_.size() && !(buf_[i] == PROTOCOLO_SYNC0 && buf_[i + 1] == PROTOCOLO_SYNC1))
+                i++;
+            bytes_ignorados += i - inicio_;
+            inicio_ = i;
+            compactar();
+
+            size_t disp = buf_.size() - inicio_;
+            if (disp < PROTOCOLO_CABECALHO)
+                return false;
+            const uint8_t *h = buf_.data() + inicio_;
+            uint16_t tamanho = (uint16_t)(h[3] | (h[4] << 8));
+            if (tamanho > PROTOCOLO_MAX_CARGA)
+            {
+                // Falso sincronismo: procura o próximo a partir do byte seguinte
+                inicio_++;
+                bytes_ignorados++;
+                continue;
+            }
+            size_t total = PROTOCOLO_EXTRA + tamanho;
+            if (disp < total)
+                return false;
+
+            uint16_t crc = protocolo_crc16(h + 2, PROTOCOLO_CABECALHO - 2 + tamanho, 0xFFFF);
+            uint16_t recebido = (uint16_t)(h[total - 2] | (h[total - 1] << 8));
+            if (crc != recebido)
+            {
+                erros_crc++;
+                inicio_++;
+                bytes_ignorados++;
+                continue;
+            }
+            q.tipo = h[2];
+            q.seq = (uint32_t)h[5] | ((uint32_t)h[6] << 8) | ((uint32_t)h[7] << 16) | ((uint32_t)h[8] << 24);
+            q.carga.assign(h + PROTOCOLO_CABECALHO, h + PROTOCOLO_CABECALHO + tamanho);
+            inicio_ += total;
+            return true;
+        }
+    }
+
+private:
+    std::vector<uint8_t> buf_;
+    size_t inicio_ = 0;
+
+    void compactar()
+    {
+        if (inicio_ > 65536)
+        {
+            buf_.erase(buf_.begin(), buf_.begin() + (ptrdiff_t)inicio_);
+            inicio_ = 0;
+        }
+    }
+};
@@ -0,0 +1,141 @@
+// Receptor da transmissão ao vivo (comando "stream" do firmware): grava as
+// amostras em CSV e informa quadros perdidos (lacunas na sequência) e
+// corrompidos (CRC inválido).
+//
+// Uso: receptor_stream <porta> [periodo_us] [segundos] [saida.csv]
+//   porta       ex.: /dev/ttyACM0
+//   periodo_us  período de amostragem pedido à placa (padrão 1000)
+//   segundos    duração; 0 = até Ctrl+C (padrão 0)
+//   saida.csv   padrão: stream.csv
+
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "quadros.hpp"
+#include "serial.hpp"
+
+static volatile sig_atomic_t interrompido = 0;
+
+static void ao_interromper(int)
+{
+    interrompido = 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Uso: %s <porta> [periodo_us] [segundos] [saida.csv]\n", argv[0]);
+        return 2;
+    }
+    const char *porta = argv[1];
+    unsigned periodo_us = argc > 2 ? (unsigned)atoi(argv[2]) : 1000;
+    double segundos = argc > 3 ? atof(argv[3]) : 0.0;
+    const char *caminho_csv = argc > 4 ? argv[4] : "stream.csv";
+
+    Serial serial(porta);
+    if (!serial.aberta())
+        return 1;
+    FILE *csv = fopen(caminho_csv, "w");
+    if (!csv)
+    {
+        perror(caminho_csv);
+        return 1;
+    }
+    fprintf(csv, "Seq,Tempo_us,AccX,AccY,AccZ,GyroX,GyroY,GyroZ,Temperatura\n");
+
+    signal(SIGINT, ao_interromper);
+
+    // Só o '\r' confirma o comando: um '\n' logo depois encerraria a transmissão
+    serial.escrever("stream " + std::to_string(periodo_us) + "\r");
+
+    using relogio = std::chrono::steady_clock;
+    auto inicio = relogio::now();
+    auto fim_pedido = relogio::time_point::max();
+    bool iniciado = false, encerrado = false, parada_enviada = false;
+    bool tem_anterior = false;
+    uint32_t seq_anterior = 0;
+    uint64_t recebidos = 0, perdidos = 0;
+    protocolo_fim_t resumo{};
+    bool tem_resumo = false;
+
+    DecodificadorQuadros dec;
+    uint8_t buf[4096];
+    while (!encerrado)
+    {
+        auto agora = relogio::now();
+        bool tempo_esgotado = segundos > 0 && iniciado &&
+                              agora - inicio >= std::chrono::duration<double>(segundos);
+        if (!parada_enviada && (interrompido || tempo_esgotado))
+        {
+            serial.escrever("x", 1);
+            parada_enviada = true;
+            fim_pedido = agora;
+        }
+        // Sem o quadro de fim em 2 s, desiste (placa desconectada ou ocupada)
+        if (parada_enviada && agora - fim_pedido > std::chrono::seconds(2))
+            break;
+        if (!iniciado && agora - inicio > std::chrono::seconds(5))
+        {
+            fprintf(stderr, "A placa não iniciou a transmissão\n");
+            break;
+        }
+
+        ssize_t n = serial.ler(buf, sizeof(buf), 100);
+        if (n < 0)
+        {
+            fprintf(stderr, "Porta serial fechada\n");
+            break;
+        }
+        dec.alimentar(buf, (size_t)n);
+
+        Quadro q;
+        while (dec.proximo(q))
+        {
+            if (q.tipo == PROTOCOLO_TIPO_INICIO)
+            {
+                protocolo_inicio_t ini;
+                if (q.como(ini))
+                    printf("Transmissão iniciada: período %u us\n", (unsigned)ini.periodo_us);
+                iniciado = true;
+                inicio = relogio::now();
+                tem_anterior = false;
+            }
+            else if (q.tipo == PROTOCOLO_TIPO_AMOSTRA)
+            {
+                protocolo_amostra_t a;
+                if (!q.como(a))
+                    continue;
+                if (tem_anterior && q.seq != seq_anterior + 1)
+                    perdidos += (uint32_t)(q.seq - seq_anterior - 1);
+                seq_anterior = q.seq;
+                tem_anterior = true;
+                recebidos++;
+                fprintf(csv, "%u,%u,%d,%d,%d,%d,%d,%d,%d\n", (unsigned)q.seq, (unsigned)a.tempo_us,
+                        a.accel[0], a.accel[1], a.accel[2], a.gyro[0], a.gyro[1], a.gyro[2], a.temp);
+            }
+            else if (q.tipo == PROTOCOLO_TIPO_FIM)
+            {
+                tem_resumo = q.como(resumo);
+                encerrado = true;
+            }
+        }
+    }
+    fclose(csv);
+
+    double duracao = std::chrono::duration<double>(relogio::now() - inicio).count();
+    printf("Amostras recebidas: %llu em %.1f s (%.0f amostras/s) -> %s\n",
+           (unsigned long long)recebidos, duracao, duracao > 0 ? recebidos / duracao : 0.0, caminho_csv);
+    printf("Lacunas na sequência: %llu, quadros com CRC inválido: %llu\n",
+           (unsigned long long)perdidos, (unsigned long long)dec.erros_crc);
+    if (tem_resumo)
+        printf("Placa: %u enviados, %u descartados (USB cheia)\n",
+               (unsigned)resumo.enviados, (unsigned)resumo.perdidos);
+    else
+        printf("Quadro de fim não recebido\n");
+    return 0;
+}
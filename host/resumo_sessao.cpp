@@ -0,0 +1,104 @@
+// Mostra o registro de estatísticas (dadosX.est) gravado pela placa ao fim
+// de uma captura, sem ler os dados. Com o CSV da mesma sessão, recalcula
+// média e desvio dos eixos direto das amostras e compara.
+//
+// Uso: resumo_sessao <dadosX.est> [dadosX.csv]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "estatisticas.h"
+#include "mpu6050_escala.h"
+#include "registro_csv.h"
+
+static void imprimir(const estatisticas_t &e)
+{
+    int accel_faixa = e.accel_faixa & 3;
+    printf("%u amostras, periodo programado %u us, faixas +-%u g e +-%u graus/s\n", e.amostras, e.periodo_us,
+           mpu6050_accel_fundo_g[accel_faixa], mpu6050_giro_fundo_dps[e.giro_faixa & 3]);
+    printf("  Canal        min      max      media     desvio\n");
+    for (int c = 0; c < EST_CANAIS; c++)
+        printf("  %-6s %9d %8d %10.1f %10.1f\n", estatisticas_nomes[c], e.canal[c].min, e.canal[c].max,
+               estatisticas_media(&e, c), estatisticas_desvio(&e, c));
+    printf("  Pico |a|: %.0f (%.2f g em +-%u g) na amostra %u\n", estatisticas_pico_accel(&e),
+           estatisticas_pico_accel(&e) / mpu6050_accel_lsb_g[accel_faixa], mpu6050_accel_fundo_g[accel_faixa],
+           e.pico_amostra);
+    if (e.amostras > 1)
+        printf("  Intervalo: media %.1f us, %u a %u us, jitter %.1f us\n", estatisticas_intervalo_medio_us(&e),
+               e.intervalo_min_us, e.intervalo_max_us, estatisticas_jitter_us(&e));
+}
+
+// Referência em double a partir do CSV (só eixos: a temperatura do CSV já
+// foi convertida e arredondada)
+static bool comparar(const estatisticas_t &e, const char *caminho)
+{
+    std::ifstream in(caminho);
+    if (!in)
+    {
+        fprintf(stderr, "Nao foi possivel abrir %s\n", caminho);
+        return false;
+    }
+    double soma[6] = {}, soma_q[6] = {};
+    int32_t min[6], max[6];
+    uint32_t n = 0;
+    std::string linha;
+    while (std::getline(in, linha))
+    {
+        registro_csv_t r;
+        if (!registro_csv_ler(linha.c_str(), &r))
+            continue;
+        int32_t v[6] = {r.accel[0], r.accel[1], r.accel[2], r.gyro[0], r.gyro[1], r.gyro[2]};
+        for (int c = 0; c < 6; c++)
+        {
+            min[c] = n ? std::min(min[c], v[c]) : v[c];
+            max[c] = n ? std::max(max[c], v[c]) : v[c];
+            soma[c] += v[c];
+            soma_q[c] += (double)v[c] * v[c];
+        }
+        n++;
+    }
+    printf("\nConferencia com %s (%u amostras no CSV)\n", caminho, n);
+    bool ok = n == e.amostras;
+    for (int c = 0; c < 6 && n > 0; c++)
+    {
+        double media = soma[c] / n;
+        double desvio = std::sqrt(std::max(0.0, soma_q[c] / n - media * media));
+        double erro = std::max(std::fabs(media - estatisticas_media(&e, c)),
+                               std::fabs(desvio - estatisticas_desvio(&e, c)));
+        bool canal_ok = min[c] == e.canal[c].min && max[c] == e.canal[c].max && erro < 1e-6;
+        printf("  %-6s %s (maior erro %.3g)\n", estatisticas_nomes[c], canal_ok ? "OK" : "DIVERGENTE", erro);
+        ok = ok && canal_ok;
+    }
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Uso: %s <dadosX.est> [dadosX.csv]\n", argv[0]);
+        return 2;
+    }
+    estatisticas_t e;
+    FILE *f = fopen(argv[1], "rb");
+    if (!f)
+    {
+        perror(argv[1]);
+        return 2;
+    }
+    size_t lidos = fread(&e, 1, sizeof(e), f);
+    fclose(f);
+    if (lidos != sizeof(e) || !estatisticas_valida(&e))
+    {
+        fprintf(stderr, "%s: registro invalido ou corrompido\n", argv[1]);
+        return 1;
+    }
+    imprimir(e);
+    if (argc > 2)
+        return comparar(e, argv[2]) ? 0 : 1;
+    return 0;
+}
@@ -0,0 +1,85 @@
+// Porta serial (CDC USB da placa) em modo bruto, para as ferramentas do PC.
+// POSIX (Linux/macOS); a taxa é irrelevante na CDC USB.
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+class Serial
+{
+public:
+    explicit Serial(const char *caminho)
+    {
+        fd_ = ::open(caminho, O_RDWR | O_NOCTTY);
+        if (fd_ < 0)
+        {
+            fprintf(stderr, "Erro ao abrir %s: %s\n", caminho, strerror(errno));
+            return;
+        }
+        termios t{};
+        tcgetattr(fd_, &t);
+        cfmakeraw(&t);
+        t.c_cc[VMIN] = 0;
+        t.c_cc[VTIME] = 0;
+        tcsetattr(fd_, TCSANOW, &t);
+        tcflush(fd_, TCIOFLUSH);
+    }
+    ~Serial()
+    {
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+    Serial(const Serial &) = delete;
+    Serial &operator=(const Serial &) = delete;
+
+    bool aberta() const { return fd_ >= 0; }
+
+    bool escrever(const void *dados, size_t len)
+    {
+        const uint8_t *p = static_cast<const uint8_t *>(dados);
+        while (len > 0)
+        {
+            ssize_t n = ::write(fd_, p, len);
+            if (n < 0)
+            {
+                if (errno == EINTR || errno == EAGAIN)
+                    continue;
+                return false;
+            }
+            p += n;
+            len -= (size_t)n;
+        }
+        return true;
+    }
+
+    bool escrever(const std::string &s) { return escrever(s.data(), s.size()); }
+
+    // Lê o que houver, esperando no máximo 'timeout_ms'. Retorna 0 no
+    // timeout e -1 em erro (placa desconectada)
+    ssize_t ler(void *destino, size_t max, int timeout_ms)
+    {
+        pollfd p{fd_, POLLIN, 0};
+        int r = ::poll(&p, 1, timeout_ms);
+        if (r < 0)
+            return errno == EINTR ? 0 : -1;
+        if (r == 0)
+            return 0;
+        if (p.revents & (POLLERR | POLLHUP | POLLNVAL))
+            return -1;
+        ssize_t n = ::read(fd_, destino, max);
+        if (n < 0)
+            return errno == EINTR || errno == EAGAIN ? 0 : -1;
+        return n;
+    }
+
+private:
+    int fd_ = -1;
+};
@@ -0,0 +1,170 @@
+// Confere o agregador do firmware (lib/agregador.c) contra uma referência
+// em double calculada aqui, direto das amostras. Lê um CSV de captura do
+// cartão ou, sem arquivo, gera dados sintéticos com a mesma faixa do MPU6050.
+//
+// Uso: verificar_agregador <janela> [captura.csv] [resumo.csv]
+//   resumo.csv recebe a mesma saída do comando "exportar" da placa, para
+//   comparar com diff.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "agregador.h"
+#include "registro_csv.h"
+
+static const int CANAIS = 7;
+static const char *const nomes[CANAIS] = {"AccX", "AccY", "AccZ", "GyroX", "GyroY", "GyroZ", "Temp_x100"};
+
+struct Amostra
+{
+    uint32_t numero;
+    uint32_t tempo_ms;
+    int32_t valores[CANAIS];
+};
+
+static bool ler_csv(const char *caminho, std::vector<Amostra> &amostras)
+{
+    std::ifstream in(caminho);
+    if (!in)
+        return false;
+    std::string linha;
+    while (std::getline(in, linha))
+    {
+        registro_csv_t r;
+        if (!registro_csv_ler(linha.c_str(), &r))
+            continue;
+        amostras.push_back({r.amostra, r.tempo_ms,
+                            {r.accel[0], r.accel[1], r.accel[2], r.gyro[0], r.gyro[1], r.gyro[2],
+                             r.temp_centesimos}});
+    }
+    return true;
+}
+
+static void gerar(std::vector<Amostra> &amostras, int quantidade)
+{
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int32_t> bruto(-32768, 32767);
+    std::uniform_int_distribution<int32_t> temperatura(-4000, 8500);
+    for (int i = 0; i < quantidade; i++)
+    {
+        Amostra a{(uint32_t)i + 1, (uint32_t)i * 100, {}};
+        for (int c = 0; c < 6; c++)
+            a.valores[c] = bruto(rng);
+        a.valores[6] = temperatura(rng);
+        amostras.push_back(a);
+    }
+}
+
+struct Referencia
+{
+    int32_t min, max;
+    double media, rms;
+};
+
+// Cálculo direto, em double, sobre as amostras da janela
+static Referencia referencia(const std::vector<Amostra> &amostras, size_t inicio, size_t fim, int canal)
+{
+    Referencia r{INT32_MAX, INT32_MIN, 0, 0};
+    double soma = 0, soma_q = 0;
+    for (size_t i = inicio; i < fim; i++)
+    {
+        double v = amostras[i].valores[canal];
+        r.min = std::min(r.min, amostras[i].valores[canal]);
+        r.max = std::max(r.max, amostras[i].valores[canal]);
+        soma += v;
+        soma_q += v * v;
+    }
+    r.media = soma / (fim - inicio);
+    r.rms = std::sqrt(soma_q / (fim - inicio));
+    return r;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || atol(argv[1]) <= 0)
+    {
+        fprintf(stderr, "Uso: %s <janela> [captura.csv] [resumo.csv]\n", argv[0]);
+        return 2;
+    }
+    uint32_t janela = (uint32_t)atol(argv[1]);
+
+    std::vector<Amostra> amostras;
+    if (argc > 2)
+    {
+        if (!ler_csv(argv[2], amostras))
+        {
+            fprintf(stderr, "Nao foi possivel abrir %s\n", argv[2]);
+            return 2;
+        }
+    }
+    else
+    {
+        gerar(amostras, 100000);
+    }
+
+    FILE *resumo = nullptr;
+    char texto[400];
+    if (argc > 3)
+    {
+        resumo = fopen(argv[3], "w");
+        if (!resumo)
+        {
+            perror(argv[3]);
+            return 2;
+        }
+        agregador_formatar_cabecalho(nomes, CANAIS, texto, sizeof(texto));
+        fputs(texto, resumo);
+    }
+
+    agregador_t agregador;
+    agregador_iniciar(&agregador, CANAIS, janela);
+    agregador_janela_t j;
+    size_t inicio = 0, janelas = 0, falhas = 0;
+    double erro_media = 0, erro_rms = 0;
+
+    auto conferir = [&](size_t fim) {
+        if (j.primeira != amostras[inicio].numero || j.amostras != fim - inicio)
+            falhas++;
+        for (int c = 0; c < CANAIS; c++)
+        {
+            Referencia r = referencia(amostras, inicio, fim, c);
+            if (r.min != j.min[c] || r.max != j.max[c])
+                falhas++;
+            erro_media = std::max(erro_media, std::fabs(r.media - agregador_media(&j, c)));
+            erro_rms = std::max(erro_rms, std::fabs(r.rms - agregador_rms(&j, c)));
+        }
+        if (resumo)
+        {
+            agregador_formatar(&j, texto, sizeof(texto));
+            fputs(texto, resumo);
+        }
+        janelas++;
+        inicio = fim;
+    };
+
+    for (size_t i = 0; i < amostras.size(); i++)
+        if (agregador_adicionar(&agregador, amostras[i].valores, amostras[i].numero, amostras[i].tempo_ms, &j))
+            conferir(i + 1);
+    if (agregador_finalizar(&agregador, &j))
+        conferir(amostras.size());
+    if (resumo)
+        fclose(resumo);
+
+    printf("%zu amostras, %zu janelas de %u\n", amostras.size(), janelas, janela);
+    printf("  min/max divergentes: %zu\n", falhas);
+    printf("  maior erro da media: %.3g\n", erro_media);
+    printf("  maior erro do RMS:   %.3g\n", erro_rms);
+
+    // As somas do agregador são inteiras e exatas; a única diferença vem do
+    // arredondamento da divisão final
+    bool ok = falhas == 0 && erro_media < 1e-6 && erro_rms < 1e-6;
+    printf("%s\n", ok ? "OK" : "DIVERGENTE");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+// Confere a fila de amostras (lib/amostras.c) com o produtor dando a volta
+// no leitor:
+//   - com CAPACIDADE - 1 amostras pendentes, todas são lidas, sem perda;
+//   - com CAPACIDADE pendentes, a mais antiga está na posição que o
+//     produtor grava em seguida e sai como perdida, não como lida;
+//   - se o produtor grava a posição durante a cópia (simulado na barreira
+//     depois dela), a cópia é descartada e contada como perdida.
+//
+// Uso: verificar_amostras
+
+#include <cstdint>
+#include <cstdio>
+
+extern "C" {
+#include "amostras.h"
+}
+
+static uint32_t seq_publicada = 0;
+static int publicar_na_copia = 0; // amostras que o "outro núcleo" publica durante a cópia
+static bool publicando = false;
+
+static void publicar(int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        amostra_t a = {};
+        a.seq = ++seq_publicada;
+        a.tempo_us = a.seq;
+        publicando = true;
+        amostras_publicar(&a);
+        publicando = false;
+    }
+}
+
+// A barreira de amostras_ler() vem logo depois da cópia: publicar aqui é o
+// produtor gravando a posição enquanto o leitor ainda a copiava
+extern "C" void __dmb(void)
+{
+    if (publicando || !publicar_na_copia)
+        return;
+    int n = publicar_na_copia;
+    publicar_na_copia = 0;
+    publicar(n);
+}
+
+extern "C" void __sev(void) {}
+
+static bool ok = true;
+
+static void conferir(const char *caso, bool condicao)
+{
+    printf("  %-58s %s\n", caso, condicao ? "ok" : "FALHOU");
+    ok = ok && condicao;
+}
+
+// Lê tudo o que há; retorna quantas vieram e confere que a sequência é
+// contínua a partir de 'primeira'
+static uint32_t ler_tudo(amostras_leitor_t *leitor, uint32_t primeira, bool *continua)
+{
+    amostra_t a;
+    uint32_t lidas = 0;
+    *continua = true;
+    while (amostras_ler(leitor, &a))
+    {
+        if (a.seq != primeira + lidas || a.tempo_us != a.seq)
+            *continua = false;
+        lidas++;
+    }
+    return lidas;
+}
+
+static void reiniciar(amostras_leitor_t *leitor)
+{
+    amostras_limpar();
+    seq_publicada = 0;
+    amostras_leitor_iniciar(leitor);
+}
+
+int main()
+{
+    amostras_leitor_t leitor;
+    bool continua;
+    printf("Fila de amostras, capacidade %d\n", AMOSTRAS_CAPACIDADE);
+
+    reiniciar(&leitor);
+    publicar(AMOSTRAS_CAPACIDADE - 1);
+    uint32_t lidas = ler_tudo(&leitor, 1, &continua);
+    conferir("CAPACIDADE - 1 pendentes: todas lidas", lidas == AMOSTRAS_CAPACIDADE - 1 && continua);
+    conferir("CAPACIDADE - 1 pendentes: nenhuma perdida", leitor.perdidas == 0);
+
+    reiniciar(&leitor);
+    publicar(AMOSTRAS_CAPACIDADE);
+    lidas = ler_tudo(&leitor, 2, &continua);
+    conferir("CAPACIDADE pendentes: a mais antiga não é lida", lidas == AMOSTRAS_CAPACIDADE - 1 && continua);
+    conferir("CAPACIDADE pendentes: a mais antiga conta como perdida", leitor.perdidas == 1);
+
+    reiniciar(&leitor);
+    publicar(3 * AMOSTRAS_CAPACIDADE + 5);
+    lidas = ler_tudo(&leitor, 2 * AMOSTRAS_CAPACIDADE + 7, &continua);
+    conferir("várias voltas atrás: lê as CAPACIDADE - 1 mais novas", lidas == AMOSTRAS_CAPACIDADE - 1 && continua);
+    conferir("várias voltas atrás: perdidas somam o resto",
+             leitor.perdidas == 2 * AMOSTRAS_CAPACIDADE + 6);
+
+    // O leitor está no limite (CAPACIDADE - 1 atrás) e o produtor grava a
+    // posição dele no meio da cópia
+    reiniciar(&leitor);
+    publicar(AMOSTRAS_CAPACIDADE - 1);
+    publicar_na_copia = 1;
+    amostra_t a;
+    bool leu = amostras_ler(&leitor, &a);
+    conferir("produtor na posição durante a cópia: cópia descartada", leu && a.seq == 2);
+    conferir("produtor na posição durante a cópia: conta como perdida", leitor.perdidas == 1);
+    lidas = ler_tudo(&leitor, 3, &continua);
+    conferir("produtor na posição durante a cópia: o resto em ordem", lidas == AMOSTRAS_CAPACIDADE - 2 && continua);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+// Confere a calibração do firmware (lib/calibracao.c) com um MPU6050
+// sintético de offset, escala e bias conhecidos (±2 g, ±250 °/s, com ruído):
+//   - seis posições (cada eixo para cima e para baixo): offset e escala dos
+//     três eixos do acelerômetro e bias do giroscópio;
+//   - uma posição (placa deitada): bias e offset de X e Y;
+//   - calibracao_aplicar() em inteiros contra a mesma conta em double.
+// O tempo por amostra medido aqui é do PC: o custo na placa sai do comando
+// "calibrar bench".
+//
+// Uso: verificar_calibracao [amostras_por_posicao]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "calibracao.h"
+
+static const double UM_G = 16384;
+
+struct Sensor
+{
+    double offset[3] = {412, -287, 655};
+    double ganho[3] = {1.021, 0.974, 1.036}; // LSB lidos por LSB ideais
+    double bias[3] = {-37, 21, 9};
+    std::mt19937 rng{7};
+    std::normal_distribution<double> ruido_accel{0, 40}, ruido_giro{0, 3};
+
+    static int16_t saturar(double v)
+    {
+        return (int16_t)std::clamp(std::lround(v), -32768L, 32767L);
+    }
+
+    // Uma captura parada com a gravidade g (em g) no referencial do sensor
+    calibracao_janela_t janela(const double g[3], int amostras)
+    {
+        calibracao_janela_t j;
+        calibracao_janela_iniciar(&j);
+        for (int k = 0; k < amostras; k++)
+        {
+            int16_t accel[3], gyro[3];
+            for (int i = 0; i < 3; i++)
+            {
+                accel[i] = saturar(g[i] * UM_G * ganho[i] + offset[i] + ruido_accel(rng));
+                gyro[i] = saturar(bias[i] + ruido_giro(rng));
+            }
+            calibracao_janela_acumular(&j, accel, gyro);
+        }
+        return j;
+    }
+};
+
+// Resíduo de cada coeficiente estimado em relação ao sensor sintético
+static bool conferir(const char *nome, const calibracao_t &c, const Sensor &s, const bool eixos_escala[3],
+                     const bool eixos_offset[3])
+{
+    bool ok = true;
+    printf("%s\n", nome);
+    for (int i = 0; i < 3; i++)
+    {
+        double erro_bias = c.giro_bias[i] - s.bias[i];
+        printf("  eixo %c: bias %d (erro %+.1f LSB)", "XYZ"[i], c.giro_bias[i], erro_bias);
+        ok &= std::fabs(erro_bias) <= 1;
+        if (eixos_offset[i])
+        {
+            double erro_offset = c.accel_offset[i] - s.offset[i];
+            printf(", offset %d (erro %+.1f LSB)", c.accel_offset[i], erro_offset);
+            ok &= std::fabs(erro_offset) <= 5;
+        }
+        if (eixos_escala[i])
+        {
+            double escala = c.accel_escala[i] / (double)CALIBRACAO_UM;
+            double erro_ppm = (escala * s.ganho[i] - 1) * 1e6;
+            printf(", escala %.5f (erro %+.0f ppm)", escala, erro_ppm);
+            ok &= std::fabs(erro_ppm) <= 500;
+        }
+        printf("\n");
+    }
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    int amostras = argc > 1 ? atoi(argv[1]) : 1000;
+    if (amostras < 100)
+    {
+        fprintf(stderr, "Uso: %s [amostras_por_posicao >= 100]\n", argv[0]);
+        return 2;
+    }
+    bool ok = true;
+
+    // Seis posições, com a placa a até ~3° da vertical em cada uma
+    Sensor sensor;
+    calibracao_estimativa_t e;
+    calibracao_estimativa_iniciar(&e);
+    const double incl = 0.05;
+    const double poses[6][3] = {{1, incl, -incl}, {incl, 1, incl}, {-incl, incl, 1},
+                                {-1, -incl, incl}, {incl, -1, -incl}, {incl, -incl, -1}};
+    for (int p = 0; p < 6; p++)
+    {
+        double n = std::sqrt(poses[p][0] * poses[p][0] + poses[p][1] * poses[p][1] + poses[p][2] * poses[p][2]);
+        double g[3] = {poses[p][0] / n, poses[p][1] / n, poses[p][2] / n};
+        calibracao_janela_t j = sensor.janela(g, amostras);
+        int eixo = calibracao_estimativa_acrescentar(&e, &j, (uint16_t)UM_G);
+        // As posições seguem a numeração de calibracao_estimativa_acrescentar()
+        if (eixo != p)
+        {
+            printf("Posição %d: eixo %d detectado, esperado %d\n", p + 1, eixo, p);
+            ok = false;
+        }
+    }
+    calibracao_t seis;
+    calibracao_estimativa_resultado(&e, 250, 2, &seis);
+    calibracao_selar(&seis);
+    const bool todos[3] = {true, true, true};
+    ok &= conferir("Seis posições:", seis, sensor, todos, todos);
+    ok &= calibracao_valida(&seis);
+
+    // Placa deitada (Z para cima): Z fica com a escala nominal
+    Sensor deitada;
+    calibracao_estimativa_iniciar(&e);
+    const double g_z[3] = {0, 0, 1};
+    calibracao_janela_t j = deitada.janela(g_z, amostras);
+    ok &= calibracao_estimativa_acrescentar(&e, &j, (uint16_t)UM_G) == 2;
+    calibracao_t uma;
+    calibracao_estimativa_resultado(&e, 250, 2, &uma);
+    const bool nenhum[3] = {false, false, false}, xy[3] = {true, true, false};
+    ok &= conferir("Uma posição (Z para cima):", uma, deitada, nenhum, xy);
+
+    // Movimento: o desvio do giroscópio precisa denunciar a captura
+    calibracao_janela_t mexida;
+    calibracao_janela_iniciar(&mexida);
+    for (int k = 0; k < amostras; k++)
+    {
+        int16_t accel[3] = {0, 0, 16384};
+        int16_t gyro[3] = {(int16_t)(400 * std::sin(k * 0.05)), 0, 0};
+        calibracao_janela_acumular(&mexida, accel, gyro);
+    }
+    uint32_t agitacao_parada = calibracao_janela_agitacao(&j), agitacao_mexida = calibracao_janela_agitacao(&mexida);
+    printf("Desvio do giroscópio: parada %u LSB, em movimento %u LSB\n", agitacao_parada, agitacao_mexida);
+    ok &= agitacao_parada < 10 && agitacao_mexida > 100;
+
+    // Aplicação em inteiros contra double, em toda a faixa de entrada
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> bruto(-32768, 32767);
+    const int N = 1000000;
+    std::vector<int16_t> dados(6 * N);
+    for (auto &v : dados)
+        v = (int16_t)bruto(rng);
+    int max_erro = 0;
+    for (int k = 0; k < N; k++)
+    {
+        int16_t accel[3] = {dados[6 * k], dados[6 * k + 1], dados[6 * k + 2]};
+        int16_t gyro[3] = {dados[6 * k + 3], dados[6 * k + 4], dados[6 * k + 5]};
+        int16_t a0[3] = {accel[0], accel[1], accel[2]}, g0[3] = {gyro[0], gyro[1], gyro[2]};
+        calibracao_aplicar(&seis, accel, gyro);
+        for (int i = 0; i < 3; i++)
+        {
+            double ref_a = std::floor((a0[i] - seis.accel_offset[i]) * (double)seis.accel_escala[i] / CALIBRACAO_UM);
+            double ref_g = (double)g0[i] - seis.giro_bias[i];
+            int ea = std::abs(accel[i] - (int)std::clamp(ref_a, -32768.0, 32767.0));
+            int eg = std::abs(gyro[i] - (int)std::clamp(ref_g, -32768.0, 32767.0));
+            max_erro = std::max({max_erro, ea, eg});
+        }
+    }
+    printf("calibracao_aplicar x double: maior diferença %d LSB em %d amostras\n", max_erro, N);
+    ok &= max_erro <= 1;
+
+    // Tempo no PC, só para acompanhar regressões
+    volatile int32_t sorvedouro = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < N; k++)
+        calibracao_aplicar(&seis, &dados[6 * k], &dados[6 * k + 3]);
+    auto t1 = std::chrono::steady_clock::now();
+    sorvedouro = dados[0];
+    (void)sorvedouro;
+    printf("PC: %.2f ns por amostra\n", std::chrono::duration<double, std::nano>(t1 - t0).count() / N);
+
+    printf("%s\n", ok ? "OK" : "DIVERGENTE");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,249 @@
+// Confere a cadeia de decimação do firmware (lib/decimador.c) contra a
+// mesma cadeia em double: o CIC como N médias móveis de R amostras e o FIR
+// com os coeficientes já arredondados (Q14). Para cada configuração:
+//   - ruído e senos de fundo de escala nos sete canais: maior diferença
+//     entre a saída em ponto fixo e a referência (a saída inteira só pode
+//     errar pelo arredondamento);
+//   - ganho do firmware para senos na banda útil e para senos acima da
+//     Nyquist da saída (o que eles deixam passar como aliasing).
+//
+// Uso: verificar_decimador [taxa_entrada_hz]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "decimador.h"
+
+struct Caso
+{
+    const char *nome;
+    uint16_t r;
+    uint8_t n, m, taps;
+    std::vector<int16_t> fir; // vazio: projetado pelo firmware
+};
+
+// Referência em double, com as mesmas fases de decimação do firmware. O
+// CIC é feito como N somas móveis de R amostras, sem integradores que
+// crescem sem limite: com entradas inteiras as somas são exatas em double
+class Referencia
+{
+  public:
+    explicit Referencia(const decimador_config_t &c)
+        : c_(c), ordem_(c.cic_fator > 1 ? c.cic_ordem : 0),
+          janela_(DECIMADOR_CANAIS, std::vector<std::vector<double>>(ordem_, std::vector<double>(c.cic_fator, 0))),
+          soma_(DECIMADOR_CANAIS, std::vector<double>(ordem_, 0)),
+          hist_(DECIMADOR_CANAIS, std::vector<double>(std::max<int>(c.taps, 1), 0))
+    {
+        ganho_ = std::pow((double)c.cic_fator, ordem_);
+    }
+
+    bool acrescentar(const int16_t *x, double *y)
+    {
+        for (int ch = 0; ch < DECIMADOR_CANAIS; ch++)
+        {
+            double v = x[ch];
+            for (int k = 0; k < ordem_; k++)
+            {
+                double &antiga = janela_[ch][k][posicao_];
+                soma_[ch][k] += v - antiga;
+                antiga = v;
+                v = soma_[ch][k];
+            }
+        }
+        if (ordem_)
+            posicao_ = (posicao_ + 1) % c_.cic_fator;
+        if (++fase_cic_ < c_.cic_fator)
+            return false;
+        fase_cic_ = 0;
+        std::vector<double> v(DECIMADOR_CANAIS);
+        for (int ch = 0; ch < DECIMADOR_CANAIS; ch++)
+            v[ch] = (ordem_ ? soma_[ch][ordem_ - 1] : x[ch]) / ganho_;
+        if (c_.taps == 0)
+        {
+            std::copy(v.begin(), v.end(), y);
+            return true;
+        }
+        for (int ch = 0; ch < DECIMADOR_CANAIS; ch++)
+        {
+            hist_[ch].insert(hist_[ch].begin(), v[ch]);
+            hist_[ch].pop_back();
+        }
+        if (++fase_fir_ < c_.fir_fator)
+            return false;
+        fase_fir_ = 0;
+        for (int ch = 0; ch < DECIMADOR_CANAIS; ch++)
+        {
+            double s = 0;
+            for (int i = 0; i < c_.taps; i++)
+                s += hist_[ch][i] * c_.fir[i] / (double)DECIMADOR_UM_Q14;
+            y[ch] = s;
+        }
+        return true;
+    }
+
+  private:
+    decimador_config_t c_;
+    int ordem_;
+    double ganho_;
+    std::vector<std::vector<std::vector<double>>> janela_;
+    std::vector<std::vector<double>> soma_, hist_;
+    int posicao_ = 0, fase_cic_ = 0, fase_fir_ = 0;
+};
+
+static decimador_config_t montar(const Caso &caso)
+{
+    decimador_config_t c = {};
+    c.cic_fator = caso.r;
+    c.cic_ordem = caso.n;
+    c.fir_fator = caso.m;
+    if (caso.fir.empty())
+    {
+        if (caso.taps)
+            decimador_projetar_fir(&c, caso.taps);
+    }
+    else
+    {
+        c.taps = (uint8_t)caso.fir.size();
+        std::copy(caso.fir.begin(), caso.fir.end(), c.fir);
+    }
+    return c;
+}
+
+// Ganho (saída/entrada) para um cosseno de 'ciclos' por amostra de
+// entrada: amplitude da saída, depois do transitório, projetada em seno e
+// cosseno da mesma frequência (0 Hz: média)
+static double ganho_seno(const decimador_config_t &c, double ciclos, double amplitude)
+{
+    decimador_t d;
+    decimador_iniciar(&d, &c);
+    uint32_t fator = decimador_fator(&c);
+    uint32_t transitorio = (decimador_atraso_x2(&c) + 2 * fator) * 2;
+    int total = (int)(transitorio + std::max(4000.0, 40 * fator / std::max(ciclos, 1e-3)));
+    double sc = 0, ss = 0;
+    long k = 0;
+    for (int i = 0; i < total; i++)
+    {
+        int16_t x[DECIMADOR_CANAIS], y[DECIMADOR_CANAIS];
+        int16_t v = (int16_t)std::lround(amplitude * std::cos(2 * M_PI * ciclos * i));
+        std::fill(x, x + DECIMADOR_CANAIS, v);
+        if (decimador_acrescentar(&d, x, y) && (uint32_t)i > transitorio)
+        {
+            sc += y[0] * std::cos(2 * M_PI * ciclos * i);
+            ss += y[0] * std::sin(2 * M_PI * ciclos * i);
+            k++;
+        }
+    }
+    return (ciclos == 0 ? 1.0 : 2.0) * std::hypot(sc, ss) / k / amplitude;
+}
+
+int main(int argc, char **argv)
+{
+    double taxa = argc > 1 ? atof(argv[1]) : 1000;
+    if (taxa <= 0)
+    {
+        fprintf(stderr, "Uso: %s [taxa_entrada_hz]\n", argv[0]);
+        return 2;
+    }
+    const std::vector<Caso> casos = {
+        {"CIC 10x4 + FIR/2 (21)", 10, 4, 2, 21, {}},
+        {"CIC 16x4 + FIR (15)", 16, 4, 1, 15, {}},
+        {"CIC 5x3", 5, 3, 1, 0, {}},
+        {"FIR/4 (31)", 1, 0, 4, 31, {}},
+        {"CIC 8x2 + FIR/2 manual", 8, 2, 2, 0, {-512, 0, 4608, 8192, 4608, 0, -512}},
+    };
+    bool ok = true;
+    std::mt19937 rng(7);
+
+    for (const Caso &caso : casos)
+    {
+        decimador_config_t c = montar(caso);
+        const char *motivo;
+        if (!decimador_config_valida(&c, &motivo))
+        {
+            printf("%s: configuração recusada (%s)\n", caso.nome, motivo);
+            ok = false;
+            continue;
+        }
+        uint32_t fator = decimador_fator(&c);
+        double saida_hz = taxa / fator;
+        printf("\n%s: %.0f Hz -> %.2f Hz, atraso %.1f amostras de entrada\n", caso.nome, taxa, saida_hz,
+               decimador_atraso_x2(&c) / 2.0);
+        if (c.taps)
+        {
+            printf("  FIR:");
+            for (int i = 0; i < c.taps; i++)
+                printf(" %d", c.fir[i]);
+            printf("\n");
+        }
+
+        // Ponto fixo x double: ruído uniforme de fundo de escala num canal,
+        // senos e onda quadrada saturada nos outros
+        decimador_t d;
+        decimador_iniciar(&d, &c);
+        Referencia ref(c);
+        std::uniform_int_distribution<int> uniforme(-32768, 32767);
+        double max_erro = 0;
+        long saidas = 0, iguais = 0;
+        for (int i = 0; i < 200000; i++)
+        {
+            int16_t x[DECIMADOR_CANAIS], y[DECIMADOR_CANAIS];
+            x[0] = (int16_t)uniforme(rng);
+            x[1] = (int16_t)std::lround(32767 * std::sin(2 * M_PI * i * 0.0123));
+            x[2] = (int16_t)((i / 37) % 2 ? 32767 : -32768);
+            x[3] = (int16_t)std::lround(16384 + 3 * std::sin(2 * M_PI * i * 0.002));
+            x[4] = (int16_t)std::lround(8000 * std::sin(2 * M_PI * i * 0.31));
+            x[5] = (int16_t)(-32768);
+            x[6] = (int16_t)(uniforme(rng) / 256);
+            double yr[DECIMADOR_CANAIS];
+            bool sai = decimador_acrescentar(&d, x, y);
+            bool sai_ref = ref.acrescentar(x, yr);
+            if (sai != sai_ref)
+            {
+                printf("  fase de decimação diferente na entrada %d\n", i);
+                ok = false;
+                break;
+            }
+            if (!sai)
+                continue;
+            for (int ch = 0; ch < DECIMADOR_CANAIS; ch++)
+            {
+                double esperado = std::min(32767.0, std::max(-32768.0, yr[ch]));
+                double erro = std::fabs(y[ch] - esperado);
+                max_erro = std::max(max_erro, erro);
+                iguais += (y[ch] == std::lround(esperado));
+                saidas++;
+            }
+        }
+        printf("  ponto fixo x double: maior diferença %.3f LSB, %.2f%% iguais ao arredondamento\n", max_erro,
+               100.0 * iguais / saidas);
+        ok &= max_erro <= 0.51;
+
+        // Resposta: até 0,25 da taxa de saída é a banda útil; de 0,75 para
+        // cima o seno volta dentro dela como aliasing
+        printf("  Hz na entrada    ganho     (dB)\n");
+        double pior_banda = 0, pior_rejeicao = -1000;
+        for (double rel : {0.0, 0.1, 0.2, 0.25, 0.3, 0.4, 0.5, 0.75, 1.1, 1.75, 2.9})
+        {
+            double hz = rel * saida_hz;
+            if (hz >= taxa / 2)
+                break;
+            double g = ganho_seno(c, hz / taxa, 8000);
+            double db = 20 * std::log10(std::max(g, 1e-6));
+            printf("  %12.2f  %8.4f  %7.2f%s\n", hz, g, db, rel >= 0.75 ? "  (aliasing)" : "");
+            if (rel <= 0.25)
+                pior_banda = std::max(pior_banda, std::fabs(db));
+            else if (rel >= 0.75)
+                pior_rejeicao = std::max(pior_rejeicao, db);
+        }
+        printf("  até 0,25 da taxa de saída: desvio de até %.2f dB; de 0,75 para cima: no máximo %.1f dB\n",
+               pior_banda, pior_rejeicao);
+    }
+    printf("\n%s\n", ok ? "OK" : "DIVERGENTE");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+// Confere o espectro do firmware (lib/espectro.c) contra uma DFT em double
+// com a mesma janela de Hann, sobre um sinal sintético do eixo Z do
+// MPU6050 (±2 g): gravidade, três senos de frequência e amplitude
+// conhecidas e ruído. Para cada tamanho de janela informa:
+//   - a maior diferença de amplitude por bin entre ponto fixo e double;
+//   - o erro de frequência e de amplitude dos picos em relação aos senos;
+//   - o RMS da janela contra o calculado em double.
+// Um segundo sinal, com senos de poucos LSB, mede a faixa dinâmica. O tempo
+// por janela medido aqui é do PC: o custo na placa sai do comando
+// "espectro bench".
+//
+// Uso: verificar_espectro [taxa_hz]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "espectro.h"
+
+struct Seno
+{
+    double hz, amplitude;
+};
+
+static std::vector<int16_t> sintetizar(int n, double taxa, const std::vector<Seno> &senos, double ruido,
+                                       unsigned semente)
+{
+    std::mt19937 rng(semente);
+    std::normal_distribution<double> normal(0, ruido);
+    std::vector<int16_t> x(n);
+    for (int i = 0; i < n; i++)
+    {
+        double v = 16384 + normal(rng);
+        for (const Seno &s : senos)
+            v += s.amplitude * std::sin(2 * M_PI * s.hz * i / taxa + s.hz);
+        x[i] = (int16_t)std::clamp(std::lround(v), -32768L, 32767L);
+    }
+    return x;
+}
+
+// Amplitude por bin (LSB do seno equivalente), com a média inteira
+// arredondada como no firmware
+static std::vector<double> dft(const std::vector<int16_t> &x, double *rms)
+{
+    int n = (int)x.size();
+    long soma = 0;
+    for (int16_t v : x)
+        soma += v;
+    long media = soma >= 0 ? (soma + n / 2) / n : -((-soma + n / 2) / n);
+    double q = 0;
+    std::vector<double> d(n);
+    for (int i = 0; i < n; i++)
+    {
+        double v = x[i] - media;
+        q += v * v;
+        d[i] = v * (0.5 - 0.5 * std::cos(2 * M_PI * i / n));
+    }
+    *rms = std::sqrt(q / n);
+    std::vector<double> a(n / 2 + 1);
+    for (int k = 0; k <= n / 2; k++)
+    {
+        double re = 0, im = 0;
+        for (int i = 0; i < n; i++)
+        {
+            re += d[i] * std::cos(2 * M_PI * k * i / n);
+            im -= d[i] * std::sin(2 * M_PI * k * i / n);
+        }
+        a[k] = std::hypot(re, im) * (k == 0 || k == n / 2 ? 2.0 : 4.0) / n;
+    }
+    return a;
+}
+
+static espectro_t espectro;
+static espectro_resultado_t resultado;
+
+static void calcular(const std::vector<int16_t> &x, double taxa)
+{
+    int n = (int)x.size();
+    espectro_config_t config = {(uint16_t)n, 2, true};
+    espectro_iniciar(&espectro, &config);
+    espectro_calcular(&espectro, x.data(), 0, (uint64_t)std::llround((n - 1) * 1e6 / taxa), &resultado);
+}
+
+int main(int argc, char **argv)
+{
+    double taxa = argc > 1 ? atof(argv[1]) : 1000;
+    if (taxa <= 0)
+    {
+        fprintf(stderr, "Uso: %s [taxa_hz]\n", argv[0]);
+        return 2;
+    }
+    const std::vector<Seno> senos = {{taxa * 0.0473, 800}, {taxa * 0.123, 300}, {taxa * 0.3117, 60}};
+    const std::vector<Seno> fracos = {{taxa * 0.0473, 8}, {taxa * 0.123, 3}};
+    bool ok = true;
+
+    printf("%d Hz; senos de %.1f Hz (%.0f LSB), %.1f Hz (%.0f LSB) e %.1f Hz (%.0f LSB), ruído 5 LSB\n",
+           (int)taxa, senos[0].hz, senos[0].amplitude, senos[1].hz, senos[1].amplitude, senos[2].hz,
+           senos[2].amplitude);
+    printf("    n  bin x double  erro freq (Hz)  erro amp (%%)  RMS fixo/double  fracos (LSB)   PC us/janela\n");
+    for (int n = ESPECTRO_N_MIN; n <= ESPECTRO_N_MAX; n *= 2)
+    {
+        std::vector<int16_t> x = sintetizar(n, taxa, senos, 5, n);
+        double rms;
+        std::vector<double> ref = dft(x, &rms);
+        calcular(x, taxa);
+
+        double max_bin = 0;
+        for (int k = 0; k <= n / 2; k++)
+            max_bin = std::max(max_bin, std::fabs(resultado.amplitude[k] - ref[k]));
+
+        // Cada seno casado com o pico mais próximo
+        double erro_hz = 0, erro_amp = 0;
+        for (const Seno &s : senos)
+        {
+            const espectro_pico_t *melhor = nullptr;
+            for (const espectro_pico_t &p : resultado.picos)
+                if (p.amplitude && (!melhor || std::fabs(p.frequencia_chz / 100.0 - s.hz) <
+                                                   std::fabs(melhor->frequencia_chz / 100.0 - s.hz)))
+                    melhor = &p;
+            if (!melhor)
+            {
+                erro_hz = erro_amp = INFINITY;
+                break;
+            }
+            erro_hz = std::max(erro_hz, std::fabs(melhor->frequencia_chz / 100.0 - s.hz));
+            erro_amp = std::max(erro_amp, std::fabs(melhor->amplitude / s.amplitude - 1) * 100);
+        }
+        double resolucao = taxa / n;
+        int rms_fixo = resultado.rms;
+
+        std::vector<int16_t> y = sintetizar(n, taxa, fracos, 0.5, n + 1);
+        double rms_y;
+        std::vector<double> ref_y = dft(y, &rms_y);
+        calcular(y, taxa);
+        double max_fraco = 0;
+        for (int k = 0; k <= n / 2; k++)
+            max_fraco = std::max(max_fraco, std::fabs(resultado.amplitude[k] - ref_y[k]));
+
+        const int repeticoes = 2000;
+        calcular(x, taxa);
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeticoes; r++)
+            espectro_calcular(&espectro, x.data(), 0, (uint64_t)((n - 1) * 1e6 / taxa), &resultado);
+        auto t1 = std::chrono::steady_clock::now();
+
+        printf("%5d  %8.2f LSB  %8.3f (%4.2f bin)  %10.2f  %7d/%-8.1f  %8.2f  %12.2f\n", n, max_bin, erro_hz,
+               erro_hz / resolucao, erro_amp, rms_fixo, rms, max_fraco,
+               std::chrono::duration<double, std::micro>(t1 - t0).count() / repeticoes);
+
+        // Limites: amplitude por bin a 1% do maior seno, frequência a 0,1
+        // bin, amplitude do pico a 2% e RMS a 1 LSB
+        ok &= max_bin <= 8 && erro_hz / resolucao <= 0.1 && erro_amp <= 2 && std::fabs(rms_fixo - rms) <= 1 &&
+              max_fraco <= 1;
+    }
+    printf("%s\n", ok ? "OK" : "DIVERGENTE");
+    return ok ? 0 : 1;
+}
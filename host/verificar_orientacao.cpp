@@ -0,0 +1,221 @@
+// Confere o filtro de orientação do firmware (lib/orientacao.c) contra o
+// mesmo filtro em double e contra a orientação verdadeira de um movimento
+// simulado. O sensor sintético tem a escala do MPU6050 (±2 g, ±250 °/s),
+// ruído e acelerações lineares que o filtro precisa rejeitar.
+//
+// A inclinação (roll/pitch) é comparada com a verdadeira; a guinada não é
+// observável pela gravidade e só é comparada entre ponto fixo e double.
+// O tempo por amostra medido aqui é do PC: o custo na placa sai do comando
+// "orientacao bench".
+//
+// Uso: verificar_orientacao [taxa_hz] [segundos] [ganho_x1000]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "orientacao.h"
+
+struct Quat
+{
+    double w, x, y, z;
+};
+
+static Quat mult(const Quat &a, const Quat &b)
+{
+    return {a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z, a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+            a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x, a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w};
+}
+
+static Quat normalizar(Quat q)
+{
+    double n = std::sqrt(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+    return {q.w / n, q.x / n, q.y / n, q.z / n};
+}
+
+// Gravidade no referencial do sensor, com a mesma convenção do firmware
+static void gravidade(const Quat &q, double v[3])
+{
+    v[0] = 2 * (q.x * q.z - q.w * q.y);
+    v[1] = 2 * (q.w * q.x + q.y * q.z);
+    v[2] = q.w * q.w - q.x * q.x - q.y * q.y + q.z * q.z;
+}
+
+static double graus_entre(const double a[3], const double b[3])
+{
+    double c = (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]) /
+               std::sqrt((a[0] * a[0] + a[1] * a[1] + a[2] * a[2]) * (b[0] * b[0] + b[1] * b[1] + b[2] * b[2]));
+    return std::acos(std::clamp(c, -1.0, 1.0)) * 180 / M_PI;
+}
+
+static double graus_entre(const Quat &a, const Quat &b)
+{
+    double d = std::fabs(a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z);
+    return 2 * std::acos(std::min(1.0, d)) * 180 / M_PI;
+}
+
+// O mesmo algoritmo de lib/orientacao.c, em double
+struct Referencia
+{
+    Quat q{1, 0, 0, 0};
+    bool iniciado = false;
+    double kp;
+    double ultimo_s = 0;
+
+    void atualizar(const int16_t accel[3], const int16_t gyro[3], double t, double giro_rad_por_lsb)
+    {
+        double a[3] = {(double)accel[0], (double)accel[1], (double)accel[2]};
+        double norma = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+        bool ok = norma >= 16384 * 0.75 && norma <= 16384 * 1.25;
+        double n[3] = {a[0] / norma, a[1] / norma, a[2] / norma};
+        if (!iniciado)
+        {
+            if (!ok)
+                return;
+            q = n[2] < -0.999 ? Quat{0, 1, 0, 0} : normalizar({1 + n[2], n[1], -n[0], 0});
+            ultimo_s = t;
+            iniciado = true;
+            return;
+        }
+        double dt = t - ultimo_s;
+        ultimo_s = t;
+        double h[3];
+        for (int i = 0; i < 3; i++)
+            h[i] = gyro[i] * giro_rad_por_lsb * dt / 2;
+        if (ok)
+        {
+            double v[3];
+            gravidade(q, v);
+            double e[3] = {n[1] * v[2] - n[2] * v[1], n[2] * v[0] - n[0] * v[2], n[0] * v[1] - n[1] * v[0]};
+            double k = std::min(kp * dt / 2, 0.5);
+            for (int i = 0; i < 3; i++)
+                h[i] += e[i] * k;
+        }
+        for (int i = 0; i < 3; i++)
+            h[i] = std::clamp(h[i], -0.25, 0.25);
+        Quat d = mult(q, {0, h[0], h[1], h[2]});
+        q = {q.w + d.w, q.x + d.x, q.y + d.y, q.z + d.z};
+        // Mesma renormalização aproximada do firmware (um passo de Newton)
+        double fator = (3 - (q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z)) / 2;
+        q = {q.w * fator, q.x * fator, q.y * fator, q.z * fator};
+    }
+};
+
+int main(int argc, char **argv)
+{
+    double taxa = argc > 1 ? atof(argv[1]) : 1000;
+    double segundos = argc > 2 ? atof(argv[2]) : 60;
+    int ganho = argc > 3 ? atoi(argv[3]) : 1000;
+    if (taxa <= 0 || segundos <= 0 || ganho <= 0)
+    {
+        fprintf(stderr, "Uso: %s [taxa_hz] [segundos] [ganho_x1000]\n", argv[0]);
+        return 2;
+    }
+    const double giro_rad_por_lsb = 250 * M_PI / 180 / 32768;
+    const double dt = 1 / taxa;
+    const int amostras = (int)(segundos * taxa);
+
+    // Movimento: soma de senoides em cada eixo (até ~120 °/s), inclinação
+    // inicial de 30°, e trancos de 0,5 g a cada 5 s
+    std::mt19937 rng(42);
+    std::normal_distribution<double> ruido_accel(0, 40), ruido_giro(0, 3);
+    Quat verdade = normalizar({std::cos(M_PI / 12), std::sin(M_PI / 12), 0, 0});
+
+    struct Amostra
+    {
+        int16_t accel[3], gyro[3];
+        uint64_t tempo_us;
+        Quat verdade;
+    };
+    std::vector<Amostra> dados(amostras);
+    auto saturar = [](double v) { return (int16_t)std::clamp(std::lround(v), -32768L, 32767L); };
+    for (int k = 0; k < amostras; k++)
+    {
+        double t = k * dt;
+        double w[3] = {1.2 * std::sin(0.7 * t), 0.9 * std::sin(1.1 * t + 1), 0.6 * std::sin(0.3 * t + 2)};
+        // Verdade integrada em subpassos, com a rotação exata de cada um
+        const int sub = 10;
+        for (int s = 0; s < sub; s++)
+        {
+            double ang = std::sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]) * dt / sub;
+            if (ang > 0)
+            {
+                double f = std::sin(ang / 2) / (ang / (dt / sub));
+                verdade = normalizar(mult(verdade, {std::cos(ang / 2), w[0] * f, w[1] * f, w[2] * f}));
+            }
+        }
+        Amostra &a = dados[k];
+        a.verdade = verdade;
+        a.tempo_us = (uint64_t)std::llround(t * 1e6);
+        double g[3];
+        gravidade(verdade, g);
+        bool tranco = std::fmod(t, 5.0) < 0.2;
+        for (int i = 0; i < 3; i++)
+        {
+            a.accel[i] = saturar((g[i] + (tranco && i == 0 ? 0.5 : 0)) * 16384 + ruido_accel(rng));
+            a.gyro[i] = saturar(w[i] / giro_rad_por_lsb + ruido_giro(rng));
+        }
+    }
+
+    orientacao_config_t config = {250, 2, (uint16_t)ganho};
+    orientacao_t filtro;
+    orientacao_iniciar(&filtro, &config);
+    Referencia ref;
+    ref.kp = ganho / 1000.0;
+
+    double max_fixo = 0, soma_fixo = 0, max_double = 0, soma_double = 0, max_entre = 0, max_inclinacao = 0;
+    int comparadas = 0;
+    for (int k = 0; k < amostras; k++)
+    {
+        const Amostra &a = dados[k];
+        orientacao_atualizar(&filtro, a.accel, a.gyro, a.tempo_us);
+        ref.atualizar(a.accel, a.gyro, a.tempo_us * 1e-6, giro_rad_por_lsb);
+        // Descarta os 2 s iniciais de convergência
+        if (k * dt < 2)
+            continue;
+        Quat fixo{filtro.q[0] / (double)ORIENTACAO_UM, filtro.q[1] / (double)ORIENTACAO_UM,
+                  filtro.q[2] / (double)ORIENTACAO_UM, filtro.q[3] / (double)ORIENTACAO_UM};
+        double gv[3], gf[3], gd[3];
+        gravidade(a.verdade, gv);
+        gravidade(fixo, gf);
+        gravidade(ref.q, gd);
+        double ef = graus_entre(gf, gv), ed = graus_entre(gd, gv);
+        max_fixo = std::max(max_fixo, ef);
+        max_double = std::max(max_double, ed);
+        soma_fixo += ef;
+        soma_double += ed;
+        max_inclinacao = std::max(max_inclinacao, graus_entre(gf, gd));
+        max_entre = std::max(max_entre, graus_entre(fixo, ref.q));
+        comparadas++;
+    }
+
+    // Tempo no PC, só para acompanhar regressões: o custo no RP2040 sai do
+    // comando "orientacao bench" da placa
+    orientacao_iniciar(&filtro, &config);
+    volatile int32_t sorvedouro = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < amostras; k++)
+        orientacao_atualizar(&filtro, dados[k].accel, dados[k].gyro, dados[k].tempo_us);
+    auto t1 = std::chrono::steady_clock::now();
+    sorvedouro = filtro.q[0];
+    (void)sorvedouro;
+
+    printf("%d amostras a %.0f Hz, Kp %.3f\n", amostras, taxa, ganho / 1000.0);
+    printf("  erro de inclinacao, ponto fixo: medio %.3f, maximo %.3f graus\n", soma_fixo / comparadas, max_fixo);
+    printf("  erro de inclinacao, double:     medio %.3f, maximo %.3f graus\n", soma_double / comparadas,
+           max_double);
+    printf("  ponto fixo x double: inclinacao maximo %.4f, com guinada %.4f graus\n", max_inclinacao, max_entre);
+    printf("  PC: %.1f ns por amostra\n",
+           std::chrono::duration<double, std::nano>(t1 - t0).count() / amostras);
+
+    // O ponto fixo deve acompanhar a referência em double na inclinação; a
+    // guinada não tem correção e acumula o arredondamento como deriva
+    bool ok = max_inclinacao < 0.1;
+    printf("%s\n", ok ? "OK" : "DIVERGENTE");
+    return ok ? 0 : 1;
+}
@@ -758,6 +758,18 @@ uint64_t sd_sectors(sd_card_t *pSD) {
     sd_release(pSD);
     return sectors;
 }
+// CMD10, Response R2 (R1 byte + 16-byte block read).
+// Only valid on an initialized card: lets the caller check that the card in
+// the socket is still the one it initialized, without a full re-init.
+bool sd_read_cid(sd_card_t *pSD, uint8_t cid[16]) {
+    if (pSD->m_Status & (STA_NOINIT | STA_NODISK)) return false;
+    sd_acquire(pSD);
+    bool ok = sd_cmd(pSD, CMD10_SEND_CID, 0x0, false, 0) == 0x0 &&
+              sd_read_bytes(pSD, cid, 16) == 0;
+    sd_release(pSD);
+    if (!ok) DBG_PRINTF("Couldn't read CID from disk\r\n");
+    return ok;
+}
 
 // SPI function to wait till chip is ready and sends start token
 static bool sd_wait_token(sd_card_t *pSD, uint8_t token) {
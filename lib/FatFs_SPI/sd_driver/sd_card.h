@@ -89,6 +89,7 @@ struct sd_card_t {
 
 bool sd_card_detect(sd_card_t *pSD);
 uint64_t sd_sectors(sd_card_t *pSD);
+bool sd_read_cid(sd_card_t *pSD, uint8_t cid[16]);
 
 bool sd_init_driver();
 bool sd_card_detect(sd_card_t *sd_card_p);
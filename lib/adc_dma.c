@@ -0,0 +1,227 @@
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "adc_dma.h"
+
+// DMA_IRQ_0 fica com o driver do cartão (spi.c)
+#define ADC_DMA_IRQ DMA_IRQ_1
+
+// Blocos alinhados ao próprio tamanho: a escrita da DMA dá a volta dentro
+// do bloco (anel de endereços). Se a interrupção atrasar tanto que o canal
+// seja disparado de novo antes de receber o destino seguinte, ele estraga o
+// próprio bloco, e não a memória depois do anel
+static uint16_t blocos[ADC_DMA_BLOCOS][ADC_DMA_BLOCO_BYTES / sizeof(uint16_t)]
+    __attribute__((aligned(ADC_DMA_BLOCO_BYTES)));
+static uint16_t descarte; // destino fixo dos blocos sem espaço no anel
+
+static int canais[2] = {-1, -1};
+static dma_channel_config config_anel[2], config_descarte[2];
+static bool irq_instalada = false;
+
+// Cada canal converte um bloco por vez, alternando com o outro. Ao terminar
+// o bloco n, o canal recebe o destino do bloco n + 2 enquanto o outro já
+// preenche o n + 1
+static int8_t destino[2];     // posição no anel; -1: descarte
+static uint32_t numero[2];    // bloco que o canal está preenchendo
+static uint32_t total_blocos;
+static volatile bool convertendo = false;
+
+// Anel: posições reservadas pela interrupção na ordem dos blocos, cheias
+// quando o bloco termina e liberadas pelo laço principal
+static volatile uint32_t reservados, cheios, lidos;
+static volatile uint32_t produzidos, perdidos, transbordos, maior_ocupacao;
+
+static void adc_dma_encerrar(void)
+{
+    adc_run(false);
+    for (int c = 0; c < 2; c++)
+    {
+        // RP2040-E13: sem interrupção nem encadeamento antes do abort
+        dma_channel_set_irq1_enabled(canais[c], false);
+        channel_config_set_chain_to(&config_anel[c], canais[c]);
+        channel_config_set_chain_to(&config_descarte[c], canais[c]);
+        dma_channel_set_config(canais[c], destino[c] >= 0 ? &config_anel[c] : &config_descarte[c], false);
+    }
+    for (int c = 0; c < 2; c++)
+    {
+        dma_channel_abort(canais[c]);
+        dma_channel_acknowledge_irq1(canais[c]);
+    }
+    adc_fifo_drain();
+    convertendo = false;
+}
+
+// Próximo destino do canal 'c', que vai preencher o bloco numero[c]
+static void adc_dma_apontar(int c)
+{
+    if (numero[c] >= total_blocos)
+    {
+        // Depois do último: o canal só roda até a interrupção que encerra
+        destino[c] = -1;
+    }
+    else if (reservados - lidos < ADC_DMA_BLOCOS)
+    {
+        destino[c] = (int8_t)(reservados % ADC_DMA_BLOCOS);
+        reservados++;
+    }
+    else
+    {
+        destino[c] = -1;
+        perdidos++;
+    }
+    if (destino[c] >= 0)
+    {
+        dma_channel_set_config(canais[c], &config_anel[c], false);
+        dma_channel_set_write_addr(canais[c], &blocos[destino[c]][sizeof(adc_dma_bloco_t) / sizeof(uint16_t)],
+                                   false);
+    }
+    else
+    {
+        dma_channel_set_config(canais[c], &config_descarte[c], false);
+        dma_channel_set_write_addr(canais[c], &descarte, false);
+    }
+    dma_channel_set_trans_count(canais[c], ADC_DMA_AMOSTRAS_POR_BLOCO, false);
+}
+
+static void adc_dma_concluir(int c)
+{
+    if (adc_hw->fcs & ADC_FCS_OVER_BITS)
+    {
+        transbordos++;
+        hw_set_bits(&adc_hw->fcs, ADC_FCS_OVER_BITS); // escrever 1 limpa
+    }
+    if (destino[c] >= 0)
+    {
+        adc_dma_bloco_t *cabecalho = (adc_dma_bloco_t *)blocos[destino[c]];
+        cabecalho->numero = numero[c];
+        cabecalho->amostras = ADC_DMA_AMOSTRAS_POR_BLOCO;
+        cabecalho->marca = ADC_DMA_MARCA;
+        cheios++;
+        if (cheios - lidos > maior_ocupacao)
+            maior_ocupacao = cheios - lidos;
+    }
+    if (++produzidos >= total_blocos)
+    {
+        adc_dma_encerrar();
+        return;
+    }
+    numero[c] += 2;
+    adc_dma_apontar(c);
+}
+
+static void adc_dma_irq(void)
+{
+    // Os dois pendentes só se a interrupção atrasou um bloco inteiro: o
+    // bloco de número menor terminou antes
+    bool pendente[2];
+    for (int c = 0; c < 2; c++)
+        pendente[c] = canais[c] >= 0 && (dma_hw->ints1 & (1u << canais[c]));
+    int primeiro = numero[0] <= numero[1] ? 0 : 1;
+    for (int k = 0; k < 2; k++)
+    {
+        int c = k ? 1 - primeiro : primeiro;
+        if (!pendente[c])
+            continue;
+        dma_channel_acknowledge_irq1(canais[c]);
+        if (convertendo)
+            adc_dma_concluir(c);
+    }
+}
+
+bool adc_dma_iniciar(uint8_t canal, uint32_t divisor, uint32_t n_blocos)
+{
+    if (convertendo || canal > ADC_DMA_CANAL_TEMPERATURA || divisor > ADC_DMA_DIVISOR_MAX || n_blocos == 0)
+        return false;
+    for (int c = 0; c < 2; c++)
+    {
+        if (canais[c] < 0)
+            canais[c] = dma_claim_unused_channel(false);
+        if (canais[c] < 0)
+            return false;
+    }
+    if (!irq_instalada)
+    {
+        irq_add_shared_handler(ADC_DMA_IRQ, adc_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(ADC_DMA_IRQ, true);
+        irq_instalada = true;
+    }
+
+    if (canal == ADC_DMA_CANAL_TEMPERATURA)
+        adc_set_temp_sensor_enabled(true);
+    else
+        adc_gpio_init(26 + canal);
+    adc_run(false);
+    adc_select_input(canal);
+    // DREQ a cada conversão, sem bit de erro e sem reduzir a 8 bits
+    adc_fifo_setup(true, true, 1, false, false);
+    adc_set_clkdiv((float)divisor);
+    adc_fifo_drain();
+    hw_set_bits(&adc_hw->fcs, ADC_FCS_OVER_BITS | ADC_FCS_UNDER_BITS);
+
+    total_blocos = n_blocos;
+    reservados = cheios = lidos = 0;
+    produzidos = perdidos = transbordos = maior_ocupacao = 0;
+    for (int c = 0; c < 2; c++)
+    {
+        int outro = canais[1 - c];
+        config_anel[c] = dma_channel_get_default_config(canais[c]);
+        channel_config_set_transfer_data_size(&config_anel[c], DMA_SIZE_16);
+        channel_config_set_read_increment(&config_anel[c], false);
+        channel_config_set_write_increment(&config_anel[c], true);
+        channel_config_set_dreq(&config_anel[c], DREQ_ADC);
+        channel_config_set_chain_to(&config_anel[c], outro);
+        config_descarte[c] = config_anel[c];
+        channel_config_set_write_increment(&config_descarte[c], false);
+        channel_config_set_ring(&config_anel[c], true, ADC_DMA_BLOCO_BITS);
+        dma_channel_set_read_addr(canais[c], &adc_hw->fifo, false);
+        numero[c] = (uint32_t)c;
+        adc_dma_apontar(c);
+        dma_channel_acknowledge_irq1(canais[c]);
+        dma_channel_set_irq1_enabled(canais[c], true);
+    }
+    convertendo = true;
+    dma_channel_start(canais[0]);
+    adc_run(true);
+    return true;
+}
+
+const uint8_t *adc_dma_bloco(void)
+{
+    if (lidos == cheios)
+        return NULL;
+    __dmb();
+    return (const uint8_t *)blocos[lidos % ADC_DMA_BLOCOS];
+}
+
+void adc_dma_liberar(void)
+{
+    if (lidos != cheios)
+        lidos++;
+}
+
+bool adc_dma_convertendo(void)
+{
+    return convertendo;
+}
+
+void adc_dma_parar(void)
+{
+    uint32_t estado = save_and_disable_interrupts();
+    if (convertendo)
+        adc_dma_encerrar();
+    restore_interrupts(estado);
+}
+
+void adc_dma_contagem(adc_dma_contagem_t *c)
+{
+    uint32_t estado = save_and_disable_interrupts();
+    c->produzidos = produzidos;
+    c->perdidos = perdidos;
+    c->transbordos_fifo = transbordos;
+    c->pendentes = cheios - lidos;
+    c->maior_ocupacao = maior_ocupacao;
+    restore_interrupts(estado);
+}
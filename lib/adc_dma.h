@@ -0,0 +1,105 @@
+#ifndef ADC_DMA_H
+#define ADC_DMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Captura contínua do ADC do RP2040 (comando "adc"): o ADC converte sem
+// parar, no ritmo do divisor de clock, e dois canais de DMA encadeados
+// (ping-pong) levam a FIFO para blocos de um anel em RAM. O laço principal
+// grava cada bloco cheio no cartão como está, em binário. Se o anel encher
+// porque o cartão não acompanha, os blocos seguintes são descartados (a DMA
+// escreve num endereço fixo) e contados; a numeração dos blocos no arquivo
+// mostra onde ficaram as lacunas.
+//
+// Arquivo (inteiros little-endian, como na placa):
+//   adc_dma_arquivo_t, completado com zeros até ADC_DMA_CABECALHO_BYTES
+//   blocos de ADC_DMA_BLOCO_BYTES: adc_dma_bloco_t + amostras de 12 bits em
+//   uint16_t
+// A amostra i do bloco n foi convertida em
+//   (n · ADC_DMA_AMOSTRAS_POR_BLOCO + i) · ciclos / relogio_hz segundos.
+//
+// Os tipos e as contas são C puro (host/ler_adc); a DMA fica em adc_dma.c.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ADC_DMA_CABECALHO_BYTES 512 // um setor: os blocos ficam alinhados no arquivo
+#define ADC_DMA_BLOCO_BITS 13
+#define ADC_DMA_BLOCO_BYTES (1u << ADC_DMA_BLOCO_BITS) // 8 KiB
+#define ADC_DMA_BLOCOS 6            // anel em RAM: 48 KiB, ~49 ms a 500 ksps
+#define ADC_DMA_AMOSTRAS_POR_BLOCO ((ADC_DMA_BLOCO_BYTES - sizeof(adc_dma_bloco_t)) / sizeof(uint16_t))
+#define ADC_DMA_RELOGIO_HZ 48000000u // clk_adc
+#define ADC_DMA_CICLOS_MIN 96        // uma conversão leva 96 ciclos: 500 ksps
+#define ADC_DMA_DIVISOR_MAX 65535
+#define ADC_DMA_CANAL_TEMPERATURA 4
+
+typedef struct __attribute__((packed)) {
+    char assinatura[4];      // "ADC1"
+    uint16_t tamanho;        // sizeof(adc_dma_arquivo_t)
+    uint16_t bloco_bytes;    // ADC_DMA_BLOCO_BYTES
+    uint16_t amostras_por_bloco;
+    uint8_t canal;           // 0 a 3 (GPIO 26 a 29) ou 4 (sensor de temperatura)
+    uint8_t completo;        // 0 enquanto a captura grava; 1 depois de fechada
+    uint32_t relogio_hz;
+    uint32_t ciclos;         // ciclos de clk_adc entre conversões
+    uint32_t duracao_ms;     // pedida
+    uint32_t blocos_previstos;
+    uint32_t blocos_gravados;
+    uint32_t blocos_perdidos; // descartados com o anel cheio
+    uint32_t transbordos_fifo; // blocos em que a FIFO do ADC transbordou
+} adc_dma_arquivo_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t numero;   // desde o início da captura
+    uint16_t amostras; // ADC_DMA_AMOSTRAS_POR_BLOCO
+    uint16_t marca;    // ADC_DMA_MARCA
+} adc_dma_bloco_t;
+
+#define ADC_DMA_MARCA 0xADC0
+
+// Ciclos entre conversões para o divisor do ADC (DIV.INT): abaixo de 95 o
+// ADC já converte sem pausa
+static inline uint32_t adc_dma_ciclos(uint32_t divisor)
+{
+    return divisor + 1 < ADC_DMA_CICLOS_MIN ? ADC_DMA_CICLOS_MIN : divisor + 1;
+}
+
+// Blocos para cobrir 'duracao_ms' (arredondado para cima)
+static inline uint32_t adc_dma_blocos(uint32_t duracao_ms, uint32_t ciclos)
+{
+    uint64_t amostras = ((uint64_t)duracao_ms * (ADC_DMA_RELOGIO_HZ / 1000) + ciclos - 1) / ciclos;
+    return (uint32_t)((amostras + ADC_DMA_AMOSTRAS_POR_BLOCO - 1) / ADC_DMA_AMOSTRAS_POR_BLOCO);
+}
+
+typedef struct {
+    uint32_t produzidos; // blocos convertidos, gravados ou não
+    uint32_t perdidos;
+    uint32_t transbordos_fifo;
+    uint32_t pendentes; // cheios esperando o cartão
+    uint32_t maior_ocupacao; // maior número de blocos cheios ao mesmo tempo
+} adc_dma_contagem_t;
+
+// Começa a captura de 'blocos' blocos do canal 'canal'. false se não há
+// canal de DMA livre ou já existe uma captura
+bool adc_dma_iniciar(uint8_t canal, uint32_t divisor, uint32_t blocos);
+
+// Bloco cheio mais antigo (ADC_DMA_BLOCO_BYTES, já com o cabeçalho) ou NULL.
+// Fica válido até adc_dma_liberar(), que devolve o espaço à DMA
+const uint8_t *adc_dma_bloco(void);
+void adc_dma_liberar(void);
+
+// A DMA ainda converte (os blocos previstos não terminaram)
+bool adc_dma_convertendo(void);
+
+// Para o ADC e a DMA antes do fim; os blocos cheios continuam disponíveis
+void adc_dma_parar(void);
+
+void adc_dma_contagem(adc_dma_contagem_t *c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_DMA_H
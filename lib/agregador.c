@@ -0,0 +1,92 @@
+#include <math.h>
+#include <stdio.h>
+#include "agregador.h"
+
+static void janela_limpar(agregador_janela_t *j, uint8_t canais, uint32_t indice)
+{
+    j->indice = indice;
+    j->amostras = 0;
+    j->canais = canais;
+    for (uint8_t c = 0; c < canais; c++)
+    {
+        j->min[c] = INT32_MAX;
+        j->max[c] = INT32_MIN;
+        j->soma[c] = 0;
+        j->soma_quadrados[c] = 0;
+    }
+}
+
+void agregador_iniciar(agregador_t *a, uint8_t canais, uint32_t janela)
+{
+    if (canais > AGREGADOR_MAX_CANAIS)
+        canais = AGREGADOR_MAX_CANAIS;
+    a->janela = janela ? janela : 1;
+    janela_limpar(&a->atual, canais, 0);
+}
+
+bool agregador_adicionar(agregador_t *a, const int32_t *valores, uint32_t amostra, uint32_t tempo_ms,
+                         agregador_janela_t *saida)
+{
+    agregador_janela_t *j = &a->atual;
+    if (j->amostras == 0)
+    {
+        j->primeira = amostra;
+        j->tempo_ms = tempo_ms;
+    }
+    for (uint8_t c = 0; c < j->canais; c++)
+    {
+        int32_t v = valores[c];
+        if (v < j->min[c])
+            j->min[c] = v;
+        if (v > j->max[c])
+            j->max[c] = v;
+        j->soma[c] += v;
+        j->soma_quadrados[c] += (uint64_t)((int64_t)v * v);
+    }
+    if (++j->amostras < a->janela)
+        return false;
+    *saida = *j;
+    janela_limpar(j, j->canais, j->indice + 1);
+    return true;
+}
+
+bool agregador_finalizar(agregador_t *a, agregador_janela_t *saida)
+{
+    if (a->atual.amostras == 0)
+        return false;
+    *saida = a->atual;
+    janela_limpar(&a->atual, a->atual.canais, a->atual.indice + 1);
+    return true;
+}
+
+double agregador_media(const agregador_janela_t *j, uint8_t canal)
+{
+    return (double)j->soma[canal] / j->amostras;
+}
+
+double agregador_rms(const agregador_janela_t *j, uint8_t canal)
+{
+    return sqrt((double)j->soma_quadrados[canal] / j->amostras);
+}
+
+int agregador_formatar_cabecalho(const char *const *nomes, uint8_t canais, char *destino, size_t tamanho)
+{
+    int n = snprintf(destino, tamanho, "Janela,Amostras,Primeira,Tempo_ms");
+    for (uint8_t c = 0; c < canais && n >= 0 && (size_t)n < tamanho; c++)
+        n += snprintf(destino + n, tamanho - n, ",%s_min,%s_max,%s_media,%s_rms", nomes[c], nomes[c], nomes[c], nomes[c]);
+    if (n >= 0 && (size_t)n < tamanho)
+        n += snprintf(destino + n, tamanho - n, "\n");
+    return n;
+}
+
+int agregador_formatar(const agregador_janela_t *j, char *destino, size_t tamanho)
+{
+    int n = snprintf(destino, tamanho, "%lu,%lu,%lu,%lu", (unsigned long)j->indice, (unsigned long)j->amostras,
+                     (unsigned long)j->primeira, (unsigned long)j->tempo_ms);
+    for (uint8_t c = 0; c < j->canais && n >= 0 && (size_t)n < tamanho; c++)
+        n += snprintf(destino + n, tamanho - n, ",%ld,%ld,%.2f,%.2f", (long)j->min[c], (long)j->max[c],
+                      agregador_media(j, c), agregador_rms(j, c));
+    if (n >= 0 && (size_t)n < tamanho)
+        n += snprintf(destino + n, tamanho - n, "\n");
+    return n;
+}
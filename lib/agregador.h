@@ -0,0 +1,57 @@
+#ifndef AGREGADOR_H
+#define AGREGADOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Agregação em janelas de N amostras: mínimo, máximo, média e RMS por
+// canal, em memória constante. Código C puro, compilado também no PC
+// (host/verificar_agregador) para conferir os resultados do firmware.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AGREGADOR_MAX_CANAIS 8
+
+typedef struct {
+    uint32_t indice;       // número da janela, a partir de 0
+    uint32_t amostras;     // amostras na janela (a última pode ser parcial)
+    uint32_t primeira;     // número da primeira amostra
+    uint32_t tempo_ms;     // Tempo_ms da primeira amostra
+    uint8_t canais;
+    int32_t min[AGREGADOR_MAX_CANAIS];
+    int32_t max[AGREGADOR_MAX_CANAIS];
+    int64_t soma[AGREGADOR_MAX_CANAIS];
+    uint64_t soma_quadrados[AGREGADOR_MAX_CANAIS];
+} agregador_janela_t;
+
+typedef struct {
+    uint32_t janela; // amostras por janela
+    agregador_janela_t atual;
+} agregador_t;
+
+void agregador_iniciar(agregador_t *a, uint8_t canais, uint32_t janela);
+
+// Acrescenta uma amostra (só operações inteiras). Quando ela fecha uma
+// janela, copia o resultado para 'saida' e retorna true
+bool agregador_adicionar(agregador_t *a, const int32_t *valores, uint32_t amostra, uint32_t tempo_ms,
+                         agregador_janela_t *saida);
+
+// Janela parcial pendente no fim dos dados; false se não há nenhuma
+bool agregador_finalizar(agregador_t *a, agregador_janela_t *saida);
+
+double agregador_media(const agregador_janela_t *j, uint8_t canal);
+double agregador_rms(const agregador_janela_t *j, uint8_t canal);
+
+// Cabeçalho e linha CSV do resumo; os mesmos no firmware e no PC.
+// 'nomes' tem um nome por canal. Retornam o tamanho escrito
+int agregador_formatar_cabecalho(const char *const *nomes, uint8_t canais, char *destino, size_t tamanho);
+int agregador_formatar(const agregador_janela_t *j, char *destino, size_t tamanho);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AGREGADOR_H
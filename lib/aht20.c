@@ -3,10 +3,6 @@
 #include "hardware/i2c.h"
 #include "aht20.h"
 
-#define AHT20_I2C_ADDR      0x38
-#define AHT20_CMD_INIT      0xBE
-#define AHT20_CMD_TRIGGER   0xAC
-#define AHT20_CMD_RESET     0xBA
 #define AHT20_STATUS_BUSY   0x80  // Bit de status ocupado
 #define AHT20_STATUS_CALIBRATED 0x08  // Bit de calibração
 
@@ -28,44 +24,74 @@ bool aht20_init(i2c_inst_t *i2c) {
     return false;  // Falhou na calibração
 }
 
-bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data) {
+bool aht20_start(i2c_inst_t *i2c) {
     uint8_t trigger_cmd[3] = {AHT20_CMD_TRIGGER, 0x33, 0x00};
-    uint8_t buffer[6];
+    return i2c_write_timeout_us(i2c, AHT20_I2C_ADDR, trigger_cmd, 3, false, I2C_TRANSACAO_US(4)) == 3;
+}
 
-    // Envia comando de medição
-    i2c_write_blocking(i2c, AHT20_I2C_ADDR, trigger_cmd, 3, false);
-    
-    // Aguarda até o sensor estar pronto
+AHT20_Status aht20_poll(i2c_inst_t *i2c) {
     uint8_t status;
-    for (int i = 0; i < 10; i++) {
-        i2c_read_blocking(i2c, AHT20_I2C_ADDR, &status, 1, false);
-        if (!(status & AHT20_STATUS_BUSY)) {
-            break;
+    if (i2c_read_timeout_us(i2c, AHT20_I2C_ADDR, &status, 1, false, I2C_TRANSACAO_US(2)) != 1) {
+        return AHT20_ERROR;
+    }
+    return (status & AHT20_STATUS_BUSY) ? AHT20_BUSY : AHT20_READY;
+}
+
+// CRC-8 do datasheet (polinômio 0x31, início 0xFF) sobre status e dados
+static uint8_t aht20_crc(const uint8_t *data, int len) {
+    uint8_t crc = 0xFF;
+    for (int i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
         }
-        sleep_ms(10);
     }
-    
-    // Se ainda estiver ocupado, falha na leitura
-    if (status & AHT20_STATUS_BUSY) {
+    return crc;
+}
+
+bool aht20_collect(i2c_inst_t *i2c, AHT20_Measurement *m) {
+    uint8_t buffer[7];
+    if (i2c_read_timeout_us(i2c, AHT20_I2C_ADDR, buffer, 7, false, AHT20_TRANSACAO_MAX_US) != 7) {
         return false;
     }
-
-    // Lê os 6 bytes de dados
-    if (i2c_read_blocking(i2c, AHT20_I2C_ADDR, buffer, 6, false) != 6) {
+    if ((buffer[0] & AHT20_STATUS_BUSY) || aht20_crc(buffer, 6) != buffer[6]) {
         return false;
     }
 
-    // Processa os dados de umidade (20 bits)
+    // Umidade e temperatura em 20 bits, de 0 a 2^20: 100 %UR e -50 a 150 °C.
+    // 10000 / 2^20 = 625 / 2^16 e 20000 / 2^20 = 625 / 2^15, e 2^20 · 625
+    // ainda cabe em 32 bits
     uint32_t raw_humidity = ((uint32_t)buffer[1] << 12) | ((uint32_t)buffer[2] << 4) | (buffer[3] >> 4);
-    data->humidity = (float)raw_humidity * 100.0 / 1048576.0;
+    m->humidity_centi = (int32_t)((raw_humidity * 625 + (1u << 15)) >> 16);
 
-    // Processa os dados de temperatura (20 bits)
     uint32_t raw_temp = ((uint32_t)(buffer[3] & 0x0F) << 16) | ((uint32_t)buffer[4] << 8) | buffer[5];
-    data->temperature = ((float)raw_temp * 200.0 / 1048576.0) - 50.0;
+    m->temperature_centi = (int32_t)((raw_temp * 625 + (1u << 14)) >> 15) - 5000;
 
     return true;
 }
 
+bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data) {
+    if (!aht20_start(i2c)) {
+        return false;
+    }
+    sleep_ms(AHT20_MEASUREMENT_MS);
+
+    // Aguarda até o sensor estar pronto
+    AHT20_Status status = aht20_poll(i2c);
+    for (int i = 0; i < 10 && status == AHT20_BUSY; i++) {
+        sleep_ms(10);
+        status = aht20_poll(i2c);
+    }
+
+    AHT20_Measurement m;
+    if (status != AHT20_READY || !aht20_collect(i2c, &m)) {
+        return false;
+    }
+    data->temperature = m.temperature_centi / 100.0f;
+    data->humidity = m.humidity_centi / 100.0f;
+    return true;
+}
+
 void aht20_reset(i2c_inst_t *i2c) {
     uint8_t reset_cmd = AHT20_CMD_RESET;
     i2c_write_blocking(i2c, AHT20_I2C_ADDR, &reset_cmd, 1, false);
@@ -1,6 +1,10 @@
 #ifndef AHT20_H
 #define AHT20_H
 
+#include <stdbool.h>
+#include <stdint.h>
+#include "hardware/i2c.h"
+#include "i2c_transacao.h"
 
 // Endereço I2C do AHT20
 #define AHT20_I2C_ADDR  0x38
@@ -10,16 +14,45 @@
 #define AHT20_CMD_TRIGGER   0xAC
 #define AHT20_CMD_RESET     0xBA
 
+// Tempo de conversão do datasheet: antes disso aht20_poll() só responde ocupado
+#define AHT20_MEASUREMENT_MS 80
+
+// Transação mais longa da leitura assíncrona (aht20_collect: endereço + 7
+// bytes); cada transação tem o limite de I2C_TRANSACAO_US()
+#define AHT20_TRANSACAO_MAX_US I2C_TRANSACAO_US(8)
+
 // Estrutura para armazenar os valores de temperatura e umidade
 typedef struct {
     float temperature;
     float humidity;
 } AHT20_Data;
 
+// Medida em inteiros (aht20_collect)
+typedef struct {
+    int32_t temperature_centi; // centésimos de °C
+    int32_t humidity_centi;    // centésimos de %UR
+} AHT20_Measurement;
+
+typedef enum {
+    AHT20_BUSY,  // conversão em andamento
+    AHT20_READY, // resultado disponível para aht20_collect()
+    AHT20_ERROR, // sensor não respondeu
+} AHT20_Status;
+
 // Inicializa o sensor AHT20
 bool aht20_init(i2c_inst_t *i2c);
 
-// Faz a leitura de temperatura e umidade do AHT20
+// Leitura assíncrona, sem espera dentro das funções (cada uma é uma
+// transação I2C curta):
+//   aht20_start()   dispara a medida
+//   aht20_poll()    lê o status e confere o bit de ocupado
+//   aht20_collect() lê os dados, confere o CRC e converte com inteiros
+bool aht20_start(i2c_inst_t *i2c);
+AHT20_Status aht20_poll(i2c_inst_t *i2c);
+bool aht20_collect(i2c_inst_t *i2c, AHT20_Measurement *m);
+
+// Faz a leitura de temperatura e umidade do AHT20 (bloqueante: espera a
+// conversão, ~80 ms)
 bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data);
 
 // Reseta o sensor AHT20
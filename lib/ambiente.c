@@ -0,0 +1,122 @@
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "bmp280.h"
+#include "aht20.h"
+#include "i2c_transacao.h"
+#include "ambiente.h"
+
+// O custo declarado de um passo é a soma dos limites das suas transações
+#define BMP280_CUSTO_US (I2C_TRANSACAO_US(2) + I2C_TRANSACAO_US(7)) // registro, depois 6 bytes
+#define AHT20_CUSTO_US AHT20_TRANSACAO_MAX_US // uma transação por passo
+
+#define BMP280_REG_ID 0xD0
+#define BMP280_ID 0x58
+#define BMP280_FORCADO ((0x01 << 5) | (0x03 << 2) | 0x01) // temperatura x1, pressão x4, modo forçado
+#define BMP280_MEDIDA_US 14000 // pior caso do datasheet para x1/x4: 13,3 ms
+
+#define AHT20_NOVA_ESPERA_US 10000
+
+static i2c_inst_t *bmp280_i2c;
+static struct bmp280_calib_param bmp280_calibracao;
+static i2c_inst_t *aht20_i2c;
+
+static const sensor_campo_t bmp280_campos[] = {{"temp_c", 2}, {"pressao_pa", 0}};
+static const sensor_campo_t aht20_campos[] = {{"temp_c", 2}, {"umidade_pct", 2}};
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// BMP280
+
+static sensor_passo_t bmp280_passo(sensor_t *s, uint64_t agora_us)
+{
+    if (s->etapa == 0)
+    {
+        uint8_t buf[2] = {REG_CTRL_MEAS, BMP280_FORCADO};
+        if (i2c_write_timeout_us(bmp280_i2c, ADDR, buf, 2, false, I2C_TRANSACAO_US(3)) != 2)
+            return SENSOR_FALHA;
+        s->etapa = 1;
+        s->espera_us = agora_us + BMP280_MEDIDA_US;
+        return SENSOR_ESPERA;
+    }
+    uint8_t reg = REG_PRESSURE_MSB;
+    uint8_t buf[6];
+    if (i2c_write_timeout_us(bmp280_i2c, ADDR, &reg, 1, true, I2C_TRANSACAO_US(2)) != 1 ||
+        i2c_read_timeout_us(bmp280_i2c, ADDR, buf, 6, false, I2C_TRANSACAO_US(7)) != 6)
+        return SENSOR_FALHA;
+    int32_t pressao = (buf[0] << 12) | (buf[1] << 4) | (buf[2] >> 4);
+    int32_t temp = (buf[3] << 12) | (buf[4] << 4) | (buf[5] >> 4);
+    s->valores[0] = bmp280_convert_temp(temp, &bmp280_calibracao);
+    s->valores[1] = bmp280_convert_pressure(pressao, temp, &bmp280_calibracao);
+    return SENSOR_MEDIDA;
+}
+
+bool ambiente_bmp280(i2c_inst_t *i2c, sensor_t *s)
+{
+    uint8_t reg = BMP280_REG_ID, id = 0;
+    if (i2c_write_timeout_us(i2c, ADDR, &reg, 1, true, 1000) != 1 ||
+        i2c_read_timeout_us(i2c, ADDR, &id, 1, false, 1000) != 1 || id != BMP280_ID)
+        return false;
+    bmp280_get_calib_params(i2c, &bmp280_calibracao);
+    // Sem filtro IIR e em repouso até o primeiro disparo
+    uint8_t buf[2] = {REG_CONFIG, 0x00};
+    i2c_write_blocking(i2c, ADDR, buf, 2, false);
+    buf[0] = REG_CTRL_MEAS;
+    i2c_write_blocking(i2c, ADDR, buf, 2, false);
+    bmp280_i2c = i2c;
+
+    s->nome = "bmp280";
+    s->campos = bmp280_campos;
+    s->n_campos = 2;
+    s->custo_us = BMP280_CUSTO_US;
+    s->passo = bmp280_passo;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------------------------------------------
+// AHT20
+
+// Disparo, status até o bit de ocupado cair e leitura, um passo de cada vez
+static sensor_passo_t aht20_passo(sensor_t *s, uint64_t agora_us)
+{
+    if (s->etapa == 0)
+    {
+        if (!aht20_start(aht20_i2c))
+            return SENSOR_FALHA;
+        s->etapa = 1;
+        s->espera_us = agora_us + AHT20_MEASUREMENT_MS * 1000;
+        return SENSOR_ESPERA;
+    }
+    if (s->etapa == 1)
+    {
+        AHT20_Status status = aht20_poll(aht20_i2c);
+        if (status == AHT20_ERROR)
+            return SENSOR_FALHA;
+        if (status == AHT20_BUSY)
+        {
+            s->espera_us = agora_us + AHT20_NOVA_ESPERA_US;
+            return SENSOR_ESPERA;
+        }
+        s->etapa = 2;
+        return SENSOR_CONTINUA;
+    }
+    AHT20_Measurement m;
+    if (!aht20_collect(aht20_i2c, &m))
+        return SENSOR_FALHA;
+    s->valores[0] = m.temperature_centi;
+    s->valores[1] = m.humidity_centi;
+    return SENSOR_MEDIDA;
+}
+
+bool ambiente_aht20(i2c_inst_t *i2c, sensor_t *s)
+{
+    if (!aht20_check(i2c) || !aht20_init(i2c))
+        return false;
+    aht20_i2c = i2c;
+
+    s->nome = "aht20";
+    s->campos = aht20_campos;
+    s->n_campos = 2;
+    s->custo_us = AHT20_CUSTO_US;
+    s->passo = aht20_passo;
+    return true;
+}
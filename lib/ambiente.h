@@ -0,0 +1,23 @@
+#ifndef AMBIENTE_H
+#define AMBIENTE_H
+
+#include <stdbool.h>
+#include "hardware/i2c.h"
+#include "sensores.h"
+
+// BMP280 (temperatura e pressão) e AHT20 (temperatura e umidade) como
+// sensores do escalonador de lib/sensores.h, no mesmo I2C do MPU6050. As
+// máquinas de estados disparam a medida, esperam o tempo de conversão do
+// datasheet sem ocupar o barramento e leem o resultado numa transação.
+//
+// BMP280 em modo forçado (uma conversão por disparo, ~14 ms, sem filtro
+// IIR): temp_c em centésimos de grau e pressao_pa em pascal.
+// AHT20 pela API assíncrona do driver (disparo, status, coleta): ~80 ms
+// por medida; temp_c e umidade_pct em centésimos, com CRC conferido.
+
+// Confere a presença do sensor e o configura (bloqueante: fora da captura).
+// Preenche nome, campos, custo e passo de 's'; false se não responde
+bool ambiente_bmp280(i2c_inst_t *i2c, sensor_t *s);
+bool ambiente_aht20(i2c_inst_t *i2c, sensor_t *s);
+
+#endif // AMBIENTE_H
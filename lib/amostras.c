@@ -0,0 +1,64 @@
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "amostras.h"
+
+#define AMOSTRAS_MASCARA (AMOSTRAS_CAPACIDADE - 1)
+
+static amostra_t fila[AMOSTRAS_CAPACIDADE];
+static volatile uint32_t escritas = 0;
+
+void amostras_limpar(void)
+{
+    escritas = 0;
+}
+
+void amostras_publicar(const amostra_t *a)
+{
+    uint32_t n = escritas;
+    fila[n & AMOSTRAS_MASCARA] = *a;
+    // A amostra precisa estar visível antes do contador (leitor no core1)
+    __dmb();
+    escritas = n + 1;
+    __sev(); // acorda o core1 (nucleo1.c) se estiver em __wfe()
+}
+
+uint32_t amostras_total(void)
+{
+    return escritas;
+}
+
+void amostras_leitor_iniciar(amostras_leitor_t *leitor)
+{
+    leitor->leitura = escritas;
+    leitor->perdidas = 0;
+}
+
+bool amostras_ler(amostras_leitor_t *leitor, amostra_t *a)
+{
+    while (true)
+    {
+        uint32_t n = escritas;
+        // Sessão reiniciada: volta para o início
+        if (leitor->leitura > n)
+            leitor->leitura = 0;
+        if (leitor->leitura == n)
+            return false;
+        // A posição n & MASCARA é a próxima que o produtor sobrescreve: o
+        // leitor fica no máximo CAPACIDADE - 1 amostras atrás
+        if (n - leitor->leitura >= AMOSTRAS_CAPACIDADE)
+        {
+            leitor->perdidas += n - leitor->leitura - AMOSTRAS_CAPACIDADE + 1;
+            leitor->leitura = n - AMOSTRAS_CAPACIDADE + 1;
+        }
+        *a = fila[leitor->leitura & AMOSTRAS_MASCARA];
+        __dmb();
+        // O produtor grava a posição antes de publicar o contador: se ele
+        // chegou a esta posição durante a cópia, ela pode estar pela metade,
+        // e a leitura recomeça a partir da mais antiga válida
+        if (escritas - leitor->leitura < AMOSTRAS_CAPACIDADE)
+        {
+            leitor->leitura++;
+            return true;
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef AMOSTRAS_H
+#define AMOSTRAS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fila circular das amostras do MPU6050 adquiridas na sessão atual.
+// Um único produtor (a captura) e vários leitores independentes: cada
+// leitor guarda a própria posição e, se ficar mais de uma volta atrás,
+// pula para as amostras mais antigas ainda disponíveis e contabiliza as perdas.
+
+// Precisa ser potência de 2
+#define AMOSTRAS_CAPACIDADE 256
+
+typedef struct {
+    uint32_t seq;      // número da amostra na sessão (começa em 1)
+    uint64_t tempo_us; // instante da leitura (time_us_64)
+    int16_t accel[3];
+    int16_t gyro[3];
+    int16_t temp;
+    uint16_t adc;      // conversão feita junto da leitura (lib/analogico.h): AMOSTRA_ADC()
+} amostra_t;
+
+// O ADC tem 12 bits: os 4 de cima de 'adc' guardam o canal + 1 (0: nenhuma
+// conversão) e a amostra continua com 32 bytes
+#define AMOSTRA_ADC(canal, valor) ((uint16_t)((((canal) + 1) << 12) | ((valor) & 0xFFF)))
+#define AMOSTRA_ADC_CANAL(adc) ((int)((adc) >> 12) - 1) // -1: nenhuma
+#define AMOSTRA_ADC_VALOR(adc) ((uint16_t)((adc) & 0xFFF))
+
+typedef struct {
+    uint32_t leitura;  // total de amostras já consumidas por este leitor
+    uint32_t perdidas; // amostras sobrescritas antes de serem lidas
+} amostras_leitor_t;
+
+// Descarta o conteúdo (início de sessão)
+void amostras_limpar(void);
+
+// Acrescenta uma amostra (somente o laço de captura chama)
+void amostras_publicar(const amostra_t *a);
+
+// Total de amostras publicadas desde amostras_limpar()
+uint32_t amostras_total(void);
+
+// Posiciona o leitor na próxima amostra a ser publicada
+void amostras_leitor_iniciar(amostras_leitor_t *leitor);
+
+// Copia a próxima amostra do leitor; false se não houver nova
+bool amostras_ler(amostras_leitor_t *leitor, amostra_t *a);
+
+#endif // AMOSTRAS_H
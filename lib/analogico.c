@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <string.h>
+#include "analogico.h"
+
+bool analogico_config_valida(const analogico_config_t *c)
+{
+    // Soma exata das frações: o produto de quatro períodos de até 60000
+    // ainda cabe em 64 bits
+    uint64_t produto = 1;
+    int ligados = 0;
+    for (int i = 0; i < ANALOGICO_CANAIS; i++)
+    {
+        if (c->a_cada[i] > ANALOGICO_A_CADA_MAX)
+            return false;
+        if (c->a_cada[i])
+        {
+            produto *= c->a_cada[i];
+            ligados++;
+        }
+    }
+    if (!ligados)
+        return false;
+    uint64_t soma = 0;
+    for (int i = 0; i < ANALOGICO_CANAIS; i++)
+        if (c->a_cada[i])
+            soma += produto / c->a_cada[i];
+    return soma <= produto;
+}
+
+int analogico_canal(const char *nome)
+{
+    if (0 == strcmp(nome, "t"))
+        return ANALOGICO_CANAIS - 1;
+    if (nome[0] >= '0' && nome[0] <= '2' && nome[1] == '\0')
+        return nome[0] - '0';
+    return -1;
+}
+
+void analogico_iniciar(analogico_t *a, const analogico_config_t *c, uint32_t seq)
+{
+    memset(a, 0, sizeof(*a));
+    a->config = *c;
+    for (int i = 0; i < ANALOGICO_CANAIS; i++)
+        a->liberado[i] = seq;
+}
+
+int analogico_escolher(analogico_t *a, uint32_t seq)
+{
+    int escolhido = -1;
+    uint32_t prazo_escolhido = 0;
+    for (int i = 0; i < ANALOGICO_CANAIS; i++)
+    {
+        uint32_t a_cada = a->config.a_cada[i];
+        if (!a_cada)
+            continue;
+        // Período que terminou sem conversão: passa para o seguinte
+        while ((int32_t)(seq - (a->liberado[i] + a_cada)) >= 0)
+        {
+            a->liberado[i] += a_cada;
+            a->perdidas++;
+        }
+        if ((int32_t)(seq - a->liberado[i]) < 0)
+            continue;
+        uint32_t prazo = a->liberado[i] + a_cada;
+        if (escolhido < 0 || (int32_t)(prazo - prazo_escolhido) < 0)
+        {
+            escolhido = i;
+            prazo_escolhido = prazo;
+        }
+    }
+    if (escolhido >= 0)
+    {
+        a->liberado[escolhido] += a->config.a_cada[escolhido];
+        a->conversoes++;
+    }
+    return escolhido;
+}
+
+int analogico_config_formatar(const analogico_config_t *c, char *destino, size_t tamanho)
+{
+    int n = 0;
+    for (int i = 0; i < ANALOGICO_CANAIS; i++)
+    {
+        if (!c->a_cada[i] || (size_t)n >= tamanho)
+            continue;
+        n += snprintf(destino + n, tamanho - n, "%s%s:%u", n ? " " : "", analogico_nomes[i], c->a_cada[i]);
+    }
+    return n;
+}
+
+int analogico_colunas(const analogico_config_t *c, char *destino, size_t tamanho)
+{
+    int n = 0;
+    for (int i = 0; i < ANALOGICO_CANAIS; i++)
+        if (c->a_cada[i] && (size_t)n < tamanho)
+            n += snprintf(destino + n, tamanho - n, ",%s", analogico_nomes[i]);
+    return n;
+}
+
+int analogico_formatar(const analogico_config_t *c, int canal, uint16_t valor, char *destino, size_t tamanho)
+{
+    int n = 0;
+    for (int i = 0; i < ANALOGICO_CANAIS; i++)
+    {
+        if (!c->a_cada[i] || (size_t)n >= tamanho)
+            continue;
+        n += i == canal ? snprintf(destino + n, tamanho - n, ",%u", valor) : snprintf(destino + n, tamanho - n, ",");
+    }
+    return n;
+}
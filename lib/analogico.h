@@ -0,0 +1,68 @@
+#ifndef ANALOGICO_H
+#define ANALOGICO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Canais analógicos junto das amostras do MPU6050 (comando "analogico"):
+// ADC0 a ADC2 e o sensor de temperatura interno, cada um convertido a cada
+// 'a_cada' leituras do MPU6050. Em cada leitura cabe uma única conversão,
+// disparada antes da leitura do sensor e recolhida depois dela, sem espera:
+// a conversão leva 2 us e a leitura em rajada ~400 us no I2C. A escolha do
+// canal é pelo prazo mais próximo (o fim do período de cada canal), que
+// atende todos os canais enquanto a soma de 1/a_cada não passar de 1.
+// Nenhuma dependência do SDK; o ADC fica no firmware.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ANALOGICO_CANAIS 4 // ADC0, ADC1, ADC2 e temperatura
+#define ANALOGICO_A_CADA_MAX 60000
+
+// Entrada do ADC (AINSEL) e nome da coluna de cada canal
+static const uint8_t analogico_entrada[ANALOGICO_CANAIS] = {0, 1, 2, 4};
+static const char *const analogico_nomes[ANALOGICO_CANAIS] = {"ADC0", "ADC1", "ADC2", "ADC_T"};
+
+typedef struct {
+    uint16_t a_cada[ANALOGICO_CANAIS]; // leituras do MPU6050 por conversão; 0 desliga o canal
+} analogico_config_t;
+
+typedef struct {
+    analogico_config_t config;
+    uint32_t liberado[ANALOGICO_CANAIS]; // leitura a partir da qual o canal pode converter
+    uint32_t conversoes;
+    uint32_t perdidas; // períodos que terminaram sem conversão
+} analogico_t;
+
+// Ao menos um canal ligado e a soma de 1/a_cada até 1
+bool analogico_config_valida(const analogico_config_t *c);
+
+// Índice do canal pelo nome ("0", "1", "2" ou "t"); -1 se não existe
+int analogico_canal(const char *nome);
+
+// Começa em 'seq' (a primeira leitura da captura); canais com o mesmo período
+// ficam defasados de uma leitura
+void analogico_iniciar(analogico_t *a, const analogico_config_t *c, uint32_t seq);
+
+// Canal a converter junto da leitura 'seq' ou -1. Chamada uma vez por
+// leitura, com 'seq' crescente (as leituras que falharam também contam)
+int analogico_escolher(analogico_t *a, uint32_t seq);
+
+// "ADC0:1 ADC_T:100" para o cabeçalho do CSV
+int analogico_config_formatar(const analogico_config_t *c, char *destino, size_t tamanho);
+
+// ",ADC0,ADC_T": as colunas dos canais ligados, na ordem dos canais
+int analogico_colunas(const analogico_config_t *c, char *destino, size_t tamanho);
+
+// Colunas de uma linha: o valor na do canal 'canal' e as demais vazias
+// (",,517" para ADC0, ADC1 e ADC_T ligados e o valor de ADC_T); 'canal' -1
+// deixa todas vazias
+int analogico_formatar(const analogico_config_t *c, int canal, uint16_t valor, char *destino, size_t tamanho);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ANALOGICO_H
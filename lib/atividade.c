@@ -0,0 +1,83 @@
+#include <string.h>
+#include "atividade.h"
+
+// Peso de cada amostra nas médias: 1/8
+#define SUAVIZACAO 3
+
+static uint32_t raiz32(uint32_t v)
+{
+    uint32_t r = 0;
+    for (uint32_t bit = 1u << 30; bit; bit >>= 2)
+    {
+        if (v >= r + bit)
+        {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        }
+        else
+        {
+            r >>= 1;
+        }
+    }
+    return r;
+}
+
+static uint32_t quadrado_limitado(uint64_t v)
+{
+    v *= v;
+    return v >= UINT32_MAX ? UINT32_MAX - 1 : (uint32_t)v;
+}
+
+static void media(uint32_t *m, uint32_t x)
+{
+    if (x > *m)
+        *m += (x - *m) >> SUAVIZACAO;
+    else
+        *m -= (*m - x) >> SUAVIZACAO;
+}
+
+void atividade_iniciar(atividade_t *at, const atividade_config_t *config, uint16_t giro_fundo_dps,
+                       uint8_t accel_fundo_g)
+{
+    memset(at, 0, sizeof(*at));
+    at->config = *config;
+    at->um_g = 32768u / (accel_fundo_g ? accel_fundo_g : 2);
+    at->accel_limiar2 = config->accel_mg ? quadrado_limitado((uint64_t)at->um_g * config->accel_mg / 1000)
+                                         : UINT32_MAX;
+    at->giro_limiar2 = config->giro_dps
+                           ? quadrado_limitado((uint64_t)config->giro_dps * 32768u / (giro_fundo_dps ? giro_fundo_dps : 250))
+                           : UINT32_MAX;
+    // Começa em movimento: a captura abre na taxa alta
+    at->ativo = true;
+}
+
+bool atividade_acrescentar(atividade_t *at, const int16_t accel[3], const int16_t gyro[3], uint64_t tempo_us)
+{
+    // |a|² e |ω|² cabem em 32 bits: 3 · 32768²
+    uint32_t a2 = (uint32_t)((int32_t)accel[0] * accel[0]) + (uint32_t)((int32_t)accel[1] * accel[1]) +
+                  (uint32_t)((int32_t)accel[2] * accel[2]);
+    uint32_t w2 = (uint32_t)((int32_t)gyro[0] * gyro[0]) + (uint32_t)((int32_t)gyro[1] * gyro[1]) +
+                  (uint32_t)((int32_t)gyro[2] * gyro[2]);
+    uint32_t modulo = raiz32(a2);
+    uint32_t desvio = modulo > at->um_g ? modulo - at->um_g : at->um_g - modulo;
+    media(&at->energia_accel, desvio * desvio);
+    media(&at->energia_giro, w2);
+
+    // A amostra sozinha também conta, com o dobro do limiar: um tranco curto
+    // sobe a taxa antes de a média chegar lá
+    bool movimento = at->energia_accel > at->accel_limiar2 || at->energia_giro > at->giro_limiar2 ||
+                     (at->accel_limiar2 != UINT32_MAX && desvio * desvio > 4 * (uint64_t)at->accel_limiar2) ||
+                     (at->giro_limiar2 != UINT32_MAX && w2 > 4 * (uint64_t)at->giro_limiar2);
+    if (at->ultimo_movimento_us == 0)
+        at->ultimo_movimento_us = tempo_us;
+    if (movimento)
+    {
+        at->ultimo_movimento_us = tempo_us;
+        at->ativo = true;
+    }
+    else if (at->ativo && tempo_us - at->ultimo_movimento_us >= (uint64_t)at->config.espera_ms * 1000)
+    {
+        at->ativo = false;
+    }
+    return at->ativo;
+}
@@ -0,0 +1,46 @@
+#ifndef ATIVIDADE_H
+#define ATIVIDADE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Detector de movimento da taxa adaptativa (comando "adaptativo"): mede a
+// energia do movimento como médias exponenciais do quadrado do afastamento
+// de |a| em relação a 1 g e do quadrado da rotação, e compara cada uma com o
+// seu limiar. A subida é imediata: uma única amostra forte já passa o
+// limiar. A descida só vem depois de 'espera_ms' com as duas médias abaixo
+// dele. Só inteiros por amostra e nenhuma dependência do SDK.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint16_t accel_mg;  // afastamento RMS de |a| em relação a 1 g; 0 não usa
+    uint16_t giro_dps;  // rotação RMS; 0 não usa
+    uint16_t espera_ms; // tempo parado antes de voltar à taxa baixa
+} atividade_config_t;
+
+typedef struct {
+    atividade_config_t config;
+    uint32_t um_g;          // LSB
+    uint32_t accel_limiar2; // LSB²; UINT32_MAX não usa
+    uint32_t giro_limiar2;
+    uint32_t energia_accel; // médias exponenciais, LSB²
+    uint32_t energia_giro;
+    uint64_t ultimo_movimento_us;
+    bool ativo;
+} atividade_t;
+
+// Fundos de escala do MPU6050 para converter os limiares em LSB
+void atividade_iniciar(atividade_t *at, const atividade_config_t *config, uint16_t giro_fundo_dps,
+                       uint8_t accel_fundo_g);
+
+// Acrescenta uma amostra; retorna o estado depois dela (true: movimento)
+bool atividade_acrescentar(atividade_t *at, const int16_t accel[3], const int16_t gyro[3], uint64_t tempo_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ATIVIDADE_H
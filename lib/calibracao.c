@@ -0,0 +1,230 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "protocolo.h"
+#include "calibracao.h"
+
+#define CRC_LEN offsetof(calibracao_t, crc)
+
+// Limites para classificar um eixo na média de uma janela: vertical acima
+// de 0,8 g, horizontal abaixo de 0,3 g
+#define VERTICAL_MIN(um_g) ((int32_t)(um_g) * 4 / 5)
+#define HORIZONTAL_MAX(um_g) ((int32_t)(um_g) * 3 / 10)
+
+void calibracao_padrao(calibracao_t *c, uint16_t giro_dps, uint8_t accel_g)
+{
+    memset(c, 0, sizeof(*c));
+    memcpy(c->assinatura, "CAL1", 4);
+    c->tamanho = sizeof(*c);
+    c->giro_dps = giro_dps;
+    c->accel_g = accel_g;
+    for (int i = 0; i < 3; i++)
+        c->accel_escala[i] = CALIBRACAO_UM;
+    calibracao_selar(c);
+}
+
+bool calibracao_neutra(const calibracao_t *c)
+{
+    for (int i = 0; i < 3; i++)
+        if (c->giro_bias[i] || c->accel_offset[i] || c->accel_escala[i] != CALIBRACAO_UM)
+            return false;
+    return true;
+}
+
+void calibracao_selar(calibracao_t *c)
+{
+    c->crc = protocolo_crc16((const uint8_t *)c, CRC_LEN, 0xFFFF);
+}
+
+bool calibracao_valida(const calibracao_t *c)
+{
+    if (memcmp(c->assinatura, "CAL1", 4) != 0 || c->tamanho != sizeof(*c) ||
+        c->crc != protocolo_crc16((const uint8_t *)c, CRC_LEN, 0xFFFF))
+        return false;
+    for (int i = 0; i < 3; i++)
+        if (c->accel_escala[i] < CALIBRACAO_ESCALA_MIN || c->accel_escala[i] > CALIBRACAO_ESCALA_MAX)
+            return false;
+    return true;
+}
+
+// v · de / para, arredondado para o inteiro mais próximo
+static int32_t reescalar(int32_t v, uint32_t de, uint32_t para)
+{
+    int64_t a = (int64_t)v * de;
+    return (int32_t)(a >= 0 ? (a + para / 2) / para : -((-a + para / 2) / para));
+}
+
+void calibracao_converter(const calibracao_t *origem, uint16_t giro_dps, uint8_t accel_g, calibracao_t *destino)
+{
+    calibracao_t c = *origem;
+    uint16_t de_dps = origem->giro_dps ? origem->giro_dps : giro_dps;
+    uint8_t de_g = origem->accel_g ? origem->accel_g : accel_g;
+    for (int i = 0; i < 3; i++)
+    {
+        c.giro_bias[i] = calibracao_saturar(reescalar(origem->giro_bias[i], de_dps, giro_dps));
+        c.accel_offset[i] = calibracao_saturar(reescalar(origem->accel_offset[i], de_g, accel_g));
+    }
+    c.giro_dps = giro_dps;
+    c.accel_g = accel_g;
+    calibracao_selar(&c);
+    *destino = c;
+}
+
+int calibracao_formatar(const calibracao_t *c, char *destino, size_t tamanho)
+{
+    return snprintf(destino, tamanho, "giro_bias=%d %d %d accel_offset=%d %d %d accel_escala_q14=%u %u %u",
+                    c->giro_bias[0], c->giro_bias[1], c->giro_bias[2], c->accel_offset[0], c->accel_offset[1],
+                    c->accel_offset[2], c->accel_escala[0], c->accel_escala[1], c->accel_escala[2]);
+}
+
+void calibracao_janela_iniciar(calibracao_janela_t *j)
+{
+    memset(j, 0, sizeof(*j));
+}
+
+void calibracao_janela_acumular(calibracao_janela_t *j, const int16_t accel[3], const int16_t gyro[3])
+{
+    for (int i = 0; i < 3; i++)
+    {
+        j->soma_accel[i] += accel[i];
+        j->soma_giro[i] += gyro[i];
+        j->soma_giro_quadrado[i] += (uint64_t)((int32_t)gyro[i] * gyro[i]);
+    }
+    j->amostras++;
+}
+
+uint32_t calibracao_janela_agitacao(const calibracao_janela_t *j)
+{
+    if (j->amostras == 0)
+        return 0;
+    double maior = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        double media = (double)j->soma_giro[i] / j->amostras;
+        double v = (double)j->soma_giro_quadrado[i] / j->amostras - media * media;
+        if (v > maior)
+            maior = v;
+    }
+    return (uint32_t)(sqrt(maior) + 0.5);
+}
+
+// Divisão com arredondamento para o inteiro mais próximo
+static int64_t dividir(int64_t a, int64_t b)
+{
+    return (a >= 0) == (b >= 0) ? (a + b / 2) / b : (a - b / 2) / b;
+}
+
+void calibracao_estimativa_iniciar(calibracao_estimativa_t *e)
+{
+    memset(e, 0, sizeof(*e));
+}
+
+int calibracao_estimativa_acrescentar(calibracao_estimativa_t *e, const calibracao_janela_t *j, uint16_t um_g)
+{
+    if (j->amostras == 0)
+        return -1;
+    for (int i = 0; i < 3; i++)
+        e->soma_giro[i] += j->soma_giro[i];
+    e->n_giro += j->amostras;
+    e->posicoes++;
+
+    int32_t media[3];
+    for (int i = 0; i < 3; i++)
+        media[i] = (int32_t)dividir(j->soma_accel[i], j->amostras);
+    for (int v = 0; v < 3; v++)
+    {
+        int32_t modulo = media[v] < 0 ? -media[v] : media[v];
+        if (modulo < VERTICAL_MIN(um_g))
+            continue;
+        bool horizontais = true;
+        for (int i = 0; i < 3; i++)
+            if (i != v && (media[i] > HORIZONTAL_MAX(um_g) || media[i] < -HORIZONTAL_MAX(um_g)))
+                horizontais = false;
+        if (!horizontais)
+            return -1;
+        int lado = media[v] < 0;
+        for (int i = 0; i < 3; i++)
+            e->vertical[v][lado][i] = media[i];
+        e->tem_vertical[v][lado] = true;
+        for (int i = 0; i < 3; i++)
+        {
+            if (i == v)
+                continue;
+            e->soma_horizontal[i] += media[i];
+            e->n_horizontal[i]++;
+        }
+        return v + 3 * lado;
+    }
+    return -1;
+}
+
+static uint16_t limitar_escala(int64_t escala)
+{
+    if (escala < CALIBRACAO_ESCALA_MIN)
+        return CALIBRACAO_ESCALA_MIN;
+    if (escala > CALIBRACAO_ESCALA_MAX)
+        return CALIBRACAO_ESCALA_MAX;
+    return (uint16_t)escala;
+}
+
+// Componente da gravidade no eixo v da posição p: 1 g menos o que os
+// outros dois eixos, já sem offset, ainda medem da inclinação da placa
+static double gravidade_vertical(const int32_t p[3], int v, const int64_t offset[3], double um_g)
+{
+    double resto = um_g * um_g;
+    for (int i = 0; i < 3; i++)
+    {
+        if (i == v)
+            continue;
+        double h = (double)(p[i] - offset[i]);
+        resto -= h * h;
+    }
+    return resto > 0 ? sqrt(resto) : 0;
+}
+
+void calibracao_estimativa_resultado(const calibracao_estimativa_t *e, uint16_t giro_dps, uint8_t accel_g,
+                                     calibracao_t *c)
+{
+    calibracao_padrao(c, giro_dps, accel_g);
+    int64_t um_g = 32768 / (accel_g ? accel_g : 2);
+
+    // Offsets primeiro: a correção da inclinação depende deles
+    int64_t offset[3] = {0, 0, 0};
+    for (int i = 0; i < 3; i++)
+    {
+        if (e->n_giro)
+            c->giro_bias[i] = calibracao_saturar((int32_t)dividir(e->soma_giro[i], e->n_giro));
+
+        bool cima = e->tem_vertical[i][0], baixo = e->tem_vertical[i][1];
+        if (cima && baixo)
+            offset[i] = dividir((int64_t)e->vertical[i][0][i] + e->vertical[i][1][i], 2);
+        else if (e->n_horizontal[i])
+            offset[i] = dividir(e->soma_horizontal[i], e->n_horizontal[i]);
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        bool cima = e->tem_vertical[i][0], baixo = e->tem_vertical[i][1];
+        // Eixo medido só para um lado: offset supondo a escala nominal
+        if (!e->n_horizontal[i] && cima != baixo)
+            offset[i] = cima ? e->vertical[i][0][i] - (int64_t)gravidade_vertical(e->vertical[i][0], i, offset, um_g)
+                             : e->vertical[i][1][i] + (int64_t)gravidade_vertical(e->vertical[i][1], i, offset, um_g);
+        double g_cima = cima ? gravidade_vertical(e->vertical[i][0], i, offset, um_g) : 0;
+        double g_baixo = baixo ? gravidade_vertical(e->vertical[i][1], i, offset, um_g) : 0;
+        int64_t escala = CALIBRACAO_UM;
+        if (cima && baixo)
+        {
+            int64_t amplitude = (int64_t)e->vertical[i][0][i] - e->vertical[i][1][i];
+            if (amplitude > 0)
+                escala = (int64_t)((g_cima + g_baixo) * CALIBRACAO_UM / amplitude + 0.5);
+        }
+        else if (e->n_horizontal[i] && (cima || baixo))
+        {
+            int64_t amplitude = cima ? e->vertical[i][0][i] - offset[i] : offset[i] - e->vertical[i][1][i];
+            if (amplitude > 0)
+                escala = (int64_t)((cima ? g_cima : g_baixo) * CALIBRACAO_UM / amplitude + 0.5);
+        }
+        c->accel_offset[i] = calibracao_saturar((int32_t)offset[i]);
+        c->accel_escala[i] = limitar_escala(escala);
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef CALIBRACAO_H
+#define CALIBRACAO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Calibração do MPU6050: bias do giroscópio e offset/escala de cada eixo do
+// acelerômetro, estimados de capturas estáticas em uma ou mais posições
+// (comando "calibrar"). Os coeficientes ficam num setor reservado da flash
+// (calibracao_flash.c, só na placa) e são aplicados na captura com
+// subtração e multiplicação inteira seguida de deslocamento.
+// O resto é C puro, compilado também no PC (host/verificar_calibracao).
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CALIBRACAO_UM (1 << 14) // escala 1,0 em Q14
+#define CALIBRACAO_ESCALA_MIN (CALIBRACAO_UM / 2)
+#define CALIBRACAO_ESCALA_MAX (CALIBRACAO_UM * 3 / 2)
+
+// Registro gravado na flash (little-endian, como na placa)
+typedef struct __attribute__((packed)) {
+    char assinatura[4];       // "CAL1"
+    uint16_t tamanho;         // sizeof(calibracao_t)
+    uint16_t giro_dps;        // fundos de escala em que foi estimada
+    uint8_t accel_g;
+    uint8_t reservado;
+    int16_t giro_bias[3];     // LSB subtraídos do giroscópio
+    int16_t accel_offset[3];  // LSB subtraídos do acelerômetro
+    uint16_t accel_escala[3]; // ganho em Q14 aplicado depois do offset
+    uint16_t crc;             // CRC-16 dos bytes anteriores
+} calibracao_t;
+
+// Coeficientes neutros (não alteram as leituras)
+void calibracao_padrao(calibracao_t *c, uint16_t giro_dps, uint8_t accel_g);
+bool calibracao_neutra(const calibracao_t *c);
+void calibracao_selar(calibracao_t *c);
+bool calibracao_valida(const calibracao_t *c);
+
+// Os mesmos coeficientes para outros fundos de escala: bias e offset são
+// grandezas físicas, então mudam na razão das sensibilidades; a escala é
+// adimensional e fica igual. Sela o resultado
+void calibracao_converter(const calibracao_t *origem, uint16_t giro_dps, uint8_t accel_g, calibracao_t *destino);
+
+// "giro_bias=x y z accel_offset=x y z accel_escala_q14=x y z" para o cabeçalho do CSV
+int calibracao_formatar(const calibracao_t *c, char *destino, size_t tamanho);
+
+static inline int16_t calibracao_saturar(int32_t v)
+{
+    return v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : (int16_t)v);
+}
+
+// Caminho de cada amostra: 6 subtrações, 3 multiplicações de 32 bits e
+// deslocamentos. A escala limitada a 1,5 mantém o produto em 32 bits
+static inline void calibracao_aplicar(const calibracao_t *c, int16_t accel[3], int16_t gyro[3])
+{
+    for (int i = 0; i < 3; i++)
+    {
+        accel[i] = calibracao_saturar(((int32_t)(accel[i] - c->accel_offset[i]) * c->accel_escala[i]) >> 14);
+        gyro[i] = calibracao_saturar(gyro[i] - c->giro_bias[i]);
+    }
+}
+
+// Uma captura estática: somas exatas para média e variância
+typedef struct {
+    uint32_t amostras;
+    int64_t soma_accel[3];
+    int64_t soma_giro[3];
+    uint64_t soma_giro_quadrado[3];
+} calibracao_janela_t;
+
+void calibracao_janela_iniciar(calibracao_janela_t *j);
+void calibracao_janela_acumular(calibracao_janela_t *j, const int16_t accel[3], const int16_t gyro[3]);
+// Maior desvio padrão do giroscópio na janela, em LSB (detecta movimento)
+uint32_t calibracao_janela_agitacao(const calibracao_janela_t *j);
+
+// Acúmulo de várias posições. Um eixo medido apontando para cima e para
+// baixo dá offset e escala; na horizontal dá o offset; só para cima (ou só
+// para baixo) dá o offset supondo a escala nominal. A gravidade esperada
+// no eixo vertical desconta a inclinação que sobra nos outros dois
+typedef struct {
+    int32_t vertical[3][2][3]; // médias da posição com o eixo para cima [0] e para baixo [1]
+    bool tem_vertical[3][2];
+    int64_t soma_horizontal[3];
+    uint32_t n_horizontal[3];
+    int64_t soma_giro[3];
+    uint32_t n_giro;
+    uint32_t posicoes;
+} calibracao_estimativa_t;
+
+void calibracao_estimativa_iniciar(calibracao_estimativa_t *e);
+
+// Acrescenta uma janela estática. Retorna o eixo vertical (0 a 2, somado
+// de 3 se apontado para baixo) ou -1 se nenhum eixo estava perto de ±1 g
+int calibracao_estimativa_acrescentar(calibracao_estimativa_t *e, const calibracao_janela_t *j, uint16_t um_g);
+
+// Coeficientes com o que foi acumulado; não sela (CRC)
+void calibracao_estimativa_resultado(const calibracao_estimativa_t *e, uint16_t giro_dps, uint8_t accel_g,
+                                     calibracao_t *c);
+
+// Persistência na flash (calibracao_flash.c). carregar() devolve os
+// coeficientes neutros e false quando o setor não tem um registro válido
+bool calibracao_carregar(calibracao_t *c, uint16_t giro_dps, uint8_t accel_g);
+bool calibracao_gravar(const calibracao_t *c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CALIBRACAO_H
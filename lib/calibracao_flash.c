@@ -0,0 +1,38 @@
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "calibracao.h"
+
+// Último setor da flash, fora da área do programa
+#define CALIBRACAO_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+
+static const calibracao_t *const calibracao_flash =
+    (const calibracao_t *)(XIP_BASE + CALIBRACAO_FLASH_OFFSET);
+
+bool calibracao_carregar(calibracao_t *c, uint16_t giro_dps, uint8_t accel_g)
+{
+    memcpy(c, calibracao_flash, sizeof(*c));
+    if (calibracao_valida(c))
+        return true;
+    calibracao_padrao(c, giro_dps, accel_g);
+    return false;
+}
+
+// Roda com as interrupções desligadas e o outro núcleo parado fora da
+// flash (flash_safe_execute)
+static void gravar_setor(void *pagina)
+{
+    flash_range_erase(CALIBRACAO_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    flash_range_program(CALIBRACAO_FLASH_OFFSET, (const uint8_t *)pagina, FLASH_PAGE_SIZE);
+}
+
+bool calibracao_gravar(const calibracao_t *c)
+{
+    static uint8_t pagina[FLASH_PAGE_SIZE];
+    memset(pagina, 0xFF, sizeof(pagina));
+    memcpy(pagina, c, sizeof(*c));
+    if (PICO_OK != flash_safe_execute(gravar_setor, pagina, 500))
+        return false;
+    return 0 == memcmp(calibracao_flash, c, sizeof(*c));
+}
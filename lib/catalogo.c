@@ -0,0 +1,223 @@
+#include <stdio.h>
+#include <string.h>
+#include "protocolo.h"
+#include "catalogo.h"
+
+// Cabeçalho com o mesmo tamanho de um registro, para manter o alinhamento
+typedef struct __attribute__((packed)) {
+    char assinatura[4]; // "SESS"
+    uint16_t versao;
+    uint16_t tamanho_registro;
+    uint8_t reservado[56];
+} catalogo_cabecalho_t;
+
+_Static_assert(sizeof(catalogo_sessao_t) == 64, "registro do catálogo deve ter 64 bytes");
+_Static_assert(sizeof(catalogo_cabecalho_t) == sizeof(catalogo_sessao_t), "cabeçalho deve ter o tamanho de um registro");
+
+#define CRC_LEN (sizeof(catalogo_sessao_t) - sizeof(uint16_t))
+#define POSICAO(indice) ((FSIZE_t)((indice) + 1) * sizeof(catalogo_sessao_t))
+
+void catalogo_sessao_iniciar(catalogo_sessao_t *s, const char *nome, uint32_t inicio,
+                             uint32_t periodo_us, uint8_t formato)
+{
+    memset(s, 0, sizeof(*s));
+    strncpy(s->nome, nome, sizeof(s->nome) - 1);
+    s->inicio = inicio;
+    s->periodo_us = periodo_us;
+    s->formato = formato;
+    s->estado = CATALOGO_ESTADO_ABERTA;
+    for (int i = 0; i < 3; i++)
+    {
+        s->accel_min[i] = INT16_MAX;
+        s->accel_max[i] = INT16_MIN;
+    }
+    s->temp_min = INT16_MAX;
+    s->temp_max = INT16_MIN;
+}
+
+void catalogo_sessao_acumular(catalogo_sessao_t *s, const int16_t accel[3], int16_t temp)
+{
+    s->amostras++;
+    for (int i = 0; i < 3; i++)
+    {
+        if (accel[i] < s->accel_min[i])
+            s->accel_min[i] = accel[i];
+        if (accel[i] > s->accel_max[i])
+            s->accel_max[i] = accel[i];
+    }
+    if (temp < s->temp_min)
+        s->temp_min = temp;
+    if (temp > s->temp_max)
+        s->temp_max = temp;
+}
+
+static void selar(catalogo_sessao_t *s)
+{
+    s->crc = protocolo_crc16((const uint8_t *)s, CRC_LEN, 0xFFFF);
+}
+
+static FRESULT abrir(FIL *f, BYTE modo)
+{
+    FRESULT fr = f_open(f, CATALOGO_ARQUIVO, modo);
+    if (FR_OK != fr || f_size(f) >= sizeof(catalogo_cabecalho_t))
+        return fr;
+    if (!(modo & FA_WRITE))
+    {
+        // Arquivo vazio ou cortado antes do cabeçalho: catálogo vazio
+        f_close(f);
+        return FR_NO_FILE;
+    }
+    catalogo_cabecalho_t c = {.assinatura = {'S', 'E', 'S', 'S'},
+                              .versao = CATALOGO_VERSAO,
+                              .tamanho_registro = sizeof(catalogo_sessao_t)};
+    UINT bw;
+    fr = f_write(f, &c, sizeof(c), &bw);
+    if (FR_OK == fr && bw != sizeof(c))
+        fr = FR_DENIED;
+    if (FR_OK != fr)
+        f_close(f);
+    return fr;
+}
+
+static uint32_t quantidade_em(FIL *f)
+{
+    return (uint32_t)(f_size(f) / sizeof(catalogo_sessao_t)) - 1;
+}
+
+static FRESULT escrever_registro(FIL *f, uint32_t indice, catalogo_sessao_t *s)
+{
+    selar(s);
+    FRESULT fr = f_lseek(f, POSICAO(indice));
+    if (FR_OK != fr)
+        return fr;
+    UINT bw;
+    fr = f_write(f, s, sizeof(*s), &bw);
+    return FR_OK == fr && bw != sizeof(*s) ? FR_DENIED : fr;
+}
+
+FRESULT catalogo_acrescentar(catalogo_sessao_t *s, uint32_t *indice)
+{
+    FIL f;
+    FRESULT fr = abrir(&f, FA_READ | FA_WRITE | FA_OPEN_ALWAYS);
+    if (FR_OK != fr)
+        return fr;
+    // Um registro cortado por falta de energia é sobrescrito
+    *indice = quantidade_em(&f);
+    fr = escrever_registro(&f, *indice, s);
+    FRESULT fr_close = f_close(&f);
+    return FR_OK != fr ? fr : fr_close;
+}
+
+FRESULT catalogo_atualizar(uint32_t indice, catalogo_sessao_t *s)
+{
+    FIL f;
+    FRESULT fr = abrir(&f, FA_READ | FA_WRITE | FA_OPEN_EXISTING);
+    if (FR_OK != fr)
+        return fr;
+    fr = indice < quantidade_em(&f) ? escrever_registro(&f, indice, s) : FR_INVALID_PARAMETER;
+    FRESULT fr_close = f_close(&f);
+    return FR_OK != fr ? fr : fr_close;
+}
+
+FRESULT catalogo_quantidade(uint32_t *quantidade)
+{
+    FILINFO fno;
+    FRESULT fr = f_stat(CATALOGO_ARQUIVO, &fno);
+    if (FR_NO_FILE == fr || (FR_OK == fr && fno.fsize < sizeof(catalogo_cabecalho_t)))
+    {
+        *quantidade = 0;
+        return FR_OK;
+    }
+    if (FR_OK == fr)
+        *quantidade = (uint32_t)(fno.fsize / sizeof(catalogo_sessao_t)) - 1;
+    return fr;
+}
+
+FRESULT catalogo_ler(uint32_t primeiro, catalogo_sessao_t *s, uint32_t max, uint32_t *lidos)
+{
+    *lidos = 0;
+    FIL f;
+    FRESULT fr = abrir(&f, FA_READ);
+    if (FR_NO_FILE == fr)
+        return FR_OK;
+    if (FR_OK != fr)
+        return fr;
+    uint32_t n = quantidade_em(&f);
+    if (primeiro < n)
+    {
+        if (max > n - primeiro)
+            max = n - primeiro;
+        UINT br = 0;
+        fr = f_lseek(&f, POSICAO(primeiro));
+        if (FR_OK == fr)
+            fr = f_read(&f, s, max * sizeof(*s), &br);
+        *lidos = br / sizeof(*s);
+        for (uint32_t i = 0; i < *lidos; i++)
+            if (s[i].crc != protocolo_crc16((const uint8_t *)&s[i], CRC_LEN, 0xFFFF))
+                s[i].estado = 0;
+    }
+    f_close(&f);
+    return fr;
+}
+
+FRESULT catalogo_procurar(const char *nome, uint32_t *indice, catalogo_sessao_t *s)
+{
+    // Lê um setor (8 registros) por vez, do fim para o começo
+    catalogo_sessao_t bloco[8];
+    uint32_t n;
+    FRESULT fr = catalogo_quantidade(&n);
+    while (FR_OK == fr && n > 0)
+    {
+        uint32_t primeiro = n > 8 ? n - 8 : 0;
+        uint32_t lidos;
+        fr = catalogo_ler(primeiro, bloco, n - primeiro, &lidos);
+        for (uint32_t i = lidos; FR_OK == fr && i-- > 0;)
+        {
+            if (bloco[i].estado && 0 == strncmp(bloco[i].nome, nome, sizeof(bloco[i].nome)))
+            {
+                *indice = primeiro + i;
+                *s = bloco[i];
+                return FR_OK;
+            }
+        }
+        n = primeiro;
+    }
+    return FR_OK == fr ? FR_NO_FILE : fr;
+}
+
+FRESULT catalogo_reconstruir(uint32_t *importados)
+{
+    *importados = 0;
+    DIR dj;
+    FILINFO fno;
+    FRESULT fr = f_findfirst(&dj, &fno, "", "*.csv");
+    while (FR_OK == fr && fno.fname[0])
+    {
+        uint32_t indice;
+        catalogo_sessao_t s;
+        if (!(fno.fattrib & AM_DIR) && strlen(fno.fname) < sizeof(s.nome) &&
+            FR_NO_FILE == catalogo_procurar(fno.fname, &indice, &s))
+        {
+            uint32_t data = ((uint32_t)fno.fdate << 16) | fno.ftime;
+            catalogo_sessao_iniciar(&s, fno.fname, data, 0, CATALOGO_FORMATO_CSV);
+            s.fim = data;
+            s.tamanho = (uint32_t)fno.fsize;
+            s.estado = CATALOGO_ESTADO_IMPORTADA;
+            fr = catalogo_acrescentar(&s, &indice);
+            if (FR_OK == fr)
+                (*importados)++;
+        }
+        if (FR_OK == fr)
+            fr = f_findnext(&dj, &fno);
+    }
+    f_closedir(&dj);
+    return fr;
+}
+
+void catalogo_formatar_data(uint32_t fattime, char *destino, size_t tamanho)
+{
+    snprintf(destino, tamanho, "%02lu/%02lu/%02lu %02lu:%02lu:%02lu",
+             (unsigned long)((fattime >> 16) & 0x1F), (unsigned long)((fattime >> 21) & 0x0F),
+             (unsigned long)(((fattime >> 25) + 80) % 100), (unsigned long)((fattime >> 11) & 0x1F),
+             (unsigned long)((fattime >> 5) & 0x3F), (unsigned long)((fattime & 0x1F) * 2));
+}
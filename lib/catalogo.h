@@ -0,0 +1,76 @@
+#ifndef CATALOGO_H
+#define CATALOGO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ff.h"
+
+// Catálogo de sessões de captura no cartão: um cabeçalho e um registro de
+// tamanho fixo por sessão, acrescentado no início da captura e reescrito no
+// fim. A quantidade vem do tamanho do arquivo e o registro N está em
+// (N + 1) * sizeof(catalogo_sessao_t), então listar as últimas sessões ou
+// consultar uma pelo número não depende de quantas existem.
+
+#define CATALOGO_ARQUIVO "sessoes.cat"
+#define CATALOGO_VERSAO 1
+
+enum {
+    CATALOGO_FORMATO_CSV = 1,         // Data,Hora,Amostra,AccX..GyroZ,Temperatura
+    CATALOGO_FORMATO_CSV_EVENTOS = 2, // mesmas colunas, só as amostras em torno dos disparos
+    CATALOGO_FORMATO_ESPECTRO = 3     // uma linha por janela: picos e bins do espectro
+};
+
+enum {
+    CATALOGO_ESTADO_ABERTA = 1,   // captura em andamento (ou interrompida sem parar)
+    CATALOGO_ESTADO_FECHADA = 2,
+    CATALOGO_ESTADO_IMPORTADA = 3 // arquivo anterior ao catálogo (catalogo reconstruir)
+};
+
+// 64 bytes: 8 registros por setor
+typedef struct __attribute__((packed)) {
+    char nome[24];       // "dadosDDMMAAAAHHMMSS.csv"
+    uint32_t inicio;     // data/hora no formato do FatFs (get_fattime)
+    uint32_t fim;
+    uint32_t amostras;
+    uint32_t periodo_us;
+    uint32_t tamanho;    // bytes do arquivo ao fechar
+    int16_t accel_min[3];
+    int16_t accel_max[3];
+    int16_t temp_min;    // valores brutos do MPU6050
+    int16_t temp_max;
+    uint8_t formato;     // CATALOGO_FORMATO_*
+    uint8_t estado;      // CATALOGO_ESTADO_*
+    uint16_t crc;        // CRC-16 dos bytes anteriores
+} catalogo_sessao_t;
+
+// Prepara um registro novo (estado ABERTA, estatísticas vazias)
+void catalogo_sessao_iniciar(catalogo_sessao_t *s, const char *nome, uint32_t inicio,
+                             uint32_t periodo_us, uint8_t formato);
+
+// Atualiza contagem e mínimos/máximos com uma amostra (custo constante)
+void catalogo_sessao_acumular(catalogo_sessao_t *s, const int16_t accel[3], int16_t temp);
+
+// Acrescenta 's' ao catálogo (criando o arquivo se preciso) e informa seu número
+FRESULT catalogo_acrescentar(catalogo_sessao_t *s, uint32_t *indice);
+
+// Reescreve o registro 'indice'
+FRESULT catalogo_atualizar(uint32_t indice, catalogo_sessao_t *s);
+
+FRESULT catalogo_quantidade(uint32_t *quantidade);
+
+// Lê até 'max' registros a partir de 'primeiro'; registros com CRC inválido
+// voltam com estado 0
+FRESULT catalogo_ler(uint32_t primeiro, catalogo_sessao_t *s, uint32_t max, uint32_t *lidos);
+
+// Procura pelo nome do arquivo, das sessões mais recentes para as antigas
+FRESULT catalogo_procurar(const char *nome, uint32_t *indice, catalogo_sessao_t *s);
+
+// Acrescenta os arquivos .csv do diretório atual que ainda não estão no
+// catálogo (estado IMPORTADA, só nome, data e tamanho). Lento: percorre o
+// diretório uma vez
+FRESULT catalogo_reconstruir(uint32_t *importados);
+
+// "DD/MM/AA hh:mm:ss" a partir da data/hora do FatFs
+void catalogo_formatar_data(uint32_t fattime, char *destino, size_t tamanho);
+
+#endif // CATALOGO_H
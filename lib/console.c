@@ -0,0 +1,154 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/critical_section.h"
+#include "usb_saida.h"
+#include "console.h"
+
+#define CONSOLE_BLOCO_USB 256 // bytes entregues à USB por vez
+
+static char buffer[CONSOLE_CAPACIDADE];
+static uint32_t cabeca; // próxima escrita
+static uint32_t cauda;  // próximo byte a enviar
+static uint32_t ocupados;
+static uint32_t retirados; // total de bytes que já saíram pela cauda (enviados ou descartados)
+static uint32_t descartadas;
+static uint32_t descartadas_avisadas;
+static critical_section_t secao;
+
+void console_init(void)
+{
+    critical_section_init(&secao);
+}
+
+// Libera a linha mais antiga inteira (até o '\n', inclusive)
+static void descartar_linha_mais_antiga(void)
+{
+    while (ocupados > 0)
+    {
+        char c = buffer[cauda];
+        cauda = (cauda + 1) % CONSOLE_CAPACIDADE;
+        ocupados--;
+        retirados++;
+        if (c == '\n')
+            break;
+    }
+    descartadas++;
+}
+
+static void colocar(char c)
+{
+    if (ocupados == CONSOLE_CAPACIDADE)
+        descartar_linha_mais_antiga();
+    buffer[cabeca] = c;
+    cabeca = (cabeca + 1) % CONSOLE_CAPACIDADE;
+    ocupados++;
+}
+
+void console_escrever(const char *texto, size_t len)
+{
+    critical_section_enter_blocking(&secao);
+    for (size_t i = 0; i < len; i++)
+    {
+        if (texto[i] == '\n')
+            colocar('\r');
+        colocar(texto[i]);
+    }
+    critical_section_exit(&secao);
+}
+
+void console_putc(char c)
+{
+    console_escrever(&c, 1);
+}
+
+void console_printf(const char *fmt, ...)
+{
+    char mensagem[CONSOLE_MAX_MENSAGEM];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(mensagem, sizeof(mensagem), fmt, args);
+    va_end(args);
+    if (n < 0)
+        return;
+    if ((size_t)n >= sizeof(mensagem))
+        n = sizeof(mensagem) - 1;
+    console_escrever(mensagem, (size_t)n);
+}
+
+void console_tarefa(void)
+{
+    if (usb_saida_livre() == 0)
+        return;
+
+    // Avisa, na ordem em que aconteceu, que houve perda de linhas
+    if (descartadas != descartadas_avisadas)
+    {
+        char aviso[48];
+        int n = snprintf(aviso, sizeof(aviso), "\r\n[console: %lu linha(s) descartada(s)]\r\n",
+                         (unsigned long)(descartadas - descartadas_avisadas));
+        if (!usb_saida_enviar((const uint8_t *)aviso, (size_t)n))
+            return;
+        descartadas_avisadas = descartadas;
+    }
+
+    // A USB é escrita fora da seção crítica: o trecho é copiado com a trava
+    // e, enquanto é enviado, quem escreve pode descartar linhas da cauda.
+    // Esses bytes descartados são os primeiros do trecho; só o que foi
+    // aceito além deles ainda está no buffer e sai da cauda.
+    char bloco[CONSOLE_BLOCO_USB];
+    for (;;)
+    {
+        critical_section_enter_blocking(&secao);
+        // Trecho contíguo até o fim do buffer circular
+        uint32_t len = CONSOLE_CAPACIDADE - cauda;
+        if (len > ocupados)
+            len = ocupados;
+        if (len > CONSOLE_BLOCO_USB)
+            len = CONSOLE_BLOCO_USB;
+        memcpy(bloco, &buffer[cauda], len);
+        uint32_t marca = retirados;
+        critical_section_exit(&secao);
+        if (len == 0)
+            return;
+
+        size_t aceitos = usb_saida_escrever((const uint8_t *)bloco, len);
+
+        critical_section_enter_blocking(&secao);
+        uint32_t ja_retirados = retirados - marca;
+        if (aceitos > ja_retirados)
+        {
+            uint32_t n = (uint32_t)aceitos - ja_retirados;
+            cauda = (cauda + n) % CONSOLE_CAPACIDADE;
+            ocupados -= n;
+            retirados += n;
+        }
+        critical_section_exit(&secao);
+        if (aceitos < len)
+            return;
+    }
+}
+
+bool console_aguardar(size_t espaco, uint32_t timeout_ms)
+{
+    absolute_time_t limite = make_timeout_time_ms(timeout_ms);
+    while (CONSOLE_CAPACIDADE - ocupados < espaco)
+    {
+        console_tarefa();
+        if (time_reached(limite) || !usb_saida_conectada())
+            return false;
+        tight_loop_contents();
+    }
+    return true;
+}
+
+void console_descarregar(uint32_t timeout_ms)
+{
+    console_aguardar(CONSOLE_CAPACIDADE, timeout_ms);
+}
+
+uint32_t console_descartadas(void)
+{
+    return descartadas;
+}
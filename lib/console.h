@@ -0,0 +1,86 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Saída de texto do console sem bloquear: as mensagens vão para um buffer
+// circular e console_tarefa() as entrega à USB conforme houver espaço.
+// Se o PC não lê, as linhas mais antigas são descartadas (e contadas); quem
+// escreve nunca espera a porta serial. Pode ser chamada em interrupções.
+
+#define CONSOLE_CAPACIDADE 4096
+#define CONSOLE_MAX_MENSAGEM 256 // maior mensagem de console_printf
+
+// Níveis de log, escolhidos na compilação. LOG_NIVEL pode ser definido no
+// CMake; sem isso, builds Release (NDEBUG) ficam em LOG_NIVEL_INFO e as
+// chamadas LOG_DEBUG não geram código nem texto no binário.
+#define LOG_NIVEL_NENHUM 0
+#define LOG_NIVEL_ERRO 1
+#define LOG_NIVEL_AVISO 2
+#define LOG_NIVEL_INFO 3
+#define LOG_NIVEL_DEBUG 4
+
+#ifndef LOG_NIVEL
+#ifdef NDEBUG
+#define LOG_NIVEL LOG_NIVEL_INFO
+#else
+#define LOG_NIVEL LOG_NIVEL_DEBUG
+#endif
+#endif
+
+// Níveis desativados: o compilador ainda confere o formato e considera as
+// variáveis usadas, mas elimina a chamada e o texto
+#define LOG_DESATIVADO(fmt, ...)                  \
+    do                                            \
+    {                                             \
+        if (0)                                    \
+            console_printf(fmt, ##__VA_ARGS__);   \
+    } while (0)
+
+#if LOG_NIVEL >= LOG_NIVEL_ERRO
+#define LOG_ERRO(fmt, ...) console_printf("[ERRO] " fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERRO(fmt, ...) LOG_DESATIVADO(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_NIVEL >= LOG_NIVEL_AVISO
+#define LOG_AVISO(fmt, ...) console_printf("[AVISO] " fmt, ##__VA_ARGS__)
+#else
+#define LOG_AVISO(fmt, ...) LOG_DESATIVADO(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_NIVEL >= LOG_NIVEL_INFO
+#define LOG_INFO(fmt, ...) console_printf(fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(fmt, ...) LOG_DESATIVADO(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_NIVEL >= LOG_NIVEL_DEBUG
+#define LOG_DEBUG(fmt, ...) console_printf("[DEBUG] " fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(fmt, ...) LOG_DESATIVADO(fmt, ##__VA_ARGS__)
+#endif
+
+void console_init(void);
+
+// Enfileira texto; '\n' vira "\r\n" como no stdio do SDK
+void console_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+void console_escrever(const char *texto, size_t len);
+void console_putc(char c);
+
+// Chamada no laço principal: entrega à USB o que couber, sem esperar
+void console_tarefa(void);
+
+// Para comandos com saída longa (ls, cat): drena até haver 'espaco' bytes
+// livres no buffer, por no máximo 'timeout_ms'. Nunca usar na amostragem.
+bool console_aguardar(size_t espaco, uint32_t timeout_ms);
+
+// Drena tudo (ou até o timeout), antes de a USB passar ao modo binário
+void console_descarregar(uint32_t timeout_ms);
+
+// Linhas descartadas desde o boot por falta de espaço
+uint32_t console_descartadas(void);
+
+#endif // CONSOLE_H
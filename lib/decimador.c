@@ -0,0 +1,183 @@
+#include <math.h>
+#include <string.h>
+#include "decimador.h"
+
+// Corte do FIR compensador, em ciclos por amostra da saída
+#define CORTE_SAIDA 0.42
+#define PASSOS_INTEGRACAO 512
+
+static uint32_t ganho_cic(const decimador_config_t *c)
+{
+    uint32_t g = 1;
+    if (c->cic_fator > 1)
+        for (int i = 0; i < c->cic_ordem; i++)
+        {
+            g *= c->cic_fator;
+            if (g > DECIMADOR_GANHO_CIC_MAX)
+                return DECIMADOR_GANHO_CIC_MAX + 1;
+        }
+    return g;
+}
+
+bool decimador_config_valida(const decimador_config_t *c, const char **motivo)
+{
+    const char *erro = NULL;
+    int32_t soma = 0;
+    for (int i = 0; i < c->taps && i < DECIMADOR_TAPS_MAX; i++)
+        soma += c->fir[i];
+    if (c->cic_fator == 0 || c->fir_fator == 0)
+        erro = "fator zero";
+    else if (c->cic_fator > 1 && (c->cic_ordem == 0 || c->cic_ordem > DECIMADOR_ORDEM_MAX))
+        erro = "ordem do CIC fora de 1 a 5";
+    else if (ganho_cic(c) > DECIMADOR_GANHO_CIC_MAX)
+        erro = "R^N passa de 65536";
+    else if (c->taps > DECIMADOR_TAPS_MAX)
+        erro = "FIR com mais de 31 coeficientes";
+    else if (c->fir_fator > 1 && c->taps == 0)
+        erro = "decimação sem FIR (aliasing)";
+    else if (c->taps && soma <= 0)
+        erro = "soma dos coeficientes não é positiva";
+    else if (decimador_fator(c) < 2)
+        erro = "fator total menor que 2";
+    if (motivo)
+        *motivo = erro;
+    return erro == NULL;
+}
+
+uint32_t decimador_fator(const decimador_config_t *c)
+{
+    return (uint32_t)c->cic_fator * c->fir_fator;
+}
+
+uint32_t decimador_atraso_x2(const decimador_config_t *c)
+{
+    uint32_t atraso = c->cic_fator > 1 ? (uint32_t)c->cic_ordem * (c->cic_fator - 1) : 0;
+    if (c->taps)
+        atraso += (uint32_t)(c->taps - 1) * c->cic_fator;
+    return atraso;
+}
+
+void decimador_projetar_fir(decimador_config_t *c, uint8_t taps)
+{
+    const double pi = 3.14159265358979323846;
+    if (taps > DECIMADOR_TAPS_MAX)
+        taps = DECIMADOR_TAPS_MAX;
+    taps |= 1;
+    c->taps = taps;
+    // Frequências em ciclos por amostra da saída do CIC
+    const double corte = CORTE_SAIDA / c->fir_fator;
+    const double r = c->cic_fator;
+    const int ordem = c->cic_fator > 1 ? c->cic_ordem : 0;
+    double h[DECIMADOR_TAPS_MAX];
+    double soma = 0;
+    for (int n = 0; n < taps; n++)
+    {
+        // h[n] = 2 ∫ D(f) cos(2π f (n − centro)) df de 0 ao corte, com D o
+        // inverso da resposta do CIC
+        double t = n - (taps - 1) / 2.0, acumulado = 0;
+        for (int k = 0; k < PASSOS_INTEGRACAO; k++)
+        {
+            double f = (k + 0.5) * corte / PASSOS_INTEGRACAO;
+            double cic = sin(pi * f) / (r * sin(pi * f / r));
+            acumulado += cos(2 * pi * f * t) / pow(cic, ordem);
+        }
+        double janela = taps > 1 ? 0.54 - 0.46 * cos(2 * pi * n / (taps - 1)) : 1;
+        h[n] = 2 * acumulado * corte / PASSOS_INTEGRACAO * janela;
+        soma += h[n];
+    }
+    // Ganho 1 em 0 Hz depois do arredondamento: a sobra vai para o centro
+    int32_t total = 0;
+    for (int n = 0; n < taps; n++)
+    {
+        c->fir[n] = (int16_t)lround(h[n] / soma * DECIMADOR_UM_Q14);
+        total += c->fir[n];
+    }
+    c->fir[taps / 2] += (int16_t)(DECIMADOR_UM_Q14 - total);
+}
+
+void decimador_iniciar(decimador_t *d, const decimador_config_t *c)
+{
+    memset(d, 0, sizeof(*d));
+    d->config = *c;
+    uint32_t g = ganho_cic(c);
+    int b = 0;
+    while ((1u << b) < g)
+        b++;
+    d->ganho_mult = (uint32_t)(((1ull << (23 + b)) + g / 2) / g);
+    d->ganho_desloc = (uint8_t)(15 + b);
+}
+
+// Soma ponderada do histórico (Q8 · Q14), arredondada para LSB
+static int16_t saturar(int64_t v, int deslocamento)
+{
+    v = (v + (1ll << (deslocamento - 1))) >> deslocamento;
+    return v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : (int16_t)v);
+}
+
+bool decimador_acrescentar(decimador_t *d, const int16_t entrada[DECIMADOR_CANAIS],
+                           int16_t saida[DECIMADOR_CANAIS])
+{
+    const decimador_config_t *c = &d->config;
+    const int ordem = c->cic_fator > 1 ? c->cic_ordem : 0;
+
+    // Integradores a cada entrada; a aritmética sem sinal dá a volta sem
+    // estouro indefinido e os pentes desfazem as voltas
+    for (int canal = 0; canal < DECIMADOR_CANAIS; canal++)
+    {
+        uint32_t v = (uint32_t)(int32_t)entrada[canal];
+        for (int k = 0; k < ordem; k++)
+            v = d->integrador[canal][k] += v;
+    }
+    if (++d->fase_cic < c->cic_fator)
+        return false;
+    d->fase_cic = 0;
+
+    int32_t q8[DECIMADOR_CANAIS];
+    for (int canal = 0; canal < DECIMADOR_CANAIS; canal++)
+    {
+        int32_t v = entrada[canal];
+        if (ordem)
+        {
+            uint32_t u = d->integrador[canal][ordem - 1];
+            for (int k = 0; k < ordem; k++)
+            {
+                uint32_t anterior = d->pente[canal][k];
+                d->pente[canal][k] = u;
+                u -= anterior;
+            }
+            v = (int32_t)u;
+        }
+        // Divide pelo ganho R^N e guarda 8 bits de fração
+        int64_t p = (int64_t)v * d->ganho_mult;
+        q8[canal] = (int32_t)((p + (1ll << (d->ganho_desloc - 1))) >> d->ganho_desloc);
+    }
+
+    if (c->taps == 0)
+    {
+        for (int canal = 0; canal < DECIMADOR_CANAIS; canal++)
+            saida[canal] = saturar(q8[canal], 8);
+        return true;
+    }
+    uint8_t posicao = d->posicao;
+    for (int canal = 0; canal < DECIMADOR_CANAIS; canal++)
+        d->historico[canal][posicao] = q8[canal];
+    d->posicao = (uint8_t)(posicao + 1 == c->taps ? 0 : posicao + 1);
+    if (++d->fase_fir < c->fir_fator)
+        return false;
+    d->fase_fir = 0;
+
+    // O coeficiente 0 pesa a amostra mais recente
+    for (int canal = 0; canal < DECIMADOR_CANAIS; canal++)
+    {
+        const int32_t *h = d->historico[canal];
+        int64_t soma = 0;
+        int j = posicao;
+        for (int i = 0; i < c->taps; i++)
+        {
+            soma += (int64_t)h[j] * c->fir[i];
+            j = j == 0 ? c->taps - 1 : j - 1;
+        }
+        saida[canal] = saturar(soma, 14 + 8);
+    }
+    return true;
+}
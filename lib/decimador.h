@@ -0,0 +1,71 @@
+#ifndef DECIMADOR_H
+#define DECIMADOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Redução da taxa das amostras (comando "decimar"): um CIC de ordem N que
+// decima por R, seguido de um FIR que compensa a queda do CIC na banda útil
+// e decima por M. Os sete canais do MPU6050 (aceleração, giroscópio e
+// temperatura) passam pela mesma cadeia. Tudo em inteiros: integradores de
+// 32 bits com volta (R^N até 65536), saída do CIC normalizada em Q8 e FIR
+// com coeficientes Q14. O ponto flutuante fica em decimador_projetar_fir().
+// Código C puro, compilado também no PC (host/verificar_decimador) para
+// comparar com a mesma cadeia em double.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DECIMADOR_CANAIS 7 // AccX..AccZ, GyroX..GyroZ, Temp
+#define DECIMADOR_ORDEM_MAX 5
+#define DECIMADOR_GANHO_CIC_MAX 65536u // R^N: entrada de 16 bits em 32
+#define DECIMADOR_TAPS_MAX 31
+#define DECIMADOR_UM_Q14 16384 // soma dos coeficientes com ganho 1 (coeficientes até ±2)
+
+typedef struct {
+    uint16_t cic_fator; // R (1 = sem CIC)
+    uint8_t cic_ordem;  // N
+    uint8_t fir_fator;  // M (1 = o FIR só filtra)
+    uint8_t taps;       // 0 = sem FIR
+    int16_t fir[DECIMADOR_TAPS_MAX]; // Q14
+} decimador_config_t;
+
+typedef struct {
+    decimador_config_t config;
+    uint32_t ganho_mult; // 2^(23+b) / R^N, com 2^b >= R^N
+    uint8_t ganho_desloc; // 15 + b
+    uint16_t fase_cic;
+    uint8_t fase_fir;
+    uint8_t posicao;     // próxima posição do histórico do FIR
+    uint32_t integrador[DECIMADOR_CANAIS][DECIMADOR_ORDEM_MAX];
+    uint32_t pente[DECIMADOR_CANAIS][DECIMADOR_ORDEM_MAX];
+    int32_t historico[DECIMADOR_CANAIS][DECIMADOR_TAPS_MAX]; // saída do CIC, Q8
+} decimador_t;
+
+// Fatores dentro dos limites, FIR presente quando M > 1 e soma dos
+// coeficientes positiva. Em 'motivo' fica o texto do primeiro problema
+bool decimador_config_valida(const decimador_config_t *c, const char **motivo);
+
+// Fator total R·M
+uint32_t decimador_fator(const decimador_config_t *c);
+
+// Atraso de grupo da cadeia em amostras de entrada, vezes 2 (pode ser meio)
+uint32_t decimador_atraso_x2(const decimador_config_t *c);
+
+// FIR de 'taps' coeficientes (ímpar, até DECIMADOR_TAPS_MAX) que desfaz a
+// queda do CIC até o corte, em 0,42 da taxa de saída, com janela de Hamming
+// e ganho exato de 1 em 0 Hz
+void decimador_projetar_fir(decimador_config_t *c, uint8_t taps);
+
+void decimador_iniciar(decimador_t *d, const decimador_config_t *c);
+
+// Acrescenta uma amostra de entrada; true quando sai uma amostra em 'saida'
+bool decimador_acrescentar(decimador_t *d, const int16_t entrada[DECIMADOR_CANAIS],
+                           int16_t saida[DECIMADOR_CANAIS]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DECIMADOR_H
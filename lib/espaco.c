@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include "espaco.h"
+#include "diskio.h"
+#include "console.h"
+
+static FATFS *fs;
+static WORD id_montagem;
+static espaco_estado_t estado = ESPACO_DESMONTADO;
+
+// Verificação em andamento
+static LBA_t setor_inicial;  // fatbase ou bitbase
+static DWORD setores;        // tamanho da área a percorrer
+static DWORD proximo;        // setores já lidos
+static DWORD livres;         // contados até aqui
+static DWORD ultimo_cluster; // fs->last_clst e fs->free_clst no começo: se
+static DWORD livre_inicial;  // mudarem, houve alocação e a contagem recomeça
+static BYTE setor[ESPACO_SETORES_POR_VOLTA][FF_MIN_SS];
+
+static bool livre_valido(void)
+{
+    return fs->free_clst <= fs->n_fatent - 2;
+}
+
+static void recomecar(void)
+{
+    proximo = 0;
+    livres = 0;
+    ultimo_cluster = fs->last_clst;
+    livre_inicial = fs->free_clst;
+}
+
+void espaco_iniciar(FATFS *sistema)
+{
+    fs = sistema;
+    id_montagem = fs->id;
+    switch (fs->fs_type)
+    {
+    case FS_FAT12:
+    {
+        // FAT de poucos setores (até 4084 clusters): f_getfree é imediato
+        DWORD n;
+        FATFS *p;
+        estado = FR_OK == f_getfree("", &n, &p) ? ESPACO_VERIFICADO : ESPACO_CONTANDO;
+        setores = 0;
+        return;
+    }
+    case FS_FAT16:
+        setor_inicial = fs->fatbase;
+        setores = (fs->n_fatent * 2 + FF_MIN_SS - 1) / FF_MIN_SS;
+        break;
+    case FS_FAT32:
+        setor_inicial = fs->fatbase;
+        setores = (fs->n_fatent * 4 + FF_MIN_SS - 1) / FF_MIN_SS;
+        break;
+#if FF_FS_EXFAT
+    case FS_EXFAT:
+        setor_inicial = fs->bitbase;
+        setores = ((fs->n_fatent - 2) / 8 + FF_MIN_SS - 1) / FF_MIN_SS;
+        break;
+#endif
+    default:
+        estado = ESPACO_DESMONTADO;
+        return;
+    }
+    estado = livre_valido() ? ESPACO_FSINFO : ESPACO_CONTANDO;
+    recomecar();
+}
+
+void espaco_parar(void)
+{
+    estado = ESPACO_DESMONTADO;
+    fs = NULL;
+}
+
+// Clusters livres em 'n' setores a partir do setor 'primeiro' da área
+static DWORD contar(DWORD primeiro, UINT n)
+{
+    DWORD total = 0;
+    for (UINT s = 0; s < n; s++)
+    {
+        const BYTE *b = setor[s];
+        DWORD base = primeiro + s;
+        if (fs->fs_type == FS_FAT16)
+        {
+            for (DWORD i = 0; i < FF_MIN_SS / 2; i++)
+            {
+                DWORD cluster = base * (FF_MIN_SS / 2) + i;
+                if (cluster >= 2 && cluster < fs->n_fatent && (b[2 * i] | b[2 * i + 1]) == 0)
+                    total++;
+            }
+        }
+        else if (fs->fs_type == FS_FAT32)
+        {
+            for (DWORD i = 0; i < FF_MIN_SS / 4; i++)
+            {
+                DWORD cluster = base * (FF_MIN_SS / 4) + i;
+                if (cluster >= 2 && cluster < fs->n_fatent &&
+                    (b[4 * i] | b[4 * i + 1] | b[4 * i + 2] | (b[4 * i + 3] & 0x0F)) == 0)
+                    total++;
+            }
+        }
+        else
+        {
+            // Bitmap do exFAT: bit i = cluster i + 2
+            for (DWORD i = 0; i < FF_MIN_SS; i++)
+            {
+                DWORD bit = (base * FF_MIN_SS + i) * 8;
+                if (bit >= fs->n_fatent - 2)
+                    break;
+                BYTE livres_byte = (BYTE)~b[i];
+                DWORD validos = fs->n_fatent - 2 - bit;
+                if (validos < 8)
+                    livres_byte &= (BYTE)((1u << validos) - 1);
+                while (livres_byte)
+                {
+                    livres_byte &= (BYTE)(livres_byte - 1);
+                    total++;
+                }
+            }
+        }
+    }
+    return total;
+}
+
+void espaco_tarefa(void)
+{
+    if (estado != ESPACO_CONTANDO && estado != ESPACO_FSINFO)
+        return;
+    if (fs->fs_type == 0 || fs->id != id_montagem)
+    {
+        // Desmontado ou remontado por fora: o próximo espaco_iniciar recomeça
+        estado = ESPACO_DESMONTADO;
+        return;
+    }
+    // Setor da FAT alterado na janela do FatFs e ainda não gravado
+    if (fs->wflag)
+        return;
+    if (fs->last_clst != ultimo_cluster || fs->free_clst != livre_inicial)
+    {
+        recomecar();
+        return;
+    }
+
+    UINT n = setores - proximo < ESPACO_SETORES_POR_VOLTA ? (UINT)(setores - proximo) : ESPACO_SETORES_POR_VOLTA;
+    if (RES_OK != disk_read(fs->pdrv, setor[0], setor_inicial + proximo, n))
+        return; // tenta de novo na próxima volta
+    livres += contar(proximo, n);
+    proximo += n;
+    if (proximo < setores)
+        return;
+
+    if (livre_valido() && fs->free_clst != livres)
+        LOG_AVISO("Espaço livre: FSINFO indicava %lu clusters, FAT tem %lu\n", (unsigned long)fs->free_clst,
+               (unsigned long)livres);
+    fs->free_clst = livres;
+    if (fs->fs_type == FS_FAT32)
+        fs->fsi_flag |= 1; // FSINFO corrigido no próximo f_sync
+    estado = ESPACO_VERIFICADO;
+}
+
+espaco_estado_t espaco_estado(void)
+{
+    return estado;
+}
+
+uint8_t espaco_progresso(void)
+{
+    if (estado == ESPACO_VERIFICADO)
+        return 100;
+    if (estado == ESPACO_DESMONTADO || setores == 0)
+        return 0;
+    return (uint8_t)((uint64_t)proximo * 100 / setores);
+}
+
+bool espaco_livre(uint64_t *bytes)
+{
+    if (estado == ESPACO_DESMONTADO || !livre_valido())
+        return false;
+    *bytes = (uint64_t)fs->free_clst * fs->csize * FF_MIN_SS;
+    return true;
+}
+
+uint64_t espaco_total(void)
+{
+    if (estado == ESPACO_DESMONTADO)
+        return 0;
+    return (uint64_t)(fs->n_fatent - 2) * fs->csize * FF_MIN_SS;
+}
+
+bool espaco_esgotado(void)
+{
+    uint64_t livre;
+    return espaco_livre(&livre) && livre < ESPACO_RESERVA_BYTES;
+}
+
+bool espaco_previsao(uint32_t bytes_por_segundo, uint32_t *segundos)
+{
+    uint64_t livre;
+    if (!espaco_livre(&livre) || bytes_por_segundo == 0)
+        return false;
+    livre = livre > ESPACO_RESERVA_BYTES ? livre - ESPACO_RESERVA_BYTES : 0;
+    uint64_t s = livre / bytes_por_segundo;
+    *segundos = s > UINT32_MAX ? UINT32_MAX : (uint32_t)s;
+    return true;
+}
+
+void espaco_formatar_duracao(uint32_t segundos, char *destino, size_t tamanho)
+{
+    if (segundos >= 86400)
+        snprintf(destino, tamanho, "%lud%02luh", (unsigned long)(segundos / 86400),
+                 (unsigned long)(segundos % 86400 / 3600));
+    else if (segundos >= 3600)
+        snprintf(destino, tamanho, "%luh%02lum", (unsigned long)(segundos / 3600),
+                 (unsigned long)(segundos % 3600 / 60));
+    else
+        snprintf(destino, tamanho, "%lum%02lus", (unsigned long)(segundos / 60), (unsigned long)(segundos % 60));
+}
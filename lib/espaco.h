@@ -0,0 +1,51 @@
+#ifndef ESPACO_H
+#define ESPACO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ff.h"
+
+// Espaço livre do cartão sem f_getfree() no caminho crítico. Na montagem
+// vale o contador do FSINFO (FAT32), que o FatFs mantém a cada alocação;
+// a FAT (ou o bitmap do exFAT) é recontada aos poucos por espaco_tarefa(),
+// alguns setores por volta do laço principal, para validar esse valor ou
+// obtê-lo quando o FSINFO não existe ou não é confiável. Nesse caso o
+// f_getfree() leria a FAT inteira de uma vez (segundos em cartões grandes).
+
+#define ESPACO_SETORES_POR_VOLTA 4 // ~17 ms de SPI a 1 MHz
+#define ESPACO_RESERVA_BYTES (256 * 1024) // sobra para fechar a sessão (catálogo, .est)
+
+typedef enum {
+    ESPACO_DESMONTADO,
+    ESPACO_CONTANDO,   // sem valor confiável ainda
+    ESPACO_FSINFO,     // valor do FSINFO, verificação em andamento
+    ESPACO_VERIFICADO  // conferido com a FAT nesta montagem
+} espaco_estado_t;
+
+// Depois do f_mount: adota o FSINFO e agenda a verificação
+void espaco_iniciar(FATFS *fs);
+
+// Antes de desmontar ou formatar
+void espaco_parar(void);
+
+// Chamada no laço principal: lê alguns setores da FAT por vez
+void espaco_tarefa(void);
+
+espaco_estado_t espaco_estado(void);
+uint8_t espaco_progresso(void); // % da verificação
+
+// false enquanto o valor não é conhecido
+bool espaco_livre(uint64_t *bytes);
+uint64_t espaco_total(void);
+
+// Livre abaixo da reserva: a captura deve parar
+bool espaco_esgotado(void);
+
+// Segundos até o cartão encher (descontada a reserva) gravando
+// 'bytes_por_segundo'; false se o espaço ainda não é conhecido
+bool espaco_previsao(uint32_t bytes_por_segundo, uint32_t *segundos);
+
+// "3d04h", "5h12m", "7m30s"
+void espaco_formatar_duracao(uint32_t segundos, char *destino, size_t tamanho);
+
+#endif // ESPACO_H
@@ -0,0 +1,227 @@
+#include <math.h>
+#include <string.h>
+#include "espectro.h"
+
+// Entrada de cada estágio abaixo deste limite: a saída da borboleta fica
+// abaixo de 8192 · (1 + √2) e cabe em 16 bits
+#define LIMITE_ESTAGIO 8192
+
+static uint32_t raiz32(uint32_t v)
+{
+    uint32_t r = 0;
+    for (uint32_t bit = 1u << 30; bit; bit >>= 2)
+    {
+        if (v >= r + bit)
+        {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        }
+        else
+        {
+            r >>= 1;
+        }
+    }
+    return r;
+}
+
+static inline int32_t modulo(int32_t v)
+{
+    return v < 0 ? -v : v;
+}
+
+bool espectro_n_valido(uint32_t n)
+{
+    return n >= ESPECTRO_N_MIN && n <= ESPECTRO_N_MAX && (n & (n - 1)) == 0;
+}
+
+void espectro_iniciar(espectro_t *e, const espectro_config_t *config)
+{
+    const double pi = 3.14159265358979323846;
+    e->config = *config;
+    e->log2n = 0;
+    while ((1u << e->log2n) < config->n)
+        e->log2n++;
+    // Hann periódica (simétrica na DFT): sem vazamento entre janelas vizinhas
+    for (int i = 0; i < config->n; i++)
+        e->hann[i] = (int16_t)lround(32767 * (0.5 - 0.5 * cos(2 * pi * i / config->n)));
+    for (int k = 0; k < ESPECTRO_N_MAX / 2; k++)
+    {
+        e->cosseno[k] = (int16_t)lround(32767 * cos(2 * pi * k / ESPECTRO_N_MAX));
+        e->seno[k] = (int16_t)lround(32767 * sin(2 * pi * k / ESPECTRO_N_MAX));
+    }
+    // Resposta da Hann a um seno deslocado δ bins do centro, relativa ao
+    // centro: sinc(δ) / (1 − δ²). A tabela guarda o inverso
+    e->correcao[0] = 1 << 14;
+    for (int i = 1; i < 33; i++)
+    {
+        double d = i / 64.0;
+        double ganho = sin(pi * d) / (pi * d) / (1 - d * d);
+        e->correcao[i] = (uint16_t)lround((1 << 14) / ganho);
+    }
+}
+
+// FFT direta no lugar sobre e->re/e->im, com a entrada já abaixo de
+// LIMITE_ESTAGIO. Retorna quantas vezes o bloco foi dividido por 2
+static int fft(espectro_t *e, int32_t maior)
+{
+    const int n = e->config.n;
+    int16_t *re = e->re, *im = e->im;
+
+    // Permutação por bits invertidos
+    for (int i = 1, j = 0; i < n; i++)
+    {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j |= bit;
+        if (i < j)
+        {
+            int16_t t = re[i];
+            re[i] = re[j];
+            re[j] = t;
+            t = im[i];
+            im[i] = im[j];
+            im[j] = t;
+        }
+    }
+
+    int expoente = 0;
+    for (int tamanho = 2; tamanho <= n; tamanho <<= 1)
+    {
+        int s = maior >= LIMITE_ESTAGIO;
+        expoente += s;
+        maior = 0;
+        int metade = tamanho >> 1;
+        int passo = ESPECTRO_N_MAX / tamanho;
+        for (int j = 0; j < metade; j++)
+        {
+            // W = e^(-i·2π·j/tamanho)
+            int32_t wr = e->cosseno[j * passo], wi = -e->seno[j * passo];
+            for (int a = j; a < n; a += tamanho)
+            {
+                int b = a + metade;
+                int32_t xr = re[b] >> s, xi = im[b] >> s;
+                int32_t ar = re[a] >> s, ai = im[a] >> s;
+                int32_t tr = (wr * xr - wi * xi + (1 << 14)) >> 15;
+                int32_t ti = (wr * xi + wi * xr + (1 << 14)) >> 15;
+                int32_t v0 = ar + tr, v1 = ai + ti, v2 = ar - tr, v3 = ai - ti;
+                re[a] = (int16_t)v0;
+                im[a] = (int16_t)v1;
+                re[b] = (int16_t)v2;
+                im[b] = (int16_t)v3;
+                int32_t m = modulo(v0) | modulo(v1) | modulo(v2) | modulo(v3);
+                if (m > maior)
+                    maior = m;
+            }
+        }
+    }
+    return expoente;
+}
+
+// Amplitude (em LSB) de um seno que produz |X| = magnitude neste bin: com a
+// janela de Hann (ganho coerente 1/2), A = |X| · 2^expoente · 4 / n
+static uint16_t amplitude_lsb(uint32_t magnitude, int deslocamento, uint32_t correcao_q14)
+{
+    uint64_t a = (uint64_t)magnitude * correcao_q14;
+    deslocamento -= 14;
+    a = deslocamento >= 0 ? a << deslocamento : (a + (1ull << (-deslocamento - 1))) >> -deslocamento;
+    return a > UINT16_MAX ? UINT16_MAX : (uint16_t)a;
+}
+
+void espectro_calcular(espectro_t *e, const int16_t *amostras, uint64_t inicio_us, uint64_t fim_us,
+                       espectro_resultado_t *r)
+{
+    const int n = e->config.n;
+    const int metade = n / 2;
+
+    // Média e RMS sem a média
+    int32_t soma = 0;
+    for (int i = 0; i < n; i++)
+        soma += amostras[i];
+    int32_t media = soma >= 0 ? (soma + n / 2) >> e->log2n : -((-soma + n / 2) >> e->log2n);
+    uint64_t soma_quadrados = 0;
+    for (int i = 0; i < n; i++)
+    {
+        int32_t d = amostras[i] - media;
+        soma_quadrados += (uint32_t)(d * d);
+    }
+    uint64_t quadrado_medio = soma_quadrados >> e->log2n;
+    r->rms = (uint16_t)raiz32(quadrado_medio > UINT32_MAX ? UINT32_MAX : (uint32_t)quadrado_medio);
+    r->media = (int16_t)media;
+
+    // Janela: o produto (amostra − média) · hann tem 15 bits de fração, e
+    // o deslocamento escolhido põe o maior valor entre 4096 e 8191. Sinais
+    // pequenos não perdem resolução na entrada da FFT
+    int32_t maior = 0;
+    for (int i = 0; i < n; i++)
+    {
+        int32_t d = amostras[i] - media;
+        d = d > 32767 ? 32767 : (d < -32768 ? -32768 : d);
+        if (modulo(d * e->hann[i]) > maior)
+            maior = modulo(d * e->hann[i]);
+    }
+    int deslocamento_entrada = 0; // para a direita
+    if (maior)
+    {
+        while ((maior >> deslocamento_entrada) >= LIMITE_ESTAGIO)
+            deslocamento_entrada++;
+        while (deslocamento_entrada > -12 && (maior >> deslocamento_entrada) < LIMITE_ESTAGIO / 2)
+            deslocamento_entrada--;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        int32_t d = amostras[i] - media;
+        d = d > 32767 ? 32767 : (d < -32768 ? -32768 : d);
+        int32_t p = d * e->hann[i];
+        e->re[i] = (int16_t)(deslocamento_entrada >= 0 ? p >> deslocamento_entrada : p << -deslocamento_entrada);
+        e->im[i] = 0;
+    }
+    maior = deslocamento_entrada >= 0 ? maior >> deslocamento_entrada : maior << -deslocamento_entrada;
+    // Entrada da FFT = (amostra − média) · janela · 2^escala
+    int escala = 15 - deslocamento_entrada;
+    int expoente = fft(e, maior) - escala;
+
+    int deslocamento = expoente + 2 - e->log2n;
+    for (int k = 0; k <= metade; k++)
+    {
+        int32_t xr = e->re[k], xi = e->im[k];
+        e->magnitude[k] = (uint16_t)raiz32((uint32_t)(xr * xr) + (uint32_t)(xi * xi));
+        if (e->config.bins)
+            r->amplitude[k] = amplitude_lsb(e->magnitude[k], deslocamento - (k == 0 || k == metade), 1 << 14);
+    }
+
+    // Instante e taxa medidos na janela
+    r->n = (uint16_t)n;
+    r->tempo_us = inicio_us;
+    uint64_t duracao = fim_us > inicio_us ? fim_us - inicio_us : 0;
+    r->fs_chz = duracao ? (uint32_t)((uint64_t)(n - 1) * 100000000ull / duracao) : 0;
+
+    // Os maiores máximos locais (fora do bin 0), com a posição refinada
+    // pela razão entre o bin e o maior vizinho, exata para a janela de Hann:
+    // δ = (2·v − m) / (m + v). A amplitude desconta a perda fora do centro
+    memset(r->picos, 0, sizeof(r->picos));
+    for (int k = 1; k < metade; k++)
+    {
+        uint32_t m = e->magnitude[k];
+        if (m == 0 || m <= e->magnitude[k - 1] || m < e->magnitude[k + 1])
+            continue;
+        uint32_t antes = e->magnitude[k - 1], depois = e->magnitude[k + 1];
+        uint32_t vizinho = depois > antes ? depois : antes;
+        int32_t delta_q8 = 2 * vizinho > m ? (int32_t)(((2 * vizinho - m) << 8) / (m + vizinho)) : 0;
+        if (delta_q8 > 128)
+            delta_q8 = 128;
+        uint16_t amp = amplitude_lsb(m, deslocamento, e->correcao[delta_q8 >> 2]);
+        if (antes > depois)
+            delta_q8 = -delta_q8;
+
+        int p = ESPECTRO_PICOS;
+        while (p > 0 && r->picos[p - 1].amplitude < amp)
+            p--;
+        if (p == ESPECTRO_PICOS)
+            continue;
+        memmove(&r->picos[p + 1], &r->picos[p], (ESPECTRO_PICOS - 1 - p) * sizeof(r->picos[0]));
+        int64_t bin_q8 = (int64_t)k * 256 + delta_q8;
+        r->picos[p].frequencia_chz = (uint32_t)((bin_q8 * r->fs_chz + ((int64_t)n << 7)) >> (8 + e->log2n));
+        r->picos[p].amplitude = amp;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef ESPECTRO_H
+#define ESPECTRO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Espectro de vibração de um eixo do acelerômetro: janela de Hann e FFT
+// radix-2 em ponto fixo de 16 bits (Q15), com escala em bloco (o estágio
+// só divide por 2 quando algum valor poderia estourar). Os produtos são de
+// 16 × 16 bits, que o Cortex-M0+ faz numa instrução. O ponto flutuante
+// fica em espectro_iniciar() (tabelas). Código C puro, compilado também no
+// PC (host/verificar_espectro) para comparar com uma DFT em double.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESPECTRO_N_MIN 64
+#define ESPECTRO_N_MAX 1024
+#define ESPECTRO_PICOS 3
+
+typedef struct {
+    uint16_t n;   // pontos por janela (potência de 2, ESPECTRO_N_MIN a ESPECTRO_N_MAX)
+    uint8_t eixo; // 0 a 2: AccX, AccY, AccZ
+    bool bins;    // grava a amplitude de todos os bins, além dos picos
+} espectro_config_t;
+
+typedef struct {
+    uint32_t frequencia_chz; // centésimos de Hz, interpolada entre os bins
+    uint16_t amplitude;      // amplitude do seno equivalente, em LSB
+} espectro_pico_t;
+
+typedef struct {
+    uint32_t janela;    // número da janela na sessão (a partir de 1)
+    uint64_t tempo_us;  // instante da primeira amostra (desde o boot)
+    uint32_t fs_chz;    // taxa medida na janela, centésimos de Hz
+    uint32_t maior_intervalo_us; // maior intervalo entre amostras (preenchido por quem junta a janela)
+    uint16_t n;
+    uint16_t rms;       // RMS da janela sem a média, em LSB
+    int16_t media;
+    espectro_pico_t picos[ESPECTRO_PICOS]; // do maior para o menor; amplitude 0 se faltou
+    uint16_t amplitude[ESPECTRO_N_MAX / 2 + 1]; // por bin, em LSB (só com config.bins)
+} espectro_resultado_t;
+
+typedef struct {
+    espectro_config_t config;
+    uint8_t log2n;
+    int16_t hann[ESPECTRO_N_MAX];          // Q15
+    int16_t cosseno[ESPECTRO_N_MAX / 2];   // Q15, para ESPECTRO_N_MAX pontos
+    int16_t seno[ESPECTRO_N_MAX / 2];
+    uint16_t correcao[33];                 // perda da Hann fora do centro do bin, Q14, δ de 0 a 0,5
+    int16_t re[ESPECTRO_N_MAX];
+    int16_t im[ESPECTRO_N_MAX];
+    uint16_t magnitude[ESPECTRO_N_MAX / 2 + 1]; // |X| na escala interna da FFT
+} espectro_t;
+
+bool espectro_n_valido(uint32_t n);
+
+void espectro_iniciar(espectro_t *e, const espectro_config_t *config);
+
+// Processa uma janela de config.n amostras de um eixo e os instantes de
+// leitura da primeira e da última (para a taxa real)
+void espectro_calcular(espectro_t *e, const int16_t *amostras, uint64_t inicio_us, uint64_t fim_us,
+                       espectro_resultado_t *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESPECTRO_H
@@ -0,0 +1,153 @@
+#include <math.h>
+#include <string.h>
+#include "protocolo.h"
+#include "estatisticas.h"
+
+#define CRC_LEN offsetof(estatisticas_t, crc)
+
+const char *const estatisticas_nomes[EST_CANAIS] = {"AccX", "AccY", "AccZ", "GyroX", "GyroY", "GyroZ", "Temp"};
+
+void estatisticas_iniciar(estatisticas_t *e, uint32_t periodo_us, uint8_t accel_faixa, uint8_t giro_faixa)
+{
+    memset(e, 0, sizeof(*e));
+    memcpy(e->assinatura, "EST1", 4);
+    e->tamanho = sizeof(*e);
+    e->accel_faixa = accel_faixa;
+    e->giro_faixa = giro_faixa;
+    e->periodo_us = periodo_us;
+    for (int c = 0; c < EST_CANAIS; c++)
+    {
+        e->canal[c].min = INT16_MAX;
+        e->canal[c].max = INT16_MIN;
+    }
+    e->intervalo_min_us = UINT32_MAX;
+}
+
+static void canal_acumular(estatisticas_canal_t *c, int16_t v)
+{
+    if (v < c->min)
+        c->min = v;
+    if (v > c->max)
+        c->max = v;
+    c->soma += v;
+    c->soma_quadrados += (uint32_t)((int32_t)v * v);
+}
+
+void estatisticas_acumular(estatisticas_t *e, const int16_t accel[3], const int16_t gyro[3], int16_t temp,
+                           uint64_t tempo_us)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        canal_acumular(&e->canal[EST_ACCX + i], accel[i]);
+        canal_acumular(&e->canal[EST_GYROX + i], gyro[i]);
+    }
+    canal_acumular(&e->canal[EST_TEMP], temp);
+    e->amostras++;
+
+    // Até 3 · 32768² = 0xC0000000: cabe em 32 bits sem sinal
+    uint32_t modulo = (uint32_t)((int32_t)accel[0] * accel[0]) + (uint32_t)((int32_t)accel[1] * accel[1]) +
+                      (uint32_t)((int32_t)accel[2] * accel[2]);
+    if (modulo > e->pico_accel_quadrado || e->amostras == 1)
+    {
+        e->pico_accel_quadrado = modulo;
+        e->pico_amostra = e->amostras;
+    }
+
+    if (e->amostras > 1)
+    {
+        uint64_t delta = tempo_us - e->ultimo_us;
+        uint32_t intervalo = delta > UINT32_MAX ? UINT32_MAX : (uint32_t)delta;
+        if (intervalo < e->intervalo_min_us)
+            e->intervalo_min_us = intervalo;
+        if (intervalo > e->intervalo_max_us)
+            e->intervalo_max_us = intervalo;
+        int64_t desvio = (int64_t)intervalo - e->periodo_us;
+        e->soma_desvio_us += desvio;
+        e->soma_desvio_quadrado += (uint64_t)(desvio * desvio);
+    }
+    e->ultimo_us = tempo_us;
+}
+
+void estatisticas_fechar(estatisticas_t *e)
+{
+    e->crc = protocolo_crc16((const uint8_t *)e, CRC_LEN, 0xFFFF);
+}
+
+bool estatisticas_valida(const estatisticas_t *e)
+{
+    return memcmp(e->assinatura, "EST1", 4) == 0 && e->tamanho == sizeof(*e) &&
+           e->crc == protocolo_crc16((const uint8_t *)e, CRC_LEN, 0xFFFF);
+}
+
+double estatisticas_media(const estatisticas_t *e, int canal)
+{
+    return e->amostras ? (double)e->canal[canal].soma / e->amostras : 0.0;
+}
+
+// Inteiro de 128 bits sem sinal, só para o numerador da variância (sem
+// __int128 no Cortex-M0+)
+typedef struct {
+    uint64_t alto;
+    uint64_t baixo;
+} u128_t;
+
+static u128_t multiplicar(uint64_t a, uint64_t b)
+{
+    uint64_t a0 = (uint32_t)a, a1 = a >> 32, b0 = (uint32_t)b, b1 = b >> 32;
+    uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    uint64_t meio = (p00 >> 32) + (uint32_t)p01 + (uint32_t)p10;
+    u128_t r = {p11 + (p01 >> 32) + (p10 >> 32) + (meio >> 32), (meio << 32) | (uint32_t)p00};
+    return r;
+}
+
+// Variância populacional (n·Σx² − (Σx)²) / n². O numerador é exato em 128
+// bits: não há cancelamento, e o único arredondamento é a conversão final
+// para double
+static double variancia(int64_t soma, uint64_t soma_quadrados, uint32_t n)
+{
+    if (n == 0)
+        return 0.0;
+    uint64_t modulo = soma < 0 ? 0 - (uint64_t)soma : (uint64_t)soma;
+    u128_t a = multiplicar(n, soma_quadrados);
+    u128_t b = multiplicar(modulo, modulo);
+    if (a.alto < b.alto || (a.alto == b.alto && a.baixo <= b.baixo))
+        return 0.0;
+    uint64_t alto = a.alto - b.alto - (a.baixo < b.baixo);
+    uint64_t baixo = a.baixo - b.baixo;
+    return (ldexp((double)alto, 64) + (double)baixo) / ((double)n * n);
+}
+
+double estatisticas_desvio(const estatisticas_t *e, int canal)
+{
+    return sqrt(variancia(e->canal[canal].soma, e->canal[canal].soma_quadrados, e->amostras));
+}
+
+double estatisticas_pico_accel(const estatisticas_t *e)
+{
+    return sqrt((double)e->pico_accel_quadrado);
+}
+
+double estatisticas_intervalo_medio_us(const estatisticas_t *e)
+{
+    if (e->amostras < 2)
+        return 0.0;
+    return e->periodo_us + (double)e->soma_desvio_us / (e->amostras - 1);
+}
+
+double estatisticas_jitter_us(const estatisticas_t *e)
+{
+    if (e->amostras < 2)
+        return 0.0;
+    return sqrt(variancia(e->soma_desvio_us, e->soma_desvio_quadrado, e->amostras - 1));
+}
+
+void estatisticas_nome(const char *arquivo, char *destino, size_t tamanho)
+{
+    strncpy(destino, arquivo, tamanho - 1);
+    destino[tamanho - 1] = '\0';
+    char *ponto = strrchr(destino, '.');
+    size_t base = ponto ? (size_t)(ponto - destino) : strlen(destino);
+    if (base + sizeof(ESTATISTICAS_EXTENSAO) > tamanho)
+        base = tamanho - sizeof(ESTATISTICAS_EXTENSAO);
+    memcpy(destino + base, ESTATISTICAS_EXTENSAO, sizeof(ESTATISTICAS_EXTENSAO));
+}
@@ -0,0 +1,85 @@
+#ifndef ESTATISTICAS_H
+#define ESTATISTICAS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Estatísticas de uma sessão acumuladas durante a captura, com custo
+// constante e só inteiros por amostra. Ao parar, o registro vai para
+// "dadosX.est", ao lado do CSV: "info" e host/resumo_sessao mostram média,
+// desvio, pico e jitter sem ler os dados. Código C puro, compilado também
+// no PC.
+//
+// Em vez de Welford, guarda somas e somas dos quadrados exatas em 64 bits:
+// com valores de 16 bits não há estouro antes de 2^32 amostras e não há
+// divisão nem perda de precisão por amostra. A variância sai no fechamento
+// como (n·Σx² − (Σx)²) / n², com o numerador calculado exato em 128 bits e
+// arredondado uma vez só para double.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESTATISTICAS_EXTENSAO ".est"
+
+enum {
+    EST_ACCX, EST_ACCY, EST_ACCZ,
+    EST_GYROX, EST_GYROY, EST_GYROZ,
+    EST_TEMP,
+    EST_CANAIS
+};
+
+typedef struct __attribute__((packed)) {
+    int16_t min;
+    int16_t max;
+    int64_t soma;
+    uint64_t soma_quadrados;
+} estatisticas_canal_t;
+
+// Registro gravado no arquivo .est (little-endian, como na placa)
+typedef struct __attribute__((packed)) {
+    char assinatura[4];        // "EST1"
+    uint16_t tamanho;          // sizeof(estatisticas_t)
+    uint8_t accel_faixa;       // AFS_SEL e FS_SEL da sessão (lib/mpu6050_escala.h): 0 nos
+    uint8_t giro_faixa;        // arquivos anteriores, que eram todos ±2 g e ±250 °/s
+    uint32_t amostras;
+    uint32_t periodo_us;       // período programado
+    estatisticas_canal_t canal[EST_CANAIS]; // valores brutos do MPU6050
+    uint32_t pico_accel_quadrado; // maior AccX² + AccY² + AccZ²
+    uint32_t pico_amostra;        // amostra (a partir de 1) onde ocorreu
+    uint64_t ultimo_us;           // instante da amostra anterior
+    uint32_t intervalo_min_us;
+    uint32_t intervalo_max_us;
+    int64_t soma_desvio_us;       // Σ (intervalo − periodo_us)
+    uint64_t soma_desvio_quadrado; // Σ (intervalo − periodo_us)²
+    uint16_t crc;                 // CRC-16 dos bytes anteriores
+} estatisticas_t;
+
+void estatisticas_iniciar(estatisticas_t *e, uint32_t periodo_us, uint8_t accel_faixa, uint8_t giro_faixa);
+
+// Acrescenta uma amostra lida no instante 'tempo_us' (desde o boot)
+void estatisticas_acumular(estatisticas_t *e, const int16_t accel[3], const int16_t gyro[3], int16_t temp,
+                           uint64_t tempo_us);
+
+// Calcula o CRC antes de gravar
+void estatisticas_fechar(estatisticas_t *e);
+bool estatisticas_valida(const estatisticas_t *e);
+
+// Resultados, em unidades brutas (LSB) e microssegundos
+double estatisticas_media(const estatisticas_t *e, int canal);
+double estatisticas_desvio(const estatisticas_t *e, int canal);
+double estatisticas_pico_accel(const estatisticas_t *e);
+double estatisticas_intervalo_medio_us(const estatisticas_t *e);
+double estatisticas_jitter_us(const estatisticas_t *e); // desvio padrão dos intervalos
+
+// Nome do arquivo de estatísticas de um arquivo de dados (troca a extensão)
+void estatisticas_nome(const char *arquivo, char *destino, size_t tamanho);
+
+extern const char *const estatisticas_nomes[EST_CANAIS];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESTATISTICAS_H
@@ -0,0 +1,182 @@
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "feedback.h"
+
+#define FEEDBACK_MSG_MAX 64
+#define BUZZER_NIVEL 256
+
+// Padrão liga/desliga genérico, usado tanto pelo LED quanto pelo buzzer
+typedef struct {
+    uint16_t ligado_ms;
+    uint16_t desligado_ms;
+    uint8_t restantes;  // ciclos que faltam; 0 = inativo
+    bool continuo;      // ignora 'restantes' e repete até ser parado
+    bool ligado;        // fase atual
+    uint16_t decorrido_ms;
+} padrao_t;
+
+static uint pino_r, pino_g, pino_b, pino_buzzer;
+static ssd1306_t *display;
+static repeating_timer_t temporizador;
+
+static volatile feedback_cor_t cor_fixa = COR_APAGADO;
+static volatile feedback_cor_t cor_piscar = COR_APAGADO;
+static padrao_t padrao_led;
+static padrao_t padrao_buzzer;
+
+static char mensagem[FEEDBACK_MSG_MAX];
+static volatile bool mensagem_pendente = false;
+static absolute_time_t mensagem_fim = {0};
+
+static void aplicar_cor(feedback_cor_t cor)
+{
+    gpio_put(pino_r, cor & 0x01);
+    gpio_put(pino_g, cor & 0x02);
+    gpio_put(pino_b, cor & 0x04);
+}
+
+static void aplicar_buzzer(bool ligado)
+{
+    pwm_set_gpio_level(pino_buzzer, ligado ? BUZZER_NIVEL : 0);
+}
+
+static void padrao_iniciar(padrao_t *p, uint16_t ligado_ms, uint16_t desligado_ms, uint8_t vezes)
+{
+    p->ligado_ms = ligado_ms;
+    p->desligado_ms = desligado_ms;
+    p->continuo = (vezes == 0);
+    p->restantes = p->continuo ? 1 : vezes;
+    p->ligado = true;
+    p->decorrido_ms = 0;
+}
+
+// Avança um padrão em FEEDBACK_TICK_MS; retorna false quando terminou
+static bool padrao_avancar(padrao_t *p)
+{
+    if (p->restantes == 0)
+        return false;
+    p->decorrido_ms += FEEDBACK_TICK_MS;
+    if (p->ligado && p->decorrido_ms >= p->ligado_ms)
+    {
+        p->ligado = false;
+        p->decorrido_ms = 0;
+    }
+    if (!p->ligado && p->decorrido_ms >= p->desligado_ms)
+    {
+        if (!p->continuo)
+            p->restantes--;
+        p->ligado = true;
+        p->decorrido_ms = 0;
+    }
+    return p->restantes > 0;
+}
+
+// Executado na interrupção do temporizador: só mexe em GPIO e PWM
+static bool feedback_tick(repeating_timer_t *rt)
+{
+    (void)rt;
+    if (padrao_avancar(&padrao_led))
+        aplicar_cor(padrao_led.ligado ? cor_piscar : COR_APAGADO);
+    else
+        aplicar_cor(cor_fixa);
+
+    aplicar_buzzer(padrao_avancar(&padrao_buzzer) && padrao_buzzer.ligado);
+    return true;
+}
+
+void feedback_init(uint led_r, uint led_g, uint led_b, uint buzzer, ssd1306_t *ssd)
+{
+    pino_r = led_r;
+    pino_g = led_g;
+    pino_b = led_b;
+    pino_buzzer = buzzer;
+    display = ssd;
+
+    gpio_init(pino_r);
+    gpio_set_dir(pino_r, GPIO_OUT);
+    gpio_init(pino_g);
+    gpio_set_dir(pino_g, GPIO_OUT);
+    gpio_init(pino_b);
+    gpio_set_dir(pino_b, GPIO_OUT);
+
+    gpio_set_function(pino_buzzer, GPIO_FUNC_PWM);
+    uint slice_num = pwm_gpio_to_slice_num(pino_buzzer);
+    uint clk_div = clock_get_hz(clk_sys) / (1000 * 4096); // Frequência ~1000Hz
+    pwm_set_clkdiv(slice_num, clk_div);
+    pwm_set_wrap(slice_num, 4095); // Resolução PWM
+    pwm_set_enabled(slice_num, true);
+    aplicar_buzzer(false);
+
+    add_repeating_timer_ms(-FEEDBACK_TICK_MS, feedback_tick, NULL, &temporizador);
+}
+
+void feedback_led_fixo(feedback_cor_t cor)
+{
+    cor_fixa = cor;
+}
+
+void feedback_led_piscar(feedback_cor_t cor, uint16_t ligado_ms, uint16_t desligado_ms, uint8_t vezes)
+{
+    uint32_t irq = save_and_disable_interrupts();
+    cor_piscar = cor;
+    padrao_iniciar(&padrao_led, ligado_ms, desligado_ms, vezes);
+    restore_interrupts(irq);
+}
+
+void feedback_led_parar(void)
+{
+    uint32_t irq = save_and_disable_interrupts();
+    padrao_led.restantes = 0;
+    restore_interrupts(irq);
+}
+
+void feedback_bipe(uint8_t vezes, uint16_t ligado_ms, uint16_t desligado_ms)
+{
+    if (vezes == 0)
+        return;
+    uint32_t irq = save_and_disable_interrupts();
+    padrao_iniciar(&padrao_buzzer, ligado_ms, desligado_ms, vezes);
+    restore_interrupts(irq);
+}
+
+void feedback_mensagem(const char *texto, uint32_t duracao_ms)
+{
+    strncpy(mensagem, texto, sizeof(mensagem) - 1);
+    mensagem[sizeof(mensagem) - 1] = '\0';
+    mensagem_fim = make_timeout_time_ms(duracao_ms);
+    mensagem_pendente = true;
+}
+
+bool feedback_mensagem_ativa(void)
+{
+    return mensagem_pendente || !time_reached(mensagem_fim);
+}
+
+void feedback_tarefa(void)
+{
+    if (!mensagem_pendente || !display)
+        return;
+    mensagem_pendente = false;
+
+    // Só a última mensagem agendada é desenhada: comandos que trocam de
+    // mensagem várias vezes custam uma única atualização do display
+    ssd1306_fill(display, false);
+    uint8_t y = 0;
+    const char *linha = mensagem;
+    while (*linha && y + 8 <= display->height)
+    {
+        char buf[FEEDBACK_MSG_MAX];
+        size_t n = strcspn(linha, "\n");
+        memcpy(buf, linha, n);
+        buf[n] = '\0';
+        ssd1306_draw_string(display, buf, 5, y);
+        y += 10;
+        linha += n;
+        if (*linha == '\n')
+            linha++;
+    }
+    ssd1306_send_data(display);
+}
@@ -0,0 +1,49 @@
+#ifndef FEEDBACK_H
+#define FEEDBACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "ssd1306.h"
+
+// Período do temporizador que avança os padrões de LED e buzzer
+#define FEEDBACK_TICK_MS 10
+
+// Cores do LED RGB (bit 0 = vermelho, bit 1 = verde, bit 2 = azul)
+typedef enum {
+    COR_APAGADO = 0,
+    COR_VERMELHO = 1,
+    COR_VERDE = 2,
+    COR_AMARELO = 3,
+    COR_AZUL = 4,
+    COR_ROXO = 5,
+    COR_CIANO = 6,
+    COR_BRANCO = 7
+} feedback_cor_t;
+
+// Configura LEDs, buzzer (PWM) e o temporizador que executa os padrões.
+// O display é usado apenas por feedback_tarefa(), nunca pela interrupção.
+void feedback_init(uint led_r, uint led_g, uint led_b, uint buzzer, ssd1306_t *ssd);
+
+// Cor exibida quando nenhum padrão de piscar está ativo
+void feedback_led_fixo(feedback_cor_t cor);
+
+// Pisca a cor informada 'vezes' vezes e volta para a cor fixa.
+// vezes = 0 pisca continuamente até feedback_led_parar().
+void feedback_led_piscar(feedback_cor_t cor, uint16_t ligado_ms, uint16_t desligado_ms, uint8_t vezes);
+void feedback_led_parar(void);
+
+// Sequência de bipes sem bloquear o chamador
+void feedback_bipe(uint8_t vezes, uint16_t ligado_ms, uint16_t desligado_ms);
+
+// Agenda uma mensagem no OLED por 'duracao_ms'. Linhas separadas por '\n'.
+// O desenho acontece na próxima chamada de feedback_tarefa().
+void feedback_mensagem(const char *texto, uint32_t duracao_ms);
+
+// Indica se ainda há mensagem sendo exibida (a tela de repouso deve esperar)
+bool feedback_mensagem_ativa(void);
+
+// Chamada no laço principal: desenha a mensagem pendente, se houver
+void feedback_tarefa(void);
+
+#endif // FEEDBACK_H
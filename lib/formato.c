@@ -0,0 +1,49 @@
+#include "formato.h"
+
+#define MIB(x) ((uint64_t)(x) * 2048) // em setores
+#define GIB(x) (MIB(x) * 1024)
+
+typedef struct {
+    uint64_t ate;         // capacidade máxima da faixa, em setores
+    uint8_t tipo;         // FM_*
+    uint32_t cluster;     // bytes
+    uint32_t alinhamento; // setores
+    const char *descricao;
+} faixa_t;
+
+static const faixa_t faixas[] = {
+    {MIB(256), FM_FAT, 16 * 1024, 128, "FAT16/12, cluster 16 KiB, alinhado a 64 KiB"},
+    {GIB(2), FM_FAT | FM_FAT32, 32 * 1024, 8192, "SDSC: FAT16, cluster 32 KiB, alinhado a 4 MiB"},
+    {GIB(32), FM_FAT32, 32 * 1024, 8192, "SDHC: FAT32, cluster 32 KiB, alinhado a 4 MiB"},
+    {UINT64_MAX, FM_EXFAT, 128 * 1024, 32768, "SDXC: exFAT, cluster 128 KiB, alinhado a 16 MiB"},
+};
+
+void formato_perfil_registro(uint64_t setores, formato_perfil_t *perfil)
+{
+    const faixa_t *f = faixas;
+    while (setores > f->ate)
+        f++;
+    perfil->parametros.fmt = f->tipo;
+    perfil->parametros.n_fat = 1; // uma cópia da FAT: metade das gravações de FAT
+    perfil->parametros.align = f->alinhamento;
+    perfil->parametros.n_root = 0;
+    perfil->parametros.au_size = f->cluster;
+    perfil->descricao = f->descricao;
+}
+
+const char *formato_nome_tipo(uint8_t fs_type)
+{
+    switch (fs_type)
+    {
+    case FS_FAT12:
+        return "FAT12";
+    case FS_FAT16:
+        return "FAT16";
+    case FS_FAT32:
+        return "FAT32";
+    case FS_EXFAT:
+        return "exFAT";
+    default:
+        return "?";
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef FORMATO_H
+#define FORMATO_H
+
+#include <stdint.h>
+#include "ff.h"
+
+// Perfil de formatação para gravação sequencial (comando "format"). O tipo
+// de FAT, o tamanho do cluster e o alinhamento da área de dados seguem a
+// capacidade do cartão, como nas recomendações da SD Association: clusters
+// grandes (menos atualizações da FAT por byte gravado) e dados começando no
+// limite da unidade de apagamento (AU), para que cada cluster caia inteiro
+// dentro de uma AU. O driver SPI não lê o tamanho da AU do cartão (ACMD13),
+// então o alinhamento usa o valor típico de cada classe de capacidade.
+// Código C puro, compilado também no PC (host/bench_formato).
+
+#define FORMATO_BUFFER (16 * 1024) // f_mkfs grava a FAT em blocos deste tamanho
+
+typedef struct {
+    MKFS_PARM parametros;
+    const char *descricao;
+} formato_perfil_t;
+
+// Perfil de registro para um volume de 'setores' setores de 512 bytes
+void formato_perfil_registro(uint64_t setores, formato_perfil_t *perfil);
+
+// "FAT12", "FAT16", "FAT32" ou "exFAT"
+const char *formato_nome_tipo(uint8_t fs_type);
+
+#endif // FORMATO_H
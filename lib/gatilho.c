@@ -0,0 +1,108 @@
+#include <stddef.h>
+#include <string.h>
+#include "gatilho.h"
+
+#define MASCARA (GATILHO_CAPACIDADE - 1)
+// Maior |a| possível: os três eixos saturados
+#define ACCEL_MODULO_MAX 56756u
+
+// Comparações pela diferença com sinal: os contadores podem dar a volta
+static inline bool antes(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+void gatilho_iniciar(gatilho_t *g, const gatilho_config_t *config, uint16_t giro_fundo_dps, uint8_t accel_fundo_g)
+{
+    memset(g, 0, offsetof(gatilho_t, fila));
+    g->config = *config;
+    if (g->config.pre > GATILHO_PRE_MAX)
+        g->config.pre = GATILHO_PRE_MAX;
+
+    uint32_t um_g = 32768u / (accel_fundo_g ? accel_fundo_g : 2);
+    if (config->accel_mg)
+    {
+        uint32_t desvio = (uint32_t)((uint64_t)um_g * config->accel_mg / 1000);
+        uint32_t minimo = desvio < um_g ? um_g - desvio : 0;
+        uint32_t maximo = um_g + desvio;
+        if (maximo > ACCEL_MODULO_MAX)
+            maximo = ACCEL_MODULO_MAX;
+        g->accel_min2 = minimo * minimo;
+        g->accel_max2 = maximo * maximo;
+    }
+    else
+    {
+        g->accel_min2 = 0;
+        g->accel_max2 = UINT32_MAX;
+    }
+    if (config->giro_dps)
+    {
+        uint32_t limiar = (uint32_t)config->giro_dps * 32768u / (giro_fundo_dps ? giro_fundo_dps : 250);
+        g->giro_limiar = limiar > 32767 ? 32767 : (int32_t)limiar;
+    }
+}
+
+bool gatilho_excede(const gatilho_t *g, const int16_t accel[3], const int16_t gyro[3])
+{
+    // |a|² cabe em 32 bits: 3 · 32768²
+    uint32_t a2 = (uint32_t)((int32_t)accel[0] * accel[0]) + (uint32_t)((int32_t)accel[1] * accel[1]) +
+                  (uint32_t)((int32_t)accel[2] * accel[2]);
+    if (a2 < g->accel_min2 || a2 > g->accel_max2)
+        return true;
+    if (g->giro_limiar)
+        for (int i = 0; i < 3; i++)
+            if (gyro[i] > g->giro_limiar || gyro[i] < -g->giro_limiar)
+                return true;
+    return false;
+}
+
+bool gatilho_acrescentar(gatilho_t *g, const gatilho_amostra_t *a)
+{
+    uint32_t n = g->escrita;
+    bool novo = false;
+    if (gatilho_excede(g, a->accel, a->gyro))
+    {
+        if (!antes(n, g->fim))
+        {
+            // Começa 'pre' amostras antes, sem repetir as do evento anterior.
+            // Se ele ainda está sendo gravado, a leitura segue e os dois se unem
+            uint32_t inicio = n - (n < g->config.pre ? n : g->config.pre);
+            if (antes(inicio, g->fim))
+                inicio = g->fim;
+            if (g->leitura == g->fim)
+                g->leitura = inicio;
+            g->eventos++;
+            novo = true;
+        }
+        g->fim = n + 1 + g->config.pos;
+    }
+    // Gravação atrasada uma volta inteira: descarta a pendente mais antiga
+    if (antes(g->leitura, g->fim) && n - g->leitura >= GATILHO_CAPACIDADE)
+    {
+        g->leitura++;
+        g->perdidas++;
+    }
+    g->fila[n & MASCARA] = *a;
+    g->escrita = n + 1;
+    return novo;
+}
+
+bool gatilho_proxima(gatilho_t *g, gatilho_amostra_t *a, uint32_t *numero)
+{
+    if (!gatilho_pendentes(g))
+        return false;
+    *a = g->fila[g->leitura & MASCARA];
+    *numero = ++g->leitura;
+    return true;
+}
+
+uint32_t gatilho_pendentes(const gatilho_t *g)
+{
+    uint32_t limite = antes(g->fim, g->escrita) ? g->fim : g->escrita;
+    return antes(g->leitura, limite) ? limite - g->leitura : 0;
+}
+
+bool gatilho_evento_aberto(const gatilho_t *g)
+{
+    return antes(g->leitura, g->fim);
+}
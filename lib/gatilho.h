@@ -0,0 +1,73 @@
+#ifndef GATILHO_H
+#define GATILHO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Captura disparada por evento (comando "gatilho"): as amostras passam por
+// uma fila circular em RAM e só vão para o cartão quando |a| se afasta de
+// 1 g ou a rotação em algum eixo passa do limiar. O evento leva as 'pre'
+// amostras anteriores ao disparo e segue até 'pos' amostras depois do
+// último disparo; disparos dentro dessa janela a estendem. Um disparo que
+// chega antes de o evento anterior terminar de ser gravado une os dois.
+// Só inteiros por amostra e nenhuma dependência do SDK.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Precisa ser potência de 2
+#define GATILHO_CAPACIDADE 2048
+// Metade da fila fica livre para o atraso da gravação
+#define GATILHO_PRE_MAX (GATILHO_CAPACIDADE / 2)
+
+typedef struct {
+    uint32_t tempo_us; // desde o início da captura
+    int16_t accel[3];
+    int16_t gyro[3];
+    int16_t temp;
+} gatilho_amostra_t;
+
+typedef struct {
+    uint16_t accel_mg; // afastamento de |a| em relação a 1 g que dispara; 0 não usa
+    uint16_t giro_dps; // rotação em qualquer eixo que dispara; 0 não usa
+    uint16_t pre;      // amostras antes do disparo (até GATILHO_PRE_MAX)
+    uint16_t pos;      // amostras depois do último disparo
+} gatilho_config_t;
+
+typedef struct {
+    gatilho_config_t config;
+    uint32_t accel_min2;  // faixa de |a|² (LSB²) que não dispara
+    uint32_t accel_max2;
+    int32_t giro_limiar;  // LSB; 0 não usa
+    uint32_t escrita;     // amostras acrescentadas
+    uint32_t leitura;     // próxima a entregar para a gravação
+    uint32_t fim;         // primeira amostra depois do evento atual
+    uint32_t eventos;
+    uint32_t perdidas;    // amostras de evento sobrescritas antes de gravadas
+    gatilho_amostra_t fila[GATILHO_CAPACIDADE];
+} gatilho_t;
+
+// Fundos de escala do MPU6050 para converter os limiares em LSB
+void gatilho_iniciar(gatilho_t *g, const gatilho_config_t *config, uint16_t giro_fundo_dps, uint8_t accel_fundo_g);
+
+bool gatilho_excede(const gatilho_t *g, const int16_t accel[3], const int16_t gyro[3]);
+
+// Acrescenta a próxima amostra. Retorna true quando ela abre um evento
+bool gatilho_acrescentar(gatilho_t *g, const gatilho_amostra_t *a);
+
+// Próxima amostra de evento a gravar e o seu número na captura (a partir
+// de 1); false quando não há nenhuma pronta
+bool gatilho_proxima(gatilho_t *g, gatilho_amostra_t *a, uint32_t *numero);
+
+// Amostras de evento já acrescentadas e ainda não entregues
+uint32_t gatilho_pendentes(const gatilho_t *g);
+
+// Evento em andamento (janela pós-disparo aberta) ou com amostras por gravar
+bool gatilho_evento_aberto(const gatilho_t *g);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GATILHO_H
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "amostras.h"
+#include "grafico.h"
+
+#define GRAFICO_PAGINA_INICIAL 2
+// O controlador precisa de dois quadros (~20 ms) entre comandos de rolagem
+#define GRAFICO_INTERVALO_MIN_US 20000
+
+static const char *const nomes_canais[GRAFICO_NUM_CANAIS] = {"ax", "ay", "az", "gx", "gy", "gz"};
+
+static ssd1306_t *display = NULL;
+static grafico_canal_t canal_atual = GRAFICO_AZ;
+static uint16_t amostras_por_coluna = 1;
+static amostras_leitor_t leitor;
+
+// Coluna em formação
+static int16_t minimo, maximo;
+static uint16_t acumuladas = 0;
+static uint64_t ultima_coluna_us = 0;
+static uint32_t colunas = 0;
+
+grafico_canal_t grafico_canal_por_nome(const char *nome)
+{
+    for (int i = 0; i < GRAFICO_NUM_CANAIS; i++)
+        if (strcmp(nome, nomes_canais[i]) == 0)
+            return (grafico_canal_t)i;
+    return GRAFICO_NUM_CANAIS;
+}
+
+const char *grafico_nome_canal(grafico_canal_t canal)
+{
+    return canal < GRAFICO_NUM_CANAIS ? nomes_canais[canal] : "?";
+}
+
+static int16_t valor_canal(const amostra_t *a)
+{
+    return canal_atual < GRAFICO_GX ? a->accel[canal_atual] : a->gyro[canal_atual - GRAFICO_GX];
+}
+
+// Linha (0 = topo da área do gráfico) correspondente a um valor bruto
+static uint8_t linha_do_valor(int16_t v, uint8_t altura)
+{
+    return (uint8_t)(((int32_t)INT16_MAX - v) * (altura - 1) / UINT16_MAX);
+}
+
+void grafico_iniciar(ssd1306_t *ssd, grafico_canal_t canal, uint16_t janela)
+{
+    display = ssd;
+    canal_atual = canal;
+    amostras_por_coluna = janela ? janela : 1;
+    acumuladas = 0;
+    ultima_coluna_us = 0;
+    amostras_leitor_iniciar(&leitor);
+
+    ssd1306_fill(display, false);
+    char titulo[20];
+    snprintf(titulo, sizeof(titulo), "Grafico %s/%u", grafico_nome_canal(canal), amostras_por_coluna);
+    ssd1306_draw_string(display, titulo, 5, 0);
+    ssd1306_send_data(display);
+}
+
+void grafico_parar(void)
+{
+    display = NULL;
+}
+
+bool grafico_ativo(void)
+{
+    return display != NULL;
+}
+
+void grafico_cabecalho(const char *texto)
+{
+    if (!display)
+        return;
+    // Completa com espaços: cada caractere sobrescreve a célula inteira,
+    // então não é preciso apagar o cabeçalho antes
+    char linha[17];
+    snprintf(linha, sizeof(linha), "%-15s", texto);
+    ssd1306_draw_string(display, linha, 5, 0);
+    ssd1306_send_data(display);
+}
+
+void grafico_tarefa(void)
+{
+    if (!display)
+        return;
+
+    amostra_t a;
+    while (amostras_ler(&leitor, &a))
+    {
+        int16_t v = valor_canal(&a);
+        if (acumuladas == 0 || v < minimo)
+            minimo = v;
+        if (acumuladas == 0 || v > maximo)
+            maximo = v;
+        if (acumuladas < UINT16_MAX)
+            acumuladas++;
+    }
+
+    // Se a janela fechar antes do intervalo mínimo, a coluna continua
+    // acumulando e cobre mais amostras
+    uint64_t agora = time_us_64();
+    if (acumuladas < amostras_por_coluna || agora - ultima_coluna_us < GRAFICO_INTERVALO_MIN_US)
+        return;
+
+    uint8_t paginas = display->pages - GRAFICO_PAGINA_INICIAL;
+    uint8_t altura = paginas * 8;
+    uint8_t coluna[8] = {0};
+    uint8_t topo = linha_do_valor(maximo, altura);
+    uint8_t base = linha_do_valor(minimo, altura);
+    for (uint8_t y = topo; y <= base; y++)
+        coluna[y >> 3] |= 1u << (y & 7);
+    // Linha do zero pontilhada como referência
+    if (colunas & 1)
+        coluna[(altura / 2) >> 3] |= 1u << ((altura / 2) & 7);
+
+    if (ssd1306_scroll_append(display, GRAFICO_PAGINA_INICIAL, display->pages - 1, coluna))
+    {
+        acumuladas = 0;
+        ultima_coluna_us = agora;
+        colunas++;
+    }
+}
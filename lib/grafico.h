@@ -0,0 +1,37 @@
+#ifndef GRAFICO_H
+#define GRAFICO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ssd1306.h"
+
+// Gráfico rolante de um canal do MPU6050 no OLED. As páginas 0-1 ficam com
+// o cabeçalho e as páginas 2-7 com o gráfico: cada coluna nova mostra o
+// mínimo e o máximo de 'janela' amostras lidas da fila de amostras, e é a
+// única coisa enviada pelo I2C (o resto da tela rola no próprio display).
+
+typedef enum {
+    GRAFICO_AX = 0,
+    GRAFICO_AY,
+    GRAFICO_AZ,
+    GRAFICO_GX,
+    GRAFICO_GY,
+    GRAFICO_GZ,
+    GRAFICO_NUM_CANAIS
+} grafico_canal_t;
+
+// Converte "ax", "gy"...; retorna GRAFICO_NUM_CANAIS se o nome não existir
+grafico_canal_t grafico_canal_por_nome(const char *nome);
+const char *grafico_nome_canal(grafico_canal_t canal);
+
+void grafico_iniciar(ssd1306_t *ssd, grafico_canal_t canal, uint16_t janela);
+void grafico_parar(void);
+bool grafico_ativo(void);
+
+// Escreve o texto nas páginas do cabeçalho sem tocar no gráfico
+void grafico_cabecalho(const char *texto);
+
+// Chamada no laço principal: consome a fila e acrescenta colunas
+void grafico_tarefa(void);
+
+#endif // GRAFICO_H
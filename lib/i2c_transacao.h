@@ -0,0 +1,11 @@
+#ifndef I2C_TRANSACAO_H
+#define I2C_TRANSACAO_H
+
+// Limite de tempo de uma transação de 'bytes' bytes (endereço incluso) no
+// I2C a 400 kHz: ~23 us por byte com o ACK, mais folga para início, parada
+// e a FIFO. Usado como timeout das transações que rodam entre as leituras
+// do MPU6050 e como custo que o escalonador de sensores (lib/sensores.h)
+// reserva para elas: um dispositivo que não responde não passa disso.
+#define I2C_TRANSACAO_US(bytes) ((bytes) * 23 + 50)
+
+#endif // I2C_TRANSACAO_H
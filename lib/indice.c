@@ -0,0 +1,110 @@
+#include <string.h>
+#include "indice.h"
+
+typedef struct __attribute__((packed)) {
+    char assinatura[4]; // "IDX1"
+    uint16_t passo;
+    uint16_t tamanho_entrada;
+    uint32_t reservado;
+} indice_cabecalho_t;
+
+void indice_nome(const char *arquivo, char *destino, size_t tamanho)
+{
+    strncpy(destino, arquivo, tamanho - 1);
+    destino[tamanho - 1] = '\0';
+    char *ponto = strrchr(destino, '.');
+    size_t base = ponto ? (size_t)(ponto - destino) : strlen(destino);
+    if (base + sizeof(INDICE_EXTENSAO) > tamanho)
+        base = tamanho - sizeof(INDICE_EXTENSAO);
+    memcpy(destino + base, INDICE_EXTENSAO, sizeof(INDICE_EXTENSAO));
+}
+
+FRESULT indice_criar(const char *nome_indice)
+{
+    FIL f;
+    FRESULT fr = f_open(&f, nome_indice, FA_WRITE | FA_CREATE_ALWAYS);
+    if (FR_OK != fr)
+        return fr;
+    indice_cabecalho_t c = {.assinatura = {'I', 'D', 'X', '1'},
+                            .passo = INDICE_PASSO,
+                            .tamanho_entrada = sizeof(indice_entrada_t)};
+    UINT bw;
+    fr = f_write(&f, &c, sizeof(c), &bw);
+    FRESULT fr_close = f_close(&f);
+    return FR_OK != fr ? fr : fr_close;
+}
+
+FRESULT indice_acrescentar(const char *nome_indice, const indice_entrada_t *entrada)
+{
+    FIL f;
+    FRESULT fr = f_open(&f, nome_indice, FA_WRITE | FA_OPEN_APPEND);
+    if (FR_OK != fr)
+        return fr;
+    // Entrada cortada por falta de energia: volta ao limite da anterior
+    FSIZE_t tamanho = f_size(&f);
+    if (tamanho > sizeof(indice_cabecalho_t))
+    {
+        FSIZE_t resto = (tamanho - sizeof(indice_cabecalho_t)) % sizeof(indice_entrada_t);
+        if (resto)
+            fr = f_lseek(&f, tamanho - resto);
+    }
+    UINT bw;
+    if (FR_OK == fr)
+        fr = f_write(&f, entrada, sizeof(*entrada), &bw);
+    FRESULT fr_close = f_close(&f);
+    return FR_OK != fr ? fr : fr_close;
+}
+
+static FRESULT ler_entrada(FIL *f, uint32_t i, indice_entrada_t *e)
+{
+    FRESULT fr = f_lseek(f, sizeof(indice_cabecalho_t) + (FSIZE_t)i * sizeof(*e));
+    UINT br;
+    if (FR_OK == fr)
+        fr = f_read(f, e, sizeof(*e), &br);
+    return FR_OK == fr && br != sizeof(*e) ? FR_INT_ERR : fr;
+}
+
+FRESULT indice_buscar(const char *nome_indice, uint32_t tempo_ms, indice_entrada_t *entrada, bool *encontrada)
+{
+    *encontrada = false;
+    FIL f;
+    FRESULT fr = f_open(&f, nome_indice, FA_READ);
+    if (FR_OK != fr)
+        return fr;
+    uint32_t n = 0;
+    if (f_size(&f) > sizeof(indice_cabecalho_t))
+        n = (uint32_t)((f_size(&f) - sizeof(indice_cabecalho_t)) / sizeof(indice_entrada_t));
+
+    // Maior i com tempo_ms[i] <= tempo_ms
+    uint32_t baixo = 0, alto = n;
+    indice_entrada_t e;
+    while (FR_OK == fr && baixo < alto)
+    {
+        uint32_t meio = baixo + (alto - baixo) / 2;
+        fr = ler_entrada(&f, meio, &e);
+        if (FR_OK != fr)
+            break;
+        if (e.tempo_ms <= tempo_ms)
+        {
+            *entrada = e;
+            *encontrada = true;
+            baixo = meio + 1;
+        }
+        else
+        {
+            alto = meio;
+        }
+    }
+    f_close(&f);
+    return fr;
+}
+
+bool indice_mapear_clusters(FIL *arquivo, DWORD *tabela, UINT tamanho)
+{
+    arquivo->cltbl = tabela;
+    tabela[0] = tamanho;
+    if (FR_OK == f_lseek(arquivo, CREATE_LINKMAP))
+        return true;
+    arquivo->cltbl = NULL;
+    return false;
+}
@@ -0,0 +1,41 @@
+#ifndef INDICE_H
+#define INDICE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ff.h"
+
+// Índice esparso tempo -> posição de cada arquivo de captura. Ao lado de
+// "dadosX.csv" fica "dadosX.idx" com uma entrada a cada INDICE_PASSO
+// amostras, para o comando "range" ir direto ao trecho pedido sem ler o
+// arquivo desde o começo.
+
+#define INDICE_PASSO 128
+#define INDICE_EXTENSAO ".idx"
+
+typedef struct __attribute__((packed)) {
+    uint32_t amostra;  // número da amostra (coluna Amostra do CSV)
+    uint32_t tempo_ms; // desde o início da captura (coluna Tempo_ms)
+    uint32_t offset;   // posição do início da linha no CSV
+} indice_entrada_t;
+
+// Nome do índice de um arquivo de dados (troca a extensão por .idx)
+void indice_nome(const char *arquivo, char *destino, size_t tamanho);
+
+// Cria o índice vazio (apaga um anterior de mesmo nome)
+FRESULT indice_criar(const char *nome_indice);
+
+FRESULT indice_acrescentar(const char *nome_indice, const indice_entrada_t *entrada);
+
+// Última entrada com tempo_ms <= 'tempo_ms' (busca binária no arquivo).
+// Retorna FR_NO_FILE se não há índice e FR_OK com encontrada = false se o
+// tempo é anterior à primeira entrada
+FRESULT indice_buscar(const char *nome_indice, uint32_t tempo_ms, indice_entrada_t *entrada, bool *encontrada);
+
+// Monta a tabela de clusters (FF_USE_FASTSEEK) de um arquivo aberto só para
+// leitura: os f_lseek seguintes não percorrem a FAT. 'tabela' precisa
+// continuar válida enquanto o arquivo estiver aberto. Retorna false (e o
+// arquivo segue funcionando sem ela) se a tabela não couber
+bool indice_mapear_clusters(FIL *arquivo, DWORD *tabela, UINT tamanho);
+
+#endif // INDICE_H
@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <string.h>
+#include "mpu6050_escala.h"
+
+static int32_t dividir_arredondado(int64_t a, int64_t b)
+{
+    return (int32_t)(a >= 0 ? (a + b / 2) / b : -((-a + b / 2) / b));
+}
+
+void mpu6050_config_padrao(mpu6050_config_t *c)
+{
+    memset(c, 0, sizeof(*c));
+}
+
+bool mpu6050_config_valida(const mpu6050_config_t *c)
+{
+    return c->dlpf <= MPU6050_DLPF_MAX && c->giro_faixa < MPU6050_FAIXAS && c->accel_faixa < MPU6050_FAIXAS;
+}
+
+uint32_t mpu6050_taxa_chz(const mpu6050_config_t *c)
+{
+    uint32_t base_hz = c->dlpf == 0 ? 8000 : 1000;
+    return base_hz * 100 / (1u + c->divisor);
+}
+
+uint8_t mpu6050_dlpf_para(uint8_t divisor)
+{
+    uint32_t metade_hz = 500 / (1u + divisor);
+    for (int i = 1; i <= MPU6050_DLPF_MAX; i++)
+        if (mpu6050_dlpf_banda_hz[i] <= metade_hz)
+            return (uint8_t)i;
+    return MPU6050_DLPF_MAX;
+}
+
+int mpu6050_faixa_giro(uint32_t dps)
+{
+    for (int i = 0; i < MPU6050_FAIXAS; i++)
+        if (mpu6050_giro_fundo_dps[i] == dps)
+            return i;
+    return -1;
+}
+
+int mpu6050_faixa_accel(uint32_t g)
+{
+    for (int i = 0; i < MPU6050_FAIXAS; i++)
+        if (mpu6050_accel_fundo_g[i] == g)
+            return i;
+    return -1;
+}
+
+void mpu6050_registros(const mpu6050_config_t *c, uint8_t registros[4])
+{
+    registros[0] = c->divisor;
+    registros[1] = c->dlpf;                    // EXT_SYNC_SET = 0
+    registros[2] = (uint8_t)(c->giro_faixa << 3);  // FS_SEL nos bits 4:3, sem autoteste
+    registros[3] = (uint8_t)(c->accel_faixa << 3); // AFS_SEL nos bits 4:3, sem autoteste
+}
+
+int mpu6050_config_formatar(const mpu6050_config_t *c, char *destino, size_t tamanho)
+{
+    uint32_t taxa = mpu6050_taxa_chz(c);
+    return snprintf(destino, tamanho, "accel_g=%u giro_dps=%u dlpf=%u banda_hz=%u smplrt_div=%u taxa_hz=%lu.%02lu",
+                    mpu6050_accel_g(c), mpu6050_giro_dps(c), c->dlpf, mpu6050_dlpf_banda_hz[c->dlpf], c->divisor,
+                    (unsigned long)(taxa / 100), (unsigned long)(taxa % 100));
+}
+
+void mpu6050_unidades(const mpu6050_config_t *c, const int16_t accel[3], const int16_t gyro[3],
+                      int32_t accel_ug[3], int32_t giro_mdps[3])
+{
+    uint16_t lsb_g = mpu6050_accel_lsb_g[c->accel_faixa & 3];
+    uint16_t lsb_10dps = mpu6050_giro_lsb_10dps[c->giro_faixa & 3];
+    for (int i = 0; i < 3; i++)
+    {
+        accel_ug[i] = dividir_arredondado((int64_t)accel[i] * 1000000, lsb_g);
+        giro_mdps[i] = dividir_arredondado((int64_t)gyro[i] * 10000, lsb_10dps);
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef MPU6050_ESCALA_H
+#define MPU6050_ESCALA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Configuração de faixa e taxa do MPU6050 (comando "mpu6050"): os quatro
+// registros consecutivos SMPLRT_DIV (0x19), CONFIG (0x1A), GYRO_CONFIG
+// (0x1B) e ACCEL_CONFIG (0x1C), com as tabelas do datasheet para fundos de
+// escala, sensibilidades e bandas do DLPF. A conversão para unidades de
+// engenharia é inteira e exata para a sensibilidade da tabela: aceleração
+// em µg e rotação em m°/s. Nenhuma dependência do SDK; o acesso ao I2C fica
+// no firmware.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MPU6050_FAIXAS 4   // AFS_SEL e FS_SEL de 0 a 3
+#define MPU6050_DLPF_MAX 6 // CONFIG 7 é reservado
+
+typedef struct {
+    uint8_t divisor;     // SMPLRT_DIV: taxa = base / (1 + divisor)
+    uint8_t dlpf;        // DLPF_CFG: 0 desliga (base de 8 kHz no giroscópio)
+    uint8_t giro_faixa;  // FS_SEL: ±250, 500, 1000, 2000 °/s
+    uint8_t accel_faixa; // AFS_SEL: ±2, 4, 8, 16 g
+} mpu6050_config_t;
+
+// Tabelas do datasheet, indexadas pela faixa e pelo DLPF_CFG
+static const uint16_t mpu6050_giro_fundo_dps[MPU6050_FAIXAS] = {250, 500, 1000, 2000};
+static const uint8_t mpu6050_accel_fundo_g[MPU6050_FAIXAS] = {2, 4, 8, 16};
+static const uint16_t mpu6050_giro_lsb_10dps[MPU6050_FAIXAS] = {1310, 655, 328, 164}; // LSB por 10 °/s
+static const uint16_t mpu6050_accel_lsb_g[MPU6050_FAIXAS] = {16384, 8192, 4096, 2048};
+static const uint16_t mpu6050_dlpf_banda_hz[MPU6050_DLPF_MAX + 1] = {256, 188, 98, 42, 20, 10, 5}; // giroscópio
+
+// Estado após o reset: ±2 g, ±250 °/s, sem DLPF, sem divisor
+void mpu6050_config_padrao(mpu6050_config_t *c);
+
+bool mpu6050_config_valida(const mpu6050_config_t *c);
+
+static inline uint16_t mpu6050_giro_dps(const mpu6050_config_t *c)
+{
+    return mpu6050_giro_fundo_dps[c->giro_faixa & 3];
+}
+
+static inline uint8_t mpu6050_accel_g(const mpu6050_config_t *c)
+{
+    return mpu6050_accel_fundo_g[c->accel_faixa & 3];
+}
+
+// Taxa de amostragem interna em centésimos de Hz (giroscópio)
+uint32_t mpu6050_taxa_chz(const mpu6050_config_t *c);
+
+// Maior banda do DLPF abaixo da metade da taxa com base de 1 kHz
+uint8_t mpu6050_dlpf_para(uint8_t divisor);
+
+// Faixa com o fundo de escala pedido; -1 se não existe
+int mpu6050_faixa_giro(uint32_t dps);
+int mpu6050_faixa_accel(uint32_t g);
+
+// Valores dos registros 0x19 a 0x1C, na ordem
+void mpu6050_registros(const mpu6050_config_t *c, uint8_t registros[4]);
+
+// "accel_g=2 giro_dps=250 dlpf=0 banda_hz=256 smplrt_div=0 taxa_hz=8000" para o cabeçalho do CSV
+int mpu6050_config_formatar(const mpu6050_config_t *c, char *destino, size_t tamanho);
+
+// Leituras em LSB para µg e m°/s, arredondadas
+void mpu6050_unidades(const mpu6050_config_t *c, const int16_t accel[3], const int16_t gyro[3],
+                      int32_t accel_ug[3], int32_t giro_mdps[3]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPU6050_ESCALA_H
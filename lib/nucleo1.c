@@ -0,0 +1,264 @@
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/flash.h"
+#include "hardware/sync.h"
+#include "amostras.h"
+#include "nucleo1.h"
+
+static volatile uint32_t sessao = 0;
+static volatile bool orientacao_ligada = false;
+static orientacao_config_t orientacao_config;
+
+// Resultado em dois buffers alternados pela paridade da sequência: o core0
+// pode copiar o da amostra N enquanto o core1 grava o da N+1
+static int32_t resultado_q[2][4];
+static volatile uint32_t resultado_seq = 0;
+
+static volatile uint32_t total_processadas, total_perdidas, pior_us;
+
+// Espectro: a janela é juntada aqui e o resultado calculado direto no slot
+// livre da fila, que o core0 lê sem copiar
+#define ESPECTRO_FILA 4
+static volatile bool espectro_ligado = false;
+static espectro_config_t espectro_config;
+static espectro_t espectro;
+static int16_t espectro_janela[ESPECTRO_N_MAX];
+static espectro_resultado_t espectro_fila[ESPECTRO_FILA];
+static volatile uint32_t espectro_produzidos, espectro_consumidos;
+static volatile uint32_t espectro_janelas, espectro_descartadas, espectro_pior_us;
+
+// Pedido de medição (nucleo1_espectro_bench): n > 0 enquanto pendente
+static volatile uint16_t bench_n;
+static volatile uint32_t bench_repeticoes, bench_media_us;
+
+static void espectro_bench_executar(void)
+{
+    espectro_config_t config = {.n = bench_n, .eixo = 0, .bins = true};
+    espectro_iniciar(&espectro, &config);
+    // Dente de serra e onda quadrada sobre 1 g: o custo não depende do sinal
+    for (int i = 0; i < config.n; i++)
+        espectro_janela[i] = (int16_t)(16384 + ((i * 37) % 64) * 100 - 3200 + ((i & 8) ? 2000 : -2000));
+    uint32_t inicio = time_us_32();
+    for (uint32_t r = 0; r < bench_repeticoes; r++)
+        espectro_calcular(&espectro, espectro_janela, 0, config.n * 1000u, &espectro_fila[0]);
+    bench_media_us = (time_us_32() - inicio) / bench_repeticoes;
+    __dmb();
+    bench_n = 0;
+}
+
+static void nucleo1_laco(void)
+{
+    // Deixa o core0 gravar a flash (calibração) pausando este núcleo
+    flash_safe_execute_core_init();
+    amostras_leitor_t leitor = {0, 0};
+    uint32_t sessao_atual = sessao;
+    bool orientar = false;
+    orientacao_t filtro;
+    bool espectrar = false;
+    uint32_t janela_n = 0, janela_seq = 0, janela_intervalo = 0;
+    uint64_t janela_inicio = 0, janela_ultimo = 0;
+    while (true)
+    {
+        if (bench_n)
+        {
+            espectro_bench_executar();
+            continue;
+        }
+        if (sessao_atual != sessao)
+        {
+            sessao_atual = sessao;
+            __dmb();
+            leitor.leitura = 0;
+            leitor.perdidas = 0;
+            resultado_seq = 0;
+            total_processadas = total_perdidas = pior_us = 0;
+            orientar = orientacao_ligada;
+            if (orientar)
+                orientacao_iniciar(&filtro, &orientacao_config);
+            espectro_produzidos = espectro_consumidos = 0;
+            espectro_janelas = espectro_descartadas = espectro_pior_us = 0;
+            janela_n = 0;
+            espectrar = espectro_ligado;
+            if (espectrar)
+                espectro_iniciar(&espectro, &espectro_config);
+        }
+        amostra_t a;
+        if (!amostras_ler(&leitor, &a))
+        {
+            // amostras_publicar() e nucleo1_nova_sessao() acordam com __sev()
+            __wfe();
+            continue;
+        }
+        if (orientar)
+        {
+            uint32_t inicio = time_us_32();
+            orientacao_atualizar(&filtro, a.accel, a.gyro, a.tempo_us);
+            uint32_t duracao = time_us_32() - inicio;
+            if (duracao > pior_us)
+                pior_us = duracao;
+            memcpy(resultado_q[a.seq & 1], filtro.q, sizeof(filtro.q));
+            __dmb();
+            resultado_seq = a.seq;
+        }
+        if (espectrar)
+        {
+            // Amostra faltando (leitura falhou ou a fila deu a volta): a
+            // janela deixa de ser uniforme e recomeça nesta amostra
+            if (janela_n && a.seq != janela_seq + 1)
+            {
+                espectro_descartadas++;
+                janela_n = 0;
+            }
+            if (janela_n == 0)
+            {
+                janela_inicio = a.tempo_us;
+                janela_intervalo = 0;
+            }
+            else if (a.tempo_us - janela_ultimo > janela_intervalo)
+            {
+                janela_intervalo = (uint32_t)(a.tempo_us - janela_ultimo);
+            }
+            janela_seq = a.seq;
+            janela_ultimo = a.tempo_us;
+            espectro_janela[janela_n++] = a.accel[espectro_config.eixo];
+            if (janela_n == espectro_config.n)
+            {
+                janela_n = 0;
+                if (espectro_produzidos - espectro_consumidos >= ESPECTRO_FILA)
+                {
+                    espectro_descartadas++;
+                }
+                else
+                {
+                    espectro_resultado_t *r = &espectro_fila[espectro_produzidos % ESPECTRO_FILA];
+                    uint32_t inicio = time_us_32();
+                    espectro_calcular(&espectro, espectro_janela, janela_inicio, janela_ultimo, r);
+                    uint32_t duracao = time_us_32() - inicio;
+                    if (duracao > espectro_pior_us)
+                        espectro_pior_us = duracao;
+                    r->janela = ++espectro_janelas;
+                    r->maior_intervalo_us = janela_intervalo;
+                    __dmb();
+                    espectro_produzidos++;
+                }
+            }
+        }
+        total_processadas++;
+        total_perdidas = leitor.perdidas;
+    }
+}
+
+void nucleo1_iniciar(void)
+{
+    multicore_launch_core1(nucleo1_laco);
+}
+
+void nucleo1_nova_sessao(void)
+{
+    __dmb();
+    sessao++;
+    __sev();
+}
+
+void nucleo1_orientacao_configurar(const orientacao_config_t *config)
+{
+    if (config)
+        orientacao_config = *config;
+    orientacao_ligada = (config != NULL);
+    nucleo1_nova_sessao();
+}
+
+bool nucleo1_orientacao_ligada(void)
+{
+    return orientacao_ligada;
+}
+
+const orientacao_config_t *nucleo1_orientacao_config(void)
+{
+    return &orientacao_config;
+}
+
+bool nucleo1_orientacao_ler(uint32_t seq, int32_t q[4], uint32_t espera_us)
+{
+    if (!orientacao_ligada)
+        return false;
+    absolute_time_t limite = make_timeout_time_us(espera_us);
+    while (true)
+    {
+        uint32_t pronto = resultado_seq;
+        // Até uma amostra à frente, o buffer de 'seq' ainda está intacto
+        if (pronto == seq || pronto == seq + 1)
+        {
+            __dmb();
+            memcpy(q, resultado_q[seq & 1], sizeof(resultado_q[0]));
+            __dmb();
+            if (resultado_seq - seq <= 1)
+                return true;
+        }
+        if (time_reached(limite))
+            return false;
+        tight_loop_contents();
+    }
+}
+
+void nucleo1_estatisticas(uint32_t *processadas, uint32_t *perdidas, uint32_t *maximo_us)
+{
+    *processadas = total_processadas;
+    *perdidas = total_perdidas;
+    *maximo_us = pior_us;
+}
+
+void nucleo1_espectro_configurar(const espectro_config_t *config)
+{
+    if (config)
+        espectro_config = *config;
+    espectro_ligado = (config != NULL);
+    nucleo1_nova_sessao();
+}
+
+bool nucleo1_espectro_ligado(void)
+{
+    return espectro_ligado;
+}
+
+const espectro_resultado_t *nucleo1_espectro_obter(void)
+{
+    if (espectro_produzidos == espectro_consumidos)
+        return NULL;
+    __dmb();
+    return &espectro_fila[espectro_consumidos % ESPECTRO_FILA];
+}
+
+void nucleo1_espectro_liberar(void)
+{
+    __dmb();
+    espectro_consumidos++;
+}
+
+void nucleo1_espectro_estatisticas(uint32_t *janelas, uint32_t *descartadas, uint32_t *maximo_us)
+{
+    *janelas = espectro_janelas;
+    *descartadas = espectro_descartadas;
+    *maximo_us = espectro_pior_us;
+}
+
+bool nucleo1_espectro_bench(uint16_t n, uint32_t repeticoes, uint32_t *media_us)
+{
+    if (espectro_ligado || !espectro_n_valido(n) || repeticoes == 0)
+        return false;
+    bench_repeticoes = repeticoes;
+    __dmb();
+    bench_n = n;
+    __sev();
+    absolute_time_t limite = make_timeout_time_ms(10000);
+    while (bench_n)
+    {
+        if (time_reached(limite))
+            return false;
+        tight_loop_contents();
+    }
+    __dmb();
+    *media_us = bench_media_us;
+    return true;
+}
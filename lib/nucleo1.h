@@ -0,0 +1,53 @@
+#ifndef NUCLEO1_H
+#define NUCLEO1_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "orientacao.h"
+#include "espectro.h"
+
+// Processamento no core1: consome a fila de amostras (amostras.h) como mais
+// um leitor, sem atrasar a aquisição e a gravação no core0. Roda a
+// estimativa de orientação (orientacao.h) e o espectro de vibração
+// (espectro.h). O resultado de cada amostra fica disponível pelo número de
+// sequência; o core0 o busca ao montar a linha do CSV, depois de abrir o
+// arquivo, e normalmente já o encontra pronto. Os espectros, um por janela,
+// passam por uma fila curta até o core0 gravá-los.
+
+void nucleo1_iniciar(void);
+
+// Início de sessão: chamar logo depois de amostras_limpar(). Reinicia os
+// estágios e a leitura da fila
+void nucleo1_nova_sessao(void);
+
+// Liga (config != NULL) ou desliga a orientação. Só entre sessões
+void nucleo1_orientacao_configurar(const orientacao_config_t *config);
+bool nucleo1_orientacao_ligada(void);
+const orientacao_config_t *nucleo1_orientacao_config(void);
+
+// Quatérnio (Q30) calculado para a amostra 'seq', esperando até espera_us
+// pelo core1; false se não ficou pronto a tempo
+bool nucleo1_orientacao_ler(uint32_t seq, int32_t q[4], uint32_t espera_us);
+
+// Desde o início da sessão: amostras processadas, perdidas (a fila deu a
+// volta antes de o core1 lê-las) e maior tempo de processamento de uma amostra
+void nucleo1_estatisticas(uint32_t *processadas, uint32_t *perdidas, uint32_t *maximo_us);
+
+// Liga (config != NULL) ou desliga o espectro. Só entre sessões
+void nucleo1_espectro_configurar(const espectro_config_t *config);
+bool nucleo1_espectro_ligado(void);
+
+// Janela mais antiga já calculada, ou NULL. Fica válida até
+// nucleo1_espectro_liberar(), que devolve o espaço ao core1
+const espectro_resultado_t *nucleo1_espectro_obter(void);
+void nucleo1_espectro_liberar(void);
+
+// Desde o início da sessão: janelas calculadas, descartadas (fila cheia ou
+// amostra faltando no meio) e maior tempo de cálculo de uma janela
+void nucleo1_espectro_estatisticas(uint32_t *janelas, uint32_t *descartadas, uint32_t *maximo_us);
+
+// Mede no core1 o tempo médio de espectro_calcular() para janelas de n
+// pontos (sinal sintético). Só fora de captura; false se o core1 não responder
+bool nucleo1_espectro_bench(uint16_t n, uint32_t repeticoes, uint32_t *media_us);
+
+#endif // NUCLEO1_H
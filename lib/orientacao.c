@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include "orientacao.h"
+
+// Intervalo máximo entre amostras considerado na integração
+#define DT_MAX_US (1u << 20)
+// Maior meio ângulo por amostra: limita o crescimento do quatérnio antes da
+// renormalização (|q|² <= 1 + 3/16) e evita estouro em Q30
+#define MEIO_ANGULO_MAX (ORIENTACAO_UM / 4)
+
+static uint32_t raiz32(uint32_t v)
+{
+    uint32_t r = 0;
+    for (uint32_t bit = 1u << 30; bit; bit >>= 2)
+    {
+        if (v >= r + bit)
+        {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        }
+        else
+        {
+            r >>= 1;
+        }
+    }
+    return r;
+}
+
+static uint64_t raiz64(uint64_t v)
+{
+    uint64_t r = 0;
+    for (uint64_t bit = 1ull << 62; bit; bit >>= 2)
+    {
+        if (v >= r + bit)
+        {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        }
+        else
+        {
+            r >>= 1;
+        }
+    }
+    return r;
+}
+
+static inline int32_t mul_q30(int32_t a, int32_t b)
+{
+    return (int32_t)(((int64_t)a * b) >> 30);
+}
+
+static inline int32_t limitar(int32_t v, int32_t limite)
+{
+    return v > limite ? limite : (v < -limite ? -limite : v);
+}
+
+void orientacao_iniciar(orientacao_t *o, const orientacao_config_t *config)
+{
+    const double pi = 3.14159265358979323846;
+    double rad_por_lsb = config->giro_dps * pi / 180.0 / 32768.0;
+    o->giro_q50 = (int64_t)(rad_por_lsb / 2 * 1e-6 * (double)(1ull << 50) + 0.5);
+    o->ganho_q40 = (int64_t)(config->ganho_x1000 / 1000.0 / 2 * 1e-6 * (double)(1ull << 40) + 0.5);
+    uint32_t um_g = 32768u / (config->accel_g ? config->accel_g : 2);
+    o->accel_min2 = (um_g * 3 / 4) * (um_g * 3 / 4);
+    o->accel_max2 = (um_g * 5 / 4) * (um_g * 5 / 4);
+    o->q[0] = ORIENTACAO_UM;
+    o->q[1] = o->q[2] = o->q[3] = 0;
+    o->ultimo_us = 0;
+    o->iniciado = false;
+}
+
+// Quatérnio de menor rotação que leva a gravidade estimada (0, 0, 1) à
+// direção medida n (Q30), com guinada zero: proporcional a (1 + nz, ny, -nx, 0)
+static void inclinacao_inicial(orientacao_t *o, const int32_t n[3])
+{
+    int64_t v[3] = {(int64_t)ORIENTACAO_UM + n[2], n[1], -(int64_t)n[0]};
+    if (v[0] < ORIENTACAO_UM / 1000)
+    {
+        // De cabeça para baixo: meia volta em torno de x
+        o->q[0] = 0;
+        o->q[1] = ORIENTACAO_UM;
+        o->q[2] = o->q[3] = 0;
+        return;
+    }
+    uint64_t norma = raiz64((uint64_t)(v[0] * v[0]) + (uint64_t)(v[1] * v[1]) + (uint64_t)(v[2] * v[2]));
+    o->q[0] = (int32_t)((v[0] << 30) / (int64_t)norma);
+    o->q[1] = (int32_t)((v[1] * ORIENTACAO_UM) / (int64_t)norma);
+    o->q[2] = (int32_t)((v[2] * ORIENTACAO_UM) / (int64_t)norma);
+    o->q[3] = 0;
+}
+
+void orientacao_atualizar(orientacao_t *o, const int16_t accel[3], const int16_t gyro[3], uint64_t tempo_us)
+{
+    int32_t a[3] = {accel[0], accel[1], accel[2]};
+    uint32_t a2 = (uint32_t)(a[0] * a[0]) + (uint32_t)(a[1] * a[1]) + (uint32_t)(a[2] * a[2]);
+    bool gravidade = a2 >= o->accel_min2 && a2 <= o->accel_max2;
+    int32_t n[3];
+    if (gravidade)
+    {
+        // Direção da gravidade medida, em Q30: |a[i]| <= |a| mantém o
+        // produto dentro de 32 bits
+        int32_t inv = (int32_t)(ORIENTACAO_UM / raiz32(a2));
+        for (int i = 0; i < 3; i++)
+            n[i] = a[i] * inv;
+    }
+
+    if (!o->iniciado)
+    {
+        if (!gravidade)
+            return;
+        inclinacao_inicial(o, n);
+        o->ultimo_us = tempo_us;
+        o->iniciado = true;
+        return;
+    }
+    uint64_t dt = tempo_us - o->ultimo_us;
+    if (dt > DT_MAX_US)
+        dt = DT_MAX_US;
+    o->ultimo_us = tempo_us;
+
+    int32_t q0 = o->q[0], q1 = o->q[1], q2 = o->q[2], q3 = o->q[3];
+
+    // Meio ângulo girado em cada eixo nesta amostra (Q30)
+    int64_t passo = (int64_t)dt * o->giro_q50;
+    int32_t h[3];
+    for (int i = 0; i < 3; i++)
+        h[i] = (int32_t)(((int64_t)gyro[i] * passo) >> 20);
+
+    if (gravidade)
+    {
+        // Gravidade estimada pelo quatérnio, no referencial do sensor
+        int32_t vx = (int32_t)(((int64_t)q1 * q3 - (int64_t)q0 * q2) >> 29);
+        int32_t vy = (int32_t)(((int64_t)q0 * q1 + (int64_t)q2 * q3) >> 29);
+        int32_t vz = (int32_t)(((int64_t)q0 * q0 - (int64_t)q1 * q1 - (int64_t)q2 * q2 + (int64_t)q3 * q3) >> 30);
+        // Erro = medida × estimada, somado à rotação com peso Kp·dt/2 (Q24)
+        int32_t e[3] = {
+            (int32_t)(((int64_t)n[1] * vz - (int64_t)n[2] * vy) >> 30),
+            (int32_t)(((int64_t)n[2] * vx - (int64_t)n[0] * vz) >> 30),
+            (int32_t)(((int64_t)n[0] * vy - (int64_t)n[1] * vx) >> 30)};
+        int64_t k = (o->ganho_q40 * (int64_t)dt) >> 16;
+        if (k > (1 << 23))
+            k = 1 << 23;
+        for (int i = 0; i < 3; i++)
+            h[i] += (int32_t)((e[i] * k) >> 24);
+    }
+    for (int i = 0; i < 3; i++)
+        h[i] = limitar(h[i], MEIO_ANGULO_MAX);
+
+    // q += q ⊗ (0, h)
+    q0 -= (int32_t)(((int64_t)o->q[1] * h[0] + (int64_t)o->q[2] * h[1] + (int64_t)o->q[3] * h[2]) >> 30);
+    q1 += (int32_t)(((int64_t)o->q[0] * h[0] + (int64_t)o->q[2] * h[2] - (int64_t)o->q[3] * h[1]) >> 30);
+    q2 += (int32_t)(((int64_t)o->q[0] * h[1] - (int64_t)o->q[1] * h[2] + (int64_t)o->q[3] * h[0]) >> 30);
+    q3 += (int32_t)(((int64_t)o->q[0] * h[2] + (int64_t)o->q[1] * h[1] - (int64_t)o->q[2] * h[0]) >> 30);
+
+    // Renormalização por um passo de Newton de 1/sqrt(x) em torno de 1:
+    // |q| já está perto de 1, e o erro que sobra cai a cada amostra
+    int64_t n2 = ((int64_t)q0 * q0 + (int64_t)q1 * q1 + (int64_t)q2 * q2 + (int64_t)q3 * q3) >> 30;
+    int32_t fator = (int32_t)((3 * (int64_t)ORIENTACAO_UM - n2) >> 1);
+    o->q[0] = mul_q30(q0, fator);
+    o->q[1] = mul_q30(q1, fator);
+    o->q[2] = mul_q30(q2, fator);
+    o->q[3] = mul_q30(q3, fator);
+}
+
+int orientacao_formatar(const int32_t q[4], char *destino, size_t tamanho)
+{
+    int n = 0;
+    for (int i = 0; i < 4 && (size_t)n < tamanho; i++)
+    {
+        int64_t v = (int64_t)q[i] * 10000;
+        bool negativo = v < 0;
+        if (negativo)
+            v = -v;
+        int32_t dez_milesimos = (int32_t)((v + ORIENTACAO_UM / 2) >> 30);
+        n += snprintf(destino + n, tamanho - n, "%s%s%ld.%04ld", i ? "," : "",
+                      negativo && dez_milesimos ? "-" : "", (long)(dez_milesimos / 10000),
+                      (long)(dez_milesimos % 10000));
+    }
+    return n;
+}
@@ -0,0 +1,50 @@
+#ifndef ORIENTACAO_H
+#define ORIENTACAO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Orientação do sensor (quatérnio) por filtro complementar em ponto fixo:
+// integra o giroscópio e corrige a inclinação pela direção da gravidade
+// medida no acelerômetro (formulação de Mahony, só o termo proporcional).
+// A atualização usa apenas inteiros; o ponto flutuante fica em
+// orientacao_iniciar(). Código C puro, compilado também no PC
+// (host/verificar_orientacao) para comparar com uma referência em double.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Quatérnio em Q30: 1.0 = 1 << 30
+#define ORIENTACAO_UM (1 << 30)
+
+typedef struct {
+    uint16_t giro_dps;    // fundo de escala do giroscópio (250, 500, 1000, 2000 °/s)
+    uint8_t accel_g;      // fundo de escala do acelerômetro (2, 4, 8, 16 g)
+    uint16_t ganho_x1000; // ganho Kp da correção pela gravidade, em milésimos de rad/s
+} orientacao_config_t;
+
+typedef struct {
+    int32_t q[4];          // w, x, y, z em Q30 (sensor em relação à Terra)
+    int64_t giro_q50;      // meio ângulo por LSB e por µs, em Q50 (rad)
+    int64_t ganho_q40;     // Kp/2 por µs, em Q40
+    uint32_t accel_min2;   // |a|² aceito para a correção (0,75 a 1,25 g)
+    uint32_t accel_max2;
+    uint64_t ultimo_us;
+    bool iniciado;         // a primeira amostra define a inclinação inicial
+} orientacao_t;
+
+void orientacao_iniciar(orientacao_t *o, const orientacao_config_t *config);
+
+// Processa uma amostra bruta do MPU6050 lida no instante tempo_us
+void orientacao_atualizar(orientacao_t *o, const int16_t accel[3], const int16_t gyro[3], uint64_t tempo_us);
+
+// "w,x,y,z" com 4 casas decimais, sem ponto flutuante. Retorna o tamanho escrito
+int orientacao_formatar(const int32_t q[4], char *destino, size_t tamanho);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ORIENTACAO_H
@@ -0,0 +1,125 @@
+#ifndef PROTOCOLO_H
+#define PROTOCOLO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Quadros binários trocados pela USB com as ferramentas do PC (pasta host/).
+// Este arquivo é compilado tanto no firmware quanto no PC.
+//
+// Formato (inteiros little-endian):
+//   sincronismo  2 bytes  0xA5 0x5A
+//   tipo         1 byte   PROTOCOLO_TIPO_*
+//   tamanho      2 bytes  bytes de carga útil
+//   seq          4 bytes  número de sequência do quadro
+//   carga útil   'tamanho' bytes
+//   crc          2 bytes  CRC-16/CCITT-FALSE de tipo..carga útil
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PROTOCOLO_SYNC0 0xA5
+#define PROTOCOLO_SYNC1 0x5A
+#define PROTOCOLO_CABECALHO 9
+#define PROTOCOLO_EXTRA (PROTOCOLO_CABECALHO + 2)
+#define PROTOCOLO_MAX_CARGA (4096 + 16) // bloco de arquivo + deslocamento
+#define PROTOCOLO_MAX_QUADRO (PROTOCOLO_MAX_CARGA + PROTOCOLO_EXTRA)
+
+enum {
+    PROTOCOLO_TIPO_INICIO = 0x01,  // início de transmissão ao vivo
+    PROTOCOLO_TIPO_AMOSTRA = 0x02, // uma amostra do MPU6050
+    PROTOCOLO_TIPO_FIM = 0x03,     // fim de transmissão ao vivo
+
+    // Download de arquivo (comando "baixar"), placa -> PC
+    PROTOCOLO_TIPO_ARQ_INICIO = 0x10,
+    PROTOCOLO_TIPO_ARQ_BLOCO = 0x11,   // protocolo_arq_bloco_t + dados
+    PROTOCOLO_TIPO_ARQ_FIM = 0x12,     // todos os bytes confirmados
+    PROTOCOLO_TIPO_ARQ_ERRO = 0x13,
+
+    // Download de arquivo, PC -> placa
+    PROTOCOLO_TIPO_ARQ_ACK = 0x20,     // tudo antes de 'offset' foi recebido
+    PROTOCOLO_TIPO_ARQ_NACK = 0x21,    // reenviar a partir de 'offset'
+    PROTOCOLO_TIPO_ARQ_CANCELAR = 0x22 // sem carga útil
+};
+
+// Carga útil de PROTOCOLO_TIPO_INICIO
+typedef struct __attribute__((packed)) {
+    uint32_t periodo_us;
+} protocolo_inicio_t;
+
+// Carga útil de PROTOCOLO_TIPO_AMOSTRA (valores brutos do sensor)
+typedef struct __attribute__((packed)) {
+    uint32_t tempo_us; // desde o início da transmissão (volta a cada ~71 min)
+    int16_t accel[3];
+    int16_t gyro[3];
+    int16_t temp;
+} protocolo_amostra_t;
+
+// Carga útil de PROTOCOLO_TIPO_FIM
+typedef struct __attribute__((packed)) {
+    uint32_t enviados;  // quadros de amostra entregues à USB
+    uint32_t perdidos;  // quadros descartados por falta de espaço na USB
+} protocolo_fim_t;
+
+// Carga útil de PROTOCOLO_TIPO_ARQ_INICIO
+typedef struct __attribute__((packed)) {
+    uint64_t tamanho;  // tamanho do arquivo
+    uint64_t offset;   // primeiro byte que será enviado (retomada)
+    uint32_t janela;   // bytes que podem estar sem confirmação
+    uint16_t bloco;    // dados por quadro (blocos alinhados a esse valor)
+} protocolo_arq_inicio_t;
+
+// Início da carga útil de PROTOCOLO_TIPO_ARQ_BLOCO; os dados vêm em seguida
+typedef struct __attribute__((packed)) {
+    uint64_t offset;
+} protocolo_arq_bloco_t;
+
+// Carga útil de PROTOCOLO_TIPO_ARQ_FIM
+typedef struct __attribute__((packed)) {
+    uint64_t tamanho;
+    uint32_t retransmissoes; // blocos reenviados (NACK ou falta de ACK)
+} protocolo_arq_fim_t;
+
+// Carga útil de PROTOCOLO_TIPO_ARQ_ERRO
+typedef struct __attribute__((packed)) {
+    int32_t codigo; // FRESULT do FatFs ou PROTOCOLO_ERRO_*
+} protocolo_arq_erro_t;
+
+#define PROTOCOLO_ERRO_TIMEOUT (-1)  // PC parou de confirmar
+#define PROTOCOLO_ERRO_CANCELADO (-2)
+
+// Carga útil de PROTOCOLO_TIPO_ARQ_ACK e PROTOCOLO_TIPO_ARQ_NACK
+typedef struct __attribute__((packed)) {
+    uint64_t offset;
+} protocolo_arq_ack_t;
+
+uint16_t protocolo_crc16(const uint8_t *dados, size_t len, uint16_t crc);
+
+// Monta um quadro completo em 'destino' (PROTOCOLO_EXTRA + len bytes) e
+// retorna o tamanho total
+size_t protocolo_montar(uint8_t *destino, uint8_t tipo, uint32_t seq, const void *carga, uint16_t len);
+
+// Como protocolo_montar, para carga útil já escrita em
+// destino + PROTOCOLO_CABECALHO (evita copiar blocos grandes)
+size_t protocolo_fechar(uint8_t *destino, uint8_t tipo, uint32_t seq, uint16_t len);
+
+// Recepção byte a byte dos quadros curtos enviados pelo PC
+#define PROTOCOLO_MAX_CARGA_RX 16
+
+typedef struct {
+    uint8_t buf[PROTOCOLO_EXTRA + PROTOCOLO_MAX_CARGA_RX];
+    uint16_t n;
+} protocolo_receptor_t;
+
+// Retorna true quando 'byte' completa um quadro com CRC válido; o quadro
+// fica em r->buf (tipo em buf[2], carga útil em buf + PROTOCOLO_CABECALHO)
+// até o próximo byte
+bool protocolo_receber(protocolo_receptor_t *r, uint8_t byte);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PROTOCOLO_H
@@ -0,0 +1,99 @@
+#include <ctype.h>
+#include "registro_csv.h"
+
+// Inteiro com sinal; avança *p até depois do separador
+static bool ler_inteiro(const char **p, int32_t *valor)
+{
+    const char *s = *p;
+    bool negativo = (*s == '-');
+    if (*s == '-' || *s == '+')
+        s++;
+    if (!isdigit((unsigned char)*s))
+        return false;
+    int32_t v = 0;
+    while (isdigit((unsigned char)*s))
+        v = v * 10 + (*s++ - '0');
+    *valor = negativo ? -v : v;
+    *p = s;
+    return true;
+}
+
+// "25.5" / "-3.25" -> centésimos, arredondando a terceira casa
+static bool ler_centesimos(const char **p, int32_t *valor)
+{
+    const char *s = *p;
+    bool negativo = (*s == '-');
+    int32_t inteiro;
+    if (!ler_inteiro(&s, &inteiro))
+        return false;
+    int32_t fracao = 0;
+    if (*s == '.')
+    {
+        s++;
+        int casas = 0;
+        while (isdigit((unsigned char)*s))
+        {
+            if (casas < 2)
+                fracao = fracao * 10 + (*s - '0');
+            else if (casas == 2 && *s >= '5')
+                fracao++;
+            casas++;
+            s++;
+        }
+        if (casas == 1)
+            fracao *= 10;
+    }
+    int32_t modulo = (negativo ? -inteiro : inteiro) * 100 + fracao;
+    *valor = negativo ? -modulo : modulo;
+    *p = s;
+    return true;
+}
+
+static bool separador(const char **p)
+{
+    if (**p != ',')
+        return false;
+    (*p)++;
+    return true;
+}
+
+bool registro_csv_ler(const char *linha, registro_csv_t *r)
+{
+    // Data e Hora são pulados: Tempo_ms e Amostra dão a posição no tempo
+    const char *p = linha;
+    if (*p == '#')
+        return false;
+    for (int campo = 0; campo < 2; campo++)
+    {
+        while (*p && *p != ',')
+            p++;
+        if (!separador(&p))
+            return false;
+    }
+    int32_t v;
+    if (!ler_inteiro(&p, &v) || v < 0)
+        return false;
+    r->amostra = (uint32_t)v;
+    for (int i = 0; i < 3; i++)
+        if (!separador(&p) || !ler_inteiro(&p, &r->accel[i]))
+            return false;
+    for (int i = 0; i < 3; i++)
+        if (!separador(&p) || !ler_inteiro(&p, &r->gyro[i]))
+            return false;
+    if (!separador(&p) || !ler_centesimos(&p, &r->temp_centesimos))
+        return false;
+    r->tem_tempo = false;
+    r->tempo_ms = 0;
+    if (*p == ',')
+    {
+        p++;
+        if (!ler_inteiro(&p, &v) || v < 0)
+            return false;
+        r->tem_tempo = true;
+        r->tempo_ms = (uint32_t)v;
+        // Colunas opcionais depois de Tempo_ms (orientação, analógicos) não são lidas
+        if (*p == ',')
+            return true;
+    }
+    return *p == '\0' || *p == '\r' || *p == '\n';
+}
@@ -0,0 +1,33 @@
+#ifndef REGISTRO_CSV_H
+#define REGISTRO_CSV_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Leitura de uma linha de dados do CSV de captura:
+//   Data,Hora,Amostra,AccX,AccY,AccZ,GyroX,GyroY,GyroZ,Temperatura[,Tempo_ms[,Q0,Q1,Q2,Q3][,ADC0,...]]
+// Sem ponto flutuante: a temperatura volta em centésimos de grau.
+// Compilado também no PC (host/).
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t amostra;
+    int32_t accel[3];
+    int32_t gyro[3];
+    int32_t temp_centesimos;
+    bool tem_tempo;    // arquivos anteriores ao índice não têm Tempo_ms
+    uint32_t tempo_ms;
+} registro_csv_t;
+
+// false para o cabeçalho (inclusive as linhas "#" de metadados), linhas
+// vazias ou malformadas
+bool registro_csv_ler(const char *linha, registro_csv_t *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REGISTRO_CSV_H
@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "sensores.h"
+
+#define SENSORES_MASCARA (SENSORES_REGISTROS - 1)
+
+void sensores_iniciar(sensores_t *e)
+{
+    memset(e, 0, sizeof(*e));
+}
+
+bool sensores_registrar(sensores_t *e, sensor_t *s)
+{
+    if (e->n >= SENSORES_MAX || !s->passo || s->n_campos > SENSORES_VALORES)
+        return false;
+    e->sensores[e->n++] = s;
+    return true;
+}
+
+void sensores_armar(sensores_t *e, uint64_t agora_us)
+{
+    e->passos = e->adiados = 0;
+    e->escrita = e->leitura = 0;
+    e->perdidos = 0;
+    for (int i = 0; i < e->n; i++)
+    {
+        sensor_t *s = e->sensores[i];
+        s->medindo = false;
+        s->proxima_us = agora_us;
+        s->medidas = s->falhas = s->atrasadas = 0;
+    }
+}
+
+// Fila cheia: o registro novo é descartado, os antigos continuam em ordem
+static void sensores_publicar(sensores_t *e, int i)
+{
+    const sensor_t *s = e->sensores[i];
+    uint32_t n = e->escrita;
+    if (n - e->leitura >= SENSORES_REGISTROS)
+    {
+        e->perdidos++;
+        return;
+    }
+    sensores_registro_t *r = &e->fila[n & SENSORES_MASCARA];
+    r->tempo_us = s->inicio_us;
+    r->sensor = (uint8_t)i;
+    memcpy(r->valores, s->valores, sizeof(r->valores));
+    __dmb();
+    e->escrita = n + 1;
+}
+
+// Começa uma medida; se a folga faltou por períodos inteiros, eles são
+// pulados em vez de medidos em sequência
+static void sensores_comecar(sensor_t *s, uint64_t agora_us)
+{
+    s->medindo = true;
+    s->etapa = 0;
+    s->inicio_us = agora_us;
+    s->proxima_us += s->periodo_us;
+    if (s->proxima_us <= agora_us)
+    {
+        uint64_t pulados = (agora_us - s->proxima_us) / s->periodo_us + 1;
+        s->atrasadas += (uint32_t)pulados;
+        s->proxima_us += pulados * s->periodo_us;
+    }
+}
+
+void sensores_executar(sensores_t *e, uint64_t agora_us, int32_t folga_us)
+{
+    bool feito[SENSORES_MAX] = {false};
+    for (;;)
+    {
+        int escolhido = -1;
+        uint64_t vencimento = 0;
+        for (int i = 0; i < e->n; i++)
+        {
+            sensor_t *s = e->sensores[i];
+            if (!s->periodo_us || feito[i])
+                continue;
+            // Medida que não terminou dentro do próprio período
+            if (s->medindo && agora_us - s->inicio_us > s->periodo_us)
+            {
+                s->medindo = false;
+                s->falhas++;
+            }
+            uint64_t v = s->medindo ? s->espera_us : s->proxima_us;
+            if (v > agora_us)
+                continue;
+            if (s->custo_us > folga_us)
+            {
+                feito[i] = true;
+                e->adiados++;
+                continue;
+            }
+            if (escolhido < 0 || v < vencimento)
+            {
+                escolhido = i;
+                vencimento = v;
+            }
+        }
+        if (escolhido < 0)
+            return;
+
+        sensor_t *s = e->sensores[escolhido];
+        feito[escolhido] = true;
+        if (!s->medindo)
+            sensores_comecar(s, agora_us);
+        s->espera_us = agora_us;
+        sensor_passo_t r = s->passo(s, agora_us);
+        e->passos++;
+        folga_us -= s->custo_us;
+        if (r == SENSOR_MEDIDA)
+        {
+            s->medindo = false;
+            s->medidas++;
+            sensores_publicar(e, escolhido);
+        }
+        else if (r == SENSOR_FALHA)
+        {
+            s->medindo = false;
+            s->falhas++;
+        }
+    }
+}
+
+bool sensores_proximo(sensores_t *e, uint64_t ate_us, sensores_registro_t *r)
+{
+    if (e->leitura == e->escrita)
+        return false;
+    __dmb();
+    const sensores_registro_t *p = &e->fila[e->leitura & SENSORES_MASCARA];
+    if (p->tempo_us > ate_us)
+        return false;
+    *r = *p;
+    e->leitura++;
+    return true;
+}
+
+static int formatar_valor(char *destino, size_t tamanho, int32_t valor, uint8_t casas)
+{
+    if (!casas)
+        return snprintf(destino, tamanho, "%ld", (long)valor);
+    uint32_t divisor = 1;
+    for (int i = 0; i < casas; i++)
+        divisor *= 10;
+    uint32_t modulo = valor < 0 ? 0u - (uint32_t)valor : (uint32_t)valor;
+    return snprintf(destino, tamanho, "%s%lu.%0*lu", valor < 0 ? "-" : "", (unsigned long)(modulo / divisor), casas,
+                    (unsigned long)(modulo % divisor));
+}
+
+int sensores_formatar(const sensores_t *e, const sensores_registro_t *r, uint64_t origem_us, char *destino,
+                      size_t tamanho)
+{
+    const sensor_t *s = e->sensores[r->sensor];
+    int n = snprintf(destino, tamanho, "# %s t_us=%llu", s->nome,
+                     (unsigned long long)(r->tempo_us > origem_us ? r->tempo_us - origem_us : 0));
+    for (int i = 0; i < s->n_campos && n > 0 && (size_t)n < tamanho; i++)
+    {
+        n += snprintf(destino + n, tamanho - n, " %s=", s->campos[i].nome);
+        if ((size_t)n < tamanho)
+            n += formatar_valor(destino + n, tamanho - n, r->valores[i], s->campos[i].casas);
+    }
+    if (n > 0 && (size_t)n + 1 < tamanho)
+    {
+        destino[n++] = '\n';
+        destino[n] = '\0';
+        return n;
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+#ifndef SENSORES_H
+#define SENSORES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Escalonador dos sensores lentos que dividem o I2C com o MPU6050 (comando
+// "sensores"). Cada sensor se registra com a taxa pedida e uma máquina de
+// estados em que cada passo é uma transação curta no barramento (ou o par
+// registro e leitura): disparar a medida, conferir se terminou, ler o
+// resultado. Entre os passos o sensor diz até quando esperar, e ninguém
+// espera parado.
+//
+// sensores_executar() é chamada logo depois de cada leitura do MPU6050 (na
+// interrupção do amostrador ou no laço principal) com o tempo que sobra até
+// a próxima leitura. Um passo só roda se o custo declarado couber nesse
+// tempo; o que não cabe fica para a leitura seguinte. Assim o MPU6050 nunca
+// atrasa por causa dos outros sensores, e são eles que atrasam se faltar
+// folga.
+//
+// Cada medida completa vira um registro com o instante em que começou,
+// numa fila de um produtor (o escalonador) e um consumidor (a gravação).
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SENSORES_MAX 4
+#define SENSORES_VALORES 3
+#define SENSORES_REGISTROS 32 // potência de 2
+
+typedef enum {
+    SENSOR_CONTINUA, // fez uma transação; o próximo passo pode vir em seguida
+    SENSOR_ESPERA,   // o próximo passo só depois de 'espera_us'
+    SENSOR_MEDIDA,   // medida completa em 'valores'
+    SENSOR_FALHA,    // medida perdida; recomeça no próximo período
+} sensor_passo_t;
+
+// Nome de um valor no registro e casas decimais do inteiro guardado
+// ("temp_c", 2: 2534 vira 25.34)
+typedef struct {
+    const char *nome;
+    uint8_t casas;
+} sensor_campo_t;
+
+typedef struct sensor sensor_t;
+struct sensor {
+    // Preenchidos pelo módulo do sensor
+    const char *nome; // fluxo no arquivo
+    const sensor_campo_t *campos;
+    uint8_t n_campos;
+    uint16_t custo_us; // pior caso de um passo: soma dos I2C_TRANSACAO_US() das suas transações
+    sensor_passo_t (*passo)(sensor_t *s, uint64_t agora_us);
+    uint32_t periodo_us; // taxa pedida; 0 desliga
+
+    // Máquina de estados: o escalonador zera 'etapa' no início de cada
+    // medida; o passo avança 'etapa' e marca 'espera_us'
+    uint8_t etapa;
+    uint64_t espera_us;
+    int32_t valores[SENSORES_VALORES];
+
+    // Escalonador
+    bool medindo;
+    uint64_t inicio_us;  // da medida em andamento
+    uint64_t proxima_us; // início previsto da próxima medida
+    uint32_t medidas;
+    uint32_t falhas;     // passos que falharam e medidas que passaram do período
+    uint32_t atrasadas;  // períodos pulados por falta de folga
+};
+
+typedef struct {
+    uint64_t tempo_us; // início da medida
+    uint8_t sensor;    // posição no registro do escalonador
+    int32_t valores[SENSORES_VALORES];
+} sensores_registro_t;
+
+typedef struct {
+    sensor_t *sensores[SENSORES_MAX];
+    uint8_t n;
+    uint32_t passos;
+    uint32_t adiados; // passos que não couberam na folga
+    sensores_registro_t fila[SENSORES_REGISTROS];
+    volatile uint32_t escrita;
+    uint32_t leitura;
+    volatile uint32_t perdidos; // registros sobrescritos antes da gravação
+} sensores_t;
+
+void sensores_iniciar(sensores_t *e);
+
+// false se já há SENSORES_MAX sensores ou o sensor está incompleto
+bool sensores_registrar(sensores_t *e, sensor_t *s);
+
+// Zera contadores e a fila; a primeira medida de cada sensor começa em 'agora_us'
+void sensores_armar(sensores_t *e, uint64_t agora_us);
+
+// Roda os passos vencidos que cabem em 'folga_us', no máximo um por sensor,
+// na ordem do vencimento
+void sensores_executar(sensores_t *e, uint64_t agora_us, int32_t folga_us);
+
+// Próximo registro com início até 'ate_us'; false se não há
+bool sensores_proximo(sensores_t *e, uint64_t ate_us, sensores_registro_t *r);
+
+// "# bmp280 t_us=1234567 temp_c=25.34 pressao_pa=101325\n", com o instante
+// contado de 'origem_us'
+int sensores_formatar(const sensores_t *e, const sensores_registro_t *r, uint64_t origem_us, char *destino,
+                      size_t tamanho);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SENSORES_H
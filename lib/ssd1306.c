@@ -1,22 +1,37 @@
+#include <string.h>
 #include "ssd1306.h"
 #include "font.h"
 
+#ifndef SSD1306_NO_DMA
+#include "hardware/dma.h"
+#endif
+
+// Endereço do byte que contém o pixel (x, y): modo de endereçamento
+// horizontal, uma página (8 linhas) de 'width' bytes após o byte de controle
+#define SSD1306_INDEX(ssd, x, page) (1 + (page) * (ssd)->width + (x))
+
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
   ssd->height = height;
   ssd->pages = height / 8U;
   ssd->address = address;
+  ssd->external_vcc = external_vcc;
   ssd->i2c_port = i2c;
   ssd->bufsize = ssd->pages * ssd->width + 1;
   ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->sent_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->dma_channel = -1;
+  ssd->dma_words = NULL;
+  ssd->dma_pending = false;
+  ssd1306_invalidate(ssd);
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
   ssd1306_command(ssd, SET_DISP | 0x00);
   ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
+  ssd1306_command(ssd, 0x00);
   ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
   ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
   ssd1306_command(ssd, SET_MUX_RATIO);
@@ -42,6 +57,7 @@ void ssd1306_config(ssd1306_t *ssd) {
 }
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+  ssd1306_wait(ssd);
   ssd->port_buffer[1] = command;
   i2c_write_blocking(
     ssd->i2c_port,
@@ -52,49 +68,253 @@ void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   );
 }
 
-void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
+// Envia vários comandos em uma única transação (byte de controle 0x00)
+static void ssd1306_command_list(ssd1306_t *ssd, const uint8_t *commands, size_t count) {
+  uint8_t buf[8];
+  ssd1306_wait(ssd);
+  buf[0] = 0x00;
+  memcpy(&buf[1], commands, count);
+  i2c_write_blocking(ssd->i2c_port, ssd->address, buf, count + 1, false);
+}
+
+void ssd1306_invalidate(ssd1306_t *ssd) {
+  ssd->dirty_pages = 0xFF;
+  ssd->sent_valid = false;
+}
+
+// Envia as páginas [first, last] como uma só janela de escrita
+static void ssd1306_send_pages(ssd1306_t *ssd, uint8_t first, uint8_t last) {
+  const uint8_t window[] = {
+    SET_COL_ADDR, 0, ssd->width - 1,
+    SET_PAGE_ADDR, first, last
+  };
+  ssd1306_command_list(ssd, window, sizeof(window));
+
+  // O byte anterior à primeira página vira, temporariamente, o byte de
+  // controle 0x40; assim os dados saem direto do framebuffer, sem cópia
+  uint8_t *start = &ssd->ram_buffer[SSD1306_INDEX(ssd, 0, first) - 1];
+  uint8_t saved = *start;
+  *start = 0x40;
   i2c_write_blocking(
     ssd->i2c_port,
     ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
+    start,
+    (last - first + 1) * ssd->width + 1,
     false
   );
+  *start = saved;
+}
+
+#ifndef SSD1306_NO_DMA
+// Cada palavra escrita em IC_DATA_CMD leva o byte nos bits 7..0; o bit STOP
+// encerra a transação e a próxima palavra abre outra com um novo START
+static uint16_t *ssd1306_dma_append(uint16_t *out, uint8_t control, const uint8_t *bytes, size_t len) {
+  *out++ = control;
+  for (size_t i = 0; i < len; ++i)
+    *out++ = bytes[i];
+  out[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+  return out;
+}
+
+bool ssd1306_dma_init(ssd1306_t *ssd) {
+  int channel = dma_claim_unused_channel(false);
+  if (channel < 0)
+    return false;
+  // Pior caso: cada página em uma janela própria (comandos + dados)
+  size_t words = ssd->pages * (7 + 1 + ssd->width);
+  ssd->dma_words = calloc(words, sizeof(uint16_t));
+  if (!ssd->dma_words) {
+    dma_channel_unclaim(channel);
+    return false;
+  }
+
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  dma_channel_config cfg = dma_channel_get_default_config(channel);
+  channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+  channel_config_set_read_increment(&cfg, true);
+  channel_config_set_write_increment(&cfg, false);
+  channel_config_set_dreq(&cfg, i2c_get_dreq(ssd->i2c_port, true));
+  dma_channel_configure(channel, &cfg, &hw->data_cmd, ssd->dma_words, 0, false);
+  ssd->dma_channel = channel;
+  return true;
+}
+
+bool ssd1306_busy(ssd1306_t *ssd) {
+  if (ssd->dma_channel < 0)
+    return false;
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  // NACK (display ausente): o controlador esvazia a FIFO e para de pedir
+  // dados; o quadro é descartado e reenviado por inteiro na próxima vez
+  if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+    dma_channel_abort(ssd->dma_channel);
+    (void)hw->clr_tx_abrt;
+    ssd1306_invalidate(ssd);
+    return false;
+  }
+  if (dma_channel_is_busy(ssd->dma_channel))
+    return true;
+  // A DMA terminou de alimentar a FIFO, mas os últimos bytes ainda saem
+  return !(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS);
+}
+
+void ssd1306_poll(ssd1306_t *ssd) {
+  if (ssd->dma_pending && !ssd1306_busy(ssd))
+    ssd1306_send_data(ssd);
+}
+#else
+bool ssd1306_dma_init(ssd1306_t *ssd) {
+  (void)ssd;
+  return false;
+}
+
+bool ssd1306_busy(ssd1306_t *ssd) {
+  (void)ssd;
+  return false;
+}
+
+void ssd1306_poll(ssd1306_t *ssd) {
+  (void)ssd;
+}
+#endif
+
+void ssd1306_wait(ssd1306_t *ssd) {
+  while (ssd1306_busy(ssd))
+    tight_loop_contents();
+}
+
+void ssd1306_send_data(ssd1306_t *ssd) {
+  // Com DMA, um quadro em andamento nunca bloqueia o chamador: as páginas
+  // continuam marcadas e o envio fica para ssd1306_poll()
+  if (ssd1306_busy(ssd)) {
+    ssd->dma_pending = true;
+    return;
+  }
+  ssd->dma_pending = false;
+
+  // Descarta páginas marcadas que, depois de redesenhadas, ficaram iguais
+  // ao que o display já mostra (caso típico: relógio redesenhado a cada 500ms)
+  uint8_t changed = 0;
+  for (uint8_t page = 0; page < ssd->pages; ++page) {
+    if (!(ssd->dirty_pages & (1u << page)))
+      continue;
+    size_t offset = SSD1306_INDEX(ssd, 0, page);
+    if (!ssd->sent_valid ||
+        memcmp(&ssd->ram_buffer[offset], &ssd->sent_buffer[offset], ssd->width) != 0)
+      changed |= (1u << page);
+  }
+  ssd->dirty_pages = 0;
+
+#ifndef SSD1306_NO_DMA
+  uint16_t *words = ssd->dma_words;
+#endif
+  // Agrupa páginas alteradas consecutivas em uma única transferência
+  uint8_t page = 0;
+  while (page < ssd->pages) {
+    if (!(changed & (1u << page))) {
+      ++page;
+      continue;
+    }
+    uint8_t last = page;
+    while (last + 1 < ssd->pages && (changed & (1u << (last + 1))))
+      ++last;
+    size_t offset = SSD1306_INDEX(ssd, 0, page);
+    size_t len = (last - page + 1) * ssd->width;
+#ifndef SSD1306_NO_DMA
+    if (ssd->dma_channel >= 0) {
+      // O quadro é copiado para a fila da DMA (segundo buffer): o chamador
+      // pode voltar a desenhar em ram_buffer enquanto a transferência corre
+      const uint8_t window[] = {
+        SET_COL_ADDR, 0, ssd->width - 1,
+        SET_PAGE_ADDR, page, last
+      };
+      words = ssd1306_dma_append(words, 0x00, window, sizeof(window));
+      words = ssd1306_dma_append(words, 0x40, &ssd->ram_buffer[offset], len);
+    } else
+#endif
+      ssd1306_send_pages(ssd, page, last);
+    memcpy(&ssd->sent_buffer[offset], &ssd->ram_buffer[offset], len);
+    page = last + 1;
+  }
+  ssd->sent_valid = true;
+
+#ifndef SSD1306_NO_DMA
+  if (ssd->dma_channel >= 0 && words != ssd->dma_words) {
+    i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+    hw->enable = 0;
+    hw->tar = ssd->address;
+    hw->enable = 1;
+    dma_channel_transfer_from_buffer_now(ssd->dma_channel, ssd->dma_words, words - ssd->dma_words);
+  }
+#endif
+}
+
+bool ssd1306_scroll_append(ssd1306_t *ssd, uint8_t first_page, uint8_t last_page, const uint8_t *column) {
+  if (ssd1306_busy(ssd))
+    return false;
+  uint8_t x = ssd->width - 1;
+  uint8_t count = last_page - first_page + 1;
+
+  // Espelha a rolagem nas duas cópias locais, assim o controle de páginas
+  // alteradas continua enxergando o mesmo conteúdo que o display
+  for (uint8_t page = first_page; page <= last_page; ++page) {
+    size_t offset = SSD1306_INDEX(ssd, 0, page);
+    memmove(&ssd->ram_buffer[offset], &ssd->ram_buffer[offset + 1], x);
+    memmove(&ssd->sent_buffer[offset], &ssd->sent_buffer[offset + 1], x);
+    ssd->ram_buffer[offset + x] = column[page - first_page];
+    ssd->sent_buffer[offset + x] = column[page - first_page];
+  }
+
+  // Rolagem de uma coluna (não contínua): desloca a GDDRAM exatamente uma
+  // vez por comando, sem depender do relógio de quadros do controlador
+  const uint8_t scroll[] = {
+    SET_SCROLL_COLUMN_LEFT, 0x00, first_page, 0x01, last_page, 0x00, x
+  };
+  const uint8_t window[] = {
+    SET_COL_ADDR, x, x,
+    SET_PAGE_ADDR, first_page, last_page
+  };
+
+#ifndef SSD1306_NO_DMA
+  if (ssd->dma_channel >= 0) {
+    uint16_t *words = ssd->dma_words;
+    words = ssd1306_dma_append(words, 0x00, scroll, sizeof(scroll));
+    words = ssd1306_dma_append(words, 0x00, window, sizeof(window));
+    words = ssd1306_dma_append(words, 0x40, column, count);
+    i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+    hw->enable = 0;
+    hw->tar = ssd->address;
+    hw->enable = 1;
+    dma_channel_transfer_from_buffer_now(ssd->dma_channel, ssd->dma_words, words - ssd->dma_words);
+    return true;
+  }
+#endif
+  uint8_t data[1 + 8];
+  data[0] = 0x40;
+  memcpy(&data[1], column, count);
+  ssd1306_command_list(ssd, scroll, sizeof(scroll));
+  ssd1306_command_list(ssd, window, sizeof(window));
+  i2c_write_blocking(ssd->i2c_port, ssd->address, data, count + 1, false);
+  return true;
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
-  uint16_t index = (y >> 3) + (x << 3) + 1;
+  if (x >= ssd->width || y >= ssd->height)
+    return;
+  uint8_t page = y >> 3;
+  uint16_t index = SSD1306_INDEX(ssd, x, page);
   uint8_t pixel = (y & 0b111);
   if (value)
     ssd->ram_buffer[index] |= (1 << pixel);
   else
     ssd->ram_buffer[index] &= ~(1 << pixel);
+  ssd->dirty_pages |= (1u << page);
 }
 
-/*
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-  uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
-
 void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
-    }
+  memset(&ssd->ram_buffer[1], value ? 0xFF : 0x00, ssd->bufsize - 1);
+  ssd->dirty_pages = 0xFF;
 }
 
-
-
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
   for (uint8_t x = left; x < left + width; ++x) {
     ssd1306_pixel(ssd, x, top, value);
@@ -144,13 +364,41 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 
 
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+  if (y >= ssd->height)
+    return;
+  if (x1 >= ssd->width)
+    x1 = ssd->width - 1;
+  uint8_t page = y >> 3;
+  uint8_t mask = 1u << (y & 0b111);
+  uint8_t *row = &ssd->ram_buffer[SSD1306_INDEX(ssd, 0, page)];
+  for (uint8_t x = x0; x <= x1; ++x) {
+    if (value)
+      row[x] |= mask;
+    else
+      row[x] &= ~mask;
+  }
+  ssd->dirty_pages |= (1u << page);
 }
 
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+  if (x >= ssd->width || y0 > y1 || y0 >= ssd->height)
+    return;
+  if (y1 >= ssd->height)
+    y1 = ssd->height - 1;
+  // Preenche byte a byte: máscara parcial nas páginas das pontas
+  for (uint8_t page = y0 >> 3; page <= (y1 >> 3); ++page) {
+    uint8_t mask = 0xFF;
+    if (page == (y0 >> 3))
+      mask &= 0xFF << (y0 & 0b111);
+    if (page == (y1 >> 3))
+      mask &= 0xFF >> (7 - (y1 & 0b111));
+    uint8_t *byte = &ssd->ram_buffer[SSD1306_INDEX(ssd, x, page)];
+    if (value)
+      *byte |= mask;
+    else
+      *byte &= ~mask;
+    ssd->dirty_pages |= (1u << page);
+  }
 }
 
 // Função para desenhar um caractere
@@ -169,15 +417,31 @@ void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
     index = 0; // Índice 0 corresponde ao caractere "nada" (espaço)
   }
 
-  // Desenha o caractere na tela
-  for (uint8_t i = 0; i < 8; ++i)
+  if (y >= ssd->height)
+    return;
+
+  // Cada byte da fonte é uma coluna de 8 pixels, no mesmo formato de uma
+  // página do display: copia a coluna inteira, deslocada quando 'y' não
+  // está alinhado à página, em vez de desenhar pixel a pixel
+  uint8_t page = y >> 3;
+  uint8_t shift = y & 0b111;
+  bool has_next = shift && (page + 1 < ssd->pages);
+  uint8_t *upper = &ssd->ram_buffer[SSD1306_INDEX(ssd, 0, page)];
+  uint8_t *lower = has_next ? upper + ssd->width : NULL;
+  uint8_t upper_mask = 0xFF << shift;
+  uint8_t lower_mask = 0xFF >> (8 - shift);
+
+  for (uint8_t i = 0; i < 8 && x + i < ssd->width; ++i)
   {
-    uint8_t line = font[index + i]; // Acessa a linha correspondente do caractere na fonte
-    for (uint8_t j = 0; j < 8; ++j)
-    {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j)); // Desenha cada pixel do caractere
-    }
+    uint8_t column = font[index + i];
+    upper[x + i] = (upper[x + i] & ~upper_mask) | (uint8_t)(column << shift);
+    if (has_next)
+      lower[x + i] = (lower[x + i] & ~lower_mask) | (uint8_t)(column >> (8 - shift));
   }
+
+  ssd->dirty_pages |= (1u << page);
+  if (has_next)
+    ssd->dirty_pages |= (1u << (page + 1));
 }
 
 // Função para desenhar uma string
@@ -1,3 +1,6 @@
+#ifndef SSD1306_H
+#define SSD1306_H
+
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
@@ -22,7 +25,10 @@ typedef enum {
   SET_DISP_CLK_DIV = 0xD5,
   SET_PRECHARGE = 0xD9,
   SET_VCOM_DESEL = 0xDB,
-  SET_CHARGE_PUMP = 0x8D
+  SET_CHARGE_PUMP = 0x8D,
+  SET_SCROLL_OFF = 0x2E,
+  SET_SCROLL_COLUMN_RIGHT = 0x2C,
+  SET_SCROLL_COLUMN_LEFT = 0x2D
 } ssd1306_command_t;
 
 typedef struct {
@@ -32,12 +38,33 @@ typedef struct {
   uint8_t *ram_buffer;
   size_t bufsize;
   uint8_t port_buffer[2];
+  uint8_t *sent_buffer;  // cópia do que o display já mostra
+  bool sent_valid;       // false até o primeiro envio completo
+  uint8_t dirty_pages;   // bit n = página n alterada desde o último envio
+  int dma_channel;       // -1 = envio bloqueante
+  uint16_t *dma_words;   // quadro codificado para IC_DATA_CMD (segundo buffer)
+  bool dma_pending;      // houve envio pedido enquanto a DMA estava ocupada
 } ssd1306_t;
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
 void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_invalidate(ssd1306_t *ssd);
+
+// Envio assíncrono: após ssd1306_dma_init, ssd1306_send_data apenas dispara
+// a DMA e retorna. ssd1306_poll reenvia quadros pedidos durante um envio.
+bool ssd1306_dma_init(ssd1306_t *ssd);
+bool ssd1306_busy(ssd1306_t *ssd);
+void ssd1306_poll(ssd1306_t *ssd);
+void ssd1306_wait(ssd1306_t *ssd);
+
+// Rola as páginas [first_page, last_page] uma coluna para a esquerda no
+// display (comando de rolagem horizontal do próprio SSD1306) e no
+// framebuffer, e envia só a nova coluna da direita: column[i] é o byte da
+// página first_page + i. Retorna false, sem fazer nada, se um envio por DMA
+// ainda estiver em andamento.
+bool ssd1306_scroll_append(ssd1306_t *ssd, uint8_t first_page, uint8_t last_page, const uint8_t *column);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
@@ -46,4 +73,6 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
\ No newline at end of file
+void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+
+#endif // SSD1306_H
@@ -0,0 +1,207 @@
+#include <string.h>
+#include "pico/stdlib.h"
+#include "protocolo.h"
+#include "usb_saida.h"
+#include "console.h"
+#include "transferencia.h"
+
+#define TIMEOUT_ACK_MS 1000 // sem ACK: reenvia a partir do último confirmado
+#define TIMEOUT_MS 10000    // sem progresso: desiste
+
+static FIL arquivo;
+static bool ativa = false;
+static bool encerrar_apos_envio;
+static uint64_t tamanho;
+static uint64_t enviado;    // próximo byte a ler do cartão
+static uint64_t confirmado; // bytes confirmados pelo PC
+static uint64_t rebobinar;  // NACK pendente (UINT64_MAX = nenhum)
+static uint32_t seq;
+static uint32_t retransmissoes;
+static absolute_time_t prazo_ack;
+static absolute_time_t prazo_final;
+static protocolo_receptor_t receptor;
+
+// Um quadro por vez; os dados do bloco são lidos direto na carga útil
+static uint8_t quadro[PROTOCOLO_EXTRA + sizeof(protocolo_arq_bloco_t) + TRANSFERENCIA_BLOCO];
+static size_t quadro_len;
+static size_t quadro_pos;
+
+static void quadro_controle(uint8_t tipo, const void *carga, uint16_t len)
+{
+    quadro_len = protocolo_montar(quadro, tipo, seq++, carga, len);
+    quadro_pos = 0;
+}
+
+static void encerrar_com_erro(int32_t codigo)
+{
+    protocolo_arq_erro_t erro = {.codigo = codigo};
+    quadro_controle(PROTOCOLO_TIPO_ARQ_ERRO, &erro, sizeof(erro));
+    encerrar_apos_envio = true;
+}
+
+static void reiniciar_prazos(void)
+{
+    prazo_ack = make_timeout_time_ms(TIMEOUT_ACK_MS);
+    prazo_final = make_timeout_time_ms(TIMEOUT_MS);
+}
+
+FRESULT transferencia_iniciar(const char *caminho, uint64_t offset)
+{
+    if (ativa)
+        return FR_LOCKED;
+    FRESULT fr = f_open(&arquivo, caminho, FA_READ);
+    if (FR_OK != fr)
+        return fr;
+    tamanho = f_size(&arquivo);
+    if (offset > tamanho)
+        offset = tamanho;
+    fr = f_lseek(&arquivo, offset);
+    if (FR_OK != fr)
+    {
+        f_close(&arquivo);
+        return fr;
+    }
+    enviado = confirmado = offset;
+    rebobinar = UINT64_MAX;
+    seq = retransmissoes = 0;
+    receptor.n = 0;
+    encerrar_apos_envio = false;
+    reiniciar_prazos();
+
+    protocolo_arq_inicio_t inicio = {
+        .tamanho = tamanho,
+        .offset = offset,
+        .janela = TRANSFERENCIA_JANELA,
+        .bloco = TRANSFERENCIA_BLOCO};
+    quadro_controle(PROTOCOLO_TIPO_ARQ_INICIO, &inicio, sizeof(inicio));
+    ativa = true;
+    return FR_OK;
+}
+
+bool transferencia_ativa(void)
+{
+    return ativa;
+}
+
+static void tratar_quadro_recebido(void)
+{
+    uint8_t tipo = receptor.buf[2];
+    protocolo_arq_ack_t ack;
+    if (tipo == PROTOCOLO_TIPO_ARQ_CANCELAR)
+    {
+        if (!encerrar_apos_envio)
+            encerrar_com_erro(PROTOCOLO_ERRO_CANCELADO);
+        return;
+    }
+    if (receptor.buf[3] != sizeof(ack) || receptor.buf[4] != 0)
+        return;
+    memcpy(&ack, &receptor.buf[PROTOCOLO_CABECALHO], sizeof(ack));
+
+    // Confirmações fora de [confirmado, enviado] são de antes de um
+    // reenvio e já não valem
+    if (ack.offset < confirmado || ack.offset > enviado)
+        return;
+    if (ack.offset > confirmado)
+    {
+        confirmado = ack.offset;
+        reiniciar_prazos();
+    }
+    if (tipo == PROTOCOLO_TIPO_ARQ_NACK && ack.offset < enviado)
+        rebobinar = ack.offset;
+}
+
+static void ler_entrada(void)
+{
+    int c;
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT)
+        if (protocolo_receber(&receptor, (uint8_t)c))
+            tratar_quadro_recebido();
+}
+
+static void voltar_para(uint64_t offset)
+{
+    if (FR_OK != f_lseek(&arquivo, offset))
+    {
+        encerrar_com_erro(FR_DISK_ERR);
+        return;
+    }
+    retransmissoes += (uint32_t)((enviado - offset + TRANSFERENCIA_BLOCO - 1) / TRANSFERENCIA_BLOCO);
+    enviado = offset;
+}
+
+static void ler_proximo_bloco(void)
+{
+    // O primeiro bloco de uma retomada vai só até o próximo alinhamento
+    UINT len = TRANSFERENCIA_BLOCO - (UINT)(enviado % TRANSFERENCIA_BLOCO);
+    if (len > tamanho - enviado)
+        len = (UINT)(tamanho - enviado);
+
+    protocolo_arq_bloco_t cabecalho = {.offset = enviado};
+    memcpy(&quadro[PROTOCOLO_CABECALHO], &cabecalho, sizeof(cabecalho));
+    UINT lidos;
+    FRESULT fr = f_read(&arquivo, &quadro[PROTOCOLO_CABECALHO + sizeof(cabecalho)], len, &lidos);
+    if (FR_OK != fr || lidos != len)
+    {
+        encerrar_com_erro(FR_OK != fr ? fr : FR_DISK_ERR);
+        return;
+    }
+    quadro_len = protocolo_fechar(quadro, PROTOCOLO_TIPO_ARQ_BLOCO, seq++, (uint16_t)(sizeof(cabecalho) + len));
+    quadro_pos = 0;
+    enviado += len;
+}
+
+void transferencia_tarefa(void)
+{
+    if (!ativa)
+        return;
+    ler_entrada();
+
+    // Termina o quadro em andamento antes de qualquer outra decisão: um
+    // quadro cortado no meio custaria um reenvio no PC
+    if (quadro_pos < quadro_len)
+    {
+        quadro_pos += usb_saida_escrever(&quadro[quadro_pos], quadro_len - quadro_pos);
+        if (quadro_pos < quadro_len)
+            return;
+    }
+    if (encerrar_apos_envio)
+    {
+        f_close(&arquivo);
+        ativa = false;
+        console_printf("\nTransferência encerrada: %llu de %llu bytes confirmados, %lu blocos reenviados\n",
+               (unsigned long long)confirmado, (unsigned long long)tamanho, (unsigned long)retransmissoes);
+        return;
+    }
+
+    if (rebobinar != UINT64_MAX)
+    {
+        voltar_para(rebobinar);
+        rebobinar = UINT64_MAX;
+        reiniciar_prazos();
+        return;
+    }
+    if (confirmado == tamanho)
+    {
+        protocolo_arq_fim_t fim = {.tamanho = tamanho, .retransmissoes = retransmissoes};
+        quadro_controle(PROTOCOLO_TIPO_ARQ_FIM, &fim, sizeof(fim));
+        encerrar_apos_envio = true;
+        return;
+    }
+    if (time_reached(prazo_final))
+    {
+        encerrar_com_erro(PROTOCOLO_ERRO_TIMEOUT);
+        return;
+    }
+    if (time_reached(prazo_ack) && enviado > confirmado)
+    {
+        // Go-back-N: sem notícias do PC, reenvia tudo que não foi confirmado
+        voltar_para(confirmado);
+        prazo_ack = make_timeout_time_ms(TIMEOUT_ACK_MS);
+        return;
+    }
+    if (enviado < tamanho && enviado - confirmado < TRANSFERENCIA_JANELA)
+    {
+        ler_proximo_bloco();
+        quadro_pos += usb_saida_escrever(quadro, quadro_len);
+    }
+}
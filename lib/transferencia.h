@@ -0,0 +1,31 @@
+#ifndef TRANSFERENCIA_H
+#define TRANSFERENCIA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ff.h"
+
+// Download binário de arquivos do cartão SD pela USB (comando "baixar").
+//
+// A placa envia blocos de até TRANSFERENCIA_BLOCO bytes em quadros
+// PROTOCOLO_TIPO_ARQ_BLOCO, cada um com o deslocamento no arquivo e CRC.
+// O PC confirma com ACK cumulativo; no máximo TRANSFERENCIA_JANELA bytes
+// ficam sem confirmação. NACK ou falta de ACK fazem a placa voltar ao
+// deslocamento pedido (go-back-N), relendo os dados do cartão.
+
+// Múltiplo do setor: com deslocamentos alinhados, o f_read lê direto no
+// buffer do quadro e o driver usa CMD18 (leitura de vários blocos)
+#define TRANSFERENCIA_BLOCO 4096
+#define TRANSFERENCIA_JANELA (8 * TRANSFERENCIA_BLOCO)
+
+// Abre o arquivo e começa a enviar a partir de 'offset'. Retorna o erro do
+// FatFs (FR_OK se a transferência começou)
+FRESULT transferencia_iniciar(const char *caminho, uint64_t offset);
+
+bool transferencia_ativa(void);
+
+// Chamada no laço principal: lê ACK/NACK da USB e envia o que couber na
+// janela sem bloquear. Enquanto ativa, consome toda a entrada da USB
+void transferencia_tarefa(void);
+
+#endif // TRANSFERENCIA_H
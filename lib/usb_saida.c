@@ -0,0 +1,46 @@
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "tusb.h"
+#include "usb_saida.h"
+
+// A escrita vai pelo driver stdio_usb, que pega o mutex do stdio USB antes
+// de mexer na FIFO: a tarefa USB que o SDK roda em segundo plano usa o
+// mesmo mutex. Chamado direto, out_chars não passa pela conversão de '\n'
+// do stdio, e o printf continua com "\r\n". Como só se escreve o que cabe
+// na FIFO, out_chars não fica esperando o PC.
+static void enviar(const uint8_t *dados, size_t len)
+{
+    stdio_usb.out_chars((const char *)dados, (int)len);
+}
+
+bool usb_saida_conectada(void)
+{
+    return stdio_usb_connected();
+}
+
+size_t usb_saida_livre(void)
+{
+    if (!usb_saida_conectada())
+        return 0;
+    return tud_cdc_write_available();
+}
+
+bool usb_saida_enviar(const uint8_t *dados, size_t len)
+{
+    if (usb_saida_livre() < len)
+        return false;
+    if (len)
+        enviar(dados, len);
+    return true;
+}
+
+size_t usb_saida_escrever(const uint8_t *dados, size_t len)
+{
+    size_t livre = usb_saida_livre();
+    if (len > livre)
+        len = livre;
+    if (len == 0)
+        return 0;
+    enviar(dados, len);
+    return len;
+}
@@ -0,0 +1,25 @@
+#ifndef USB_SAIDA_H
+#define USB_SAIDA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Escrita binária na CDC USB, sem passar pelo printf (sem conversão de
+// '\n' e sem esperar o PC). Usa o driver stdio_usb do SDK, que serializa o
+// acesso à FIFO com a tarefa USB em segundo plano e com o printf.
+
+// PC com a porta serial aberta
+bool usb_saida_conectada(void);
+
+// Bytes que cabem agora na FIFO de transmissão (0 se o PC não está conectado)
+size_t usb_saida_livre(void);
+
+// Envia tudo ou nada: retorna false, sem escrever, se não couber agora
+bool usb_saida_enviar(const uint8_t *dados, size_t len);
+
+// Escreve o quanto couber agora e retorna o número de bytes aceitos
+// (quadros maiores que a FIFO são enviados em várias chamadas)
+size_t usb_saida_escrever(const uint8_t *dados, size_t len);
+
+#endif // USB_SAIDA_H